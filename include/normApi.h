@@ -51,6 +51,8 @@ typedef uint32_t UINT32;
 //  C++ code continues to evolve.  But, until this notice
 //  is removed, the API shouldn't be considered final.
 
+#include "normIovec.h"  // for "struct iovec"
+
 #ifndef __cplusplus
 #include <stdbool.h>
 #define DEFAULT(arg)
@@ -111,6 +113,14 @@ typedef enum NormFlushMode
     NORM_FLUSH_ACTIVE
 } NORM_API_LINKAGE NormFlushMode;
 
+/** Flags for NormStreamWritev() */
+typedef enum NormWritevFlags
+{
+    NORM_WRITEV_NONE     = 0x00,
+    NORM_WRITEV_EOM      = 0x01,   // mark end-of-message after the last buffer
+    NORM_WRITEV_EOM_EACH = 0x02    // each buffer is a complete message
+} NORM_API_LINKAGE NormWritevFlags;
+
 typedef enum NormNackingMode
 {
     NORM_NACK_NONE,
@@ -208,9 +218,31 @@ int NormGetVersion(int* major DEFAULT((int*)0),
                    int* minor DEFAULT((int*)0),
                    int* patch  DEFAULT((int*)0));
 
+// Creates an instance with a single NORM protocol thread that runs all of
+// its sessions (the same as "NormCreateInstanceEx(priorityBoost, 1)").
 NORM_API_LINKAGE
 NormInstanceHandle NormCreateInstance(bool priorityBoost DEFAULT(false));
 
+// The "threadCount" sets how the instance's NORM protocol operation is run:
+//
+// 0 - No NORM protocol thread is created and the application instead runs the
+//     instance from its own event loop (UNIX only).  The application waits for
+//     input on the "NormGetDescriptors()" (or for "NormGetNextTimeout()" to
+//     elapse) and then calls "NormInstanceProcess()".  All API calls for such
+//     an instance must be made from the same (event loop) thread.
+// 1 - The default single NORM protocol thread runs all of the instance's
+//     sessions (as with "NormCreateInstance()").
+// N - An instance with "N" NORM protocol threads.  Each session is run by one
+//     thread (see "NormCreateSessionEx()") and the events of all sessions are
+//     delivered through the one instance event queue.  (Event retrieval locks
+//     only that queue and briefly suspends just the thread(s) owning the
+//     retrieved events' handles, so retrieving events in batches with
+//     "NormGetNextEvents()" is still recommended, and an event callback, if
+//     set, may be invoked concurrently from the different threads.)
+NORM_API_LINKAGE
+NormInstanceHandle NormCreateInstanceEx(bool         priorityBoost DEFAULT(false),
+                                        unsigned int threadCount DEFAULT(1));
+
 NORM_API_LINKAGE
 void NormDestroyInstance(NormInstanceHandle instanceHandle);
 
@@ -238,6 +270,20 @@ bool NormSetCacheDirectory(NormInstanceHandle instanceHandle,
 NORM_API_LINKAGE
 bool NormGetNextEvent(NormInstanceHandle instanceHandle, NormEvent* theEvent, bool waitForEvent DEFAULT(true));
 
+// Retrieves up to "count" pending events at once, waiting up to "timeout" seconds 
+// (a negative "timeout" waits indefinitely and zero doesn't wait) if none are 
+// pending.  Returns the number of events placed in "eventArray".  The handles
+// of the returned events remain valid until the next "NormGetNextEvent(s)()"
+// call or "NormReleaseEvents()".
+NORM_API_LINKAGE
+unsigned int NormGetNextEvents(NormInstanceHandle instanceHandle, 
+                               NormEvent*         eventArray, 
+                               unsigned int       count,
+                               double             timeout DEFAULT(-1.0));
+
+NORM_API_LINKAGE
+void NormReleaseEvents(NormInstanceHandle instanceHandle);
+
 // The "NormGetDescriptor()" function returns a HANDLE (WIN32) or
 // a file descriptor (UNIX) which can be used for async notification
 // of pending NORM events. On WIN32, the returned HANDLE can be used 
@@ -256,6 +302,83 @@ const NormDescriptor NORM_DESCRIPTOR_INVALID;
 NORM_API_LINKAGE
 NormDescriptor NormGetDescriptor(NormInstanceHandle instanceHandle);
 
+// External loop operation (see "NormCreateInstanceEx()"):  "NormGetDescriptors()" 
+// fills "descArray" with the session socket descriptors to be monitored for input
+// (two per session suffices) and returns the count.  These change as sessions
+// are started or stopped.  "NormGetNextTimeout()" returns the seconds until
+// "NormInstanceProcess()" should be called if no descriptor becomes ready sooner
+// (-1.0 if no timeout is pending).  "NormInstanceProcess()" services ready sockets
+// (up to "maxWork" socket handler invocations, zero means no limit) and expired
+// timers, returning the amount of work done.  When "maxWork" cuts a call short,
+// the next call resumes with the session after the last one serviced.  Events are retrieved with 
+// "NormGetNextEvent(instance, &event, false)" or delivered via "NormSetEventCallback()".
+// (Not supported on WIN32)
+NORM_API_LINKAGE
+unsigned int NormGetDescriptors(NormInstanceHandle instanceHandle,
+                                NormDescriptor*    descArray,
+                                unsigned int       arraySize);
+
+NORM_API_LINKAGE
+double NormGetNextTimeout(NormInstanceHandle instanceHandle);
+
+NORM_API_LINKAGE
+unsigned int NormInstanceProcess(NormInstanceHandle instanceHandle,
+                                 unsigned int       maxWork DEFAULT(0));
+
+// Pending events are queued up to a memory limit ("maxBytes", default 8 MB).  
+// Events beyond that limit are dropped and counted by "NormGetEventOverflowCount()",
+// except NORM_RX_OBJECT_NEW/COMPLETED/ABORTED, NORM_TX_OBJECT_PURGED, and 
+// NORM_REMOTE_SENDER_PURGED, which are always queued since they carry object and
+// sender handle state.  (New receive objects are accepted either way.)
+NORM_API_LINKAGE
+void NormSetEventQueueLimit(NormInstanceHandle instanceHandle,
+                            unsigned long      maxBytes);
+
+NORM_API_LINKAGE
+unsigned long NormGetEventOverflowCount(NormInstanceHandle instanceHandle);
+
+// Sets a callback that is invoked directly from the NORM protocol thread for 
+// each event instead of queueing it for "NormGetNextEvent()" (a NULL 
+// "eventCallback" restores queued delivery).  The event handles are valid only
+// for the duration of the callback (use NormObjectRetain() or NormNodeRetain()
+// to keep them).  The callback must return promptly and may only call the
+// non-blocking "per-event" functions (e.g., NormStreamRead(), NormStreamPeekSegments(),
+// NormStreamConsume(), NormObjectGetInfo(), NormGetAckingStatus(), NormObjectRelease(),
+// NormObjectCancel(), NormSetWatermark() ...).  NormGetNextEvent(s)(), NormDestroySession(),
+// and the instance stop/restart/destroy functions fail when called from the callback.
+// NormObjectCancel(), NormStreamClose(stream, false), NormNodeDelete(), NormStopSender(),
+// and NormStopReceiver() take effect just after the callback returns to the NORM
+// thread's dispatch loop (the handle remains valid until then).  Events caused by
+// API calls made from within the callback are passed to it, in order, once it returns.
+typedef void (*NormEventCallback)(const void* userData, const NormEvent* theEvent);
+
+NORM_API_LINKAGE
+bool NormSetEventCallback(NormInstanceHandle instanceHandle,
+                          NormEventCallback  eventCallback,
+                          const void*        userData DEFAULT((const void*)0));
+
+// Sets a callback that supplies the destination buffer for each received 
+// NORM_OBJECT_DATA (just before its NORM_RX_OBJECT_NEW notification) so that
+// received segments and decoded content are written directly into application
+// memory (e.g., a registered region or shared-memory ring) instead of being
+// copied out after completion.  The callback is given the object handle (for 
+// NormObjectGetSize() or, if already received, NormObjectGetInfo()) and its 
+// "dataLen" and returns a buffer of at least "dataLen" bytes, or NULL to use the
+// default (NormSetAllocationFunctions()) allocation.  Supplied buffers are never
+// freed by NORM and must remain valid until the object is completed, aborted,
+// or released; NormDataAccessData() returns them.  The callback is _not_ invoked
+// for compressed objects (see NormSetTxCompression()); their content is 
+// received and decompressed into default-allocated buffers instead.
+// The callback runs on the NORM protocol thread with the same restrictions as
+// the NormEventCallback (for a multi-threaded instance, it applies to all of the
+// instance's threads and may be invoked from them concurrently).
+typedef char* (*NormDataPlacementCallback)(const void* userData, NormObjectHandle objectHandle, UINT32 dataLen);
+
+NORM_API_LINKAGE
+bool NormSetRxDataPlacement(NormInstanceHandle        instanceHandle,
+                            NormDataPlacementCallback placementCallback,
+                            const void*               userData DEFAULT((const void*)0));
+
 NORM_API_LINKAGE
 void NormSetAllocationFunctions(NormInstanceHandle      instance,
                                 NormAllocFunctionHandle allocFunc,
@@ -269,6 +392,16 @@ NormSessionHandle NormCreateSession(NormInstanceHandle instanceHandle,
                                     UINT16             sessionPort,
                                     NormNodeId         localNodeId);
 
+// Creates a session run by the instance thread with the given "threadIndex"
+// (0 to threadCount-1, see "NormCreateInstanceEx()").  A negative "threadIndex"
+// assigns sessions to threads in round-robin order (as does "NormCreateSession()").
+NORM_API_LINKAGE
+NormSessionHandle NormCreateSessionEx(NormInstanceHandle instanceHandle,
+                                      const char*        sessionAddress,
+                                      UINT16             sessionPort,
+                                      NormNodeId         localNodeId,
+                                      int                threadIndex DEFAULT(-1));
+
 NORM_API_LINKAGE
 void NormDestroySession(NormSessionHandle sessionHandle);
 
@@ -393,6 +526,30 @@ NORM_API_LINKAGE
 bool NormSetFragmentation(NormSessionHandle sessionHandle,
                           bool              fragmentation);
 
+// Lock (e.g. mlock()) sender/receiver buffer memory subsequently allocated
+NORM_API_LINKAGE
+void NormSetBufferLocking(NormSessionHandle sessionHandle,
+                          bool              lockBuffers);
+
+// Access content of subsequently enqueued (or accepted) files through a
+// memory mapping instead of read()/write() calls.  Files that can't be
+// mapped are accessed as usual.
+NORM_API_LINKAGE
+void NormSetFileMapping(NormSessionHandle sessionHandle,
+                        bool              enable);
+
+// Coalesce NORM_RX_OBJECT_UPDATED and NORM_TX_QUEUE_VACANCY notifications
+// so each represents more work.  An event for an object is held until at
+// least "minBytes" of new data (or stream buffer space) is available and
+// at most "maxEventRate" are posted per second.  No event is held longer
+// than "maxLatency" seconds.  A "maxEventRate" and "minBytes" of zero (the
+// default) post these events as soon as they occur.
+NORM_API_LINKAGE
+bool NormSetEventCoalescing(NormSessionHandle sessionHandle,
+                            double            maxEventRate,
+                            unsigned int      minBytes,
+                            double            maxLatency DEFAULT(0.1));
+
 // Special functions for debug support
 NORM_API_LINKAGE
 void NormSetMessageTrace(NormSessionHandle sessionHandle, bool state);
@@ -478,6 +635,28 @@ void NormSetTxCacheBounds(NormSessionHandle sessionHandle,
                           UINT32            countMin,
                           UINT32            countMax);
 
+// Sets how many FEC blocks of each enqueued file are read ahead of
+// transmission by helper threads so disk latency does not stall the
+// sender (0, the default, reads file content as it is sent)
+NORM_API_LINKAGE
+void NormSetTxFileReadAhead(NormSessionHandle sessionHandle,
+                            unsigned int      blockCount);
+
+// Compresses the content of subsequently enqueued file and data objects
+// (when that makes them smaller).  Receivers decompress such objects
+// before posting NORM_RX_OBJECT_COMPLETED, so until then a received
+// object's size and progress refer to its compressed content.  (Files
+// are compressed to a temporary file when they are enqueued, and a
+// receiver decompresses a file within the NORM protocol thread, which
+// delays its other session activity, so this best suits modest sizes.)
+// Compression is off by default and is enabled per session.  IMPORTANT: 
+// receivers that predate this option ignore the NORM_OBJECT "compressed"
+// flag and deliver the compressed framing as the object content, so _all_
+// receivers of the session must be upgraded before it is enabled.
+NORM_API_LINKAGE
+void NormSetTxCompression(NormSessionHandle sessionHandle,
+                          bool              enable);
+
 NORM_API_LINKAGE
 void NormSetAutoParity(NormSessionHandle sessionHandle,
                        unsigned char     autoParity);
@@ -531,6 +710,24 @@ NormObjectHandle NormDataEnqueue(NormSessionHandle sessionHandle,
                                  const char*       infoPtr DEFAULT((const char*)0),
                                  unsigned int      infoLen DEFAULT(0));
 
+// Enqueues a NORM_OBJECT_DATA whose content is the concatenation of the "iovCount"
+// buffers (e.g., separate header, metadata, and body) without first copying them
+// into one contiguous buffer.  The buffers must remain valid until "releaseFunc"
+// is invoked for each of them (with its "iov_base", "iov_len", and "releaseData")
+// when the object is purged from the transmit cache or cancelled.  With no 
+// "releaseFunc", the buffers must remain valid until NORM_TX_OBJECT_PURGED (as
+// for NormDataEnqueue()).  The release function is not invoked if enqueue fails.
+typedef void (*NormExtentReleaseFunction)(void* extentPtr, size_t extentLen, const void* releaseData);
+
+NORM_API_LINKAGE
+NormObjectHandle NormDataEnqueueV(NormSessionHandle         sessionHandle,
+                                  const struct iovec*       iov,
+                                  unsigned int              iovCount,
+                                  NormExtentReleaseFunction releaseFunc DEFAULT((NormExtentReleaseFunction)0),
+                                  const void*               releaseData DEFAULT((const void*)0),
+                                  const char*               infoPtr DEFAULT((const char*)0),
+                                  unsigned int              infoLen DEFAULT(0));
+
 NORM_API_LINKAGE
 bool NormRequeueObject(NormSessionHandle sessionHandle, NormObjectHandle objectHandle);
                                      
@@ -558,6 +755,31 @@ unsigned int NormStreamWrite(NormObjectHandle streamHandle,
                              const char*      buffer,
                              unsigned int     numBytes);
 
+// Writes "iovCount" buffers to the stream with a single call.  Message
+// boundaries are marked per "flags" and any stream auto flush is applied
+// once after the last buffer rather than for each buffer or message.  Returns
+// the total number of bytes written which is less than the total requested
+// when the stream buffer lacks vacancy (the same as NormStreamWrite()).
+NORM_API_LINKAGE
+unsigned int NormStreamWritev(NormObjectHandle      streamHandle,
+                              const struct iovec*   iov,
+                              unsigned int          iovCount,
+                              int                   flags DEFAULT(NORM_WRITEV_NONE));
+
+// Zero-copy stream writing: NormStreamGetWriteBuffer() provides a pointer to
+// (and length of) writable space within the stream buffer and the application
+// then calls NormStreamCommitWrite() with the number of bytes it filled in.
+// Returns false (with zero length) if the stream buffer is currently full.
+NORM_API_LINKAGE
+bool NormStreamGetWriteBuffer(NormObjectHandle streamHandle,
+                              char**           bufferPtr,
+                              unsigned int*    numBytes);
+
+NORM_API_LINKAGE
+unsigned int NormStreamCommitWrite(NormObjectHandle streamHandle,
+                                   unsigned int     numBytes,
+                                   bool             eom DEFAULT(false));
+
 NORM_API_LINKAGE
 void NormStreamFlush(NormObjectHandle streamHandle, 
                      bool             eom DEFAULT(false),
@@ -580,6 +802,17 @@ unsigned int NormStreamGetVacancy(NormObjectHandle streamHandle, unsigned int by
 NORM_API_LINKAGE
 void NormStreamMarkEom(NormObjectHandle streamHandle);
 
+// Enables (or disables for zero "ringSize") a single-producer ring buffer
+// of "ringSize" bytes for the tx stream so that NormStreamWrite(), etc are
+// processed without locking the NORM protocol thread.  Only one application
+// thread should write to the stream when the ring is enabled.  NormStreamFlush()
+// and NormStreamMarkEom() are queued in the ring behind prior writes and are
+// dropped (with an error logged) if the ring remains full.  A graceful NormStreamClose()
+// takes effect once the ring content has been sent to the stream.  The ring
+// can't be resized or disabled (this returns false) until it has been drained.
+NORM_API_LINKAGE
+bool NormStreamSetWriteRing(NormObjectHandle streamHandle, unsigned int ringSize);
+
 NORM_API_LINKAGE
 bool NormSetWatermark(NormSessionHandle  sessionHandle,
                       NormObjectHandle   objectHandle,
@@ -655,6 +888,23 @@ NORM_API_LINKAGE
 void NormSetRxCacheLimit(NormSessionHandle sessionHandle,
                          unsigned short    countMax);
 
+// Sets how many FEC blocks of each accepted file are staged in memory
+// so received segments are written to disk in large, sequential writes
+// (0, the default, writes each segment as it is received)
+NORM_API_LINKAGE
+void NormSetRxFileWriteBehind(NormSessionHandle sessionHandle,
+                              unsigned int      blockCount);
+
+// When enabled, the receive state (completed blocks) of each accepted file
+// is kept in a small sidecar file in the directory of the accepted file's
+// (initial) path.  If the receiver restarts, a matching file object (same 
+// sender, instance, object id and FTI) accepted into the same directory 
+// resumes with the previously received blocks (only the remainder is NACKed).
+// (The NORM_SYNC_ALL sync policy lets a restarted receiver sync mid-object.)
+NORM_API_LINKAGE
+void NormSetRxFileResume(NormSessionHandle sessionHandle,
+                         bool              enable);
+
 NORM_API_LINKAGE
 bool NormSetRxSocketBuffer(NormSessionHandle sessionHandle,
                            unsigned int      bufferSize);
@@ -717,12 +967,31 @@ bool NormStreamRead(NormObjectHandle   streamHandle,
                     char*              buffer,
                     unsigned int*      numBytes);
 
+// Zero-copy stream reading: NormStreamPeekSegments() fills "iov" with up to
+// "iovMax" descriptors of contiguous, in-order stream content that remains
+// buffered (lent to the application) until NormStreamConsume() is called.
+// Returns the number of descriptors filled or -1 upon a stream break (as
+// when NormStreamRead() returns false).
+NORM_API_LINKAGE
+int NormStreamPeekSegments(NormObjectHandle streamHandle,
+                           struct iovec*    iov,
+                           unsigned int     iovMax);
+
+NORM_API_LINKAGE
+bool NormStreamConsume(NormObjectHandle streamHandle,
+                       unsigned int     numBytes);
+
 NORM_API_LINKAGE
 bool NormStreamSeekMsgStart(NormObjectHandle streamHandle);
 
 NORM_API_LINKAGE
 UINT32 NormStreamGetReadOffset(NormObjectHandle streamHandle);
 
+// NormStreamGetBufferUsage() and NormObjectGetBytesPending() do not
+// suspend the NORM thread.  They return the status last published for
+// the object, which is refreshed each time a message for it is sent or
+// received, stream data is written or read, or a notification for it
+// is posted.
 NORM_API_LINKAGE
 UINT32 NormStreamGetBufferUsage(NormObjectHandle streamHandle);
 
@@ -0,0 +1,153 @@
+#ifndef _NORM_ATOMIC
+#define _NORM_ATOMIC
+
+#include "protoDefs.h"  // for UINT32
+
+#ifdef WIN32
+#include <windows.h>    // for MemoryBarrier(), InterlockedExchange(), CRITICAL_SECTION
+#else
+#include <pthread.h>    // for pthread_mutex_t
+#endif // if/else WIN32
+
+#if !defined(__GNUC__) && !defined(WIN32)
+// (plain loads and stores would silently lose the ordering these promise)
+#error "normAtomic.h: no atomic operations are available for this compiler"
+#endif
+
+// These provide the minimal set of atomic operations used for state that
+// is shared between an application thread and the NORM protocol thread
+// without the dispatcher lock held (e.g., single-producer/single-consumer
+// ring indices).  Loads have "acquire" and stores have "release" ordering.
+// NormAtomicExchange() is a full barrier.
+
+inline UINT32 NormAtomicLoad(const volatile UINT32* ptr)
+{
+#if defined(__GNUC__)
+    return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+#else
+    UINT32 value = *ptr;
+    MemoryBarrier();
+    return value;
+#endif
+}  // end NormAtomicLoad()
+
+inline void NormAtomicStore(volatile UINT32* ptr, UINT32 value)
+{
+#if defined(__GNUC__)
+    __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+#else
+    MemoryBarrier();
+    *ptr = value;
+#endif
+}  // end NormAtomicStore()
+
+// Sets "*ptr" to "value" and returns the prior value
+inline UINT32 NormAtomicExchange(volatile UINT32* ptr, UINT32 value)
+{
+#if defined(__GNUC__)
+    return __atomic_exchange_n(ptr, value, __ATOMIC_SEQ_CST);
+#else
+    return (UINT32)InterlockedExchange((volatile LONG*)ptr, (LONG)value);
+#endif
+}  // end NormAtomicExchange()
+
+inline void NormAtomicFence()
+{
+#if defined(__GNUC__)
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+#else
+    MemoryBarrier();
+#endif
+}  // end NormAtomicFence()
+
+// A minimal (non-recursive) mutex for critical sections shared by NORM
+// threads that are not otherwise serialized by a single dispatcher.  Waiters
+// block rather than spin, so it may be held across memory allocation, system
+// calls (e.g., signaling the notification descriptor), and handle release.
+class NormMutex
+{
+    public:
+        NormMutex()
+        {
+#ifdef WIN32
+            InitializeCriticalSection(&mutex);
+#else
+            pthread_mutex_init(&mutex, NULL);
+#endif // if/else WIN32
+        }
+        ~NormMutex()
+        {
+#ifdef WIN32
+            DeleteCriticalSection(&mutex);
+#else
+            pthread_mutex_destroy(&mutex);
+#endif // if/else WIN32
+        }
+        
+        void Lock()
+        {
+#ifdef WIN32
+            EnterCriticalSection(&mutex);
+#else
+            pthread_mutex_lock(&mutex);
+#endif // if/else WIN32
+        }
+        void Unlock()
+        {
+#ifdef WIN32
+            LeaveCriticalSection(&mutex);
+#else
+            pthread_mutex_unlock(&mutex);
+#endif // if/else WIN32
+        }
+        
+    private:
+        NormMutex(const NormMutex&);             // (not copyable)
+        NormMutex& operator=(const NormMutex&);
+        
+#ifdef WIN32
+        CRITICAL_SECTION    mutex;
+#else
+        pthread_mutex_t     mutex;
+#endif // if/else WIN32
+};  // end class NormMutex
+
+// A "sequence lock" lets the NORM thread publish a small status
+// value (e.g., a session's current rate and GRTT) that other threads
+// may read without suspending the protocol thread.  "Publish()" must 
+// only be called by a single writer at a time (i.e., the NORM thread or
+// an API call holding the dispatcher lock).  "Read()" retries if it 
+// overlaps an update, so readers never see a partially written value.
+template <class T>
+class NormSeqLock
+{
+    public:
+        NormSeqLock() : sequence(0) {}
+        
+        void Publish(const T& value)
+        {
+            NormAtomicStore(&sequence, sequence + 1);  // odd while updating
+            NormAtomicFence();
+            content = value;
+            NormAtomicStore(&sequence, sequence + 1);
+        }
+        T Read() const
+        {
+            T value;
+            UINT32 before, after;
+            do
+            {
+                before = NormAtomicLoad(&sequence);
+                value = content;
+                NormAtomicFence();
+                after = NormAtomicLoad(&sequence);
+            } while ((0 != (before & 1)) || (before != after));
+            return value;
+        }
+        
+    private:
+        volatile UINT32 sequence;
+        T               content;
+};  // end class NormSeqLock
+
+#endif // _NORM_ATOMIC
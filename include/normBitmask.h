@@ -0,0 +1,171 @@
+#ifndef _NORM_BITMASK
+#define _NORM_BITMASK
+
+#include "protoDefs.h"  // for UINT32, UINT64, etc
+
+#include <stdio.h>  // for FILE*
+
+// These are word-parallel counterparts of the protolib ProtoBitmask and
+// ProtoSlidingMask classes used for NORM pending/repair state.  Bits are
+// kept in 64-bit words so that set/unset of ranges is done a whole word
+// at a time and "GetNextSet()" style scans skip empty words and use
+// count-trailing-zeros (or count-leading-zeros) to locate set bits within
+// a word instead of testing bit by bit.  The method names and semantics
+// follow the protolib classes so they may be used interchangeably.
+
+class NormBitmask
+{
+    public:
+        NormBitmask();
+        ~NormBitmask();
+
+        bool Init(UINT32 numBits);
+        void Destroy();
+        UINT32 GetSize() const {return num_bits;}
+
+        void Clear();                   // clears all bits
+        void Reset(UINT32 index = 0);   // sets all bits at/after "index"
+
+        bool IsSet() const {return (first_set < num_bits);}
+        bool Test(UINT32 index) const
+        {
+            return ((index < num_bits) &&
+                    (0 != (mask[index >> 6] & ((UINT64)1 << (index & 0x3f)))));
+        }
+        bool CanSet(UINT32 index) const {return (index < num_bits);}
+        bool Set(UINT32 index);
+        bool Unset(UINT32 index);
+        bool Invert(UINT32 index)
+            {return (Test(index) ? Unset(index) : Set(index));}
+        bool SetBits(UINT32 index, UINT32 count);
+        bool UnsetBits(UINT32 index, UINT32 count);
+
+        bool GetFirstSet(UINT32& index) const
+        {
+            index = first_set;
+            return IsSet();
+        }
+        bool GetNextSet(UINT32& index) const;   // first set bit at/after "index"
+        bool GetPrevSet(UINT32& index) const;   // last set bit at/before "index"
+        bool GetLastSet(UINT32& index) const
+        {
+            index = num_bits - 1;
+            return GetPrevSet(index);
+        }
+        bool GetNextUnset(UINT32& index) const;
+        UINT32 GetSetCount() const;             // popcount of whole mask
+
+        // Logical operations (masks should be of equal size)
+        bool Copy(const NormBitmask& b);        // this = b
+        bool Add(const NormBitmask& b);         // this = this | b
+        bool Subtract(const NormBitmask& b);    // this = this & ~b
+        bool XCopy(const NormBitmask& b);       // this = b & ~this
+        bool Multiply(const NormBitmask& b);    // this = this & b
+        bool Xor(const NormBitmask& b);         // this = this ^ b
+
+        void Display(FILE* stream) const;
+
+    private:
+        void UpdateFirstSet(UINT32 index);  // recompute "first_set" from "index"
+
+        UINT64*     mask;
+        UINT32      mask_len;   // in 64-bit words
+        UINT32      num_bits;
+        UINT32      first_set;  // == num_bits when nothing is set
+};  // end class NormBitmask
+
+
+// The NormSlidingMask keeps a window of up to "num_bits" consecutive set bits
+// over a (possibly wrapping) identifier space as a circular array of words.
+// A "rangeMask" of zero means identifiers are plain, non-wrapping unsigned
+// values (as used for non-stream NormObject block ids).
+class NormSlidingMask
+{
+    public:
+        NormSlidingMask();
+        ~NormSlidingMask();
+
+        bool Init(INT32 numBits, UINT32 rangeMask = 0xffffffff);
+        bool Resize(INT32 numBits);
+        void Destroy();
+        INT32 GetSize() const {return num_bits;}
+        UINT32 GetRange() const {return range_mask;}
+
+        bool IsSet() const {return (start < cap_bits);}
+        void Clear();
+        void Reset(UINT32 index = 0);   // sets "num_bits" bits starting at "index"
+
+        bool Test(UINT32 index) const;
+        bool CanSet(UINT32 index) const;
+        bool Set(UINT32 index);
+        bool Unset(UINT32 index);
+        bool Invert(UINT32 index)
+            {return (Test(index) ? Unset(index) : Set(index));}
+        bool SetBits(UINT32 index, INT32 count);
+        bool UnsetBits(UINT32 index, INT32 count);
+
+        bool GetFirstSet(UINT32& index) const
+        {
+            index = offset;
+            return IsSet();
+        }
+        bool GetLastSet(UINT32& index) const
+        {
+            index = (offset + Span() - 1) & RangeMask();
+            return IsSet();
+        }
+        bool GetNextSet(UINT32& index) const;   // first set bit at/after "index"
+        bool GetPrevSet(UINT32& index) const;   // last set bit at/before "index"
+
+        // Logical operations
+        bool Copy(const NormSlidingMask& b);        // this = b
+        bool Add(const NormSlidingMask& b);         // this = this | b
+        bool Subtract(const NormSlidingMask& b);    // this = this & ~b
+        bool XCopy(const NormSlidingMask& b);       // this = b & ~this
+        bool Multiply(const NormSlidingMask& b);    // this = this & b
+        bool Xor(const NormSlidingMask& b);         // this = this ^ b
+
+        // Signed difference "a - b" in this mask's (wrapping) id space
+        INT32 Difference(UINT32 a, UINT32 b) const
+        {
+            if (0 == range_mask) return (INT32)(a - b);
+            UINT32 result = a - b;
+            return ((0 == (result & range_sign)) ?
+                        (INT32)(result & range_mask) :
+                        (((result != range_sign) || (a < b)) ?
+                            (INT32)(result | ~range_mask) : (INT32)result));
+        }
+
+        void Display(FILE* stream) const;
+
+    private:
+        UINT32 RangeMask() const
+            {return ((0 != range_mask) ? range_mask : 0xffffffff);}
+        // Number of bits from first set bit to last set bit (inclusive)
+        UINT32 Span() const
+            {return ((end >= start) ? (end - start) : (end + cap_bits - start)) + 1;}
+        UINT32 Position(UINT32 delta) const
+        {
+            UINT32 pos = start + delta;
+            return ((pos < cap_bits) ? pos : (pos - cap_bits));
+        }
+        bool TestPosition(UINT32 pos) const
+            {return (0 != (mask[pos >> 6] & ((UINT64)1 << (pos & 0x3f))));}
+        // Circular scans returning the distance from "pos" to the
+        // nearest set bit (or "limit" if none found within "limit" bits)
+        UINT32 ScanForward(UINT32 pos, UINT32 limit) const;
+        UINT32 ScanBackward(UINT32 pos, UINT32 limit) const;
+        void FillPositions(UINT32 pos, UINT32 count, bool value);
+
+        UINT64*     mask;
+        UINT32      mask_len;   // in 64-bit words
+        UINT32      cap_bits;   // mask_len * 64
+        INT32       num_bits;
+        UINT32      range_mask;
+        UINT32      range_sign;
+        UINT32      start;      // ring position of first set bit (== cap_bits when empty)
+        UINT32      end;        // ring position of last set bit
+        UINT32      offset;     // id value of first set bit
+};  // end class NormSlidingMask
+
+#endif // _NORM_BITMASK
@@ -0,0 +1,62 @@
+#ifndef _NORM_COMPRESS
+#define _NORM_COMPRESS
+
+#include "normFile.h"  // for NormFile
+
+// The NormCompressor provides a small, fast LZ77-style codec (producing the
+// LZ4 "block" format) along with the framing used for compressed NORM object
+// content (see NormSession::SetTxCompression()).  Framed content is a
+// FRAME_HEADER_SIZE header (magic, original size, chunk size) followed by a
+// sequence of chunks, each holding "chunkSize" bytes (the last may be shorter)
+// of original content in compressed (or, if not compressible, stored) form.
+// The NORM sender uses its FEC source block payload size (segmentSize * ndata)
+// as the chunk size so that chunks line up with the original data blocking.
+
+class NormCompressor
+{
+    public:
+        enum
+        {
+            FRAME_HEADER_SIZE = 16,  // "NRMZ", original size (8), chunk size (4)
+            CHUNK_HEADER_SIZE = 4,   // chunk content length (msb set if stored)
+            MAX_CHUNK_SIZE    = 16*1024*1024  // larger chunk sizes are reduced to this
+        };                                    // (and received frames are rejected)
+
+        // Block codec.  Compress() returns the compressed length or 0 if the
+        // result would not fit within "dstMax" bytes.  Decompress() fails
+        // unless "src" is well-formed and decodes to exactly "dstLen" bytes.
+        static UINT32 Compress(const char* src, UINT32 srcLen, char* dst, UINT32 dstMax);
+        static bool Decompress(const char* src, UINT32 srcLen, char* dst, UINT32 dstLen);
+
+        // Framing of in-memory content.  CompressData() returns the framed
+        // length or 0 if that would not be smaller than "dataLen".  GetDataSize()
+        // fails if the size in the header is more than "frameLen" could hold.
+        static UINT32 CompressData(const char* data, UINT32 dataLen, UINT32 chunkSize,
+                                   char* buffer, UINT32 bufferMax);
+        static bool GetDataSize(const char* frame, UINT32 frameLen, NormFile::Offset& dataSize);
+        static bool DecompressData(const char* frame, UINT32 frameLen, char* data, UINT32 dataLen);
+
+        // Framing of file content.  CompressFile() fails if the result would
+        // not be smaller than the original file.
+        static bool CompressFile(const char* inPath, const char* outPath, UINT32 chunkSize);
+        static bool DecompressFile(const char* inPath, const char* outPath);
+
+    private:
+        enum
+        {
+            HASH_BITS       = 12,
+            MIN_MATCH       = 4,
+            LAST_LITERALS   = 5,     // block must end with at least this many literals
+            MATCH_LIMIT     = 12,    // last match must start this far from the end
+            MAX_OFFSET      = 65535,
+            CHUNK_STORED    = 0x80000000
+        };
+        static void WriteHeader(char* buffer, NormFile::Offset dataSize, UINT32 chunkSize);
+        static bool ReadHeader(const char* buffer, NormFile::Offset& dataSize, UINT32& chunkSize);
+        // Writes one framed chunk, returning its framed length (or 0 if it won't fit)
+        static UINT32 WriteChunk(const char* data, UINT32 dataLen, char* buffer, UINT32 bufferMax);
+
+        static const char FRAME_MAGIC[4];
+};  // end class NormCompressor
+
+#endif // _NORM_COMPRESS
@@ -11,6 +11,7 @@
 #else
 #include <unistd.h>
 #include <dirent.h>
+#include <pthread.h>  // for NormDirectoryScanner
 #endif // if/else WIN32
 
 #ifdef _WIN32_WCE
@@ -20,10 +21,14 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #endif // if/else _WIN32_WCE
+#include <string.h>     // for memcmp()
 
 // From PROTOLIB
 #include "protokit.h"    // for Protolib stuff
 
+#include "normAtomic.h"  // for NormAtomicLoad(), etc
+#include "normIovec.h"   // for "struct iovec"
+
 // (TBD) Rewrite this implementation to use 
 // native WIN32 APIs on that platform !!!
 
@@ -72,11 +77,35 @@ class NormFile
 		NormFile::Offset GetOffset() const {return (offset);}
 		NormFile::Offset GetSize() const;
         bool Pad(Offset theOffset);  // if file size is less than theOffset, writes a byte to force filesize
+        bool Allocate(Offset theSize);  // reserves file space (uses Pad() if fallocate() not supported)
+        // Positional (pread()/pwrite() style) access.  These neither use nor 
+        // change the current file offset (except on WIN32 where they seek) 
+        // so helper threads may share the file descriptor.  "WriteAtV()" 
+        // writes the "iov" buffers contiguously from "theOffset".
+        size_t ReadAt(Offset theOffset, char* buffer, size_t len);
+        size_t WriteAt(Offset theOffset, const char* buffer, size_t len);
+        size_t WriteAtV(Offset theOffset, const struct iovec* iov, int iovCount);
+        
+        // Memory mapping of file content ("theOffset" must be a multiple of 
+        // GetPageSize()).  The mapping is writable (and shared) if the file
+        // was opened O_RDWR.  Map() returns NULL if the file can't be mapped.
+        enum Advice {ADVISE_SEQUENTIAL, ADVISE_WILLNEED};
+        char* Map(Offset theOffset, size_t length);
+        static void Unmap(char* addr, size_t length);
+        static void Advise(char* addr, size_t length, Advice advice);
+        static size_t GetPageSize();
         
         // static helper methods
         static NormFile::Type GetType(const char *path);
 		static NormFile::Offset GetSize(const char* path);
         static time_t GetUpdateTime(const char* path);
+        static time_t GetModifyTime(const char* path);
+        static bool SetModifyTime(const char* path, time_t modifyTime);
+        // Creates a new, uniquely named empty file in "dirPath" (with name
+        // "prefix" followed by 6 characters) and sets "pathBuffer" to its path
+        static bool MakeTemp(const char* dirPath, const char* prefix, char* pathBuffer);
+        // Returns the system temporary file directory (TMPDIR or TEMP)
+        static const char* GetTempDir();
         static bool IsLocked(const char *path);
          
         static bool Exists(const char* path)
@@ -127,6 +156,67 @@ class NormFile
 #endif // if/else WIN32/UNIX
 };  // end class NormFile
 
+/******************************************
+* The NormFileIo class is a small, process-wide pool of helper
+* threads that perform positional reads (pread()) of NormFile
+* content on behalf of the NORM protocol thread(s) so that a slow
+* disk (or network file system) does not stall protocol timing.
+* A "Request" is submitted with "Submit()" and the submitter polls its
+* status.  Helper threads are started by the first "Retain()" and
+* stopped by the last "Release()".  (Not supported on WIN32 where 
+* "Retain()" returns false and the caller should read synchronously)
+*/
+class NormFileIo
+{
+    public:
+        enum {THREAD_COUNT = 2};
+        
+        class Request
+        {
+            friend class NormFileIo;
+            public:
+                enum Status {IDLE, QUEUED, BUSY, DONE, FAILED};
+                    
+                Request();
+                ~Request();
+                
+                void Init(NormFile& file, NormFile::Offset offset, char* buffer, size_t length);
+                
+                Status GetStatus() const
+                    {return (Status)NormAtomicLoad(&status);}
+                bool IsPending() const
+                {
+                    Status s = GetStatus();
+                    return ((QUEUED == s) || (BUSY == s));
+                }
+                NormFile::Offset GetOffset() const {return req_offset;}
+                char* GetBuffer() const {return req_buffer;}
+                size_t GetLength() const {return req_length;}
+                    
+            private:
+                void Execute();
+                
+                NormFile*           req_file;
+                NormFile::Offset    req_offset;
+                char*               req_buffer;
+                size_t              req_length;
+                volatile UINT32     status;
+                Request*            next;
+        };  // end class NormFileIo::Request
+        
+        static bool Retain();
+        static void Release();
+        
+        // The "request" must stay valid until it is no longer pending
+        static bool Submit(Request& request);
+        // Removes the "request" if queued or waits for its completion if busy
+        // (unless "wait" is false, in which case this fails if it is busy)
+        static bool Cancel(Request& request, bool wait = true);
+        
+    private:
+        static void* Run(void* arg);  // helper thread entry point
+};  // end class NormFileIo
+
 
         
 /******************************************
@@ -171,6 +261,63 @@ class NormDirectoryIterator
         int             path_len;
 };  // end class NormDirectoryIterator
 
+/******************************************
+* The NormDirectoryScanner walks a directory tree with a few helper
+* threads and keeps a bounded queue of the files found (with their
+* size and update time) so that the consumer seldom has to wait for
+* directory and file metadata i/o.  Since subdirectories are scanned in
+* parallel, files are not returned in depth-first order.  (On WIN32, 
+* Open() fails and NormDirectoryIterator should be used instead)
+*/
+class NormDirectoryScanner
+{
+    public:
+        enum {THREAD_COUNT = 4, QUEUE_MAX = 1024};
+        NormDirectoryScanner();
+        ~NormDirectoryScanner();
+        bool Open(const char* thePath);
+        void Close();
+        bool IsOpen() const {return (0 != thread_count);}
+        // "fileName" (PATH_MAX long) is set relative to the scanned path.
+        // This waits if no file is queued yet and returns false once
+        // the scan is complete.
+        bool GetNextFile(char* fileName, NormFile::Offset& fileSize, time_t& updateTime);
+        // Returns true if GetNextFile() can return without waiting
+        bool IsReady();
+        
+    private:
+        // (queued file or directory pending scan)
+        class Item
+        {
+            public:
+                Item(const char* theName, NormFile::Offset theSize = 0, time_t theTime = 0);
+                ~Item();
+                
+                char*               name;
+                NormFile::Offset    size;
+                time_t              update_time;
+                Item*               next;
+        };
+#ifndef WIN32
+        static void* Run(void* arg);  // helper thread entry point
+        void Scan(const Item& dir);
+        bool IsDone() const {return ((NULL == dir_list) && (0 == busy_count));}
+        void DestroyItems();
+        
+        pthread_mutex_t     mutex;
+        pthread_cond_t      scan_cond;  // signals any change of scan state
+        pthread_t           thread[THREAD_COUNT];
+#endif // !WIN32
+        char                path[PATH_MAX];  // (with trailing delimiter)
+        unsigned int        thread_count;
+        Item*               dir_list;        // directories pending scan
+        Item*               file_head;       // queue of files found
+        Item*               file_tail;
+        unsigned int        file_count;
+        unsigned int        busy_count;      // helper threads scanning a directory
+        bool                stopping;
+};  // end class NormDirectoryScanner
+
 
 class NormFileList
 {
@@ -200,8 +347,12 @@ class NormFileList
         
         bool Append(const char* path);
         bool Remove(const char* path);
-        bool GetNextFile(char* pathBuffer);
+        // (the file's size is also provided if "fileSize" is non-NULL)
+        bool GetNextFile(char* pathBuffer, NormFile::Offset* fileSize = NULL);
         void GetCurrentBasePath(char* pathBuffer);
+        // Returns false if GetNextFile() would have to wait
+        // for a directory scan to catch up (starts the scan if needed)
+        bool IsReady();
                      
     private:
         class FileItem
@@ -212,12 +363,14 @@ class NormFileList
                 virtual ~FileItem();
                 NormFile::Type GetType() {return NormFile::GetType(path);}
 				NormFile::Offset Size() const {return size;}
-                virtual bool GetNextFile(char*   thePath,
-                                         bool    reset,
-                                         bool    updatesOnly,
-                                         time_t  lastTime,
-                                         time_t  thisTime,
-                                         time_t& bigTime);
+                virtual bool GetNextFile(char*              thePath,
+                                         bool               reset,
+                                         bool               updatesOnly,
+                                         time_t             lastTime,
+                                         time_t             thisTime,
+                                         time_t&            bigTime,
+                                         NormFile::Offset*  fileSize);
+                virtual bool IsReady(bool reset) {return true;}
                     
             protected:        
                 const char* Path() {return path;}
@@ -233,14 +386,18 @@ class NormFileList
             public:
                 DirectoryItem(const char* thePath);
                 ~DirectoryItem();
-                virtual bool GetNextFile(char*   thePath,
-                                         bool    reset,
-                                         bool    updatesOnly,
-                                         time_t  lastTime,
-                                         time_t  thisTime,
-                                         time_t& bigTime);    
+                virtual bool GetNextFile(char*              thePath,
+                                         bool               reset,
+                                         bool               updatesOnly,
+                                         time_t             lastTime,
+                                         time_t             thisTime,
+                                         time_t&            bigTime,
+                                         NormFile::Offset*  fileSize);
+                virtual bool IsReady(bool reset);
             private:
-                NormDirectoryIterator diterator;
+                bool                  scan_started;  // by IsReady()
+                NormDirectoryScanner  scanner;    // used where available
+                NormDirectoryIterator diterator;  // (else synchronous walk)
         };    
         
         time_t          this_time;
@@ -253,4 +410,61 @@ class NormFileList
         bool            reset;
 };  // end class NormFileList
 
+/******************************************
+* The NormFileBundle class packs a sequence of (typically small) files
+* into a single "bundle" file so they may be sent as one NORM object
+* instead of paying per-object overhead for each one.  The bundle is an
+* 8-byte magic prefix followed, for each member file, by an in-band index
+* entry (name length, modify time, and size), the member's relative name
+* (with '/' delimiters) and its content.  A bundle is identified to
+* receivers by its NORM_INFO (see IsBundleInfo()) and unpacked with 
+* Extract() into the receive cache directory.
+*/
+class NormFileBundle
+{
+    public:
+        NormFileBundle();
+        ~NormFileBundle();
+        
+        // Bundle creation ("dirPath" is where a temporary bundle file is created)
+        bool Create(const char* dirPath);
+        bool Append(const char* filePath, const char* name, UINT16 nameLen);
+        
+        // Bundle unpacking (one member file per Extract() call until
+        // Extract() returns false and "IsDone()" indicates success)
+        bool Open(const char* bundlePath);
+        bool Extract(const char* dirPath, char* pathBuffer);
+        bool IsDone() const {return done;}
+        
+        void Close();
+        bool IsOpen() const {return file.IsOpen();}
+        const char* GetPath() const {return path;}
+        NormFile::Offset GetSize() const {return bundle_size;}
+        unsigned long GetCount() const {return file_count;}
+        
+        // NORM_INFO used to mark bundle objects
+        static const char* GetInfo() {return BUNDLE_INFO;}
+        static UINT16 GetInfoLength() {return BUNDLE_INFO_LEN;}
+        static bool IsBundleInfo(const char* info, UINT16 infoLen)
+            {return ((BUNDLE_INFO_LEN == infoLen) && (0 == memcmp(info, BUNDLE_INFO, infoLen)));}
+        
+    private:
+        enum 
+        {
+            MAGIC_SIZE = 8,
+            ENTRY_HEADER_SIZE = 16,  // nameLen(2) + reserved(2) + mtime(4) + size(8)
+            COPY_BUFFER_SIZE = 16384
+        };
+        // (the leading NUL keeps this from matching any real file name info)
+        enum {BUNDLE_INFO_LEN = 11};
+        static const char BUNDLE_INFO[BUNDLE_INFO_LEN];
+        static const char BUNDLE_MAGIC[MAGIC_SIZE];
+            
+        NormFile            file;
+        char                path[PATH_MAX];
+        NormFile::Offset    bundle_size;
+        unsigned long       file_count;
+        bool                done;
+};  // end class NormFileBundle
+
 #endif // _NORM_FILE
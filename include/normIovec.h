@@ -0,0 +1,19 @@
+#ifndef _NORM_IOVEC
+#define _NORM_IOVEC
+
+// "struct iovec" is used by the NORM API vectored calls and by NormFile,
+// so it is defined in this one place for both
+
+#ifdef WIN32
+#include <stddef.h>     // for size_t
+// POSIX-style scatter/gather buffer descriptor for WIN32 builds
+struct iovec
+{
+    void*   iov_base;
+    size_t  iov_len;
+};
+#else
+#include <sys/uio.h>    // for "struct iovec"
+#endif // if/else WIN32
+
+#endif // !_NORM_IOVEC
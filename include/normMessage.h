@@ -732,8 +732,10 @@ class NormObjectMsg : public NormMsg
             FLAG_UNRELIABLE = 0x08,
             FLAG_FILE       = 0x10,
             FLAG_STREAM     = 0x20,
-            FLAG_SYN        = 0x40
+            FLAG_SYN        = 0x40,
             //FLAG_MSG_START  = 0x40 deprecated
+            FLAG_COMPRESSED = 0x80   // (experimental) NormCompressor framed content 
+                                     // (older receivers ignore it, so opt-in only)
         }; 
         UINT16 GetInstanceId() const
             {return (ntohs(((UINT16*)buffer)[INSTANCE_ID_OFFSET]));}
@@ -72,10 +72,12 @@ class NormNode
         ProtoAddress        addr;
         unsigned int        reference_count;
         const void*         user_data;
-        // We keep NormNodes in a binary tree (TBD) make this a ProtoTree
+        // We keep NormNodes in a red-black binary tree (see NormNodeTree)
+        // (the "left" and "right" pointers are also used by NormNodeList)
         NormNode*           parent;
         NormNode*           right;
         NormNode*           left;
+        bool                is_red;
 };  // end class NormNode
 
 // Weighted-history loss event estimator
@@ -358,7 +360,10 @@ class NormSenderNode : public NormNode, public ProtoTree::Item
         
         void UpdateGrttEstimate(UINT8 grttQuantized);
         double GetGrttEstimate() const {return grtt_estimate;}
-        void ResetGrttNotification() {notify_on_grtt_update = true;}
+        // Lock-free copy of "grtt_estimate" for API getters
+        double GetGrttStatus() const {return grtt_status.Read();}
+        // (called by the lock-free GRTT getter)
+        void ResetGrttNotification() {NormAtomicStore(&notify_on_grtt_update, 1);}
         
         bool UpdateLossEstimate(const struct timeval&   currentTime,
                                 unsigned short          theSequence, 
@@ -432,6 +437,9 @@ class NormSenderNode : public NormNode, public ProtoTree::Item
         
         void DeleteObject(NormObject* obj);
         
+        // Posts coalesced RX_OBJECT_UPDATED events (see NormSession::ServiceHeldEvents())
+        void ServiceHeldEvents(bool flush, double& nextDelay);
+        
         NormObject* GetNextPendingObject()
         {
             NormObjectId objid;
@@ -639,8 +647,8 @@ class NormSenderNode : public NormNode, public ProtoTree::Item
         NormStreamObject*       preset_stream;
         
         NormObjectTable         rx_table;
-        ProtoSlidingMask        rx_pending_mask;
-        ProtoSlidingMask        rx_repair_mask;
+        NormSlidingMask         rx_pending_mask;
+        NormSlidingMask         rx_repair_mask;
         RepairBoundary          repair_boundary;
         NormObject::NackingMode default_nacking_mode;
         bool                    unicast_nacks;
@@ -668,13 +676,14 @@ class NormSenderNode : public NormNode, public ProtoTree::Item
         
         // Remote sender grtt measurement state       
         double                  grtt_estimate;
+        NormSeqLock<double>     grtt_status;
         UINT8                   grtt_quantized;
         struct timeval          grtt_send_time;
         struct timeval          grtt_recv_time;
         double                  gsize_estimate;
         UINT8                   gsize_quantized;
         double                  backoff_factor;
-        bool                    notify_on_grtt_update;  // for API
+        volatile UINT32         notify_on_grtt_update;  // for API (set without lock)
         
         // Remote sender congestion control state
         NormLossEstimator2      loss_estimator;
@@ -718,7 +727,9 @@ class NormSenderNode : public NormNode, public ProtoTree::Item
     
     
 // Used for binary trees of NormNodes sorted by NormNodeId
-// (TBD - update to use ProtoTree instead?
+// (The tree is kept balanced with red-black insert/remove rules 
+//  since node ids are often sequential (e.g., derived from IPv4
+//  addresses) and would otherwise degenerate the tree into a list)
 class NormNodeTree
 {    
     friend class NormNodeTreeIterator;
@@ -734,6 +745,11 @@ class NormNodeTree
         void Destroy();    // delete all nodes in tree
        
     private: 
+        void RotateLeft(NormNode* x);
+        void RotateRight(NormNode* x);
+        void Transplant(NormNode* u, NormNode* v);
+        void AttachFixup(NormNode* x);
+        void DetachFixup(NormNode* x, NormNode* xParent);
     // Members
         NormNode* root;
 };  // end class NormNodeTree
@@ -4,18 +4,11 @@
 #include "normSegment.h"  // NORM segmentation classes
 #include "normEncoder.h"
 #include "normFile.h"
+#include "normAtomic.h"   // for write ring indices
 
 #include <stdio.h>
 
-#define USE_PROTO_TREE 1  // for more better performing NormObjectTable?
-
-#ifdef USE_PROTO_TREE
-#include "protoTree.h"
-
-class NormObject : public ProtoSortedTree::Item
-#else
 class NormObject
-#endif // if/else USE_PROTO_TREE
 {
     friend class NormObjectTable;
     
@@ -148,6 +141,21 @@ class NormObject
         virtual char* RetrieveSegment(NormBlockId   blockId,
                                       NormSegmentId segmentId) = 0;
         
+        // Sender content for "blockId" may be loaded asynchronously
+        // (e.g., file read-ahead) and this returns false until it is
+        // available for reading without blocking.
+        virtual bool IsBlockReady(NormBlockId /*blockId*/) {return true;}
+        
+        // Called when a receiver object has completed reception of a block
+        virtual void OnBlockCompleted(NormBlockId /*blockId*/) {}
+        
+        // Content compression (see NormSession::SetTxCompression()).  A
+        // receiver calls "Decompress()" once reception of a compressed
+        // object is complete to restore its original content and size.
+        bool IsCompressed() const {return compressed;}
+        void SetCompressed(bool state) {compressed = state;}
+        virtual bool Decompress() {return !compressed;}
+        
         NackingMode GetNackingMode() const {return nacking_mode;}
         void SetNackingMode(NackingMode nackingMode) 
         {
@@ -166,6 +174,25 @@ class NormObject
         
         NormObjectSize GetBytesPending() const;
         
+        // Lock-free object status for API getters.  "GetStatus()" returns
+        // the values last published by "UpdateStatus()", which is called
+        // whenever the object's pending state or buffer usage changes.
+        struct Status
+        {
+            NormObjectSize  bytes_pending;
+            unsigned int    buffer_usage;  // stream segments in use
+        };
+        Status GetStatus() const
+            {return status_snapshot.Read();}
+        void UpdateStatus();
+        
+        // Event coalescing (see NormSession::SetEventCoalescing()).  
+        // "CoalesceCheck()" returns true if an RX_OBJECT_UPDATED or 
+        // TX_QUEUE_VACANCY for "byteCount" bytes may be posted now, else
+        // the event is held and "holdDelay" is when to reconsider it.
+        bool CoalesceCheck(UINT32 byteCount, double& holdDelay);
+        void ServiceHeldEvent(bool flush, double& nextDelay);
+        
         bool IsPending(bool flush = true) const;
         bool IsRepairPending();
         bool IsPendingInfo() {return pending_info;}
@@ -292,16 +319,6 @@ class NormObject
                    const NormObjectId&      objectId); 
     
         void Accept() {accepted = true;}
-
-#ifdef USE_PROTO_TREE    
-        // Proto::Tree item required overrides
-        const char* GetKey() const
-            {return transport_id.GetValuePtr();}
-        unsigned int GetKeysize() const
-            {return (8*sizeof(UINT16));}
-        ProtoTree::Endian GetEndian() const
-            {return ProtoTree::GetNativeEndian();}
-#endif // USE PROTO_TREE
                 
         NormObject::Type      type;
         class NormSession&    session;
@@ -318,9 +335,9 @@ class NormObject
         UINT16                nparity;
         NormBlockBuffer       block_buffer;
         bool                  pending_info;  // set when we need to send or recv info
-        ProtoSlidingMask      pending_mask;
+        NormSlidingMask       pending_mask;
         bool                  repair_info;   // receiver: set when
-        ProtoSlidingMask      repair_mask;
+        NormSlidingMask       repair_mask;
         NormBlockId           current_block_id;    // for suppression       
         NormSegmentId         next_segment_id;     // for suppression       
         NormBlockId           max_pending_block;   // for NACK construction 
@@ -335,6 +352,7 @@ class NormObject
         ProtoTime             last_nack_time;  // time of last NACK received (used for flow control)
         char*                 info_ptr;
         UINT16                info_len;
+        bool                  compressed;    // content is NormCompressor framed
         
         // Here are some members used to let us know
         // our status with respect to the rest of the world
@@ -342,10 +360,15 @@ class NormObject
         bool                  accepted;
         bool                  notify_on_update;
         
+        // Event coalescing state
+        bool                  event_held;       // an update/vacancy event is held
+        ProtoTime             event_hold_time;  // when it was first held
+        ProtoTime             event_post_time;  // when one was last posted
+        UINT32                update_bytes;     // received since last RX_OBJECT_UPDATED
+        
+        NormSeqLock<Status>   status_snapshot;
+        
         const void*           user_data;  // for NORM API usage only
-#ifndef USE_PROTO_TREE       
-        NormObject*           next;
-#endif  
 };  // end class NormObject
 
 
@@ -359,7 +382,8 @@ class NormFileObject : public NormObject
         
         bool Open(const char* thePath,
                   const char* infoPtr = NULL,
-                  UINT16      infoLen = 0);
+                  UINT16      infoLen = 0,
+                  bool        truncate = true);
         bool Accept(const char* thePath);
         void CloseFile();
         void Close();
@@ -369,6 +393,7 @@ class NormFileObject : public NormObject
         {
             bool result = file.Rename(path, newPath);
             result ? strncpy(path, newPath, PATH_MAX) : NULL;
+            if (result && ('\0' != resume_path[0])) WriteResumeState();
             return result;
         }
         bool PadToSize()
@@ -384,12 +409,82 @@ class NormFileObject : public NormObject
         
         virtual char* RetrieveSegment(NormBlockId   blockId,
                                       NormSegmentId segmentId);
+        
+        virtual bool IsBlockReady(NormBlockId blockId);
+        bool IsReadPending() const {return read_pending;}
+        
+        virtual void OnBlockCompleted(NormBlockId blockId);
+        // (this decompresses the whole file synchronously on the protocol
+        //  thread, so reception from the session stalls for its duration)
+        virtual bool Decompress();
             
     //private:
-        char            path[PATH_MAX+10];
-        NormFile        file;
-        NormObjectSize  large_block_length;
-        NormObjectSize  small_block_length;
+        // Sender read-ahead buffers one whole FEC block per slot
+        // (see NormSession::SetTxFileReadAhead())
+        class ReadAheadSlot
+        {
+            public:
+                ReadAheadSlot() : buffer(NULL) {}
+                ~ReadAheadSlot()
+                {
+                    if (request.IsPending()) NormFileIo::Cancel(request);
+                    if (NULL != buffer) delete[] buffer;
+                }
+                
+                NormBlockId         block_id;
+                char*               buffer;
+                NormFileIo::Request request;
+        };
+        // Receiver write-behind stages one whole FEC block per slot
+        // (see NormSession::SetRxFileWriteBehind())
+        class WriteBehindSlot
+        {
+            public:
+                WriteBehindSlot() : buffer(NULL), count(0) {}
+                ~WriteBehindSlot() {if (NULL != buffer) delete[] buffer;}
+                
+                NormBlockId     block_id;
+                char*           buffer;
+                NormBitmask     mask;   // staged segments
+                UINT16          count;  // number of staged segments (0 when free)
+        };
+        NormFile::Offset GetSegmentOffset(NormBlockId blockId, NormSegmentId segmentId) const;
+        ReadAheadSlot* FindReadAhead(NormBlockId blockId);
+        ReadAheadSlot* StartReadAhead(NormBlockId blockId, NormBlockId firstId);
+        void CloseReadAhead();
+        WriteBehindSlot* FindWriteBehind(NormBlockId blockId);
+        WriteBehindSlot* GetWriteBehind(NormBlockId blockId);
+        bool FlushWriteBehind(WriteBehindSlot** slotList, unsigned int slotCount);
+        bool CloseWriteBehind();
+        // Memory-mapped access (see NormSession::SetFileMapping()) maps
+        // a window of the file at a time so large files can be handled
+        enum {MAP_WINDOW_SIZE = 64*1024*1024};
+        bool MapFile();
+        char* MapSegment(NormBlockId blockId, NormSegmentId segmentId, size_t len);
+        void UnmapFile();
+        // Receive "resume state" sidecar (see NormSession::SetRxFileResume())
+        enum {RESUME_SAVE_INTERVAL = 1};  // seconds between sidecar updates
+        bool ReadResumeState(const char* thePath, NormBitmask& blockMask);
+        bool WriteResumeState();
+        
+        char                path[PATH_MAX+10];
+        NormFile            file;
+        NormObjectSize      large_block_length;
+        NormObjectSize      small_block_length;
+        ReadAheadSlot*      read_ahead;
+        unsigned int        read_ahead_count;
+        UINT32              read_ahead_front;  // newest block checked (older ones are repairs)
+        bool                read_pending;   // IsBlockReady() awaits a read
+        WriteBehindSlot*    write_behind;
+        unsigned int        write_behind_count;
+        bool                file_mapped;
+        char*               map_ptr;        // current mapped window
+        NormFile::Offset    map_offset;
+        size_t              map_length;
+        NormFile::Offset    map_file_size;  // file size as of last check
+        char                resume_path[PATH_MAX];  // sidecar path (empty if not kept)
+        ProtoTime           resume_save_time;
+        char                comp_path[PATH_MAX];    // sender temp compressed file (if any)
 };  // end class NormFileObject
 
 class NormDataObject : public NormObject
@@ -397,6 +492,9 @@ class NormDataObject : public NormObject
     // (TBD) allow support of greater than 4GB size data objects
     public:
         typedef void (*DataFreeFunctionHandle)(char*);
+        typedef char* (*DataAllocFunctionHandle)(size_t);
+        // Invoked for each "OpenV()" extent when the object is destroyed
+        typedef void (*ExtentReleaseFunctionHandle)(void* extentPtr, size_t extentLen, const void* releaseData);
     
         NormDataObject(class NormSession&       theSession,
                        class NormSenderNode*    theSender,
@@ -409,9 +507,22 @@ class NormDataObject : public NormObject
                   bool        dataRelease,
                   const char* infoPtr = NULL,
                   UINT16      infoLen = 0);
+        // Opens a sender object whose content is the concatenation of the
+        // "iovCount" extents (which must remain valid until "releaseFunc", if
+        // any, is invoked for them or, otherwise, until the object is destroyed)
+        bool OpenV(const struct iovec*          iov,
+                   unsigned int                 iovCount,
+                   ExtentReleaseFunctionHandle  releaseFunc,
+                   const void*                  releaseData,
+                   const char*                  infoPtr = NULL,
+                   UINT16                       infoLen = 0);
         bool Accept(char* dataPtr, UINT32 dataMax, bool dataRelease);
         void Close();
+        // Drops the "OpenV()" extents _without_ invoking the release
+        // function (i.e., when the caller keeps them on enqueue failure)
+        void DetachExtents();
         
+        // (returns NULL for "OpenV()" objects)
         const char* GetData() {return data_ptr;}
         char* DetachData() 
         {
@@ -431,9 +542,22 @@ class NormDataObject : public NormObject
         virtual char* RetrieveSegment(NormBlockId   blockId,
                                       NormSegmentId segmentId);
         
-        
+        virtual bool Decompress();
             
     private:
+        void FreeContent();
+        bool OpenSender(UINT32 dataLen, const char* infoPtr, UINT16 infoLen);
+        void CompressContent(const char* dataPtr, UINT32 dataLen);
+        void ReleaseExtents();
+        // Copies "len" bytes of extent content at "offset" to "buffer"
+        void ReadExtents(UINT32 offset, char* buffer, UINT32 len) const;
+        
+        // Content transmitted (the compressed copy, if any, for sender objects)
+        char* ContentPtr() const 
+            {return ((NULL != comp_ptr) ? comp_ptr : data_ptr);}
+        UINT32 ContentMax() const 
+            {return ((NULL != comp_ptr) ? comp_len : data_max);}
+        
         NormObjectSize          large_block_length;
         NormObjectSize          small_block_length;
         char*                   data_ptr;
@@ -442,6 +566,19 @@ class NormDataObject : public NormObject
         DataFreeFunctionHandle  data_free_func;
         
                                          // on NormDataObject destruction
+        char*                   comp_ptr;        // sender compressed content copy
+        UINT32                  comp_len;
+        
+        struct Extent
+        {
+            char*   ptr;
+            UINT32  len;
+            UINT32  offset;   // of extent within object content
+        };
+        Extent*                     extent_list;     // "OpenV()" content (or NULL)
+        unsigned int                extent_count;
+        ExtentReleaseFunctionHandle extent_release_func;
+        const void*                 extent_release_data;
 };  // end class NormDataObject
 
 
@@ -501,6 +638,53 @@ class NormStreamObject : public NormObject
             
         bool Read(char* buffer, unsigned int* buflen, bool findMsgStart = false);
         UINT32 Write(const char* buffer, UINT32 len, bool eom = false);
+        // Writes "iovCount" buffers, marking end-of-message after each one (if
+        // "eomEach") or the last one (if "eom"), with any auto flush applied
+        // once after the last buffer
+        UINT32 Writev(const struct iovec* iov, unsigned int iovCount, 
+                      bool eomEach = false, bool eom = false);
+        
+        // Zero-copy alternative to "Write()": "GetWriteBuffer()" returns space
+        // within the current stream segment (NULL if the buffer is full) for
+        // the application to fill and "CommitWrite()" then accounts for "len"
+        // bytes of it.  Any intervening "Write()" invalidates the space.
+        char* GetWriteBuffer(UINT32& len);
+        UINT32 CommitWrite(UINT32 len, bool eom = false);
+        
+        // The optional "write ring" is a single-producer/single-consumer byte
+        // ring that lets an application thread queue tx stream content without
+        // holding the protocol dispatcher lock.  The "Ring*()" methods are
+        // invoked _only_ by the (single) application writer thread while the
+        // protocol thread moves ring content into the stream buffer with
+        // "DrainWriteRing()".  (Ring records are "Write()" or "Flush()" calls.)
+        bool OpenWriteRing(UINT32 ringSize);
+        void CloseWriteRing();
+        bool HasWriteRing() const
+            {return (NULL != ring_buffer);}
+        UINT32 RingWrite(const char* buffer, UINT32 len, bool eom = false);
+        bool RingFlush(bool eom, FlushMode flushMode);
+        bool RingMarkEom()
+            {return RingMark(RING_FLAG_EOM);}
+        bool RingIsEmpty() const
+            {return (NormAtomicLoad(&ring_head) == NormAtomicLoad(&ring_tail));}
+        UINT32 RingGetVacancy(unsigned int wanted = 0);
+        // Returns "true" if the protocol thread is not actively draining the
+        // ring so the caller should invoke "DrainWriteRing()" with the lock held
+        bool RingNeedsService()
+            {return (0 != NormAtomicExchange(&ring_idle, 0));}
+        // Returns "true" if the application was waiting for ring vacancy and
+        // some was made available (i.e., a TX_QUEUE_VACANCY should be posted).
+        // A graceful "Close()" made while the ring holds content is completed
+        // here once the ring has been drained.
+        bool DrainWriteRing();
+        
+        // Zero-copy alternative to "Read()": "PeekSegments()" describes
+        // buffered, in-order stream content with "iov" entries (returning
+        // -1 upon a stream break) and the content is lent to the application
+        // (i.e., not pruned) until "Consume()" advances the read position.
+        int PeekSegments(struct iovec* iov, unsigned int iovMax);
+        bool Consume(UINT32 numBytes);
+        bool IsLent() const {return (0 != lent_bytes);}
         
         UINT32 GetCurrentReadOffset() {return read_offset;}
         
@@ -586,6 +770,29 @@ class NormStreamObject : public NormObject
     private:
         bool ReadPrivate(char* buffer, unsigned int* buflen, bool findMsgStart = false);
         void Terminate();
+        char* GetWriteSegment(NormBlock*& block);
+        void CommitSegment(NormBlock* block, char* segment, UINT32 count, bool final);
+        void CompleteWrite(UINT32 nBytes, bool eom);
+        void NotifyVacancy();  // posts TX_QUEUE_VACANCY subject to coalescing
+        
+        enum
+        {
+            RING_HEADER_SIZE    = 4,            // UINT32 record header
+            RING_LENGTH_MASK    = 0x1fffffff,
+            RING_FLAG_EOM       = 0x80000000,
+            RING_FLAG_FLUSH     = 0x40000000,   // zero-length "Flush()" record
+            RING_FLAG_ACTIVE    = 0x20000000    // FLUSH_ACTIVE (vs. FLUSH_PASSIVE)
+        };
+        UINT32 RingSpace() const
+            {return (ring_mask + 1 - (ring_head - NormAtomicLoad(&ring_tail)));}
+        bool RingPut(UINT32 header, const char* buffer);
+        bool RingMark(UINT32 header);  // puts zero-length record
+        void RingCopyOut(UINT32 index, char* buffer, UINT32 len) const;
+        bool IsStarved(NormBlockId blockId, NormSegmentId segmentId) const
+        {
+            return ((NULL == stream_buffer.Find(blockId)) ||
+                    ((blockId == write_index.block) && (segmentId >= write_index.segment)));
+        }
         
         class Index
         {
@@ -621,6 +828,20 @@ class NormStreamObject : public NormObject
         
         // For threaded API purposes
         UINT32                      block_pool_threshold;
+        // Application "write ring" state ("ring_head" is advanced by the
+        // writer, "ring_tail" by the protocol thread, both free-running)
+        char*                       ring_buffer;
+        UINT32                      ring_mask;
+        volatile UINT32             ring_head;
+        volatile UINT32             ring_tail;
+        volatile UINT32             ring_idle;      // writer must prompt drain
+        volatile UINT32             ring_wanted;    // writer wants vacancy event
+        UINT32                      ring_record;    // remaining length of current record
+        UINT32                      ring_flags;     // current record flags
+        bool                        ring_record_open;
+        bool                        ring_close_pending;  // graceful close awaits drain
+        char*                       write_reserve;  // segment from GetWriteBuffer()
+        UINT32                      lent_bytes;     // content lent by PeekSegments()
 };  // end class NormStreamObject
 
 #ifdef SIMULATE
@@ -653,10 +874,9 @@ class NormSimObject : public NormObject
 };  // end class NormSimObject
 #endif // SIMULATE
 
-#ifdef USE_PROTO_TREE
-class NormObjectTree : public ProtoSortedTreeTemplate<NormObject> {};
-#endif // USE_PROTO_TREE
-
+// The NormObjectTable is a circular array (ring) of 2^n slots indexed by
+// (objectId & ring_mask). The ring is always at least as large as the
+// "range_max" so each slot holds at most one object (direct-mapped).
 class NormObjectTable
 {
     public:
@@ -665,7 +885,7 @@ class NormObjectTable
         
         NormObjectTable();
         ~NormObjectTable();
-        bool Init(UINT16 rangeMax, UINT16 tableSize = 256);
+        bool Init(UINT16 rangeMax);
         void SetRangeMax(UINT16 rangeMax);
         void Destroy();
         
@@ -680,23 +900,7 @@ class NormObjectTable
         bool IsEmpty() const {return (0 == range);}
         UINT32 GetCount() const {return count;}
         const NormObjectSize& GetSize() const {return size;}
-
-#ifdef USE_PROTO_TREE
-        class Iterator
-        {
-            public:
-                Iterator(NormObjectTable& objectTable);
-                NormObject* GetNextObject();
-                NormObject* GetPrevObject();
-                void Reset();
-                
-            private:
-                const NormObjectTable&      table;
-                NormObjectTree::Iterator    iterator;
-                NormObject*                 next_object;
-        }; 
-        
-#else        
+     
         class Iterator
         {
             public:
@@ -710,19 +914,18 @@ class NormObjectTable
                 bool                    reset;
                 NormObjectId            index;
         }; 
-#endif // if/else USE_PROTO_TREE
             
     private:
-#ifndef USE_PROTO_TREE
-        NormObject* Next(NormObject* o) const {return o->next;}    
-#endif
-    
-#ifdef USE_PROTO_TREE
-        NormObjectTree  tree;
-#else        
-        NormObject**    table;
-        UINT16          hash_mask;       
-#endif // if/else USE_PROTO_TREE
+        bool ResizeRing(UINT16 rangeMax);
+        // These find the closest object after/before the
+        // given "objectId" (which must be in range)
+        NormObject* FindNext(const NormObjectId& objectId) const;
+        NormObject* FindPrev(const NormObjectId& objectId) const;
+        NormObject* Slot(const NormObjectId& objectId) const
+            {return table[((UINT16)objectId) & ring_mask];}
+        
+        NormObject**    table;      // ring of object "slots"
+        UINT16          ring_mask;  // (ring size - 1)
         UINT16          range_max;  // max range of objects that can be kept
         UINT16          range;      // zero if "object table" is empty
         NormObjectId    range_lo;
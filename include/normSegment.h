@@ -2,31 +2,33 @@
 #define _NORM_SEGMENT
 
 #include "normMessage.h"
-#include "protoBitmask.h"
-
-#define USE_PROTO_TREE 1  // for more better performing NormBlockBuffer?
+#include "normBitmask.h"
 
 
 // Norm uses preallocated (or dynamically allocated) pools of 
-// segments (vectors) for different buffering purposes
+// segments (vectors) for different buffering purposes.  The segments
+// of a pool are carved from a single contiguous "slab" (large slabs are
+// mmap()'d with huge pages where available) at cache line aligned offsets, and the
+// free segments are tracked with a separate stack of pointers so that
+// Get()/Put() don't touch (possibly cold) segment memory.
 
 class NormSegmentPool
 {
     public:
+        enum {SEGMENT_ALIGNMENT = 64};  // cache line (and SIMD) alignment
+        
         NormSegmentPool();
         ~NormSegmentPool();
         
-        bool Init(unsigned int count, unsigned int size);
+        bool Init(unsigned int count, unsigned int size, bool lockMemory = false);
         void Destroy();        
         char* Get();
         void Put(char* segment)
         {
             ASSERT(seg_count < seg_total);
-            *((char**)((void*)segment)) = seg_list;  // this might make a warning on Solaris
-            seg_list = segment;
-            seg_count++;
+            seg_list[seg_count++] = segment;
         }
-        bool IsEmpty() const {return (NULL == seg_list);}
+        bool IsEmpty() const {return (0 == seg_count);}
         
         unsigned int CurrentUsage() const 
             {return (seg_total - seg_count);}
@@ -35,22 +37,25 @@ class NormSegmentPool
         unsigned int GetSegmentSize() {return seg_size;}
         
     private: 
+        bool AllocateSlab(size_t numBytes, bool lockMemory);
+        void FreeSlab();
+        
         unsigned int    seg_size;
         unsigned int    seg_count;  
         unsigned int    seg_total;
-        char*           seg_list;
-		char**          seg_pool;
+        char**          seg_list;   // stack of free segments
+        char*           seg_pool;   // slab base (SEGMENT_ALIGNMENT aligned)
+        char*           slab_ptr;   // slab allocation as returned by mmap() or new
+        size_t          slab_size;  // slab allocation size in bytes
+        bool            slab_mapped;
+        bool            slab_locked;
         
         unsigned long   peak_usage;
         unsigned long   overruns;
         bool            overrun_flag;
 };  // end class NormSegmentPool
 
-#ifdef USE_PROTO_TREE
-class NormBlock : public ProtoSortedTree::Item
-#else
 class NormBlock
-#endif // if/else USE_PROTO_TREE
 {
     friend class NormBlockPool;
     friend class NormBlockBuffer;
@@ -261,15 +266,6 @@ class NormBlock
         void EmptyToPool(NormSegmentPool& segmentPool);
             
     private:
-#ifdef USE_PROTO_TREE
-        const char* GetKey() const
-            {return blk_id.GetValuePtr();}
-        unsigned int GetKeysize() const
-            {return (8*sizeof(UINT32));} 
-        ProtoTree::Endian GetEndian() const
-            {return ProtoTree::GetNativeEndian();}    
-#endif  // USE_PROTO_TREE
-            
         NormBlockId  blk_id;
         UINT16       size;
         char**       segment_table;
@@ -280,10 +276,10 @@ class NormBlock
         UINT16       parity_offset; // offset from where our fresh parity will be sent
         UINT16       seg_size_max;
         
-        ProtoBitmask pending_mask;
-        ProtoBitmask repair_mask;
+        NormBitmask  pending_mask;
+        NormBitmask  repair_mask;
         ProtoTime    last_nack_time;  // for stream flow control
-        NormBlock*   next;            // used for NormBlockPool
+        NormBlock*   next;            // used for NormBlockPool and NormBlockBuffer
 };  // end class NormBlock
 
 class NormBlockPool
@@ -329,10 +325,10 @@ class NormBlockPool
         bool            overrun_flag;
 };  // end class NormBlockPool
 
-#ifdef USE_PROTO_TREE
-class NormBlockTree : public ProtoSortedTreeTemplate<NormBlock> {};
-#endif // USE_PROTO_TREE
-
+// The NormBlockBuffer is a circular array (ring) of 2^n slots indexed
+// by (blockId & ring_mask).  When the ring is at least as large as the 
+// buffer "range_max", each slot holds at most one block (direct-mapped).
+// Otherwise (very large objects), blocks sharing a slot are chained.
 class NormBlockBuffer
 {
     public:
@@ -341,6 +337,7 @@ class NormBlockBuffer
             
         NormBlockBuffer();
         ~NormBlockBuffer();
+        // Note "tableSize" limits the ring size (rounded up to 2^n)
         bool Init(unsigned long rangeMax, unsigned long tableSize, UINT32 fecBlockMask);
         void Destroy();
         
@@ -353,22 +350,7 @@ class NormBlockBuffer
         NormBlockId RangeMin() const;
         bool IsEmpty() const {return (0 == range);}
         bool CanInsert(NormBlockId blockId) const;
-
-#ifdef USE_PROTO_TREE
-        class Iterator
-        {
-            public:
-                Iterator(NormBlockBuffer& blockBuffer);
-                NormBlock* GetNextBlock();
-                void Reset();
-                
-            private:
-                NormBlockBuffer&           buffer;
-                NormBlockTree::Iterator    iterator;
-                NormBlock*                 next_block;
-        }; 
-        
-#else        
+      
         class Iterator
         {
             public:
@@ -381,7 +363,7 @@ class NormBlockBuffer
                 bool                    reset;
                 NormBlockId             index;
         }; 
-#endif // if/else USE_PROTO_TREE            
+           
     private:
         int Compare(NormBlockId a, NormBlockId b) const
             {return NormBlockId::Compare(a, b, fec_block_mask);}
@@ -391,14 +373,14 @@ class NormBlockBuffer
             {b.Increment(i, fec_block_mask);}
         void Decrement(NormBlockId& b, UINT32 i = 1) const
             {b.Decrement(i, fec_block_mask);}
-
-#ifdef USE_PROTO_TREE
-        NormBlockTree   tree;
-#else    
-        static NormBlock* Next(NormBlock* b) {return b->next;}    
-        NormBlock**     table;
-        unsigned long   hash_mask; 
-#endif // if/else USE_PROTO_TREE      
+        
+        // These find the closest buffered block after/before
+        // the given "blockId" (which must be in range)
+        NormBlock* FindNext(const NormBlockId& blockId) const;
+        NormBlock* FindPrev(const NormBlockId& blockId) const;
+  
+        NormBlock**     table;      // ring of block "slots"
+        UINT32          ring_mask;  // (ring size - 1)
         unsigned long   range_max;  // max range of blocks that can be buffered
         unsigned long   range;      // zero if "block buffer" is empty
         UINT32          fec_block_mask;
@@ -103,6 +103,14 @@ class NormSessionMgr
         
         void DoSystemTimeout()
             {timer_mgr.DoSystemTimeout();}
+        
+#if !defined(WIN32) && !defined(SIMULATE)
+        // These support running the sessions from an external event loop
+        // (i.e., with no ProtoDispatcher thread waiting on their sockets)
+        unsigned int GetDescriptors(int* fdArray, unsigned int arraySize) const;
+        unsigned int ServiceSockets(unsigned int maxCount = 0);
+        bool IsTxBlocked() const;
+#endif // !WIN32 && !SIMULATE
     
         NormController* GetController() const {return controller;}
         
@@ -111,6 +119,11 @@ class NormSessionMgr
             {data_free_func = freeFunc;}
         NormDataObject::DataFreeFunctionHandle GetDataFreeFunction() const
             {return data_free_func;}
+        // (used for buffers the protocol engine allocates for received data)
+        void SetDataAllocFunction(NormDataObject::DataAllocFunctionHandle allocFunc)
+            {data_alloc_func = allocFunc;}
+        NormDataObject::DataAllocFunctionHandle GetDataAllocFunction() const
+            {return data_alloc_func;}
         
     private:   
         ProtoTimerMgr&                          timer_mgr;      
@@ -118,8 +131,10 @@ class NormSessionMgr
         ProtoChannel::Notifier*                 channel_notifier; 
         NormController*                         controller;     
         NormDataObject::DataFreeFunctionHandle  data_free_func;
+        NormDataObject::DataAllocFunctionHandle data_alloc_func;
         
         class NormSession*       top_session;  // top of NormSession list
+        class NormSession*       service_next; // where ServiceSockets() resumes
               
 };  // end class NormSessionMgr
 
@@ -147,6 +162,7 @@ class NormSession
         static const double DEFAULT_FLOW_CONTROL_FACTOR;
         static const UINT16 DEFAULT_RX_CACHE_MAX;
         static const int DEFAULT_ROBUST_FACTOR;
+        static const double TX_READ_RETRY_INTERVAL;  // while awaiting file read-ahead
         
         enum {IFACE_NAME_MAX = 31};
         
@@ -262,12 +278,20 @@ class NormSession
             {return rx_socket.SetRxBufferSize(bufferSize);}
         
         // Session parameters
-        double GetTxRate();  // returns bits/sec
+        // These "status" getters read the values most recently published
+        // by the NORM thread and may be called without the dispatcher lock
+        double GetTxRate()  // returns bits/sec
+        {
+            NormAtomicStore(&posted_tx_rate_changed, 0);  // (re-enables TX_RATE_CHANGED)
+            return status_snapshot.Read().tx_rate;
+        }
+        double GetGrttStatus() const 
+            {return status_snapshot.Read().grtt;}
         // (TBD) watch timer scheduling and min/max bounds
         void SetTxRate(double txRate)
         {
             txRate /= 8.0;  // convert to bytes/sec
-            posted_tx_rate_changed = false;
+            NormAtomicStore(&posted_tx_rate_changed, 0);
             SetTxRateInternal(txRate);
         }
         void SetTxRateBounds(double rateMin, double rateMax);
@@ -287,6 +311,7 @@ class NormSession
             cc_enable = state;
             cc_adjust = adjustRate;
             if (state) probe_proactive = true;
+            PublishStatus();
         }
         
         // This MUST be called before
@@ -335,6 +360,19 @@ class NormSession
                               unsigned long  countMin,
                               unsigned long  countMax);
         
+        // Number of FEC blocks of each sender file object to load ahead
+        // of transmission by helper threads (0 reads synchronously).  This
+        // applies to subsequently enqueued file objects.
+        void SetTxFileReadAhead(unsigned int blockCount)
+            {tx_read_ahead = blockCount;}
+        unsigned int GetTxFileReadAhead() const
+            {return tx_read_ahead;}
+        
+        // Compress the content of subsequently enqueued file and data
+        // objects when that makes them smaller (see NormCompressor)
+        void SetTxCompression(bool state) {tx_compression = state;}
+        bool GetTxCompression() const {return tx_compression;}
+        
         // For NormSocket API extension support only
         void SetServerListener(bool state)
             {is_server_listener = state;}
@@ -345,6 +383,7 @@ class NormSession
                     class NormNode*       node,
                     class NormObject*     object)
         {
+            if (NULL != object) object->UpdateStatus();
             notify_pending = true;
             session_mgr.Notify(event, this, node, object);  
             notify_pending = false;
@@ -399,6 +438,12 @@ class NormSession
                                     UINT32      dataLen,
                                     const char* infoPtr = NULL,
                                     UINT16      infoLen = 0);
+        NormDataObject* QueueTxDataV(const struct iovec*                         iov,
+                                     unsigned int                                iovCount,
+                                     NormDataObject::ExtentReleaseFunctionHandle releaseFunc,
+                                     const void*                                 releaseData,
+                                     const char*                                 infoPtr = NULL,
+                                     UINT16                                      infoLen = 0);
         
         bool RequeueTxObject(NormObject* obj);
         
@@ -496,8 +541,9 @@ class NormSession
         }
         
         double SenderGrtt() const {return grtt_advertised;}
+        // (called by the lock-free GRTT getter)
         void ResetGrttNotification() 
-            {notify_on_grtt_update = true;}
+            {NormAtomicStore(&notify_on_grtt_update, 1);}
         void SenderSetGrtt(double grttValue)
         {
             if (IsSender())
@@ -507,6 +553,7 @@ class NormSession
             }
             grtt_quantized = NormQuantizeRtt(grttValue);
             grtt_measured = grtt_advertised = NormUnquantizeRtt(grtt_quantized);  
+            PublishStatus();
         }
         double SenderGroupSize() {return gsize_measured;}
         void SenderSetGroupSize(double gsize)
@@ -640,6 +687,37 @@ class NormSession
         UINT16 GetRxCacheMax() const
             {return rx_cache_count_max;}
         
+        // Number of FEC blocks of each received file object to stage in
+        // memory for coalesced writes (0 writes each segment as received).
+        // This applies to subsequently accepted file objects.
+        void SetRxFileWriteBehind(unsigned int blockCount)
+            {rx_write_behind = blockCount;}
+        unsigned int GetRxFileWriteBehind() const
+            {return rx_write_behind;}
+        
+        // Keep a "resume state" sidecar file for each accepted file object
+        // so reception may be resumed after a receiver restart
+        // (see NormFileObject::Accept())
+        void SetRxFileResume(bool state) {rx_file_resume = state;}
+        bool GetRxFileResume() const {return rx_file_resume;}
+        
+        // Lock segment buffer memory (e.g. mlock()) so it isn't paged out
+        void SetBufferLocking(bool state) {buffer_locking = state;}
+        bool GetBufferLocking() const {return buffer_locking;}
+        
+        // Access subsequently opened file object content via mmap()
+        void SetFileMapping(bool state) {file_mapping = state;}
+        bool GetFileMapping() const {return file_mapping;}
+        
+        // RX_OBJECT_UPDATED and TX_QUEUE_VACANCY coalescing policy (a
+        // "maxRate" and "minBytes" of zero disables coalescing)
+        void SetEventCoalescing(double maxRate, UINT32 minBytes, double maxLatency);
+        bool EventCoalescing() const {return coalesce_enable;}
+        double GetCoalesceInterval() const {return coalesce_interval;}
+        UINT32 GetCoalesceBytes() const {return coalesce_bytes;}
+        double GetCoalesceLatency() const {return coalesce_latency;}
+        void ActivateCoalesceTimer(double delay);
+        
         // Debug settings
         void SetTrace(bool state) {trace = state;}
         void SetTxLoss(double percent) {tx_loss_rate = percent;}
@@ -656,6 +734,13 @@ class NormSession
         
         void SetProbeCount(unsigned probeCount) {probe_count = probeCount;}
         bool SenderQueueSquelch(NormObjectId objectId);
+        
+#if !defined(WIN32) && !defined(SIMULATE)
+        // For external event loop operation (see NormSessionMgr::ServiceSockets())
+        unsigned int GetDescriptors(int* fdArray, unsigned int arraySize) const;
+        unsigned int ServiceSockets();
+        bool IsTxBlocked() const {return tx_blocked;}
+#endif // !WIN32 && !SIMULATE
                    
     private:
         // Only NormSessionMgr can create/delete sessions
@@ -676,6 +761,8 @@ class NormSession
         bool OnCmdTimeout(ProtoTimer& theTimer);
         bool OnFlowControlTimeout(ProtoTimer& theTimer);
         bool OnUserTimeout(ProtoTimer& theTimer);
+        bool OnCoalesceTimeout(ProtoTimer& theTimer);
+        double ServiceHeldEvents(bool flush);
         
         void TxSocketRecvHandler(ProtoSocket& theSocket, ProtoSocket::Event theEvent);
         void RxSocketRecvHandler(ProtoSocket& theSocket, ProtoSocket::Event theEvent);        
@@ -707,6 +794,7 @@ class NormSession
                                     double         ccRate,              
                                     UINT16         ccSequence);         
         void AdjustRate(bool onResponse);
+        void PublishStatus();  // updates "status_snapshot"
         void SetTxRateInternal(double txRate);  // here, txRate is bytes/sec
         //bool SenderQueueSquelch(NormObjectId objectId);
         void SenderQueueFlush();
@@ -734,6 +822,8 @@ class NormSession
         ProtoSocket                     tx_socket_actual;
         ProtoSocket*                    tx_socket;
         ProtoSocket                     rx_socket;
+        bool                            tx_blocked;    // awaiting tx_socket output notification
+        bool                            tx_read_wait;  // awaiting file read-ahead
 #ifdef ECN_SUPPORT
         ProtoCap*                       proto_cap;        // raw packet capture alternative to "rx_socket"
         ProtoAddress                    src_addr;         // used for raw packet sendto()
@@ -783,8 +873,8 @@ class NormSession
         FtiMode                         fti_mode;  
         
         NormObjectTable                 tx_table;
-        ProtoSlidingMask                tx_pending_mask;
-        ProtoSlidingMask                tx_repair_mask;
+        NormSlidingMask                 tx_pending_mask;
+        NormSlidingMask                 tx_repair_mask;
         ProtoTimer                      repair_timer;
         NormBlockPool                   block_pool;
         NormSegmentPool                 segment_pool;
@@ -797,11 +887,19 @@ class NormSession
         unsigned int                    tx_cache_count_min;
         unsigned int                    tx_cache_count_max;
         NormObjectSize                  tx_cache_size_max;
+        unsigned int                    tx_read_ahead;   // file read-ahead depth (in blocks)
+        bool                            tx_compression;
         ProtoTimer                      flush_timer;
         int                             flush_count;
         bool                            posted_tx_queue_empty;
-        bool                            posted_tx_rate_changed;
+        volatile UINT32                 posted_tx_rate_changed;  // (reset by API getter)
         bool                            posted_send_error;
+        struct Status
+        {
+            double  tx_rate;    // bits/sec (CLR rate if !cc_adjust)
+            double  grtt;       // grtt_advertised
+        };
+        NormSeqLock<Status>             status_snapshot;
         
         // For postive acknowledgement collection
         NormNodeTree                    acking_node_tree;
@@ -891,14 +989,25 @@ class NormSession
         NormObject::NackingMode         default_nacking_mode;
         NormSenderNode::SyncPolicy      default_sync_policy;
         UINT16                          rx_cache_count_max;
+        unsigned int                    rx_write_behind;  // file write-behind depth (in blocks)
+        bool                            rx_file_resume;
+        bool                            buffer_locking;
+        bool                            file_mapping;
         NormFtiData                     preset_fti;
         
+        // Event coalescing policy (see SetEventCoalescing())
+        bool                            coalesce_enable;
+        double                          coalesce_interval;  // 1/maxRate
+        UINT32                          coalesce_bytes;     // minBytes
+        double                          coalesce_latency;   // maxLatency
+        ProtoTimer                      coalesce_timer;     // posts held events
+        
         // For NormSocket server-listener support
         bool                            is_server_listener;
         NormClientTree                  client_tree;
         
-        // API-specific state variables
-        bool                            notify_on_grtt_update;
+        // API-specific state variables (set by API getters without the lock)
+        volatile UINT32                 notify_on_grtt_update;
         
         // State for some experimental congestion control
         bool                            ecn_ignore_loss;  
@@ -16,6 +16,8 @@ LOCAL_EXPORT_CFLAGS := $(LOCAL_CFLAGS)
 LOCAL_SRC_FILES := \
 	../../../src/common/galois.cpp \
 	../../../src/common/normApi.cpp \
+	../../../src/common/normBitmask.cpp \
+	../../../src/common/normCompress.cpp \
 	../../../src/common/normEncoder.cpp \
 	../../../src/common/normEncoderMDP.cpp \
 	../../../src/common/normEncoderRS16.cpp \
@@ -1,12 +1,18 @@
 #define _NORM_API_BUILD	// force 'dllexport' in "normApi.h"
 #include "normApi.h"
 #include "normSession.h"
+#include "normAtomic.h"  // for NormAtomicLoad(), etc
 
 #ifdef WIN32
 #ifndef _WIN32_WCE
 #include <io.h>  // for _mktemp()
 #endif // !_WIN32_WCE
-#endif // WIN32
+#else
+#ifdef __linux__
+#include <sys/eventfd.h>  // for eventfd()
+#define NORM_USE_EVENTFD
+#endif // __linux__
+#endif // if/else WIN32
 
 // const defs
 extern NORM_API_LINKAGE
@@ -42,18 +48,39 @@ class NormInstance : public NormController
                     class NormNode*         node,
                     class NormObject*       object);
         
-        bool Startup(bool priorityBoost = false);
+        // A "threadCount" of zero is an "external loop" instance and more than 
+        // one creates additional "shard" instances to run sessions on
+        bool Startup(bool priorityBoost = false, unsigned int threadCount = 1);
         void Shutdown();
         
+        // These are for "external loop" instances that have no NORM
+        // protocol thread and are driven by the application instead
+        bool IsExternalLoop() const
+            {return external_loop;}
+        unsigned int GetDescriptors(NormDescriptor* descArray, unsigned int arraySize);
+        double GetNextTimeout();
+        unsigned int Process(unsigned int maxWork);
+        
         void Stop()  // pause NORM protocol engine
         {
+            for (unsigned int i = 1; i < shard_count; i++)
+                shard_list[i]->dispatcher.Stop();
             dispatcher.Stop();
             Notify(NormController::EVENT_INVALID, &session_mgr, NULL, NULL, NULL);
         }
         bool Start()
         {
+            if (external_loop) return true;  // the app runs the instance
             if (dispatcher.StartThread(priority_boost))
             {
+                for (unsigned int i = 1; i < shard_count; i++)
+                {
+                    if (!shard_list[i]->dispatcher.StartThread(priority_boost))
+                    {
+                        PLOG(PL_FATAL, "NormInstance::Resume() error restarting NORM shard thread\n");
+                        return false;
+                    }
+                }
                 return true;
             }
             else
@@ -63,21 +90,86 @@ class NormInstance : public NormController
             }
         }
         
-        bool WaitForEvent();
+        // Sessions of a multi-threaded instance are each run by one of its
+        // "shards" (shard zero is the instance itself).  A negative "index"
+        // picks the next shard in round-robin order.
+        unsigned int GetShardCount() const
+            {return shard_count;}
+        // The application's instance handle (a shard's parent)
+        NormInstance* GetParent()
+            {return ((NULL != parent) ? parent : this);}
+        NormInstance* GetShard(int index);
+        // These suspend/resume all of the instance's NORM threads
+        bool SuspendShards();
+        void ResumeShards();
+        
+        bool WaitForEvent(double timeout = -1.0);
         bool GetNextEvent(NormEvent* theEvent);
+        unsigned int GetNextEvents(NormEvent* eventArray, unsigned int count);
         bool SetCacheDirectory(const char* cachePath);
         
         void SetAllocationFunctions(NormAllocFunctionHandle allocFunc, 
-                                    NormFreeFunctionHandle  freeFunc)
+                                    NormFreeFunctionHandle  freeFunc);
+        
+        // When an event callback is set, notifications are delivered 
+        // directly from Notify() (i.e., on the NORM protocol thread) 
+        // instead of being queued for NormGetNextEvent()
+        void SetEventCallback(NormEventCallback callback, const void* userData);
+        // The optional data placement callback supplies the buffers 
+        // for received NORM_OBJECT_DATA content (see RX_OBJECT_NEW)
+        void SetRxDataPlacement(NormDataPlacementCallback callback, const void* userData);
+        // True when called from within the event callback 
+        // (by the thread that is running it).  Other (application)
+        // threads may call this, so "callback_active" is accessed 
+        // atomically and "callback_thread" is only set by the NORM 
+        // thread _before_ it publishes "callback_active"
+        bool InCallback() const
         {
-            data_alloc_func = allocFunc;
-            session_mgr.SetDataFreeFunction(freeFunc);
+            return ((0 != NormAtomicLoad(&callback_active)) && 
+                    ProtoDispatcher::IsSameThread(callback_thread, ProtoDispatcher::GetCurrentThread()));
         }
+        // The dispatcher is already "suspended" (i.e. the protocol
+        // thread is ours) during the event callback, so API calls 
+        // made from the callback don't (re)acquire it
+        bool SuspendThread()
+            {return (InCallback() ? true : dispatcher.SuspendThread());}
+        void ResumeThread()
+            {if (!InCallback()) dispatcher.ResumeThread();}
+        
+        // API calls made from within the event callback that would delete
+        // state the NORM thread may still be using further up its call 
+        // stack (an object, a remote sender, or sender/receiver operation)
+        // are deferred until the callback has returned to the dispatcher
+        enum DeferredCall
+        {
+            DEFER_OBJECT_CANCEL,
+            DEFER_NODE_DELETE,
+            DEFER_STOP_SENDER,
+            DEFER_STOP_RECEIVER
+        };
+        void DeferCall(DeferredCall call, void* handle);
+        void CancelObject(NormObject* obj);
+        void DeleteNode(NormNode* node);
         
         void ReleasePreviousEvent();
         
+        // These may be called without the dispatcher lock
         bool NotifyQueueIsEmpty() const 
-            {return notify_queue.IsEmpty();}
+            {return (NormAtomicLoad(&notify_head) == NormAtomicLoad(&notify_tail));}
+        bool PreviousEventPending() const
+            {return (0 != previous_count);}
+        
+        // Limits memory used for pending notifications (events 
+        // beyond the limit are dropped and counted as overflow)
+        void SetNotifyQueueLimit(unsigned long maxBytes);
+        // (counted under the queue lock by any of the shard threads)
+        unsigned long GetNotifyOverflowCount()
+        {
+            LockQueue();
+            unsigned long count = notify_overflow_count;
+            UnlockQueue();
+            return count;
+        }
         
         void PurgeSessionNotifications(NormSessionHandle sessionHandle);
         void PurgeNodeNotifications(NormNodeHandle nodeHandle);
@@ -115,54 +207,208 @@ class NormInstance : public NormController
             return static_cast<NormInstance*>(session.GetSessionMgr().GetController());   
         }
         
-        class Notification : public ProtoList::Item
-        {
-            public:
-                NormEvent   event;
-            
-            class Queue : public ProtoListTemplate<Notification> {};
-        };  // end class NormInstance::Notification
+        enum {NOTIFY_QUEUE_SIZE_INIT = 256};
+        static const double TIMER_PRECISION;    // sec
+        static const double TX_BLOCKED_RETRY;   // sec
+        enum {DEFAULT_NOTIFY_QUEUE_LIMIT = 8*1024*1024};  // bytes
         
         ProtoDispatcher             dispatcher;
         bool                        priority_boost;
+        bool                        external_loop;
         NormSessionMgr              session_mgr;   
         NormAllocFunctionHandle     data_alloc_func;
         
     private:
+        // The event queue (shared by the shards of a multi-threaded instance)
+        // has its own lock so events are dequeued without suspending the NORM
+        // thread(s).  When both are needed, a shard's dispatcher is suspended
+        // (or held by its thread) _before_ the queue is locked.
+        void LockQueue()
+            {queue_lock.Lock();}
+        void UnlockQueue()
+            {queue_lock.Unlock();}
+        // Object and sender lifecycle events carry handle state the
+        // application depends on, so they are queued even beyond the
+        // event queue limit (only the other events are ever dropped)
+        static bool IsEssentialEvent(NormEventType eventType)
+        {
+            switch (eventType)
+            {
+                case NORM_TX_OBJECT_PURGED:
+                case NORM_REMOTE_SENDER_PURGED:
+                case NORM_RX_OBJECT_NEW:
+                case NORM_RX_OBJECT_COMPLETED:
+                case NORM_RX_OBJECT_ABORTED:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+        bool ReserveNotification(NormEventType eventType);
+        void QueueNotification(NormEventType     eventType,
+                               NormSession*      session,
+                               NormNode*         node,
+                               NormObject*       object);
+
         void ResetNotificationEvent()
         {
 #ifdef WIN32
             if (0 == ResetEvent(notify_event))
                 PLOG(PL_ERROR, "NormInstance::ResetNotificationEvent() ResetEvent error: %s\n", GetErrorString());
+#elif defined(NORM_USE_EVENTFD)
+            UINT64 count;
+            if ((read(notify_fd[0], &count, sizeof(UINT64)) < 0) && (EAGAIN != errno))
+                PLOG(PL_ERROR, "NormInstance::ResetNotificationEvent() read() error: %s\n", GetErrorString());
 #else
            char byte[32];
            while (read(notify_fd[0], byte, 32) > 0);  // TBD - error check
-#endif // if/else WIN32/UNIX
+#endif // if/else WIN32/NORM_USE_EVENTFD/UNIX
         }  
-         
-        Notification::Queue         notify_pool;
-        Notification::Queue         notify_queue; 
-        Notification*               previous_notification;
+        void SetNotificationEvent();
+        void ReleasePreviousEvents(NormSessionHandle sessionHandle,
+                                   NormNodeHandle    nodeHandle,
+                                   NormObjectHandle  objectHandle);
+        bool MakeNotifyRoom(NormEventType eventType);
+        bool GrowNotifyQueue(bool pastLimit = false);
+        void PurgeQueue(NormSessionHandle sessionHandle,
+                        NormNodeHandle    nodeHandle,
+                        NormObjectHandle  objectHandle,
+                        NormEventType     eventType);
+        static void ResetEventState(const NormEvent& event);
+        // Returns true if the event has handle state to release ("release")
+        // or to reset upon dequeue (see "ResetEventState()")
+        static bool EventNeedsService(const NormEvent& event, bool release)
+        {
+            if (release)
+                return ((NORM_OBJECT_INVALID != event.object) || (NORM_NODE_INVALID != event.sender));
+            else if (NORM_RX_OBJECT_UPDATED == event.type)
+                return (NORM_OBJECT_INVALID != event.object);
+            else if (NORM_SEND_ERROR == event.type)
+                return (NORM_SESSION_INVALID != event.session);
+            else
+                return false;
+        }
+        static NormInstance* GetInstanceFromEvent(const NormEvent& event)
+        {
+            if (NORM_OBJECT_INVALID != event.object)
+                return GetInstanceFromObject(event.object);
+            else if (NORM_NODE_INVALID != event.sender)
+                return GetInstanceFromNode(event.sender);
+            else
+                return GetInstanceFromSession(event.session);
+        }
+        void ServicePreviousEvents(bool release);
+        // Passes an event (with retained handles) to the event callback
+        // and then any events raised by the API calls it made
+        void DispatchCallback(const NormEvent& theEvent);
+        void InvokeCallback(const NormEvent& theEvent);
+        bool HoldCallbackEvent(const NormEvent& theEvent);
+        void DeliverHeldCallbackEvents();
+        void PurgeHeldCallbackEvents(NormSessionHandle sessionHandle,
+                                     NormNodeHandle    nodeHandle,
+                                     NormObjectHandle  objectHandle,
+                                     NormEventType     eventType);
+        bool OnDeferredTimeout(ProtoTimer& theTimer);
+        void PurgeDeferredCalls(NormSessionHandle sessionHandle);
+        static void ReleaseEventHandles(const NormEvent& event)
+        {
+            // "Release" any previously-retained object or node handle
+            if (NORM_OBJECT_INVALID != event.object)
+                ((NormObject*)event.object)->Release();
+            else if (NORM_NODE_INVALID != event.sender)
+                ((NormNode*)event.sender)->Release();
+        }
+        
+        // The pending notifications are kept in a power-of-two sized ring
+        // indexed by free-running "head" (API consumer) and "tail" (NORM 
+        // protocol thread) counters.  The ring is only accessed, grown, or 
+        // purged with "queue_lock" held, but the indices may be read without
+        // it to check for pending events.
+        NormEvent*                  notify_ring;
+        UINT32                      notify_ring_mask;
+        volatile UINT32             notify_head;
+        volatile UINT32             notify_tail;
+        UINT32                      notify_ring_max;
+        unsigned long               notify_overflow_count;
+        bool                        notify_overflow;
+        // Most recently dispatched event(s) whose handles are retained
+        // until the next GetNextEvent(s) call or ReleasePreviousEvent()
+        NormEvent*                  previous_events;
+        unsigned int                previous_max;
+        volatile unsigned int       previous_count;
         
         const char*                 rx_cache_path;
         
+        NormEventCallback           event_callback;
+        const void*                 event_callback_data;
+        volatile UINT32             callback_active;
+        ProtoDispatcher::ThreadId   callback_thread;
+        // Events raised by API calls made from within the event callback
+        // are held (with their handles retained) and passed to it once it
+        // returns (purged entries are marked NORM_EVENT_INVALID)
+        NormEvent*                  callback_held;
+        unsigned int                callback_held_max;
+        unsigned int                callback_held_count;
+        // Calls deferred from within the event callback (see "DeferCall()")
+        struct Deferral
+        {
+            DeferredCall    call;
+            void*           handle;  // object, node, or session
+        };
+        Deferral*                   deferred_list;
+        unsigned int                deferred_max;
+        unsigned int                deferred_count;
+        ProtoTimer                  deferred_timer;
+        
+        NormDataPlacementCallback   data_place_callback;
+        const void*                 data_place_data;
+        
+        // A multi-threaded instance keeps a list of its "shards" (each 
+        // with its own dispatcher thread and session manager) and the
+        // shards forward notifications to their "parent" event queue
+        NormInstance*               parent;
+        NormInstance**              shard_list;
+        unsigned int                shard_count;
+        unsigned int                shard_next;
+        NormMutex                   queue_lock;
+        
 #ifdef WIN32
         HANDLE                      notify_event;
 #else
-        int                         notify_fd[2];  // TBD - use eventfd on Linux for this, may EVT_USER on MacOS
+        int                         notify_fd[2];  // (both are the same eventfd on Linux)
 #endif // if/else WIN32/UNIX
 };  // end class NormInstance
 
 
 ////////////////////////////////////////////////////
 // NormInstance implementation
+
+// External loop timers within this much of expiring are serviced 
+// (to match the millisecond timeout granularity of poll(), etc)
+const double NormInstance::TIMER_PRECISION = 1.0e-03;
+// External loop re-poll interval while a session's transmission 
+// is blocked (EWOULDBLOCK) awaiting socket output readiness
+const double NormInstance::TX_BLOCKED_RETRY = 1.0e-03;
+
 NormInstance::NormInstance()
- : priority_boost(false),
+ : priority_boost(false), external_loop(false),
    session_mgr(static_cast<ProtoTimerMgr&>(dispatcher), 
                static_cast<ProtoSocket::Notifier&>(dispatcher),
                static_cast<ProtoChannel::Notifier*>(&dispatcher)),
-   data_alloc_func(NULL), previous_notification(NULL), rx_cache_path(NULL)
-{
+   data_alloc_func(NULL), notify_ring(NULL), notify_ring_mask(0),
+   notify_head(0), notify_tail(0), notify_ring_max(0),
+   notify_overflow_count(0), notify_overflow(false), 
+   previous_events(NULL), previous_max(0), previous_count(0),
+   rx_cache_path(NULL), event_callback(NULL), event_callback_data(NULL),
+   callback_active(0), callback_held(NULL), callback_held_max(0), callback_held_count(0),
+   deferred_list(NULL), deferred_max(0), deferred_count(0),
+   data_place_callback(NULL), data_place_data(NULL), parent(NULL), shard_list(NULL), shard_count(1), 
+   shard_next(0)
+{
+    SetNotifyQueueLimit(DEFAULT_NOTIFY_QUEUE_LIMIT);
+    deferred_timer.SetListener(this, &NormInstance::OnDeferredTimeout);
+    deferred_timer.SetInterval(0.0);
+    deferred_timer.SetRepeat(0);
 #ifdef WIN32
     notify_event = NULL;
 #else
@@ -181,7 +427,7 @@ bool NormInstance::SetCacheDirectory(const char* cachePath)
 {
     // (TBD) verify that we can _write_ to this directory!
     bool result = false;
-    if (dispatcher.SuspendThread())
+    if (SuspendThread())
     {
         size_t length = strlen(cachePath);
         if (PROTO_PATH_DELIMITER != cachePath[length-1]) 
@@ -204,11 +450,99 @@ bool NormInstance::SetCacheDirectory(const char* cachePath)
             PLOG(PL_ERROR, "NormInstance::SetCacheDirectory() new pathStorage error: %s\n",
                     GetErrorString());
         }
-        dispatcher.ResumeThread();
+        ResumeThread();
     }
+    // Each shard keeps its own copy for its RX_OBJECT_NEW accept policy
+    for (unsigned int i = 1; result && (i < shard_count); i++)
+        result = shard_list[i]->SetCacheDirectory(cachePath);
     return result;
 }  // end NormInstance::SetCacheDirectory()
 
+void NormInstance::SetAllocationFunctions(NormAllocFunctionHandle allocFunc, 
+                                          NormFreeFunctionHandle  freeFunc)
+{
+    data_alloc_func = allocFunc;
+    session_mgr.SetDataFreeFunction(freeFunc);
+    session_mgr.SetDataAllocFunction(allocFunc);
+    for (unsigned int i = 1; i < shard_count; i++)
+    {
+        NormInstance* shard = shard_list[i];
+        if (shard->SuspendThread())
+        {
+            shard->SetAllocationFunctions(allocFunc, freeFunc);
+            shard->ResumeThread();
+        }
+    }
+}  // end NormInstance::SetAllocationFunctions()
+
+// (each shard invokes the callback on its own thread)
+void NormInstance::SetEventCallback(NormEventCallback callback, const void* userData)
+{
+    event_callback = callback;
+    event_callback_data = userData;
+    for (unsigned int i = 1; i < shard_count; i++)
+    {
+        NormInstance* shard = shard_list[i];
+        if (shard->SuspendThread())
+        {
+            shard->SetEventCallback(callback, userData);
+            shard->ResumeThread();
+        }
+    }
+}  // end NormInstance::SetEventCallback()
+
+void NormInstance::SetRxDataPlacement(NormDataPlacementCallback callback, const void* userData)
+{
+    data_place_callback = callback;
+    data_place_data = userData;
+    for (unsigned int i = 1; i < shard_count; i++)
+    {
+        NormInstance* shard = shard_list[i];
+        if (shard->SuspendThread())
+        {
+            shard->SetRxDataPlacement(callback, userData);
+            shard->ResumeThread();
+        }
+    }
+}  // end NormInstance::SetRxDataPlacement()
+
+NormInstance* NormInstance::GetShard(int index)
+{
+    if (index < 0)
+    {
+        index = shard_next;
+        shard_next = (shard_next + 1) % shard_count;
+    }
+    else if ((unsigned int)index >= shard_count)
+    {
+        PLOG(PL_ERROR, "NormInstance::GetShard() error: invalid thread index %d\n", index);
+        return NULL;
+    }
+    return ((0 == index) ? this : shard_list[index]);
+}  // end NormInstance::GetShard()
+
+bool NormInstance::SuspendShards()
+{
+    if (!SuspendThread()) return false;
+    for (unsigned int i = 1; i < shard_count; i++)
+    {
+        if (!shard_list[i]->SuspendThread())
+        {
+            while (--i > 0) shard_list[i]->ResumeThread();
+            ResumeThread();
+            return false;
+        }
+    }
+    return true;
+}  // end NormInstance::SuspendShards()
+
+void NormInstance::ResumeShards()
+{
+    for (unsigned int i = shard_count - 1; i > 0; i--)
+        shard_list[i]->ResumeThread();
+    ResumeThread();
+}  // end NormInstance::ResumeShards()
+
 void NormInstance::Notify(NormController::Event   event,
                           class NormSessionMgr*   sessionMgr,
                           class NormSession*      session,
@@ -221,24 +555,32 @@ void NormInstance::Notify(NormController::Event   event,
             // Purge any pending NORM_SEND_ERROR notifications for session
             PurgeNotifications(session, NORM_SEND_ERROR);
             return;
+        case TX_QUEUE_VACANCY:
+        case TX_QUEUE_EMPTY:
+            // Move any application "write ring" content into 
+            // the stream buffer now that it has some vacancy
+            if ((NULL != object) && (NormObject::STREAM == object->GetType()))
+            {
+                NormStreamObject* stream = static_cast<NormStreamObject*>(object);
+                if (stream->HasWriteRing()) stream->DrainWriteRing();
+            }
+            break;
         default:
             break;
     }
     
-    // (TBD) set a limit on how many pending notifications
-    // we allow to queue up (it could be large and probably
-    // we could base it on how much memory space the pending
-    // notifications are allowed to consume.
-    Notification* next = notify_pool.RemoveHead();
-    if (NULL == next)
-    {
-        if (NULL == (next = new Notification))
-        {
-            PLOG(PL_FATAL, "NormInstance::Notify() new Notification error: %s\n", GetErrorString());
-            return;   
-        }
-    }
+    // Events are passed directly to the event callback, if set, unless
+    // this is a "wake up" (EVENT_INVALID).  The callback isn't re-entered,
+    // so a notification caused by an API call made from within the 
+    // callback itself is held and passed to it once it returns.
+    bool doCallback = (NULL != event_callback) && (EVENT_INVALID != event);
+    bool holdCallback = doCallback && (0 != NormAtomicLoad(&callback_active));
     
+    // (the event queue of a "shard" is kept by its parent instance)
+    NormInstance* queue = (NULL != parent) ? parent : this;
+    
+    // The RX_OBJECT_NEW accept policy is applied regardless of
+    // whether there is room for the notification itself
     switch (event)
     { 
         case RX_OBJECT_NEW:
@@ -256,7 +598,6 @@ void NormInstance::Notify(NormController::Event   event,
                     if (!stream->Accept(size.LSB(), true))
                     {
                         PLOG(PL_FATAL, "NormInstance::Notify() stream accept error\n");
-                        notify_pool.Append(*next);
                         return;   
                     }
                     // By setting a non-zero "block pool threshold", this
@@ -310,7 +651,6 @@ void NormInstance::Notify(NormController::Event   event,
                     {
                         // we're ignoring files
                         PLOG(PL_DETAIL, "NormInstance::Notify() warning: receive file but no cache directory set, so ignoring file\n");
-                        notify_pool.Append(*next);
                         return;    
                     }                
                     break;
@@ -319,30 +659,46 @@ void NormInstance::Notify(NormController::Event   event,
                 {
                     NormDataObject* dataObj = static_cast<NormDataObject*>(object);
                     unsigned int dataLen = (unsigned int)(object->GetSize().GetOffset());
-                    char* dataPtr = (NULL != data_alloc_func) ? data_alloc_func(dataLen) : new char[dataLen];
+                    char* dataPtr = NULL;
+                    // (compressed content isn't placed since the decompressed
+                    //  content would not end up in the placed buffer anyway)
+                    if ((NULL != data_place_callback) && !object->IsCompressed())
+                    {
+                        // The app may place the content directly into its own memory
+                        // (this is invoked like the event callback, so API calls made
+                        // from it don't try to (re)acquire the dispatcher).  If the
+                        // event callback is already active, it is on this thread.
+                        UINT32 wasActive = NormAtomicLoad(&callback_active);
+                        callback_thread = ProtoDispatcher::GetCurrentThread();
+                        NormAtomicStore(&callback_active, 1);
+                        dataPtr = data_place_callback(data_place_data, (NormObjectHandle)object, dataLen);
+                        NormAtomicStore(&callback_active, wasActive);
+                        if (0 == wasActive) DeliverHeldCallbackEvents();
+                    }
+                    bool dataRelease = (NULL == dataPtr);
+                    if (dataRelease)
+                        dataPtr = (NULL != data_alloc_func) ? data_alloc_func(dataLen) : new char[dataLen];
                     if (NULL == dataPtr)
                     {
                         PLOG(PL_FATAL, "NormInstance::Notify(RX_OBJECT_NEW) new dataPtr error: %s\n",
                                        GetErrorString());
-                        notify_pool.Append(*next);
                         return;   
                     }
-                    // Note that the "true" parameter means the
+                    // Note that a "true" dataRelease means the
                     // NORM protocol engine will free the allocated
                     // data on object deletion, so the app should
                     // use NormDataDetachData() to keep the received
-                    // data (or copy it before the data object is deleted)
-                    if (!dataObj->Accept(dataPtr, dataLen, true))
+                    // data (or copy it before the data object is deleted).
+                    // Buffers from the placement callback remain the app's.
+                    if (!dataObj->Accept(dataPtr, dataLen, dataRelease))
                     {
                         PLOG(PL_FATAL, "NormInstance::Notify() data object accept error\n");
-                        notify_pool.Append(*next);
                         return;   
                     }
                     break;
                 }
                 default:
                     // This shouldn't occur
-                    notify_pool.Append(*next);
                     return;
             }  // end switch(object->GetType())
             break;
@@ -352,217 +708,571 @@ void NormInstance::Notify(NormController::Event   event,
             break;
     }  // end switch(event)
     
+    if (!doCallback && !queue->ReserveNotification((NormEventType)event)) return;
+    
     // "Retain" any valid "object" or "sender" handles for API access
     if (NORM_OBJECT_INVALID != object)
         ((NormObject*)object)->Retain();
     else if (NORM_NODE_INVALID != node)
         ((NormNode*)node)->Retain();
     
-    bool doNotify = notify_queue.IsEmpty();
-    next->event.type = (NormEventType)event;
-    next->event.session = session;
-    next->event.sender = node;
-    next->event.object = object;
-    notify_queue.Append(*next);
+    if (doCallback)
+    {
+        NormEvent theEvent;
+        theEvent.type = (NormEventType)event;
+        theEvent.session = session;
+        theEvent.sender = node;
+        theEvent.object = object;
+        if (!holdCallback)
+            DispatchCallback(theEvent);
+        else if (!HoldCallbackEvent(theEvent))
+            ReleaseEventHandles(theEvent);
+        return;
+    }
     
-    if (doNotify)
+    queue->QueueNotification((NormEventType)event, session, node, object);
+}  // end NormInstance::Notify()
+
+void NormInstance::DispatchCallback(const NormEvent& theEvent)
+{
+    InvokeCallback(theEvent);
+    DeliverHeldCallbackEvents();
+}  // end NormInstance::DispatchCallback()
+
+void NormInstance::InvokeCallback(const NormEvent& theEvent)
+{
+    ResetEventState(theEvent);
+    callback_thread = ProtoDispatcher::GetCurrentThread();
+    NormAtomicStore(&callback_active, 1);
+    event_callback(event_callback_data, &theEvent);
+    NormAtomicStore(&callback_active, 0);
+    // The handles are only valid for the duration of the callback
+    // (the app may NormObjectRetain() or NormNodeRetain() to keep them)
+    ReleaseEventHandles(theEvent);
+}  // end NormInstance::InvokeCallback()
+
+// Holds an event raised from within the event callback until it returns
+bool NormInstance::HoldCallbackEvent(const NormEvent& theEvent)
+{
+    if (callback_held_count == callback_held_max)
     {
-#ifdef WIN32
-        if (0 == SetEvent(notify_event))
+        unsigned int newMax = (0 != callback_held_max) ? (2 * callback_held_max) : 16;
+        NormEvent* newList = new NormEvent[newMax];
+        if (NULL == newList)
         {
-            PLOG(PL_ERROR, "NormInstance::Notify() SetEvent() error: %s\n",
-                           GetErrorString());
+            PLOG(PL_ERROR, "NormInstance::HoldCallbackEvent() new event list error: %s\n", GetErrorString());
+            return false;
         }
-#else
-        char byte = 0;
-        while (1 != write(notify_fd[1], &byte, 1))
+        for (unsigned int i = 0; i < callback_held_count; i++)
+            newList[i] = callback_held[i];
+        if (NULL != callback_held) delete[] callback_held;
+        callback_held = newList;
+        callback_held_max = newMax;
+    }
+    callback_held[callback_held_count++] = theEvent;
+    return true;
+}  // end NormInstance::HoldCallbackEvent()
+
+// Passes the held events (including any that these raise in
+// turn) to the event callback in the order they were raised
+void NormInstance::DeliverHeldCallbackEvents()
+{
+    for (unsigned int i = 0; i < callback_held_count; i++)
+    {
+        // (copied since the list may grow while the callback runs)
+        NormEvent next = callback_held[i];
+        if (NORM_EVENT_INVALID == next.type) continue;
+        if (NULL != event_callback)
+        {
+            InvokeCallback(next);
+        }
+        else
+        {
+            // (the callback was removed, so revert to queued delivery)
+            NormInstance* queue = (NULL != parent) ? parent : this;
+            queue->QueueNotification(next.type, (NormSession*)next.session, 
+                                     (NormNode*)next.sender, (NormObject*)next.object);
+        }
+    }
+    callback_held_count = 0;
+}  // end NormInstance::DeliverHeldCallbackEvents()
+
+// Purges (and releases handles of) held callback events matching the
+// given (non-invalid) handles and event type.  Entries are marked invalid
+// rather than removed since a delivery pass may be in progress.
+void NormInstance::PurgeHeldCallbackEvents(NormSessionHandle sessionHandle,
+                                           NormNodeHandle    nodeHandle,
+                                           NormObjectHandle  objectHandle,
+                                           NormEventType     eventType)
+{
+    for (unsigned int i = 0; i < callback_held_count; i++)
+    {
+        NormEvent& next = callback_held[i];
+        if ((NORM_EVENT_INVALID != next.type) &&
+            ((NORM_SESSION_INVALID == sessionHandle) || (sessionHandle == next.session)) &&
+            ((NORM_NODE_INVALID == nodeHandle) || (nodeHandle == next.sender)) &&
+            ((NORM_OBJECT_INVALID == objectHandle) || (objectHandle == next.object)) &&
+            ((NORM_EVENT_INVALID == eventType) || (eventType == next.type)))
+        {
+            ReleaseEventHandles(next);
+            next.type = NORM_EVENT_INVALID;
+            next.object = NORM_OBJECT_INVALID;
+            next.sender = NORM_NODE_INVALID;
+        }
+    }
+}  // end NormInstance::PurgeHeldCallbackEvents()
+
+// (called from within the event callback, so the NORM thread is ours)
+void NormInstance::DeferCall(DeferredCall call, void* handle)
+{
+    if (deferred_count == deferred_max)
+    {
+        unsigned int newMax = (0 != deferred_max) ? (2 * deferred_max) : 16;
+        Deferral* newList = new Deferral[newMax];
+        if (NULL == newList)
+        {
+            PLOG(PL_ERROR, "NormInstance::DeferCall() new deferral list error: %s\n", GetErrorString());
+            return;
+        }
+        for (unsigned int i = 0; i < deferred_count; i++)
+            newList[i] = deferred_list[i];
+        if (NULL != deferred_list) delete[] deferred_list;
+        deferred_list = newList;
+        deferred_max = newMax;
+    }
+    // Deferred object and node handles are retained until the call is made
+    if (DEFER_OBJECT_CANCEL == call)
+        ((NormObject*)handle)->Retain();
+    else if (DEFER_NODE_DELETE == call)
+        ((NormNode*)handle)->Retain();
+    deferred_list[deferred_count].call = call;
+    deferred_list[deferred_count].handle = handle;
+    deferred_count++;
+    if (!deferred_timer.IsActive())
+        session_mgr.ActivateTimer(deferred_timer);
+}  // end NormInstance::DeferCall()
+
+// Makes the calls deferred from within the event callback, in order
+bool NormInstance::OnDeferredTimeout(ProtoTimer& /*theTimer*/)
+{
+    // (a deferred call may raise events whose callback defers more calls)
+    for (unsigned int i = 0; i < deferred_count; i++)
+    {
+        Deferral next = deferred_list[i];
+        switch (next.call)
         {
-            if ((EINTR != errno) && (EAGAIN != errno))
+            case DEFER_OBJECT_CANCEL:
             {
-                PLOG(PL_FATAL, "NormInstance::Notify() write() error: %s\n",
-                               GetErrorString());
+                NormObject* obj = (NormObject*)next.handle;
+                CancelObject(obj);
+                obj->Release();
                 break;
             }
-        }    
-#endif // if/else WIN32/UNIX  
-    }  
-}  // end NormInstance::Notify()
+            case DEFER_NODE_DELETE:
+            {
+                // (skipped if the sender was deleted in the meantime)
+                NormNode* node = (NormNode*)next.handle;
+                if ((NormNode::SENDER != node->GetType()) ||
+                    static_cast<NormSenderNode*>(node)->IsOpen())
+                {
+                    DeleteNode(node);
+                }
+                node->Release();
+                break;
+            }
+            case DEFER_STOP_SENDER:
+                ((NormSession*)next.handle)->StopSender();
+                break;
+            case DEFER_STOP_RECEIVER:
+                ((NormSession*)next.handle)->StopReceiver();
+                break;
+        }
+    }
+    deferred_count = 0;
+    return true;
+}  // end NormInstance::OnDeferredTimeout()
 
-// Purge any notifications associated with a specific object
-void NormInstance::PurgeObjectNotifications(NormObjectHandle objectHandle)
+// Drops deferred calls for a session that is being destroyed
+void NormInstance::PurgeDeferredCalls(NormSessionHandle sessionHandle)
 {
-    if (NORM_OBJECT_INVALID == objectHandle) return;
-    
-    Notification::Queue::Iterator iterator(notify_queue);
-    Notification* next;
-    while (NULL != (next = iterator.GetNextItem()))
+    unsigned int count = 0;
+    for (unsigned int i = 0; i < deferred_count; i++)
     {
-        if (objectHandle == next->event.object)
+        Deferral& next = deferred_list[i];
+        NormSession* session;
+        switch (next.call)
         {
-            // "Release" the previously-retained object handle
-            ((NormObject*)objectHandle)->Release();
-            // Remove from queue and put in pool
-            notify_queue.Remove(*next);
-            notify_pool.Append(*next);
+            case DEFER_OBJECT_CANCEL:
+                session = &((NormObject*)next.handle)->GetSession();
+                break;
+            case DEFER_NODE_DELETE:
+                session = &((NormNode*)next.handle)->GetSession();
+                break;
+            default:
+                session = (NormSession*)next.handle;
+                break;
+        }
+        if ((NormSessionHandle)session == sessionHandle)
+        {
+            if (DEFER_OBJECT_CANCEL == next.call)
+                ((NormObject*)next.handle)->Release();
+            else if (DEFER_NODE_DELETE == next.call)
+                ((NormNode*)next.handle)->Release();
+        }
+        else
+        {
+            deferred_list[count++] = next;
         }
     }
-    if ((NULL != previous_notification) && (objectHandle == previous_notification->event.object))
+    deferred_count = count;
+    if ((0 == deferred_count) && deferred_timer.IsActive())
+        deferred_timer.Deactivate();
+}  // end NormInstance::PurgeDeferredCalls()
+
+void NormInstance::CancelObject(NormObject* obj)
+{
+    NormSenderNode* sender = obj->GetSender();
+    if (sender)
+        sender->DeleteObject(obj); 
+    else
+        obj->GetSession().DeleteTxObject(obj, false);
+    PurgeObjectNotifications((NormObjectHandle)obj);
+}  // end NormInstance::CancelObject()
+
+void NormInstance::DeleteNode(NormNode* node)
+{
+    if (NormNode::SENDER == node->GetType())
     {
-        // "Release" any previously-retained object or node handle
-        ((NormObject*)(previous_notification->event.object))->Release();
-        notify_pool.Append(*previous_notification);   
-        previous_notification = NULL;   
+        NormSenderNode* sender = static_cast<NormSenderNode*>(node);
+        sender->GetSession().DeleteRemoteSender(*sender);
     }
-    // TBD - check if event queue is emptied and reset event/fd
-}  // end NormInstance::PurgeObjectNotifications()
+    // else if NormNode::ACKER, should we remove from acking node list???
+    PurgeNodeNotifications((NormNodeHandle)node);
+}  // end NormInstance::DeleteNode()
 
-// Purge any notifications associated with a specific remote sender node
-void NormInstance::PurgeNodeNotifications(NormNodeHandle nodeHandle)
+// Makes sure there is room for a notification within the event
+// queue memory limit, else counts it as an overflow
+bool NormInstance::ReserveNotification(NormEventType eventType)
 {
-    if (NORM_NODE_INVALID == nodeHandle) return;
-    Notification::Queue::Iterator iterator(notify_queue);
-    Notification* next;
-    while (NULL != (next = iterator.GetNextItem()))
+    bool result = true;
+    LockQueue();
+    if (!MakeNotifyRoom(eventType))
     {
-        if (nodeHandle == next->event.sender)
+        notify_overflow_count++;
+        if (!notify_overflow)
         {
-            // "Release" the previously-retained object handle
-            ((NormNode*)nodeHandle)->Release();
-            // Remove this notification from queue and return to pool
-            notify_queue.Remove(*next);
-            notify_pool.Append(*next);
+            PLOG(PL_ERROR, "NormInstance::Notify() error: event queue limit reached, dropping events\n");
+            notify_overflow = true;
         }
+        result = false;
     }
-    if ((NULL != previous_notification) && (nodeHandle == previous_notification->event.sender))
+    UnlockQueue();
+    return result;
+}  // end NormInstance::ReserveNotification()
+
+// Appends a notification whose handles have been "retained"
+void NormInstance::QueueNotification(NormEventType     eventType,
+                                     NormSession*      session,
+                                     NormNode*         node,
+                                     NormObject*       object)
+{
+    LockQueue();
+    // (another shard may have used the room since ReserveNotification())
+    if (!MakeNotifyRoom(eventType))
+    {
+        notify_overflow_count++;
+        UnlockQueue();
+        NormEvent dropped;
+        dropped.type = eventType;
+        dropped.session = session;
+        dropped.sender = node;
+        dropped.object = object;
+        ReleaseEventHandles(dropped);
+        return;
+    }
+    // Only signal on transition from empty (the API clears the
+    // signal when it empties the queue), so wakeups are coalesced
+    bool doNotify = (notify_tail == NormAtomicLoad(&notify_head));
+    NormEvent& next = notify_ring[notify_tail & notify_ring_mask];
+    next.type = eventType;
+    next.session = session;
+    next.sender = node;
+    next.object = object;
+    NormAtomicStore(&notify_tail, notify_tail + 1);
+    
+    if (doNotify) SetNotificationEvent();
+    UnlockQueue();
+}  // end NormInstance::QueueNotification()
+
+void NormInstance::SetNotificationEvent()
+{
+#ifdef WIN32
+    if (0 == SetEvent(notify_event))
     {
-        // "Release" any previously-retained object or node handle
-        if (NORM_OBJECT_INVALID != previous_notification->event.object)
-            ((NormObject*)(previous_notification->event.object))->Release();
+        PLOG(PL_ERROR, "NormInstance::SetNotificationEvent() SetEvent() error: %s\n",
+                       GetErrorString());
+    }
+#else
+#ifdef NORM_USE_EVENTFD
+    UINT64 count = 1;
+    while (sizeof(UINT64) != write(notify_fd[1], &count, sizeof(UINT64)))
+#else
+    char byte = 0;
+    while (1 != write(notify_fd[1], &byte, 1))
+#endif // if/else NORM_USE_EVENTFD
+    {
+        if ((EINTR != errno) && (EAGAIN != errno))
+        {
+            PLOG(PL_FATAL, "NormInstance::SetNotificationEvent() write() error: %s\n",
+                           GetErrorString());
+            break;
+        }
+    }    
+#endif // if/else WIN32/UNIX  
+}  // end NormInstance::SetNotificationEvent()
+
+void NormInstance::SetNotifyQueueLimit(unsigned long maxBytes)
+{
+    // Limit is rounded down to a power-of-two number of events
+    unsigned long maxCount = maxBytes / sizeof(NormEvent);
+    UINT32 ringMax = NOTIFY_QUEUE_SIZE_INIT;
+    while ((ringMax < 0x40000000) && ((2*(unsigned long)ringMax) <= maxCount))
+        ringMax <<= 1;
+    LockQueue();
+    notify_ring_max = ringMax;
+    UnlockQueue();
+}  // end NormInstance::SetNotifyQueueLimit()
+
+// Makes sure there is a free ring slot for a notification of the given
+// type.  Non-essential events are held to the queue limit while essential
+// ones may grow the ring past it.  (The queue MUST be locked.)
+bool NormInstance::MakeNotifyRoom(NormEventType eventType)
+{
+    UINT32 count = notify_tail - notify_head;
+    bool essential = IsEssentialEvent(eventType);
+    if (!essential && (count >= notify_ring_max)) 
+        return false;
+    else if ((NULL != notify_ring) && (count <= notify_ring_mask))
+        return true;
+    else
+        return GrowNotifyQueue(essential);
+}  // end NormInstance::MakeNotifyRoom()
+
+// The queue MUST be locked
+bool NormInstance::GrowNotifyQueue(bool pastLimit)
+{
+    UINT32 ringSize = notify_ring_mask + 1;
+    if (NULL == notify_ring) 
+        ringSize = NOTIFY_QUEUE_SIZE_INIT;
+    else if ((ringSize < notify_ring_max) || (pastLimit && (ringSize < 0x80000000)))
+        ringSize <<= 1;
+    else
+        return false;  // at limit
+    NormEvent* newRing = new NormEvent[ringSize];
+    if (NULL == newRing)
+    {
+        PLOG(PL_ERROR, "NormInstance::GrowNotifyQueue() new event ring error: %s\n", GetErrorString());
+        return false;
+    }
+    // Pending events keep their (free-running) indices
+    UINT32 newMask = ringSize - 1;
+    for (UINT32 i = notify_head; i != notify_tail; i++)
+        newRing[i & newMask] = notify_ring[i & notify_ring_mask];
+    if (NULL != notify_ring) delete[] notify_ring;
+    notify_ring = newRing;
+    notify_ring_mask = newMask;
+    return true;
+}  // end NormInstance::GrowNotifyQueue()
+
+// Removes (and releases handles of) queued notifications matching the
+// given (non-invalid) handles and event type.  The ring is compacted
+// in place, preserving the order of the remaining notifications.
+void NormInstance::PurgeQueue(NormSessionHandle sessionHandle,
+                              NormNodeHandle    nodeHandle,
+                              NormObjectHandle  objectHandle,
+                              NormEventType     eventType)
+{
+    // Note the matching handles belong to the caller's shard
+    LockQueue();
+    UINT32 tail = notify_head;
+    for (UINT32 i = notify_head; i != notify_tail; i++)
+    {
+        NormEvent& next = notify_ring[i & notify_ring_mask];
+        if (((NORM_SESSION_INVALID == sessionHandle) || (sessionHandle == next.session)) &&
+            ((NORM_NODE_INVALID == nodeHandle) || (nodeHandle == next.sender)) &&
+            ((NORM_OBJECT_INVALID == objectHandle) || (objectHandle == next.object)) &&
+            ((NORM_EVENT_INVALID == eventType) || (eventType == next.type)))
+        {
+            ReleaseEventHandles(next);
+        }
         else
-            ((NormNode*)(previous_notification->event.sender))->Release();
-        notify_pool.Append(*previous_notification);   
-        previous_notification = NULL;   
+        {
+            if (i != tail) notify_ring[tail & notify_ring_mask] = next;
+            tail++;
+        }
     }
-    if (notify_queue.IsEmpty()) ResetNotificationEvent();
+    NormAtomicStore(&notify_tail, tail);
+    if (NotifyQueueIsEmpty()) ResetNotificationEvent();
+    UnlockQueue();
+}  // end NormInstance::PurgeQueue()
+
+// Purge any notifications associated with a specific object
+void NormInstance::PurgeObjectNotifications(NormObjectHandle objectHandle)
+{
+    if (NORM_OBJECT_INVALID == objectHandle) return;
+    PurgeHeldCallbackEvents(NORM_SESSION_INVALID, NORM_NODE_INVALID, objectHandle, NORM_EVENT_INVALID);
+    if (NULL != parent)
+    {
+        parent->PurgeObjectNotifications(objectHandle);
+        return;
+    }
+    PurgeQueue(NORM_SESSION_INVALID, NORM_NODE_INVALID, objectHandle, NORM_EVENT_INVALID);
+    ReleasePreviousEvents(NORM_SESSION_INVALID, NORM_NODE_INVALID, objectHandle);
+}  // end NormInstance::PurgeObjectNotifications()
+
+// Purge any notifications associated with a specific remote sender node
+void NormInstance::PurgeNodeNotifications(NormNodeHandle nodeHandle)
+{
+    if (NORM_NODE_INVALID == nodeHandle) return;
+    PurgeHeldCallbackEvents(NORM_SESSION_INVALID, nodeHandle, NORM_OBJECT_INVALID, NORM_EVENT_INVALID);
+    if (NULL != parent)
+    {
+        parent->PurgeNodeNotifications(nodeHandle);
+        return;
+    }
+    PurgeQueue(NORM_SESSION_INVALID, nodeHandle, NORM_OBJECT_INVALID, NORM_EVENT_INVALID);
+    ReleasePreviousEvents(NORM_SESSION_INVALID, nodeHandle, NORM_OBJECT_INVALID);
 }  // end NormInstance::PurgeNodeNotifications()
 
 void NormInstance::PurgeSessionNotifications(NormSessionHandle sessionHandle)
 {
     if (NORM_SESSION_INVALID == sessionHandle) return;
-    Notification::Queue::Iterator iterator(notify_queue);
-    Notification* next;
-    while (NULL != (next = iterator.GetNextItem()))
-    {
-        if (next->event.session == sessionHandle)
-        {
-             if (NORM_OBJECT_INVALID != next->event.object)
-                ((NormObject*)next->event.object)->Release();
-            else if (NORM_NODE_INVALID != next->event.sender)
-                ((NormNode*)next->event.sender)->Release();
-            // Remove this notification from queue and return to pool
-            notify_queue.Remove(*next);
-            notify_pool.Append(*next);
-        }   
-    }
-    if ((NULL != previous_notification) && (sessionHandle == previous_notification->event.session))
+    // (held callback events and deferred calls are kept per shard)
+    PurgeHeldCallbackEvents(sessionHandle, NORM_NODE_INVALID, NORM_OBJECT_INVALID, NORM_EVENT_INVALID);
+    PurgeDeferredCalls(sessionHandle);
+    if (NULL != parent)
     {
-        // "Release" any previously-retained object or node handle
-        if (NORM_OBJECT_INVALID != previous_notification->event.object)
-            ((NormObject*)(previous_notification->event.object))->Release();
-        else if (NORM_NODE_INVALID != previous_notification->event.sender)
-            ((NormNode*)(previous_notification->event.sender))->Release();
-        notify_pool.Append(*previous_notification);   
-        previous_notification = NULL;   
+        parent->PurgeSessionNotifications(sessionHandle);
+        return;
     }
-    if (notify_queue.IsEmpty()) ResetNotificationEvent();
+    PurgeQueue(sessionHandle, NORM_NODE_INVALID, NORM_OBJECT_INVALID, NORM_EVENT_INVALID);
+    ReleasePreviousEvents(sessionHandle, NORM_NODE_INVALID, NORM_OBJECT_INVALID);
 }  // end NormInstance::PurgeSessionNotifications()
 
 // Purges notifications of a specific type for a specific session
 void NormInstance::PurgeNotifications(NormSessionHandle sessionHandle, NormEventType eventType)
 {
     if (NORM_SESSION_INVALID == sessionHandle) return;
-    Notification::Queue::Iterator iterator(notify_queue);
-    Notification* next;
-    while (NULL != (next = iterator.GetNextItem()))
+    PurgeHeldCallbackEvents(sessionHandle, NORM_NODE_INVALID, NORM_OBJECT_INVALID, eventType);
+    if (NULL != parent)
     {
-        if ((next->event.session == sessionHandle) &&
-            (next->event.type == eventType))
-        {
-            if (NORM_OBJECT_INVALID != next->event.object)
-                ((NormObject*)next->event.object)->Release();
-            else if (NORM_NODE_INVALID != next->event.sender)
-                ((NormNode*)next->event.sender)->Release();
-            // Remove this notification from queue and return to pool
-            notify_queue.Remove(*next);
-            notify_pool.Append(*next);
-        }
+        parent->PurgeNotifications(sessionHandle, eventType);
+        return;
     }
-    if (notify_queue.IsEmpty()) ResetNotificationEvent();
+    PurgeQueue(sessionHandle, NORM_NODE_INVALID, NORM_OBJECT_INVALID, eventType);
 }  // end NormInstance::PurgeNotifications()
 
-// NormInstance::dispatcher MUST be suspended _before_ calling this
 bool NormInstance::GetNextEvent(NormEvent* theEvent)
 {
-    // First, do any garbage collection for "previous_notification"
-    if (NULL != previous_notification)
+    NormEvent event;
+    bool result = (0 != GetNextEvents(&event, 1));
+    if (NULL != theEvent)
+    {
+        if (result)
+        {
+            *theEvent = event;
+        }
+        else
+        {
+    	    theEvent->type = NORM_EVENT_INVALID;
+	        theEvent->session = NORM_SESSION_INVALID;
+	        theEvent->sender = NORM_NODE_INVALID;
+	        theEvent->object = NORM_OBJECT_INVALID;
+        }
+    }
+    return result; 
+}  // end NormInstance::GetNextEvent()
+
+// Events are dequeued with only the queue locked.  The NORM thread(s) are
+// not suspended except for the shard(s) owning the handles of the prior
+// batch (to release them) or of dequeued events with state to reset.
+unsigned int NormInstance::GetNextEvents(NormEvent* eventArray, unsigned int count)
+{
+    // First, do any garbage collection for "previous_events"
+    ReleasePreviousEvent();
+    LockQueue();
+    if (count > previous_max)
     {
-        // "Release" any previously-retained object or node handle
-        if (NORM_OBJECT_INVALID != previous_notification->event.object)
-            ((NormObject*)(previous_notification->event.object))->Release();
-        else if (NORM_NODE_INVALID != previous_notification->event.sender)
-            ((NormNode*)(previous_notification->event.sender))->Release();
-        notify_pool.Append(*previous_notification);   
-        previous_notification = NULL;   
+        NormEvent* eventList = new NormEvent[count];
+        if (NULL != eventList)
+        {
+            if (NULL != previous_events) delete[] previous_events;
+            previous_events = eventList;
+            previous_max = count;
+        }
+        else
+        {
+            PLOG(PL_ERROR, "NormInstance::GetNextEvents() new event list error: %s\n", GetErrorString());
+            count = previous_max;  // deliver what we can
+        }
     }
-    Notification* next;
-    while (NULL != (next = notify_queue.RemoveHead()))
+    unsigned int index = 0;
+    while ((index < count) && (notify_head != notify_tail))
     {
-        switch (next->event.type)
+        NormEvent& next = notify_ring[notify_head & notify_ring_mask];
+        switch (next.type)
         {
             case NORM_EVENT_INVALID:
-                if (!notify_queue.IsEmpty())
+                if (((notify_head + 1) != notify_tail) || (0 != index))
                 {
                     // Discard this invalid event and get next one
-                    notify_pool.Append(*next);
+                    // (it's only delivered alone as a "wake up")
+                    NormAtomicStore(&notify_head, notify_head + 1);
                     continue;
                 }
                 break;
-            case NORM_RX_OBJECT_UPDATED:
-            {
-                // reset update event notification for non-streams
-                // (NormStreamRead() takes care of streams)
-                NormObject* obj = ((NormObject*)next->event.object);
-                if (!obj->IsStream()) obj->SetNotifyOnUpdate(true);
-                break;
-            }
-            case NORM_SEND_ERROR:
-            {
-                NormSession* session = (NormSession*)next->event.session;
-                session->ClearSendError();
-                break;
-            }
             default:
                 break;   
         }
-	    break;
-    }
-    if (NULL != next)
-    {
-        previous_notification = next;  // keep dispatched event for garbage collection
-        if (NULL != theEvent) *theEvent = next->event;
-    }
-    else if (NULL != theEvent)
-    {
-    	theEvent->type = NORM_EVENT_INVALID;
-	    theEvent->session = NORM_SESSION_INVALID;
-	    theEvent->sender = NORM_NODE_INVALID;
-	    theEvent->object = NORM_OBJECT_INVALID;
+        // keep dispatched events for garbage collection
+        eventArray[index] = previous_events[index] = next;
+        index++;
+        NormAtomicStore(&notify_head, notify_head + 1);
+    }
+    previous_count = index;
+    if (0 != index) notify_overflow = false;
+    if (NotifyQueueIsEmpty()) ResetNotificationEvent();
+    UnlockQueue();
+    ServicePreviousEvents(false);
+    return index; 
+}  // end NormInstance::GetNextEvents()
+
+// Resets any state that re-enables notification for 
+// an event type once the event has been dispatched
+void NormInstance::ResetEventState(const NormEvent& event)
+{
+    switch (event.type)
+    {
+        case NORM_RX_OBJECT_UPDATED:
+        {
+            // reset update event notification for non-streams
+            // (NormStreamRead() takes care of streams)
+            NormObject* obj = ((NormObject*)event.object);
+            if (!obj->IsStream()) obj->SetNotifyOnUpdate(true);
+            break;
+        }
+        case NORM_SEND_ERROR:
+        {
+            NormSession* session = (NormSession*)event.session;
+            session->ClearSendError();
+            break;
+        }
+        default:
+            break;
     }
-    if (notify_queue.IsEmpty()) ResetNotificationEvent();
-    return (NULL != next); 
-}  // end NormInstance::GetNextEvent()
+}  // end NormInstance::ResetEventState()
 
-bool NormInstance::WaitForEvent()
+bool NormInstance::WaitForEvent(double timeout)
 {
     if (!dispatcher.IsThreaded()) 
     {
@@ -570,15 +1280,26 @@ bool NormInstance::WaitForEvent()
         return false;
     }
 #ifdef WIN32
-    WaitForSingleObject(notify_event, INFINITE);
+    DWORD msec = (timeout < 0.0) ? INFINITE : (DWORD)(1000.0*timeout);
+    if (WAIT_OBJECT_0 != WaitForSingleObject(notify_event, msec))
+        return false;
 #else
+    struct timeval timeoutValue;
+    struct timeval* timeoutPtr = (struct timeval*)NULL;
+    if (timeout >= 0.0)
+    {
+        timeoutValue.tv_sec = (long)timeout;
+        timeoutValue.tv_usec = (long)(1.0e+06*(timeout - (double)timeoutValue.tv_sec));
+        timeoutPtr = &timeoutValue;
+    }
     fd_set fdSet;
-    FD_ZERO(&fdSet);
-    FD_SET(notify_fd[0], &fdSet);
     while (1)
     {
-        if (0 > select(notify_fd[0] + 1, &fdSet, (fd_set*)NULL, 
-                       (fd_set*)NULL, (struct timeval*)NULL))
+        FD_ZERO(&fdSet);
+        FD_SET(notify_fd[0], &fdSet);
+        int result = select(notify_fd[0] + 1, &fdSet, (fd_set*)NULL, 
+                            (fd_set*)NULL, timeoutPtr);
+        if (result < 0)
         {
             if (EINTR != errno)
             {
@@ -587,6 +1308,10 @@ bool NormInstance::WaitForEvent()
                 return false;   
             }
         }
+        else if (0 == result)
+        {
+            return false;  // timed out
+        }
         else
         {
             break;       
@@ -597,7 +1322,7 @@ bool NormInstance::WaitForEvent()
 }  // end NormInstance::WaitForEvent()
 
 
-bool NormInstance::Startup(bool priorityBoost)
+bool NormInstance::Startup(bool priorityBoost, unsigned int threadCount)
 {
     // 1) Create descriptor to use for event notification
 #ifdef WIN32
@@ -608,6 +1333,14 @@ bool NormInstance::Startup(bool priorityBoost)
         PLOG(PL_FATAL, "NormInstance::Startup() CreateEvent() error: %s\n", GetErrorString());
         return false;
     }
+#elif defined(NORM_USE_EVENTFD)
+    // Non-blocking eventfd() serves as both read and write descriptor
+    notify_fd[0] = notify_fd[1] = eventfd(0, EFD_NONBLOCK);
+    if (notify_fd[0] < 0)
+    {
+        PLOG(PL_FATAL, "NormInstance::Startup() eventfd() error: %s\n", GetErrorString());
+        return false;
+    }
 #else
     if (0 != pipe(notify_fd))
     {
@@ -624,42 +1357,182 @@ bool NormInstance::Startup(bool priorityBoost)
         return false;
     }
 #endif // if/else WIN32/UNIX
-    // 2) Start thread
+    // 2) Create "shard" instances for any additional threads
+    if (threadCount > 1)
+    {
+        if (NULL == (shard_list = new NormInstance*[threadCount]))
+        {
+            PLOG(PL_FATAL, "NormInstance::Startup() new shard_list error: %s\n", GetErrorString());
+            return false;
+        }
+        shard_list[0] = this;
+        while (shard_count < threadCount)
+        {
+            NormInstance* shard = new NormInstance();
+            if (NULL == shard)
+            {
+                PLOG(PL_FATAL, "NormInstance::Startup() new shard error: %s\n", GetErrorString());
+                return false;
+            }
+            shard->parent = this;
+            shard->priority_boost = priorityBoost;
+            // A new shard takes on the instance's current callbacks and
+            // allocation functions (its thread isn't started yet)
+            shard->SetAllocationFunctions(data_alloc_func, session_mgr.GetDataFreeFunction());
+            shard->SetEventCallback(event_callback, event_callback_data);
+            shard->SetRxDataPlacement(data_place_callback, data_place_data);
+            shard_list[shard_count++] = shard;
+        }
+    }
+    // 3) Start thread(s) (unless the application will run the instance)
     priority_boost = priorityBoost;
-    return dispatcher.StartThread(priorityBoost);
+    external_loop = (0 == threadCount);
+    return Start();
 }  // end NormInstance::Startup()
 
+unsigned int NormInstance::GetDescriptors(NormDescriptor* descArray, unsigned int arraySize)
+{
+#if defined(WIN32) || defined(SIMULATE)
+    PLOG(PL_ERROR, "NormInstance::GetDescriptors() error: external loop operation not supported\n");
+    return 0;
+#else
+    return session_mgr.GetDescriptors(descArray, arraySize);
+#endif // if/else WIN32 || SIMULATE
+}  // end NormInstance::GetDescriptors()
+
+// Returns seconds until Process() should next be called 
+// (if no descriptor is ready sooner), or -1.0 if no timeout
+double NormInstance::GetNextTimeout()
+{
+    double timeout = session_mgr.GetTimerMgr().GetTimeRemaining();
+#if !defined(WIN32) && !defined(SIMULATE)
+    if (session_mgr.IsTxBlocked() && ((timeout < 0.0) || (timeout > TX_BLOCKED_RETRY)))
+        timeout = TX_BLOCKED_RETRY;
+#endif // !WIN32 && !SIMULATE
+    return timeout;
+}  // end NormInstance::GetNextTimeout()
+
+// Services ready session sockets (up to "maxWork" socket handler 
+// invocations, zero means no limit) and then any expired timers.
+// Returns the amount of work (socket handlers plus timer service) done.
+unsigned int NormInstance::Process(unsigned int maxWork)
+{
+#if defined(WIN32) || defined(SIMULATE)
+    PLOG(PL_ERROR, "NormInstance::Process() error: external loop operation not supported\n");
+    return 0;
+#else
+    unsigned int workCount = session_mgr.ServiceSockets(maxWork);
+    double timeRemaining = session_mgr.GetTimerMgr().GetTimeRemaining();
+    if ((timeRemaining >= 0.0) && (timeRemaining < TIMER_PRECISION))
+    {
+        session_mgr.DoSystemTimeout();
+        workCount++;
+    }
+    return workCount;
+#endif // if/else WIN32 || SIMULATE
+}  // end NormInstance::Process()
+
 
 
 void NormInstance::ReleasePreviousEvent()
 {
-    // Garbage collect our "previous_notification"
-    if (NULL != previous_notification)
+    // Garbage collect our "previous_events"
+    if (0 == previous_count) return;
+    ServicePreviousEvents(true);
+    LockQueue();
+    previous_count = 0;
+    UnlockQueue();
+}  // end NormInstance::ReleasePreviousEvent()
+
+// Releases the handles ("release" true) or resets the state (see
+// "ResetEventState()") of the "previous_events", suspending each shard
+// that owns some of them in turn.  (Only the API consumer thread calls 
+// this, but the owning shard may concurrently purge the events' handles
+// using "ReleasePreviousEvents()", so the queue lock is held to check them.)
+void NormInstance::ServicePreviousEvents(bool release)
+{
+    for (unsigned int i = 0; i < shard_count; i++)
     {
-        // Release any previously-retained object or node handles
-        if (NORM_OBJECT_INVALID != previous_notification->event.object)
-            ((NormObject*)(previous_notification->event.object))->Release();
-        else if (NORM_NODE_INVALID != previous_notification->event.sender)
-            ((NormNode*)(previous_notification->event.sender))->Release();
-        notify_pool.Append(*previous_notification);   
-        previous_notification = NULL;   
+        NormInstance* shard = (0 == i) ? this : shard_list[i];
+        bool pending = false;
+        LockQueue();
+        for (unsigned int j = 0; j < previous_count; j++)
+        {
+            const NormEvent& prev = previous_events[j];
+            if (EventNeedsService(prev, release) && (shard == GetInstanceFromEvent(prev)))
+            {
+                pending = true;
+                break;
+            }
+        }
+        UnlockQueue();
+        if (!pending || !shard->SuspendThread()) continue;
+        LockQueue();
+        for (unsigned int j = 0; j < previous_count; j++)
+        {
+            NormEvent& prev = previous_events[j];
+            if (!EventNeedsService(prev, release) || (shard != GetInstanceFromEvent(prev)))
+                continue;
+            if (release)
+            {
+                ReleaseEventHandles(prev);
+                // (so it's not released again)
+                prev.sender = NORM_NODE_INVALID;
+                prev.object = NORM_OBJECT_INVALID;
+            }
+            else
+            {
+                ResetEventState(prev);
+            }
+        }
+        UnlockQueue();
+        shard->ResumeThread();
     }
-}  // end NormInstance::ReleasePreviousEvent()
+}  // end NormInstance::ServicePreviousEvents()
+
+// Releases handles of previously dispatched events matching the
+// given (non-invalid) handles (e.g., when the object is purged)
+void NormInstance::ReleasePreviousEvents(NormSessionHandle sessionHandle,
+                                         NormNodeHandle    nodeHandle,
+                                         NormObjectHandle  objectHandle)
+{
+    LockQueue();
+    for (unsigned int i = 0; i < previous_count; i++)
+    {
+        NormEvent& prev = previous_events[i];
+        if (((NORM_SESSION_INVALID == sessionHandle) || (sessionHandle == prev.session)) &&
+            ((NORM_NODE_INVALID == nodeHandle) || (nodeHandle == prev.sender)) &&
+            ((NORM_OBJECT_INVALID == objectHandle) || (objectHandle == prev.object)))
+        {
+            ReleaseEventHandles(prev);
+            // (so it's not released (or reset) again)
+            prev.session = NORM_SESSION_INVALID;
+            prev.sender = NORM_NODE_INVALID;
+            prev.object = NORM_OBJECT_INVALID;
+        }
+    }
+    UnlockQueue();
+}  // end NormInstance::ReleasePreviousEvents()
 
 NORM_API_LINKAGE
 void NormReleasePreviousEvent(NormInstanceHandle instanceHandle)
 {
     NormInstance* instance = (NormInstance*)instanceHandle;
-    if (instance && instance->dispatcher.SuspendThread())
-    {
-        instance->ReleasePreviousEvent();
-        instance->dispatcher.ResumeThread();
-    }
+    if (NULL != instance) instance->ReleasePreviousEvent();
 }  // end NormReleasePreviousEvent()
 
+NORM_API_LINKAGE
+void NormReleaseEvents(NormInstanceHandle instanceHandle)
+{
+    // Releases the whole batch from the last "NormGetNextEvents()" call
+    NormReleasePreviousEvent(instanceHandle);
+}  // end NormReleaseEvents()
+
 
 void NormInstance::Shutdown()
 {
+    for (unsigned int i = 1; i < shard_count; i++)
+        shard_list[i]->dispatcher.Stop();
     dispatcher.Stop();
 #ifdef WIN32
     if (NULL != notify_event)
@@ -671,7 +1544,8 @@ void NormInstance::Shutdown()
     if (notify_fd[0] >= 0)
     {
         close(notify_fd[0]);  // close read end of pipe
-        close(notify_fd[1]);  // close write end of pipe
+        if (notify_fd[1] != notify_fd[0])
+            close(notify_fd[1]);  // close write end of pipe
         notify_fd[0] = notify_fd[1] = -1;
     }
 #endif // if/else WIN32/UNIX
@@ -681,26 +1555,51 @@ void NormInstance::Shutdown()
         rx_cache_path = NULL;   
     }
     
-    // Garbage collect our "previous_notification"
-    if (NULL != previous_notification)
+    // Garbage collect our "previous_events" (the NORM threads are stopped)
+    for (unsigned int i = 0; i < previous_count; i++)
+        ReleaseEventHandles(previous_events[i]);
+    previous_count = 0;
+    if (NULL != previous_events)
     {
-        // Release any previously-retained object or node handles
-        if (NORM_OBJECT_INVALID != previous_notification->event.object)
-            ((NormObject*)(previous_notification->event.object))->Release();
-        else if (NORM_NODE_INVALID != previous_notification->event.sender)
-            ((NormNode*)(previous_notification->event.sender))->Release();
-        notify_pool.Append(*previous_notification);   
-        previous_notification = NULL;   
+        delete[] previous_events;
+        previous_events = NULL;
+        previous_max = 0;
     }
     
-    Notification* next;
-    while (NULL != (next = notify_queue.RemoveHead()))
+    // Likewise any held callback events and deferred calls
+    for (unsigned int i = 0; i < callback_held_count; i++)
+        ReleaseEventHandles(callback_held[i]);
+    callback_held_count = 0;
+    if (NULL != callback_held)
     {
-        switch (next->event.type)
+        delete[] callback_held;
+        callback_held = NULL;
+        callback_held_max = 0;
+    }
+    if (deferred_timer.IsActive()) deferred_timer.Deactivate();
+    for (unsigned int i = 0; i < deferred_count; i++)
+    {
+        if (DEFER_OBJECT_CANCEL == deferred_list[i].call)
+            ((NormObject*)deferred_list[i].handle)->Release();
+        else if (DEFER_NODE_DELETE == deferred_list[i].call)
+            ((NormNode*)deferred_list[i].handle)->Release();
+    }
+    deferred_count = 0;
+    if (NULL != deferred_list)
+    {
+        delete[] deferred_list;
+        deferred_list = NULL;
+        deferred_max = 0;
+    }
+    
+    while (notify_head != notify_tail)
+    {
+        NormEvent& next = notify_ring[notify_head & notify_ring_mask];
+        switch (next.type)
         {
             case NORM_RX_OBJECT_NEW:
             {
-                NormObject* obj = (NormObject*)next->event.object;
+                NormObject* obj = (NormObject*)next.object;
                 switch (obj->GetType())
                 {
                     case NormObject::FILE:
@@ -714,29 +1613,47 @@ void NormInstance::Shutdown()
             default:
                 break;
         }   
-        if (NORM_OBJECT_INVALID != next->event.object)
-            ((NormObject*)(next->event.object))->Release();
-        else if (NORM_NODE_INVALID != next->event.sender)
-            ((NormNode*)(next->event.sender))->Release();
-        delete next;        
+        ReleaseEventHandles(next);
+        NormAtomicStore(&notify_head, notify_head + 1);
+    }
+    if (NULL != notify_ring)
+    {
+        delete[] notify_ring;
+        notify_ring = NULL;
+        notify_ring_mask = 0;
+    }
+    
+    // Shards are detached first so any notifications from their 
+    // session teardown don't go to this instance's closed queue
+    for (unsigned int i = 1; i < shard_count; i++)
+    {
+        shard_list[i]->parent = NULL;
+        delete shard_list[i];
     }
-    notify_pool.Destroy();
+    if (NULL != shard_list)
+    {
+        delete[] shard_list;
+        shard_list = NULL;
+    }
+    shard_count = 1;
 }  // end NormInstance::Shutdown()
 
 // This function doesn't make sense?
 UINT32 NormInstance::CountCompletedObjects(NormSession* session)
 {
+    if (NULL != parent) return parent->CountCompletedObjects(session);
+    LockQueue();
 	UINT32 result = 0UL;
-    Notification::Queue::Iterator iterator(notify_queue);
-    Notification* next;
-    while (NULL != (next = iterator.GetNextItem()))
+    for (UINT32 i = notify_head; i != notify_tail; i++)
     {
-		if ((session == next->event.session) &&
-			(NORM_RX_OBJECT_COMPLETED == next->event.type))
+        const NormEvent& next = notify_ring[i & notify_ring_mask];
+		if ((session == next.session) &&
+			(NORM_RX_OBJECT_COMPLETED == next.type))
         {
 			result ++;
         }
 	}
+    UnlockQueue();
 	return result;
 } // end NormInstance::CountCompletedObjects()
 
@@ -770,16 +1687,41 @@ NormInstanceHandle NormCreateInstance(bool priorityBoost)
     return NORM_INSTANCE_INVALID;  
 }  // end NormCreateInstance()
 
+NORM_API_LINKAGE
+NormInstanceHandle NormCreateInstanceEx(bool priorityBoost, unsigned int threadCount)
+{
+    NormInstance* normInstance = new NormInstance;
+    if (normInstance)
+    {
+        if (normInstance->Startup(priorityBoost, threadCount))
+            return ((NormInstanceHandle)normInstance); 
+        else
+            delete normInstance;
+    }
+    return NORM_INSTANCE_INVALID;  
+}  // end NormCreateInstanceEx()
+
 NORM_API_LINKAGE
 void NormDestroyInstance(NormInstanceHandle instanceHandle)
 {
-    delete ((NormInstance*)instanceHandle);   
+    NormInstance* instance = (NormInstance*)instanceHandle;
+    if ((NULL != instance) && instance->InCallback())
+    {
+        PLOG(PL_ERROR, "NormDestroyInstance() error: not allowed from event callback\n");
+        return;
+    }
+    delete instance;   
 }  // end NormDestroyInstance()
 
 NORM_API_LINKAGE
 void NormStopInstance(NormInstanceHandle instanceHandle)
 {
     NormInstance* instance = (NormInstance*)instanceHandle;
+    if ((NULL != instance) && instance->InCallback())
+    {
+        PLOG(PL_ERROR, "NormStopInstance() error: not allowed from event callback\n");
+        return;
+    }
     if (instance) instance->Stop();  // stops NORM protocol thread
 }  // end NormStopInstance()
 
@@ -787,6 +1729,11 @@ NORM_API_LINKAGE
 bool NormRestartInstance(NormInstanceHandle instanceHandle)
 {
     NormInstance* instance = (NormInstance*)instanceHandle;
+    if ((NULL != instance) && instance->InCallback())
+    {
+        PLOG(PL_ERROR, "NormRestartInstance() error: not allowed from event callback\n");
+        return false;
+    }
     if (instance)
     {
         if (instance->dispatcher.IsThreaded())
@@ -802,7 +1749,7 @@ bool NormSuspendInstance(NormInstanceHandle instanceHandle)
 {
     NormInstance* instance = (NormInstance*)instanceHandle;
     if (instance) 
-        return instance->dispatcher.SuspendThread();  // stops NORM protocol thread
+        return instance->SuspendShards();  // stops NORM protocol thread(s)
     else
         return false;
 }  // end NormSuspendInstance()
@@ -811,7 +1758,7 @@ NORM_API_LINKAGE
 void NormResumeInstance(NormInstanceHandle instanceHandle)
 {
     NormInstance* instance = (NormInstance*)instanceHandle;
-    if (instance) instance->dispatcher.ResumeThread();  
+    if (instance) instance->ResumeShards();  
 }  // end NormResumeInstance()
 
 
@@ -827,61 +1774,201 @@ bool NormSetCacheDirectory(NormInstanceHandle instanceHandle,
 } // end NormSetCacheDirectory()
 
 NORM_API_LINKAGE
-NormDescriptor NormGetDescriptor(NormInstanceHandle instanceHandle)
+NormDescriptor NormGetDescriptor(NormInstanceHandle instanceHandle)
+{
+    NormInstance* instance = (NormInstance*)instanceHandle;
+    if (instance)
+        return (instance->GetDescriptor());
+    else
+        return NORM_DESCRIPTOR_INVALID;
+}  // end NormGetDescriptor()
+
+NORM_API_LINKAGE
+unsigned int NormGetDescriptors(NormInstanceHandle instanceHandle,
+                                NormDescriptor*    descArray,
+                                unsigned int       arraySize)
+{
+    NormInstance* instance = (NormInstance*)instanceHandle;
+    unsigned int result = 0;
+    if ((NULL != instance) && (NULL != descArray) && instance->SuspendThread())
+    {
+        result = instance->GetDescriptors(descArray, arraySize);
+        instance->ResumeThread();
+    }
+    return result;
+}  // end NormGetDescriptors()
+
+NORM_API_LINKAGE
+double NormGetNextTimeout(NormInstanceHandle instanceHandle)
+{
+    NormInstance* instance = (NormInstance*)instanceHandle;
+    double result = -1.0;
+    if ((NULL != instance) && instance->SuspendThread())
+    {
+        result = instance->GetNextTimeout();
+        instance->ResumeThread();
+    }
+    return result;
+}  // end NormGetNextTimeout()
+
+NORM_API_LINKAGE
+unsigned int NormInstanceProcess(NormInstanceHandle instanceHandle, unsigned int maxWork)
+{
+    NormInstance* instance = (NormInstance*)instanceHandle;
+    if (NULL == instance) return 0;
+    if (!instance->IsExternalLoop() || instance->InCallback())
+    {
+        PLOG(PL_ERROR, "NormInstanceProcess() error: not an external loop instance (or called from event callback)\n");
+        return 0;
+    }
+    // (no dispatcher thread, so nothing to suspend)
+    return instance->Process(maxWork);
+}  // end NormInstanceProcess()
+
+
+NORM_API_LINKAGE
+void NormSetAllocationFunctions(NormInstanceHandle      instanceHandle, 
+                                NormAllocFunctionHandle allocFunc, 
+                                NormFreeFunctionHandle  freeFunc)
+{
+    NormInstance* instance = (NormInstance*)instanceHandle;
+    instance->SetAllocationFunctions(allocFunc, freeFunc);
+}  // end NormSetAllocationFunctions()
+
+
+// if "waitForEvent" is false, this is a non-blocking call
+// (TBD) add a timeout option to this?
+
+NORM_API_LINKAGE
+bool NormGetNextEvent(NormInstanceHandle instanceHandle, NormEvent* theEvent, bool waitForEvent)
+{
+    NormInstance* instance = (NormInstance*)instanceHandle;
+    bool result = false;
+    if ((NULL != instance) && instance->InCallback())
+    {
+        // (events are delivered to the callback, and waiting would deadlock)
+        PLOG(PL_ERROR, "NormGetNextEvent() error: not allowed from event callback\n");
+        instance = NULL;
+    }
+    if (instance)
+    {
+        // The event queue can be checked without suspending the NORM thread
+        if (instance->NotifyQueueIsEmpty())
+        {
+            if (waitForEvent)
+            {
+                // no pending events, so wait
+                if (!instance->WaitForEvent())
+                {
+                    // Indication that NormInstance is dead
+			        // TBD - how do we inform app although this shouldn't
+			        // happen unless the app destroys the "instance"
+                    return false;
+                }
+            }
+            else if (!instance->PreviousEventPending())
+            {
+                // nothing to dequeue or garbage collect
+                if (NULL != theEvent)
+                {
+                    theEvent->type = NORM_EVENT_INVALID;
+                    theEvent->session = NORM_SESSION_INVALID;
+                    theEvent->sender = NORM_NODE_INVALID;
+                    theEvent->object = NORM_OBJECT_INVALID;
+                }
+                return false;
+            }
+        }
+        result = instance->GetNextEvent(theEvent);
+    }
+    return result;  
+}  // end NormGetNextEvent()
+
+NORM_API_LINKAGE
+unsigned int NormGetNextEvents(NormInstanceHandle instanceHandle, 
+                               NormEvent*         eventArray, 
+                               unsigned int       count,
+                               double             timeout)
+{
+    NormInstance* instance = (NormInstance*)instanceHandle;
+    unsigned int result = 0;
+    if ((NULL != instance) && instance->InCallback())
+    {
+        PLOG(PL_ERROR, "NormGetNextEvents() error: not allowed from event callback\n");
+        return 0;
+    }
+    if (instance && (NULL != eventArray) && (0 != count))
+    {
+        if (instance->NotifyQueueIsEmpty())
+        {
+            if (0.0 != timeout)
+            {
+                // no pending events, so wait (up to "timeout" seconds)
+                if (!instance->WaitForEvent(timeout)) return 0;
+            }
+            else if (!instance->PreviousEventPending())
+            {
+                return 0;  // nothing to dequeue or garbage collect
+            }
+        }
+        result = instance->GetNextEvents(eventArray, count);
+    }
+    return result;
+}  // end NormGetNextEvents()
+
+NORM_API_LINKAGE
+void NormSetEventQueueLimit(NormInstanceHandle instanceHandle, unsigned long maxBytes)
 {
     NormInstance* instance = (NormInstance*)instanceHandle;
-    if (instance)
-        return (instance->GetDescriptor());
-    else
-        return NORM_DESCRIPTOR_INVALID;
-}  // end NormGetDescriptor()
-
+    if (instance && instance->SuspendThread())
+    {
+        instance->SetNotifyQueueLimit(maxBytes);
+        instance->ResumeThread();
+    }
+}  // end NormSetEventQueueLimit()
 
 NORM_API_LINKAGE
-void NormSetAllocationFunctions(NormInstanceHandle      instanceHandle, 
-                                NormAllocFunctionHandle allocFunc, 
-                                NormFreeFunctionHandle  freeFunc)
+unsigned long NormGetEventOverflowCount(NormInstanceHandle instanceHandle)
 {
+    unsigned long result = 0;
     NormInstance* instance = (NormInstance*)instanceHandle;
-    instance->SetAllocationFunctions(allocFunc, freeFunc);
-}  // end NormSetAllocationFunctions()
-
+    if (instance && instance->SuspendThread())
+    {
+        result = instance->GetNotifyOverflowCount();
+        instance->ResumeThread();
+    }
+    return result;
+}  // end NormGetEventOverflowCount()
 
-// if "waitForEvent" is false, this is a non-blocking call
-// (TBD) add a timeout option to this?
+NORM_API_LINKAGE
+bool NormSetEventCallback(NormInstanceHandle instanceHandle,
+                          NormEventCallback  eventCallback,
+                          const void*        userData)
+{
+    NormInstance* instance = (NormInstance*)instanceHandle;
+    if (instance && instance->SuspendThread())
+    {
+        instance->SetEventCallback(eventCallback, userData);
+        instance->ResumeThread();
+        return true;
+    }
+    return false;
+}  // end NormSetEventCallback()
 
 NORM_API_LINKAGE
-bool NormGetNextEvent(NormInstanceHandle instanceHandle, NormEvent* theEvent, bool waitForEvent)
+bool NormSetRxDataPlacement(NormInstanceHandle        instanceHandle,
+                            NormDataPlacementCallback placementCallback,
+                            const void*               userData)
 {
     NormInstance* instance = (NormInstance*)instanceHandle;
-    bool result = false;
-    if (instance)
+    if (instance && instance->SuspendThread())
     {
-        if (instance->dispatcher.SuspendThread())
-        {
-            if (waitForEvent)
-            {
-                if (instance->NotifyQueueIsEmpty()) 
-                {
-                    // no pending events, so resume and wait
-                    instance->dispatcher.ResumeThread();
-                    if (!instance->WaitForEvent())
-                    {
-                        // Indication that NormInstance is dead
-			            // TBD - how do we inform app although this shouldn't
-			            // happen unless the app destroys the "instance"
-                        return false;
-                    }
-                    // re-suspend thread after wait
-                    if (!instance->dispatcher.SuspendThread()) return false;
-                }
-            }
-            result = instance->GetNextEvent(theEvent);
-            instance->dispatcher.ResumeThread();
-        }
+        instance->SetRxDataPlacement(placementCallback, userData);
+        instance->ResumeThread();
+        return true;
     }
-    return result;  
-}  // end NormGetNextEvent()
+    return false;
+}  // end NormSetRxDataPlacement()
 
 
 NORM_API_LINKAGE
@@ -902,24 +1989,45 @@ NormSessionHandle NormCreateSession(NormInstanceHandle instanceHandle,
                                     UINT16             sessionPort,
                                     NormNodeId         localNodeId)
 {
-    // (TBD) wrap this with SuspendThread/ResumeThread ???
+    return NormCreateSessionEx(instanceHandle, sessionAddr, sessionPort, localNodeId, -1);
+}  // end NormCreateSession()
+
+NORM_API_LINKAGE
+NormSessionHandle NormCreateSessionEx(NormInstanceHandle instanceHandle,
+                                      const char*        sessionAddr,
+                                      UINT16             sessionPort,
+                                      NormNodeId         localNodeId,
+                                      int                threadIndex)
+{
     NormInstance* instance = (NormInstance*)instanceHandle;
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
-        NormSession* session = 
-            instance->session_mgr.NewSession(sessionAddr, sessionPort, localNodeId);
-        instance->dispatcher.ResumeThread();
-        if (NULL != session) 
-            return ((NormSessionHandle)session);
+        // The session is run by (and its handles lead to) the chosen shard
+        NormInstance* shard = instance->GetShard(threadIndex);
+        instance->ResumeThread();
+        if ((NULL != shard) && shard->SuspendThread())
+        {
+            NormSession* session = 
+                shard->session_mgr.NewSession(sessionAddr, sessionPort, localNodeId);
+            shard->ResumeThread();
+            if (NULL != session) 
+                return ((NormSessionHandle)session);
+        }
     }
     return NORM_SESSION_INVALID;
-}  // end NormCreateSession()
+}  // end NormCreateSessionEx()
 
 NORM_API_LINKAGE
 void NormDestroySession(NormSessionHandle sessionHandle)
 {
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if ((NULL != instance) && instance->InCallback())
+    {
+        // (the session may be in the midst of processing on the call stack)
+        PLOG(PL_ERROR, "NormDestroySession() error: not allowed from event callback\n");
+        return;
+    }
+    if (instance && instance->SuspendThread())
     {    
         NormSession* session = (NormSession*)sessionHandle;
         if (NULL != session)
@@ -928,26 +2036,27 @@ void NormDestroySession(NormSessionHandle sessionHandle)
             session->GetSessionMgr().DeleteSession(session);
             instance->PurgeSessionNotifications(sessionHandle);
         }
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
 }  // end NormDestroySession()
 
 NORM_API_LINKAGE 
 NormInstanceHandle NormGetInstance(NormSessionHandle sessionHandle)
 {
-    
-    return (NormInstanceHandle)NormInstance::GetInstanceFromSession(sessionHandle);
+    // (sessions of a multi-threaded instance are run by its shards)
+    NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
+    return (NormInstanceHandle)((NULL != instance) ? instance->GetParent() : NULL);
 }  // end NormGetIntance()
 
 NORM_API_LINKAGE
 void NormSetUserData(NormSessionHandle sessionHandle, const void* userData)
 {
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {    
         NormSession* session = (NormSession*)sessionHandle;
         if (session) session->SetUserData(userData);
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
 }  // end NormSetUserData()
 
@@ -958,12 +2067,12 @@ const void* NormGetUserData(NormSessionHandle sessionHandle)
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
     if (instance)
     {
-        if (instance->dispatcher.SuspendThread())
+        if (instance->SuspendThread())
         {    
             NormSession* session = (NormSession*)sessionHandle;
             if (session) 
                 userData = session->GetUserData();
-            instance->dispatcher.ResumeThread();
+            instance->ResumeThread();
         }
     }
     return userData;
@@ -976,12 +2085,12 @@ void NormSetUserTimer(NormSessionHandle sessionHandle, double seconds)
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
     if (instance)
     {
-        if (instance->dispatcher.SuspendThread())
+        if (instance->SuspendThread())
         {    
             NormSession* session = (NormSession*)sessionHandle;
             if (session) session->SetUserTimer(seconds);
             instance->PurgeNotifications(sessionHandle, NORM_USER_TIMEOUT);
-            instance->dispatcher.ResumeThread();
+            instance->ResumeThread();
         }
     }
 }   // end NormSetUserTimer()
@@ -992,12 +2101,12 @@ void NormCancelUserTimer(NormSessionHandle sessionHandle)
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
     if (NULL != instance)
     {
-        if (instance->dispatcher.SuspendThread())
+        if (instance->SuspendThread())
         {    
             NormSession* session = (NormSession*)sessionHandle;
             if (session) session->SetUserTimer(-1.0);  // interval less than zero cancels timer
             instance->PurgeNotifications(sessionHandle, NORM_USER_TIMEOUT);
-            instance->dispatcher.ResumeThread();
+            instance->ResumeThread();
         }
     }
 }  // end NormCancelUserTimer()
@@ -1023,7 +2132,7 @@ bool NormGetAddress(NormSessionHandle   sessionHandle,
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
     if (NULL != instance)
     {
-        if (instance->dispatcher.SuspendThread())
+        if (instance->SuspendThread())
         {    
             NormSession* session = (NormSession*)sessionHandle;
             const ProtoAddress& sessionAddr = session->Address();
@@ -1039,7 +2148,7 @@ bool NormGetAddress(NormSessionHandle   sessionHandle,
             }      
             if (bufferLen) *bufferLen = addrLen;
             if (port) *port = sessionAddr.GetPort();
-            instance->dispatcher.ResumeThread();  
+            instance->ResumeThread();  
         }
     }
     return result;
@@ -1061,7 +2170,7 @@ bool NormGetRxBindAddress(NormSessionHandle sessionHandle, char* addr, unsigned
 {
     bool result = false;
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if ((NULL != instance) && instance->dispatcher.SuspendThread())
+    if ((NULL != instance) && instance->SuspendThread())
     {    
         NormSession* session = (NormSession*)sessionHandle;
         port = session->GetRxPort();
@@ -1081,7 +2190,7 @@ bool NormGetRxBindAddress(NormSessionHandle sessionHandle, char* addr, unsigned
             memcpy(addr, bindAddr.GetRawHostAddress(), addrLen);
             result = true;
         }    
-        instance->dispatcher.ResumeThread();  
+        instance->ResumeThread();  
     }
     else
     {
@@ -1100,12 +2209,12 @@ bool NormSetTxPort(NormSessionHandle sessionHandle,
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
     if (NULL != instance)
     {
-        if (instance->dispatcher.SuspendThread())
+        if (instance->SuspendThread())
         {    
             NormSession* session = (NormSession*)sessionHandle;
             if (NULL != session) 
                 result = session->SetTxPort(txPort, enableReuse, txAddress);
-            instance->dispatcher.ResumeThread();
+            instance->ResumeThread();
         }
     } 
     return result;
@@ -1127,11 +2236,11 @@ void NormSetTxOnly(NormSessionHandle sessionHandle,
                    bool              connectToSessionAddress)
 {
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormSession* session = (NormSession*)sessionHandle;
         if (session) session->SetTxOnly(txOnly, connectToSessionAddress);
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
 }  // end NormSetTxOnly()
 
@@ -1144,7 +2253,7 @@ bool NormPresetObjectInfo(NormSessionHandle  sessionHandle,
 {
     bool result = false;
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormSession* session = (NormSession*)sessionHandle;
         if (session) 
@@ -1152,7 +2261,7 @@ bool NormPresetObjectInfo(NormSessionHandle  sessionHandle,
             result = session->SetPresetFtiData((unsigned int)objectSize, segmentSize, numData, numParity);
             if (result) session->SenderSetFtiMode(NormSession::FTI_PRESET);
         }
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
     return result;
 } // end NormPresetObjectInfo()
@@ -1161,7 +2270,7 @@ NORM_API_LINKAGE
 void NormLimitObjectInfo(NormSessionHandle sessionHandle, bool state)
 {
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormSession* session = (NormSession*)sessionHandle;
         if (session) 
@@ -1171,7 +2280,7 @@ void NormLimitObjectInfo(NormSessionHandle sessionHandle, bool state)
             else
                 session->SenderSetFtiMode(NormSession::FTI_ALWAYS);
         }
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
 } // end NormLimitObjectInfo()
 
@@ -1181,11 +2290,11 @@ NORM_API_LINKAGE
 void NormSetId(NormSessionHandle sessionHandle, NormNodeId normId)
 {
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormSession* session = (NormSession*)sessionHandle;
         if (NULL != session) session->SetNodeId(normId);
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
 }  // end NormSetId()
 
@@ -1210,7 +2319,7 @@ bool NormChangeDestination(NormSessionHandle sessionHandle,
 	}
     dest.SetPort(sessionPort);
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         if (NULL != session) 
         {
@@ -1218,7 +2327,7 @@ bool NormChangeDestination(NormSessionHandle sessionHandle,
             if (connectToSessionAddress)
                 session->SetTxOnly(session->GetTxOnly(), true);
         }
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
     return true;
 }  // end NormChangeDestination()
@@ -1229,11 +2338,11 @@ void NormSetServerListener(NormSessionHandle sessionHandle, bool state)
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
     if (NULL != instance)
     {
-        if (instance->dispatcher.SuspendThread())
+        if (instance->SuspendThread())
         {    
             NormSession* session = (NormSession*)sessionHandle;
             if (session) session->SetServerListener(state);
-            instance->dispatcher.ResumeThread();
+            instance->ResumeThread();
         }
     } 
 }  // end NormSetServerListener()
@@ -1250,18 +2359,18 @@ bool NormTransferSender(NormSessionHandle sessionHandle, NormNodeHandle senderHa
     NormInstance* dstInstance = NormInstance::GetInstanceFromSession(sessionHandle);
     if (NULL != dstInstance)
     {
-        if (dstInstance->dispatcher.SuspendThread())
+        if (dstInstance->SuspendThread())
         {
             NormInstance* srcInstance = NormInstance::GetInstanceFromNode(senderHandle);
-            if (srcInstance->dispatcher.SuspendThread())
+            if (srcInstance->SuspendThread())
             {
                 NormSession* session = (NormSession*)sessionHandle;
                 NormSenderNode* sender = (NormSenderNode*)senderHandle;
                 if ((NULL != session) && (NULL != sender))
                     result = session->InsertRemoteSender(*sender);
-                srcInstance->dispatcher.ResumeThread();
+                srcInstance->ResumeThread();
             }
-            dstInstance->dispatcher.ResumeThread();
+            dstInstance->ResumeThread();
         }
     }
 	return result;
@@ -1277,11 +2386,11 @@ void NormSetRxPortReuse(NormSessionHandle sessionHandle,
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
     if (NULL != instance)
     {
-        if (instance->dispatcher.SuspendThread())
+        if (instance->SuspendThread())
         {    
             NormSession* session = (NormSession*)sessionHandle;
             if (session) session->SetRxPortReuse(enableReuse, rxAddress, senderAddress, senderPort);
-            instance->dispatcher.ResumeThread();
+            instance->ResumeThread();
         }
     } 
 }  // end NormSetRxPortReuse()
@@ -1293,11 +2402,11 @@ void NormSetEcnSupport(NormSessionHandle sessionHandle, bool ecnEnable, bool ign
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
     if (NULL != instance)
     {
-        if (instance->dispatcher.SuspendThread())
+        if (instance->SuspendThread())
         {    
             NormSession* session = (NormSession*)sessionHandle;
             if (session) session->SetEcnSupport(ecnEnable, ignoreLoss, tolerateLoss);
-            instance->dispatcher.ResumeThread();
+            instance->ResumeThread();
         }
     } 
 }  // end NormSetEcnSupport()
@@ -1310,12 +2419,12 @@ bool NormSetMulticastInterface(NormSessionHandle sessionHandle,
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
     if (NULL != instance)
     {
-        if (instance->dispatcher.SuspendThread())
+        if (instance->SuspendThread())
         {    
             NormSession* session = (NormSession*)sessionHandle;
             if (session)
                 result = session->SetMulticastInterface(interfaceName);
-            instance->dispatcher.ResumeThread();
+            instance->ResumeThread();
         }
     }
     return result;     
@@ -1329,12 +2438,12 @@ bool NormSetSSM(NormSessionHandle sessionHandle,
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
     if (NULL != instance)
     {
-        if (instance->dispatcher.SuspendThread())
+        if (instance->SuspendThread())
         {    
             NormSession* session = (NormSession*)sessionHandle;
             if (session)
                 result = session->SetSSM(sourceAddress);
-            instance->dispatcher.ResumeThread();
+            instance->ResumeThread();
         }
     }
     return result;     
@@ -1348,12 +2457,12 @@ bool NormSetTTL(NormSessionHandle sessionHandle,
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
     if (NULL != instance)
     {
-        if (instance->dispatcher.SuspendThread())
+        if (instance->SuspendThread())
         {    
             NormSession* session = (NormSession*)sessionHandle;
             if (session)
                 result = session->SetTTL(ttl);
-            instance->dispatcher.ResumeThread();
+            instance->ResumeThread();
         }
     }
     return result;     
@@ -1367,12 +2476,12 @@ bool NormSetTOS(NormSessionHandle sessionHandle,
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
     if (instance)
     {
-        if (instance->dispatcher.SuspendThread())
+        if (instance->SuspendThread())
         {    
             NormSession* session = (NormSession*)sessionHandle;
             if (session)
                 result = session->SetTOS(tos);
-            instance->dispatcher.ResumeThread();
+            instance->ResumeThread();
         }
     }
     return result;     
@@ -1411,6 +2520,43 @@ bool NormSetFragmentation(NormSessionHandle sessionHandle, bool state)
         return false;  
 }  // end NormSetFragmentation()
 
+NORM_API_LINKAGE
+void NormSetBufferLocking(NormSessionHandle sessionHandle, bool lockBuffers)
+{
+    NormSession* session = (NormSession*)sessionHandle;
+    if (session) session->SetBufferLocking(lockBuffers);
+}  // end NormSetBufferLocking()
+
+NORM_API_LINKAGE
+void NormSetFileMapping(NormSessionHandle sessionHandle, bool enable)
+{
+    NormSession* session = (NormSession*)sessionHandle;
+    if (session) session->SetFileMapping(enable);
+}  // end NormSetFileMapping()
+
+NORM_API_LINKAGE
+bool NormSetEventCoalescing(NormSessionHandle sessionHandle,
+                            double            maxEventRate,
+                            unsigned int      minBytes,
+                            double            maxLatency)
+{
+    if ((maxEventRate < 0.0) || (maxLatency <= 0.0))
+    {
+        PLOG(PL_ERROR, "NormSetEventCoalescing() error: invalid parameters\n");
+        return false;
+    }
+    bool result = false;
+    NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
+    if (instance && instance->SuspendThread())
+    {
+        NormSession* session = (NormSession*)sessionHandle;
+        session->SetEventCoalescing(maxEventRate, minBytes, maxLatency);
+        instance->ResumeThread();
+        result = true;
+    }
+    return result;
+}  // end NormSetEventCoalescing()
+
 NORM_API_LINKAGE
 void NormSetMessageTrace(NormSessionHandle sessionHandle, bool state)
 {
@@ -1439,9 +2585,9 @@ bool NormOpenDebugLog(NormInstanceHandle instanceHandle, const char *path)
     cause problems with this. */
     bool result = false;
     NormInstance* instance = (NormInstance*)instanceHandle;
-    if (instance->dispatcher.SuspendThread()) {
+    if (instance->SuspendThread()) {
         result = OpenDebugLog(path);
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
     return result;
 }
@@ -1452,9 +2598,9 @@ void NormCloseDebugLog(NormInstanceHandle instanceHandle)
     /* NOTE: This only locks one thread.  Multiple NormInstances could
     cause problems with this. */
     NormInstance* instance = (NormInstance*)instanceHandle;
-    if (instance->dispatcher.SuspendThread()) {
+    if (instance->SuspendThread()) {
         CloseDebugLog();
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
 }
 
@@ -1465,9 +2611,9 @@ bool NormOpenDebugPipe(NormInstanceHandle instanceHandle, const char *pipeName)
     cause problems with this. */
     bool result = false;
     NormInstance* instance = (NormInstance*)instanceHandle;
-    if (instance->dispatcher.SuspendThread()) {
+    if (instance->SuspendThread()) {
         result = OpenDebugPipe(pipeName);
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
     return result;
 }   // end NormOpenDebugPipe()
@@ -1478,9 +2624,9 @@ void NormCloseDebugPipe(NormInstanceHandle instanceHandle)
     /* NOTE: This only locks one thread.  Multiple NormInstances could
     cause problems with this. */
     NormInstance* instance = (NormInstance*)instanceHandle;
-    if (instance->dispatcher.SuspendThread()) {
+    if (instance->SuspendThread()) {
         CloseDebugPipe();
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
 }  // end NormCloseDebugPipe()
 
@@ -1501,12 +2647,12 @@ NORM_API_LINKAGE
 void NormSetReportInterval(NormSessionHandle sessionHandle, double interval)
 {
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormSession* session = (NormSession*)sessionHandle;
         if (session)
             session->SetReportTimerInterval(interval);
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
 }  // end NormSetReportInterval()
 
@@ -1515,12 +2661,12 @@ double NormGetReportInterval(NormSessionHandle sessionHandle)
 {
     double result = 0;
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormSession* session = (NormSession*)sessionHandle;
         if (session)
             result = session->GetReportTimerInterval();
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
     return result;
 }  // end NormGetReportInterval()
@@ -1547,14 +2693,14 @@ bool NormStartSender(NormSessionHandle  sessionHandle,
 {
     bool result = false;
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormSession* session = (NormSession*)sessionHandle;
         if (session)
             result = session->StartSender(sessionId, bufferSpace, segmentSize, numData, numParity, fecId);
         else
             result = false;
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
     return result;
 }  // end NormStartSender()
@@ -1563,11 +2709,14 @@ NORM_API_LINKAGE
 void NormStopSender(NormSessionHandle sessionHandle)
 {
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormSession* session = (NormSession*)sessionHandle;
-        if (session) session->StopSender();
-        instance->dispatcher.ResumeThread();
+        if (instance->InCallback())
+            instance->DeferCall(NormInstance::DEFER_STOP_SENDER, session);
+        else
+            session->StopSender();
+        instance->ResumeThread();
     }
 }  // end NormStopSender()
 
@@ -1586,11 +2735,11 @@ void NormSetTxRate(NormSessionHandle sessionHandle,
                          double            bitsPerSecond)
 {
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormSession* session = (NormSession*)sessionHandle;
         if (session) session->SetTxRate(bitsPerSecond);
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
 }  // end NormSetTxRate()
 
@@ -1600,12 +2749,12 @@ bool NormSetTxSocketBuffer(NormSessionHandle sessionHandle,
 {
     bool result = false;
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormSession* session = (NormSession*)sessionHandle;
         if (session) 
             result = session->SetTxSocketBuffer(bufferSize);
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
     return result;
 }  // end NormSetTxSocketBuffer()
@@ -1614,11 +2763,11 @@ NORM_API_LINKAGE
 void NormSetFlowControl(NormSessionHandle sessionHandle, double flowControlFactor)
 {
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormSession* session = (NormSession*)sessionHandle;
         if (session) session->SetFlowControl(flowControlFactor);
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
 }  // end NormSetFlowControl()
 
@@ -1626,11 +2775,11 @@ NORM_API_LINKAGE
 void NormSetCongestionControl(NormSessionHandle sessionHandle, bool enable, bool adjustRate)
 {
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormSession* session = (NormSession*)sessionHandle;
         if (session) session->SetCongestionControl(enable, adjustRate);
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
 }  // end NormSetCongestionControl()
 
@@ -1640,11 +2789,11 @@ void NormSetTxRateBounds(NormSessionHandle sessionHandle,
                          double            rateMax)
 {
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormSession* session = (NormSession*)sessionHandle;
         if (session) session->SetTxRateBounds(rateMin, rateMax);
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
 }  // end NormSetTxRateBounds()
 
@@ -1655,24 +2804,50 @@ void NormSetTxCacheBounds(NormSessionHandle sessionHandle,
                           UINT32            countMax)
 {
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormSession* session = (NormSession*)sessionHandle;
         NormObjectSize theSize(sizeMax);
         if (session) session->SetTxCacheBounds(theSize, countMin, countMax);
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
 }  // end NormSetTxCacheBounds()
 
+NORM_API_LINKAGE
+void NormSetTxFileReadAhead(NormSessionHandle sessionHandle,
+                            unsigned int      blockCount)
+{
+    NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
+    if (instance && instance->SuspendThread())
+    {
+        NormSession* session = (NormSession*)sessionHandle;
+        if (session) session->SetTxFileReadAhead(blockCount);
+        instance->ResumeThread();
+    }
+}  // end NormSetTxFileReadAhead()
+
+NORM_API_LINKAGE
+void NormSetTxCompression(NormSessionHandle sessionHandle,
+                          bool              enable)
+{
+    NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
+    if (instance && instance->SuspendThread())
+    {
+        NormSession* session = (NormSession*)sessionHandle;
+        if (session) session->SetTxCompression(enable);
+        instance->ResumeThread();
+    }
+}  // end NormSetTxCompression()
+
 NORM_API_LINKAGE
 void NormSetAutoParity(NormSessionHandle sessionHandle, unsigned char autoParity)
 {
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormSession* session = (NormSession*)sessionHandle;
         if (session) session->SenderSetAutoParity(autoParity);
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
 }  // end NormSetAutoParity()
 
@@ -1681,11 +2856,11 @@ void NormSetGrttEstimate(NormSessionHandle sessionHandle,
                          double            grttEstimate)
 {
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormSession* session = (NormSession*)sessionHandle;
         if (session) session->SenderSetGrtt(grttEstimate);
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
 }  // end NormSetGrttEstimate()
 
@@ -1696,7 +2871,7 @@ double NormGetGrttEstimate(NormSessionHandle sessionHandle)
     {
         NormSession* session = (NormSession*)sessionHandle;
         session->ResetGrttNotification();
-        return (session->SenderGrtt());
+        return (session->GetGrttStatus());
     }
     else
     {
@@ -1709,11 +2884,11 @@ void NormSetGrttMax(NormSessionHandle sessionHandle,
                     double            grttMax)
 {
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormSession* session = (NormSession*)sessionHandle;
         if (session) session->SetGrttMax(grttMax);
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
 }  // end NormSetGrttMax()
 
@@ -1722,11 +2897,11 @@ void NormSetGrttProbingMode(NormSessionHandle sessionHandle,
                             NormProbingMode   probingMode)
 {
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormSession* session = (NormSession*)sessionHandle;
         session->SetGrttProbingMode((NormSession::ProbingMode)probingMode);
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
 }  // end NormSetGrttProbingMode()
 
@@ -1736,11 +2911,11 @@ void NormSetGrttProbingInterval(NormSessionHandle sessionHandle,
                                 double            intervalMax)
 {
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormSession* session = (NormSession*)sessionHandle;
         if (session) session->SetGrttProbingInterval(intervalMin, intervalMax);
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
 }  // end NormSetGrttProbingInterval()
 
@@ -1749,11 +2924,11 @@ void NormSetGrttProbingTOS(NormSessionHandle sessionHandle,
                            UINT8              probeTOS)
 {
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormSession* session = (NormSession*)sessionHandle;
         session->SetProbeTOS(probeTOS);
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
 }  // end NormSetGrttProbingTOS()
 
@@ -1762,12 +2937,12 @@ void NormSetBackoffFactor(NormSessionHandle sessionHandle,
                           double            backoffFactor)
 {
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormSession* session = (NormSession*)sessionHandle;
         if (backoffFactor >= 0.0)
             session->SetBackoffFactor(backoffFactor);
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
 }  // end NormSetBackoffFactor()
 
@@ -1776,11 +2951,11 @@ void NormSetGroupSize(NormSessionHandle sessionHandle,
                       unsigned int      groupSize)
 {
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormSession* session = (NormSession*)sessionHandle;
         session->SenderSetGroupSize((double)groupSize);
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
 }  // end NormSetGroupSize()
 
@@ -1789,11 +2964,11 @@ void NormSetTxRobustFactor(NormSessionHandle sessionHandle,
                            int               robustFactor)
 {
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormSession* session = (NormSession*)sessionHandle;
         session->SetTxRobustFactor(robustFactor);
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
 }  // end NormSetTxRobustFactor()
 
@@ -1805,7 +2980,7 @@ NormObjectHandle NormFileEnqueue(NormSessionHandle  sessionHandle,
 {
     NormObjectHandle objectHandle = NORM_OBJECT_INVALID;
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormSession* session = (NormSession*)sessionHandle;
         if (session)
@@ -1814,7 +2989,7 @@ NormObjectHandle NormFileEnqueue(NormSessionHandle  sessionHandle,
                 static_cast<NormObject*>(session->QueueTxFile(fileName, infoPtr, infoLen));
             if (obj) objectHandle = (NormObjectHandle)(obj);
         }
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
     return objectHandle;
 }  // end NormFileEnqueue()
@@ -1828,7 +3003,7 @@ NormObjectHandle NormDataEnqueue(NormSessionHandle  sessionHandle,
 {
     NormObjectHandle objectHandle = NORM_OBJECT_INVALID;
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormSession* session = (NormSession*)sessionHandle;
         if (session)
@@ -1837,18 +3012,45 @@ NormObjectHandle NormDataEnqueue(NormSessionHandle  sessionHandle,
                 static_cast<NormObject*>(session->QueueTxData(dataPtr, dataLen, infoPtr, infoLen));
             if (NULL != obj) objectHandle = (NormObjectHandle)obj;
         }
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
     return objectHandle;
 }  // end NormDataEnqueue()
 
+NORM_API_LINKAGE
+NormObjectHandle NormDataEnqueueV(NormSessionHandle         sessionHandle,
+                                  const struct iovec*       iov,
+                                  unsigned int              iovCount,
+                                  NormExtentReleaseFunction releaseFunc,
+                                  const void*               releaseData,
+                                  const char*               infoPtr, 
+                                  unsigned int              infoLen)
+{
+    NormObjectHandle objectHandle = NORM_OBJECT_INVALID;
+    if ((NULL == iov) && (0 != iovCount)) return objectHandle;
+    NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
+    if (instance && instance->SuspendThread())
+    {
+        NormSession* session = (NormSession*)sessionHandle;
+        if (session)
+        {
+            NormObject* obj = 
+                static_cast<NormObject*>(session->QueueTxDataV(iov, iovCount, releaseFunc, releaseData, 
+                                                               infoPtr, infoLen));
+            if (NULL != obj) objectHandle = (NormObjectHandle)obj;
+        }
+        instance->ResumeThread();
+    }
+    return objectHandle;
+}  // end NormDataEnqueueV()
+
 
 NORM_API_LINKAGE 
 bool NormRequeueObject(NormSessionHandle sessionHandle, NormObjectHandle objectHandle)
 {
     bool result = false;
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormSession* session = (NormSession*)sessionHandle;
         if (session)
@@ -1856,7 +3058,7 @@ bool NormRequeueObject(NormSessionHandle sessionHandle, NormObjectHandle objectH
             if (NORM_OBJECT_INVALID != objectHandle)
                 result = session->RequeueTxObject((NormObject*)objectHandle);
         }
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
     return result;
 }  // end NormRequeueObject()
@@ -1869,7 +3071,7 @@ NormObjectHandle NormStreamOpen(NormSessionHandle  sessionHandle,
 {
     NormObjectHandle objectHandle = NORM_OBJECT_INVALID;
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormSession* session = (NormSession*)sessionHandle;
         if (session)
@@ -1879,7 +3081,7 @@ NormObjectHandle NormStreamOpen(NormSessionHandle  sessionHandle,
                 static_cast<NormObject*>(streamObj);
             if (obj) objectHandle = (NormObjectHandle)obj;
         }
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
     return objectHandle;
 }  // end NormStreamOpen()
@@ -1894,10 +3096,11 @@ void NormStreamClose(NormObjectHandle streamHandle, bool graceful)
         if (graceful && (NULL == stream->GetSender()))
         {
             NormInstance* instance = NormInstance::GetInstanceFromObject(streamHandle);
-            if (instance && instance->dispatcher.SuspendThread())
+            if (instance && instance->SuspendThread())
             {
+                // (deferred until any "write ring" content is drained)
                 stream->Close(true);  // graceful stream closure
-                instance->dispatcher.ResumeThread();
+                instance->ResumeThread();
             }  
         }
         else
@@ -1918,42 +3121,179 @@ unsigned int NormGetStreamBufferSegmentCount(unsigned int bufferBytes, UINT16 se
     return (numBlocks * blockSize);
 }  // end NormGetStreamBufferSegmentCount()
 
+// This moves stream "write ring" content into the stream buffer when the
+// protocol thread is not already doing so (see NormStreamObject::ReadSegment())
+static void NormStreamServiceRing(NormInstance* instance, NormStreamObject* stream)
+{
+    if (instance->SuspendThread())
+    {
+        if (stream->DrainWriteRing())
+            stream->GetSession().Notify(NormController::TX_QUEUE_VACANCY, NULL, stream);
+        instance->ResumeThread();
+    }
+}  // end NormStreamServiceRing()
+
+NORM_API_LINKAGE
+bool NormStreamSetWriteRing(NormObjectHandle streamHandle, unsigned int ringSize)
+{
+    bool result = false;
+    NormInstance* instance = NormInstance::GetInstanceFromObject(streamHandle);
+    if (instance && instance->SuspendThread())
+    {
+        NormStreamObject* stream = 
+            static_cast<NormStreamObject*>((NormObject*)streamHandle);
+        // (the ring can't be replaced or removed while it still has content)
+        if (stream->HasWriteRing()) stream->DrainWriteRing();
+        if (stream->HasWriteRing() && !stream->RingIsEmpty())
+        {
+            PLOG(PL_ERROR, "NormStreamSetWriteRing() error: write ring not yet drained\n");
+        }
+        else if (0 != ringSize)
+        {
+            result = stream->OpenWriteRing(ringSize);
+        }
+        else
+        {
+            stream->CloseWriteRing();
+            result = true;
+        }
+        instance->ResumeThread();
+    }
+    return result;
+}  // end NormStreamSetWriteRing()
+
 NORM_API_LINKAGE
 unsigned int NormStreamWrite(NormObjectHandle   streamHandle,
                              const char*        buffer,
                              unsigned int       numBytes)
 {
+    // Streams with a "write ring" are written without the dispatcher
+    // lock unless the protocol thread needs to be prompted
+    NormStreamObject* stream = 
+        static_cast<NormStreamObject*>((NormObject*)streamHandle);
+    if ((NULL != stream) && stream->HasWriteRing())
+    {
+        unsigned int result = stream->RingWrite(buffer, numBytes, false);
+        if (stream->RingNeedsService())
+            NormStreamServiceRing(NormInstance::GetInstanceFromObject(streamHandle), stream);
+        return result;
+    }
     // Note: Since an underlying issue with ProtoDispatcher::SignalThread() had been resolved,
     //       using  ProtoDispatcher::SuspendThread() should be sufficient since the underlying
     //       protolib time scheduling, etc. code actually invokes SignalThread() on an
     //       as-needed basis.  Thus, using SuspendThread() (lighter weight) should suffice
     unsigned int result = 0;
     NormInstance* instance = NormInstance::GetInstanceFromObject(streamHandle);
-    if ((NULL != instance) && instance->dispatcher.SuspendThread())
+    if ((NULL != instance) && instance->SuspendThread())
     {
-        NormStreamObject* stream = 
-            static_cast<NormStreamObject*>((NormObject*)streamHandle);
         result = stream->Write(buffer, numBytes, false);
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
     return result;
 }  // end NormStreamWrite()
 
+NORM_API_LINKAGE
+unsigned int NormStreamWritev(NormObjectHandle      streamHandle,
+                              const struct iovec*   iov,
+                              unsigned int          iovCount,
+                              int                   flags)
+{
+    unsigned int result = 0;
+    NormInstance* instance = NormInstance::GetInstanceFromObject(streamHandle);
+    if ((NULL != instance) && instance->SuspendThread())
+    {
+        NormStreamObject* stream = 
+            static_cast<NormStreamObject*>((NormObject*)streamHandle);
+        // (any "write ring" content is written first to keep stream order)
+        if (stream->HasWriteRing()) stream->DrainWriteRing();
+        if (!stream->HasWriteRing() || stream->RingIsEmpty())
+            result = stream->Writev(iov, iovCount, 
+                                    0 != (flags & NORM_WRITEV_EOM_EACH),
+                                    0 != (flags & NORM_WRITEV_EOM));
+        instance->ResumeThread();
+    }
+    return result;
+}  // end NormStreamWritev()
+
+NORM_API_LINKAGE
+bool NormStreamGetWriteBuffer(NormObjectHandle streamHandle,
+                              char**           bufferPtr,
+                              unsigned int*    numBytes)
+{
+    bool result = false;
+    *bufferPtr = NULL;
+    *numBytes = 0;
+    NormInstance* instance = NormInstance::GetInstanceFromObject(streamHandle);
+    if ((NULL != instance) && instance->SuspendThread())
+    {
+        NormStreamObject* stream = 
+            static_cast<NormStreamObject*>((NormObject*)streamHandle);
+        // (any "write ring" content is written first to keep stream order)
+        if (stream->HasWriteRing()) stream->DrainWriteRing();
+        UINT32 len = 0;
+        char* ptr = NULL;
+        if (!stream->HasWriteRing() || stream->RingIsEmpty())
+            ptr = stream->GetWriteBuffer(len);
+        if (NULL != ptr)
+        {
+            *bufferPtr = ptr;
+            *numBytes = len;
+            result = true;
+        }
+        instance->ResumeThread();
+    }
+    return result;
+}  // end NormStreamGetWriteBuffer()
+
+NORM_API_LINKAGE
+unsigned int NormStreamCommitWrite(NormObjectHandle streamHandle,
+                                   unsigned int     numBytes,
+                                   bool             eom)
+{
+    unsigned int result = 0;
+    NormInstance* instance = NormInstance::GetInstanceFromObject(streamHandle);
+    if ((NULL != instance) && instance->SuspendThread())
+    {
+        NormStreamObject* stream = 
+            static_cast<NormStreamObject*>((NormObject*)streamHandle);
+        result = stream->CommitWrite(numBytes, eom);
+        instance->ResumeThread();
+    }
+    return result;
+}  // end NormStreamCommitWrite()
+
 NORM_API_LINKAGE
 void NormStreamFlush(NormObjectHandle streamHandle, 
                      bool             eom,
                      NormFlushMode    flushMode)
 {
+    NormStreamObject* stream = 
+        static_cast<NormStreamObject*>((NormObject*)streamHandle);
+    if ((NULL != stream) && stream->HasWriteRing() &&
+        stream->RingFlush(eom, (NormStreamObject::FlushMode)flushMode))
+    {
+        if (stream->RingNeedsService())
+            NormStreamServiceRing(NormInstance::GetInstanceFromObject(streamHandle), stream);
+        return;
+    }
     NormInstance* instance = NormInstance::GetInstanceFromObject(streamHandle);
-    if ((NULL != instance) && instance->dispatcher.SuspendThread())
+    if ((NULL != instance) && instance->SuspendThread())
     {
-        NormStreamObject* stream = 
-            static_cast<NormStreamObject*>((NormObject*)streamHandle);
-        NormStreamObject::FlushMode saveFlushMode = stream->GetFlushMode();
-        stream->SetFlushMode((NormStreamObject::FlushMode)flushMode);
-        stream->Flush(eom);
-        stream->SetFlushMode(saveFlushMode);
-        instance->dispatcher.ResumeThread();
+        // (if the "write ring" is full, it is drained before flushing, but
+        //  the flush can't be applied ahead of content still in the ring)
+        if (stream->HasWriteRing()) stream->DrainWriteRing();
+        if (stream->HasWriteRing() && !stream->RingIsEmpty())
+        {
+            PLOG(PL_ERROR, "NormStreamFlush() error: write ring full\n");
+        }
+        else
+        {
+            NormStreamObject::FlushMode saveFlushMode = stream->GetFlushMode();
+            stream->SetFlushMode((NormStreamObject::FlushMode)flushMode);
+            stream->Flush(eom);
+            stream->SetFlushMode(saveFlushMode);
+        }
+        instance->ResumeThread();
     }
 }  // end NormStreamFlush()
 
@@ -1978,15 +3318,23 @@ void NormStreamSetPushEnable(NormObjectHandle streamHandle, bool state)
 NORM_API_LINKAGE
 bool NormStreamHasVacancy(NormObjectHandle streamHandle)
 {
+    NormStreamObject* stream = 
+        static_cast<NormStreamObject*>((NormObject*)streamHandle);
+    if ((NULL != stream) && stream->HasWriteRing())
+    {
+        if (!stream->RingIsEmpty() && stream->RingNeedsService())
+            NormStreamServiceRing(NormInstance::GetInstanceFromObject(streamHandle), stream);
+        return (0 != stream->RingGetVacancy());
+    }
     bool result = false;
     NormInstance* instance = NormInstance::GetInstanceFromObject(streamHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormStreamObject* stream = 
             static_cast<NormStreamObject*>((NormObject*)streamHandle);
         if (NULL != stream)
             result = stream->HasVacancy();
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
     return result;
 }  // end NormStreamHasVacancy()
@@ -1994,15 +3342,23 @@ bool NormStreamHasVacancy(NormObjectHandle streamHandle)
 NORM_API_LINKAGE
 unsigned int NormStreamGetVacancy(NormObjectHandle streamHandle, unsigned int bytesWanted)
 {
-    bool result = false;
+    NormStreamObject* stream = 
+        static_cast<NormStreamObject*>((NormObject*)streamHandle);
+    if ((NULL != stream) && stream->HasWriteRing())
+    {
+        if (!stream->RingIsEmpty() && stream->RingNeedsService())
+            NormStreamServiceRing(NormInstance::GetInstanceFromObject(streamHandle), stream);
+        return stream->RingGetVacancy(bytesWanted);
+    }
+    unsigned int result = 0;
     NormInstance* instance = NormInstance::GetInstanceFromObject(streamHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormStreamObject* stream = 
             static_cast<NormStreamObject*>((NormObject*)streamHandle);
         if (NULL != stream)
             result = stream->GetVacancy(bytesWanted);
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
     return result;
 }  // end NormStreamGetVacancy()
@@ -2010,13 +3366,27 @@ unsigned int NormStreamGetVacancy(NormObjectHandle streamHandle, unsigned int by
 NORM_API_LINKAGE
 void NormStreamMarkEom(NormObjectHandle streamHandle)
 {
+    NormStreamObject* stream = 
+        static_cast<NormStreamObject*>((NormObject*)streamHandle);
+    if ((NULL != stream) && stream->HasWriteRing() && stream->RingMarkEom())
+    {
+        if (stream->RingNeedsService())
+            NormStreamServiceRing(NormInstance::GetInstanceFromObject(streamHandle), stream);
+        return;
+    }
     NormInstance* instance = NormInstance::GetInstanceFromObject(streamHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
-        NormStreamObject* stream = 
-            static_cast<NormStreamObject*>((NormObject*)streamHandle);
-        if (stream) stream->Write(NULL, 0, true);
-        instance->dispatcher.ResumeThread();
+        if (NULL != stream)
+        {
+            // (the EOM can't be marked ahead of content still in the ring)
+            if (stream->HasWriteRing()) stream->DrainWriteRing();
+            if (stream->HasWriteRing() && !stream->RingIsEmpty())
+                PLOG(PL_ERROR, "NormStreamMarkEom() error: write ring full\n");
+            else
+                stream->Write(NULL, 0, true);
+        }
+        instance->ResumeThread();
     }
 }  // end NormStreamMarkEom()
 
@@ -2027,7 +3397,7 @@ bool NormSetWatermark(NormSessionHandle  sessionHandle,
 {
     bool result = false;
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormSession* session = (NormSession*)sessionHandle;
         NormObject* obj = (NormObject*)objectHandle;
@@ -2055,7 +3425,7 @@ bool NormSetWatermark(NormSessionHandle  sessionHandle,
             }
             result = true;
         }        
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
     return result;
 }  // end NormSetWatermark()
@@ -2069,7 +3439,7 @@ bool NormSetWatermarkEx(NormSessionHandle  sessionHandle,
 {
     bool result = false;
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormSession* session = (NormSession*)sessionHandle;
         NormObject* obj = (NormObject*)objectHandle;
@@ -2098,7 +3468,7 @@ bool NormSetWatermarkEx(NormSessionHandle  sessionHandle,
                                                      buffer, numBytes);   
             }
         }        
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
     return result;
 }  // end NormSetWatermarkEx()
@@ -2107,13 +3477,13 @@ NORM_API_LINKAGE
 bool NormResetWatermark(NormSessionHandle  sessionHandle)
 {
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         // Purge any existing NORM_TX_WATERMARK_COMPLETED notifications to be safe
         instance->PurgeNotifications(sessionHandle, NORM_TX_WATERMARK_COMPLETED);
         NormSession* session = (NormSession*)sessionHandle;
         session->SenderResetWatermark();
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
         return true;
     }
     else
@@ -2126,11 +3496,11 @@ NORM_API_LINKAGE
 void NormCancelWatermark(NormSessionHandle sessionHandle)
 {
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormSession* session = (NormSession*)sessionHandle;
         session->SenderCancelWatermark();
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
 }  // end NormSetWatermark()
 
@@ -2140,12 +3510,12 @@ bool NormAddAckingNode(NormSessionHandle  sessionHandle,
 {
     bool result = false;
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormSession* session = (NormSession*)sessionHandle;
         if (session)
             result = (NULL != session->SenderAddAckingNode(nodeId));
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
     return result;
 }  // end NormAddAckingNode()
@@ -2155,11 +3525,11 @@ void NormRemoveAckingNode(NormSessionHandle  sessionHandle,
                           NormNodeId         nodeId)
 {
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormSession* session = (NormSession*)sessionHandle;
         if (session) session->SenderRemoveAckingNode(nodeId);
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
 }  // end NormRemoveAckingNode()
 
@@ -2170,11 +3540,11 @@ NormNodeHandle NormGetAckingNodeHandle(NormSessionHandle  sessionHandle,
 	if (NORM_SESSION_INVALID != sessionHandle)
     {
         NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-        if (instance && instance->dispatcher.SuspendThread())
+        if (instance && instance->SuspendThread())
         {
             NormSession* session = (NormSession*)sessionHandle;
             NormAckingNode* acker = session->SenderFindAckingNode(nodeId);
-			instance->dispatcher.ResumeThread();
+			instance->ResumeThread();
             if (NULL != acker)
                 return ((NormNodeHandle)static_cast<NormNode*>(acker));
         }
@@ -2211,12 +3581,12 @@ NormAckingStatus NormGetAckingStatus(NormSessionHandle  sessionHandle,
                                      NormNodeId         nodeId)
 {
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormSession* session = (NormSession*)sessionHandle;
         NormAckingStatus status = 
             (NormAckingStatus)session->SenderGetAckingStatus(nodeId);
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
         return status;
     }
     else
@@ -2232,11 +3602,11 @@ bool NormGetNextAckingNode(NormSessionHandle    sessionHandle,
 {
     if (NULL == nodeId) return false;
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormSession* session = (NormSession*)sessionHandle;
         bool result = session->SenderGetNextAckingNode(*nodeId, (NormSession::AckingStatus*)ackingStatus);
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
         return result;
     }
     else
@@ -2252,11 +3622,11 @@ bool NormGetAckEx(NormSessionHandle sessionHandle,
                   unsigned int*     buflen)
 {
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormSession* session = (NormSession*)sessionHandle;
         bool result = (NormAckingStatus)session->SenderGetAckEx(nodeId, buffer, buflen);
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
         return result;
     }
     if (NULL != buflen) *buflen = 0;
@@ -2271,11 +3641,11 @@ bool NormSendCommand(NormSessionHandle  sessionHandle,
                      bool               robust)
 {
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormSession* session = (NormSession*)sessionHandle;
         bool result = session->SenderSendCmd(cmdBuffer, cmdLength, robust);
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
         return result;
     }
     else
@@ -2288,13 +3658,13 @@ NORM_API_LINKAGE
 void NormCancelCommand(NormSessionHandle sessionHandle)
 {
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormSession* session = (NormSession*)sessionHandle;
         session->SenderCancelCmd();
         // we purge in case command was already sent notification posted
         instance->PurgeNotifications(sessionHandle, NORM_TX_CMD_SENT);
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
 }  // end NormCancelCommand()
 
@@ -2308,7 +3678,7 @@ bool NormSendCommandTo(NormSessionHandle  sessionHandle,
 {
     bool result = false;
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormSession* session = (NormSession*)sessionHandle;
         ProtoAddress dest;
@@ -2317,7 +3687,7 @@ bool NormSendCommandTo(NormSessionHandle  sessionHandle,
             dest.SetPort(port);
             result = session->SenderSendAppCmd(cmdBuffer, cmdLength, dest);
         }
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
     return result;
 }  // end NormSendCommandTo()
@@ -2327,11 +3697,11 @@ NORM_API_LINKAGE
 void NormSetSynStatus(NormSessionHandle sessionHandle, bool state)
 {
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormSession* session = (NormSession*)sessionHandle;
         session->SenderSetSynStatus(state);
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
 }  // end NormSetSynStatus()
 
@@ -2344,11 +3714,11 @@ bool NormStartReceiver(NormSessionHandle  sessionHandle,
 {
     bool result = false;
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormSession* session = (NormSession*)sessionHandle;
         result = session->StartReceiver(bufferSpace);
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
     return result;
 }  // end NormStartReceiver()
@@ -2357,11 +3727,14 @@ NORM_API_LINKAGE
 void NormStopReceiver(NormSessionHandle sessionHandle)
 {
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormSession* session = (NormSession*)sessionHandle;
-        session->StopReceiver();
-        instance->dispatcher.ResumeThread();
+        if (instance->InCallback())
+            instance->DeferCall(NormInstance::DEFER_STOP_RECEIVER, session);
+        else
+            session->StopReceiver();
+        instance->ResumeThread();
     }
 }  // end NormStopReceiver()
 
@@ -2371,26 +3744,52 @@ void NormSetRxCacheLimit(NormSessionHandle sessionHandle,
                          unsigned short    countMax)
 {
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormSession* session = (NormSession*)sessionHandle;
         if (session) session->SetRxCacheMax(countMax);
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
 }  // end NormSetRxCacheLimit()
 
+NORM_API_LINKAGE 
+void NormSetRxFileWriteBehind(NormSessionHandle sessionHandle,
+                              unsigned int      blockCount)
+{
+    NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
+    if (instance && instance->SuspendThread())
+    {
+        NormSession* session = (NormSession*)sessionHandle;
+        if (session) session->SetRxFileWriteBehind(blockCount);
+        instance->ResumeThread();
+    }
+}  // end NormSetRxFileWriteBehind()
+
+NORM_API_LINKAGE 
+void NormSetRxFileResume(NormSessionHandle sessionHandle,
+                         bool              enable)
+{
+    NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
+    if (instance && instance->SuspendThread())
+    {
+        NormSession* session = (NormSession*)sessionHandle;
+        if (session) session->SetRxFileResume(enable);
+        instance->ResumeThread();
+    }
+}  // end NormSetRxFileResume()
+
 NORM_API_LINKAGE
 bool NormSetRxSocketBuffer(NormSessionHandle sessionHandle, 
                            unsigned int      bufferSize)
 {
     bool result = false;
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormSession* session = (NormSession*)sessionHandle;
         if (session) 
             result = session->SetRxSocketBuffer(bufferSize);
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
     return result;
 }  // end NormSetRxSocketBuffer()
@@ -2492,11 +3891,11 @@ void NormSetDefaultRxRobustFactor(NormSessionHandle sessionHandle,
                                   int               robustFactor)
 {
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormSession* session = (NormSession*)sessionHandle;
         session->SetRxRobustFactor(robustFactor);
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
 }  // end NormSetDefaultRxRobustFactor()
 
@@ -2507,7 +3906,7 @@ void NormNodeSetRxRobustFactor(NormNodeHandle   nodeHandle,
     if (NORM_NODE_INVALID != nodeHandle)
     {
         NormInstance* instance = NormInstance::GetInstanceFromNode(nodeHandle);
-        if (instance && instance->dispatcher.SuspendThread())
+        if (instance && instance->SuspendThread())
         {
             NormNode* node = (NormNode*)nodeHandle;
             if (NormNode::SENDER == node->GetType())
@@ -2515,7 +3914,7 @@ void NormNodeSetRxRobustFactor(NormNodeHandle   nodeHandle,
                 NormSenderNode* sender = static_cast<NormSenderNode*>(node);        
                 sender->SetRobustFactor(robustFactor);
             }
-            instance->dispatcher.ResumeThread();
+            instance->ResumeThread();
         }
     }
 }  // end NormNodeSetRxRobustFactor()
@@ -2530,11 +3929,11 @@ bool NormPreallocateRemoteSender(NormSessionHandle  sessionHandle,
 {
     bool result = false;
     NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormSession* session = (NormSession*)sessionHandle;
         result = session->PreallocateRemoteSender((unsigned int)bufferSize, segmentSize, numData, numParity, streamBufferSize);
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
     return result;
 }  // end NormPreallocateRemoteSender()
@@ -2546,28 +3945,61 @@ bool NormStreamRead(NormObjectHandle   streamHandle,
 {
     bool result = false;
     NormInstance* instance = NormInstance::GetInstanceFromObject(streamHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormStreamObject* stream = 
             static_cast<NormStreamObject*>((NormObject*)streamHandle);
         result = stream->Read(buffer, numBytes);
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
     return result;
 }  // end NormStreamRead()
 
+NORM_API_LINKAGE
+int NormStreamPeekSegments(NormObjectHandle streamHandle,
+                           struct iovec*    iov,
+                           unsigned int     iovMax)
+{
+    int result = 0;
+    NormInstance* instance = NormInstance::GetInstanceFromObject(streamHandle);
+    if (instance && instance->SuspendThread())
+    {
+        NormStreamObject* stream = 
+            static_cast<NormStreamObject*>((NormObject*)streamHandle);
+        result = stream->PeekSegments(iov, iovMax);
+        instance->ResumeThread();
+    }
+    return result;
+}  // end NormStreamPeekSegments()
+
+NORM_API_LINKAGE
+bool NormStreamConsume(NormObjectHandle streamHandle,
+                       unsigned int     numBytes)
+{
+    bool result = false;
+    NormInstance* instance = NormInstance::GetInstanceFromObject(streamHandle);
+    if (instance && instance->SuspendThread())
+    {
+        NormStreamObject* stream = 
+            static_cast<NormStreamObject*>((NormObject*)streamHandle);
+        result = stream->Consume(numBytes);
+        instance->ResumeThread();
+    }
+    return result;
+}  // end NormStreamConsume()
+
 NORM_API_LINKAGE
 bool NormStreamSeekMsgStart(NormObjectHandle streamHandle)
 {
     bool result = false;
     NormInstance* instance = NormInstance::GetInstanceFromObject(streamHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormStreamObject* stream = 
             static_cast<NormStreamObject*>((NormObject*)streamHandle);
         unsigned int numBytes = 0;
         result = stream->Read(NULL, &numBytes, true);
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
     return result;
 }  // end NormStreamSeekMsgStart()
@@ -2586,16 +4018,11 @@ UINT32 NormStreamGetReadOffset(NormObjectHandle streamHandle)
 NORM_API_LINKAGE 
 unsigned int NormStreamGetBufferUsage(NormObjectHandle streamHandle)
 {
-    unsigned int usage = 0;
-    NormInstance* instance = NormInstance::GetInstanceFromObject(streamHandle);
-    if (instance && instance->dispatcher.SuspendThread())
-    {
-        NormStreamObject* stream = 
-            static_cast<NormStreamObject*>((NormObject*)streamHandle);
-        usage = stream->GetCurrentBufferUsage() ;
-        instance->dispatcher.ResumeThread();
-    }
-    return usage;
+    // Lock-free read of status published by the NORM thread
+    if (NORM_OBJECT_INVALID != streamHandle)
+        return ((NormObject*)streamHandle)->GetStatus().buffer_usage;
+    else
+        return 0;
 }  // end NormStreamGetBufferUsage()
 
 
@@ -2652,17 +4079,11 @@ NormSize NormObjectGetSize(NormObjectHandle objectHandle)
 NORM_API_LINKAGE
 NormSize NormObjectGetBytesPending(NormObjectHandle objectHandle)
 {
-    NormSize bytesPending = 0;
+    // Lock-free read of status published by the NORM thread
     if (NORM_OBJECT_INVALID != objectHandle)
-    {
-        NormInstance* instance = NormInstance::GetInstanceFromObject(objectHandle);
-        if (instance && instance->dispatcher.SuspendThread())
-        {
-            bytesPending = ((NormSize)((NormObject*)objectHandle)->GetBytesPending().GetOffset());
-            instance->dispatcher.ResumeThread();
-        }
-    }
-    return bytesPending;
+        return ((NormSize)((NormObject*)objectHandle)->GetStatus().bytes_pending.GetOffset());
+    else
+        return 0;
 }  // end NormObjectGetBytesPending()
 
 NORM_API_LINKAGE
@@ -2671,16 +4092,15 @@ void NormObjectCancel(NormObjectHandle objectHandle)
     if (NORM_OBJECT_INVALID != objectHandle)
     {
         NormInstance* instance = NormInstance::GetInstanceFromObject(objectHandle);
-        if (instance && instance->dispatcher.SuspendThread())
+        if (instance && instance->SuspendThread())
         {
+            // (deferred when called from within the event callback)
             NormObject* obj = (NormObject*)objectHandle;
-            NormSenderNode* sender = obj->GetSender();
-            if (sender)
-                sender->DeleteObject(obj); 
+            if (instance->InCallback())
+                instance->DeferCall(NormInstance::DEFER_OBJECT_CANCEL, obj);
             else
-                obj->GetSession().DeleteTxObject(obj, false);
-            instance->PurgeObjectNotifications(objectHandle);
-            instance->dispatcher.ResumeThread();
+                instance->CancelObject(obj);
+            instance->ResumeThread();
         }
     }
 }  // end NormObjectCancel()
@@ -2691,10 +4111,10 @@ void NormObjectSetUserData(NormObjectHandle objectHandle, const void* userData)
     NormInstance* instance = NormInstance::GetInstanceFromObject(objectHandle);
     if (instance)
     {
-        if (instance->dispatcher.SuspendThread())
+        if (instance->SuspendThread())
         {    
             ((NormObject*)objectHandle)->SetUserData(userData);
-            instance->dispatcher.ResumeThread();
+            instance->ResumeThread();
         }
     }
 }  // end NormObjectSetUserData()
@@ -2712,10 +4132,10 @@ void NormObjectRetain(NormObjectHandle objectHandle)
     if (NORM_OBJECT_INVALID != objectHandle)
     {
         NormInstance* instance = NormInstance::GetInstanceFromObject(objectHandle);
-        if (instance && instance->dispatcher.SuspendThread())
+        if (instance && instance->SuspendThread())
         {
             ((NormObject*)objectHandle)->Retain();
-            instance->dispatcher.ResumeThread();
+            instance->ResumeThread();
         }
     }
 }  // end NormRetainObject()
@@ -2728,10 +4148,10 @@ void NormObjectRelease(NormObjectHandle objectHandle)
     if (NORM_OBJECT_INVALID != objectHandle)
     {
         NormInstance* instance = NormInstance::GetInstanceFromObject(objectHandle);
-        if (instance && instance->dispatcher.SuspendThread())
+        if (instance && instance->SuspendThread())
         {
             ((NormObject*)objectHandle)->Release();
-            instance->dispatcher.ResumeThread();
+            instance->ResumeThread();
         }
     }
 }  // end NormObjectRelease()
@@ -2761,13 +4181,13 @@ bool NormFileRename(NormObjectHandle   fileHandle,
 {
     bool result = false;
     NormInstance* instance = NormInstance::GetInstanceFromObject(fileHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         // (TBD) verify "fileHandle" is a NORM_FILE ?>??
         NormFileObject* file = 
             static_cast<NormFileObject*>((NormObject*)fileHandle);
         result = file->Rename(fileName);
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
     return result;
 }  // end NormFileRename()
@@ -2785,11 +4205,11 @@ char* NormDataDetachData(NormObjectHandle dataHandle)
 {
     char* ptr = NULL;
     NormInstance* instance = NormInstance::GetInstanceFromObject(dataHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         NormDataObject* dataObj = static_cast<NormDataObject*>((NormObject*)dataHandle);
         ptr = dataObj->DetachData();
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
     return ptr;
 }  // end NormDataDetachData()
@@ -2836,7 +4256,7 @@ bool NormNodeGetAddress(NormNodeHandle  nodeHandle,
     if (NORM_NODE_INVALID != nodeHandle)
     {
         //NormInstance* instance = NormInstance::GetInstanceFromNode(nodeHandle);
-        //if (instance && instance->dispatcher.SuspendThread())
+        //if (instance && instance->SuspendThread())
         {
             NormNode* node = (NormNode*)nodeHandle;
             const ProtoAddress& nodeAddr = node->GetAddress();
@@ -2852,7 +4272,7 @@ bool NormNodeGetAddress(NormNodeHandle  nodeHandle,
             }      
             if (bufferLen) *bufferLen = addrLen;
             if (port) *port = nodeAddr.GetPort();
-            //instance->dispatcher.ResumeThread();  
+            //instance->ResumeThread();  
         }
     }
     return result;
@@ -2886,7 +4306,7 @@ double NormNodeGetGrtt(NormNodeHandle nodeHandle)
     {
         NormSenderNode* sender = static_cast<NormSenderNode*>(node);
         sender->ResetGrttNotification();
-        return sender->GetGrttEstimate();
+        return sender->GetGrttStatus();
     }
     else
     {
@@ -2903,7 +4323,7 @@ bool NormNodeGetCommand(NormNodeHandle nodeHandle,
     if (NORM_NODE_INVALID != nodeHandle)
     {
         NormInstance* instance = NormInstance::GetInstanceFromNode(nodeHandle);
-        if (instance && instance->dispatcher.SuspendThread())
+        if (instance && instance->SuspendThread())
         {
             NormNode* node = (NormNode*)nodeHandle;
             if (NormNode::SENDER == node->GetType())
@@ -2911,7 +4331,7 @@ bool NormNodeGetCommand(NormNodeHandle nodeHandle,
                 NormSenderNode* sender = static_cast<NormSenderNode*>(node);
                 result = sender->ReadNextCmd(cmdBuffer, cmdLength);
             }
-            instance->dispatcher.ResumeThread();  
+            instance->ResumeThread();  
         }
     }
     return result;
@@ -2926,7 +4346,7 @@ bool NormNodeSendAckEx(NormNodeHandle nodeHandle,
     if (NORM_NODE_INVALID != nodeHandle)
     {
         NormInstance* instance = NormInstance::GetInstanceFromNode(nodeHandle);
-        if (instance && instance->dispatcher.SuspendThread())
+        if (instance && instance->SuspendThread())
         {
             NormNode* node = (NormNode*)nodeHandle;
             if (NormNode::SENDER == node->GetType())
@@ -2934,7 +4354,7 @@ bool NormNodeSendAckEx(NormNodeHandle nodeHandle,
                 NormSenderNode* sender = static_cast<NormSenderNode*>(node);
                 result = sender->SendAckEx(buffer, numBytes);
             }
-            instance->dispatcher.ResumeThread();  
+            instance->ResumeThread();  
         }
     }
     return result;
@@ -2949,7 +4369,7 @@ bool NormNodeGetWatermarkEx(NormNodeHandle nodeHandle,
     if (NORM_NODE_INVALID != nodeHandle)
     {
         NormInstance* instance = NormInstance::GetInstanceFromNode(nodeHandle);
-        if (instance && instance->dispatcher.SuspendThread())
+        if (instance && instance->SuspendThread())
         {
             NormNode* node = (NormNode*)nodeHandle;
             if (NormNode::SENDER == node->GetType())
@@ -2957,7 +4377,7 @@ bool NormNodeGetWatermarkEx(NormNodeHandle nodeHandle,
                 NormSenderNode* sender = static_cast<NormSenderNode*>(node);
                 result = sender->GetWatermarkEx(buffer, buflen);
             }
-            instance->dispatcher.ResumeThread();  
+            instance->ResumeThread();  
         }
     }
     return result;
@@ -2969,7 +4389,7 @@ void NormNodeFreeBuffers(NormNodeHandle nodeHandle)
     if (NORM_NODE_INVALID != nodeHandle)
     {
         NormInstance* instance = NormInstance::GetInstanceFromNode(nodeHandle);
-        if (instance && instance->dispatcher.SuspendThread())
+        if (instance && instance->SuspendThread())
         {
             NormNode* node = (NormNode*)nodeHandle;
             if (NormNode::SENDER == node->GetType())
@@ -2979,7 +4399,7 @@ void NormNodeFreeBuffers(NormNodeHandle nodeHandle)
                 // Since this results in aborted objects, should we purge those object notifications?
                 // or let the be delivered since the app may have associate state
             }
-            instance->dispatcher.ResumeThread(); 
+            instance->ResumeThread(); 
         }
     }
 }  // end NormNodeFreeBuffers()
@@ -2990,17 +4410,15 @@ void NormNodeDelete(NormNodeHandle nodeHandle)
     if (NORM_NODE_INVALID != nodeHandle)
     {
         NormInstance* instance = NormInstance::GetInstanceFromNode(nodeHandle);
-        if (instance && instance->dispatcher.SuspendThread())
+        if (instance && instance->SuspendThread())
         {
+            // (deferred when called from within the event callback)
             NormNode* node = (NormNode*)nodeHandle;
-            if (NormNode::SENDER == node->GetType())
-            {
-                NormSenderNode* sender = static_cast<NormSenderNode*>(node);
-                sender->GetSession().DeleteRemoteSender(*sender);
-            }
-            // else if NormNode::ACKER, should we remove from acking node list???
-            instance->PurgeNodeNotifications(nodeHandle);
-            instance->dispatcher.ResumeThread(); 
+            if (instance->InCallback())
+                instance->DeferCall(NormInstance::DEFER_NODE_DELETE, node);
+            else
+                instance->DeleteNode(node);
+            instance->ResumeThread(); 
         }
     }
 }  // end NormNodeDelete()
@@ -3011,10 +4429,10 @@ void NormNodeRetain(NormNodeHandle nodeHandle)
     if (NORM_NODE_INVALID != nodeHandle)
     {
         NormInstance* instance = NormInstance::GetInstanceFromNode(nodeHandle);
-        if (instance && instance->dispatcher.SuspendThread())
+        if (instance && instance->SuspendThread())
         {
             ((NormNode*)nodeHandle)->Retain();
-            instance->dispatcher.ResumeThread();
+            instance->ResumeThread();
         }
     }
 }  // end NormNodeRetain()
@@ -3025,10 +4443,10 @@ void NormNodeRelease(NormNodeHandle nodeHandle)
     if (NORM_NODE_INVALID != nodeHandle)
     {
         NormInstance* instance = NormInstance::GetInstanceFromNode(nodeHandle);
-        if (instance && instance->dispatcher.SuspendThread())
+        if (instance && instance->SuspendThread())
         {
             ((NormNode*)nodeHandle)->Release();
-            instance->dispatcher.ResumeThread();
+            instance->ResumeThread();
         }
     }
 }  // end NormNodeRelease()
@@ -3059,10 +4477,10 @@ UINT32 NormCountCompletedObjects(NormSessionHandle sessionHandle)
     UINT32 result = 0;
     NormSession* session = (NormSession*)sessionHandle;
 	NormInstance* instance = NormInstance::GetInstanceFromSession(sessionHandle);
-    if (instance && instance->dispatcher.SuspendThread())
+    if (instance && instance->SuspendThread())
     {
         result = instance->CountCompletedObjects(session);
-        instance->dispatcher.ResumeThread();
+        instance->ResumeThread();
     }
 	return result;
 }  // end NormCountCompletedObjects()
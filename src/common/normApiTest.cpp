@@ -0,0 +1,1306 @@
+// This program runs focused tests of NORM API features.  The "loopback"
+// tests run a sender and receiver within one NormSession (with NormSetLoopback()
+// enabled) on the local host and check what is received.  Each test is run by
+// name and the program exits with zero status if it passes.
+
+#include "normApi.h"
+#include "normFile.h"  // for NormFile (test file setup)
+
+#include <stdio.h>
+#include <stdlib.h>  // for rand(), getenv()
+#include <string.h>
+
+#ifdef WIN32
+#include <windows.h>  // for Sleep()
+#else
+#include <unistd.h>   // for usleep()
+#endif // if/else WIN32
+
+static void SleepSec(double seconds)
+{
+#ifdef WIN32
+    Sleep((DWORD)(seconds * 1000.0));
+#else
+    usleep((useconds_t)(seconds * 1.0e+06));
+#endif // if/else WIN32
+}  // end SleepSec()
+
+// Test content has its "index" in the first four bytes followed by a
+// pattern derived from it so received content can be fully checked
+static void FillPattern(char* buffer, UINT32 len, UINT32 index)
+{
+    for (UINT32 i = 0; i < len; i++)
+    {
+        if (i < 4)
+            buffer[i] = (char)(index >> (8 * (3 - i)));
+        else
+            buffer[i] = (char)((index * 31) + (i * 7));
+    }
+}  // end FillPattern()
+
+// Returns the content "index" (or -1 if the content is not as expected)
+static int CheckPattern(const char* buffer, UINT32 len, UINT32 expectedLen)
+{
+    if ((NULL == buffer) || (len != expectedLen) || (len < 4)) return -1;
+    UINT32 index = 0;
+    for (UINT32 i = 0; i < 4; i++)
+        index = (index << 8) | (UINT8)buffer[i];
+    for (UINT32 i = 4; i < len; i++)
+    {
+        if (buffer[i] != (char)((index * 31) + (i * 7)))
+            return -1;
+    }
+    return (int)index;
+}  // end CheckPattern()
+
+// Sets up a NORM instance and session that sends to itself (the session is
+// run by the last of the instance's "threadCount" NORM protocol threads)
+class NormLoopback
+{
+    public:
+        NormLoopback();
+        ~NormLoopback();
+
+        bool Open(UINT16 sessionPort, unsigned int threadCount = 1);
+        void Close();
+
+        NormInstanceHandle GetInstance() const {return instance;}
+        NormSessionHandle GetSession() const {return session;}
+        NormSessionId GetSenderInstanceId() const {return instance_id;}
+
+        // Waits up to "timeout" seconds for the next event (the event
+        // handles are valid until the next call)
+        bool GetNextEvent(NormEvent& theEvent, double timeout)
+            {return (0 != NormGetNextEvents(instance, &theEvent, 1, timeout));}
+
+    private:
+        NormInstanceHandle  instance;
+        NormSessionHandle   session;
+        NormSessionId       instance_id;
+};  // end class NormLoopback
+
+NormLoopback::NormLoopback()
+ : instance(NORM_INSTANCE_INVALID), session(NORM_SESSION_INVALID), instance_id(0)
+{
+}
+
+NormLoopback::~NormLoopback()
+{
+    Close();
+}
+
+bool NormLoopback::Open(UINT16 sessionPort, unsigned int threadCount)
+{
+    if (NORM_INSTANCE_INVALID == (instance = NormCreateInstanceEx(false, threadCount)))
+    {
+        fprintf(stderr, "normApiTest: NormCreateInstanceEx() error\n");
+        return false;
+    }
+    session = NormCreateSessionEx(instance, "127.0.0.1", sessionPort, 1, (int)threadCount - 1);
+    if (NORM_SESSION_INVALID == session)
+    {
+        fprintf(stderr, "normApiTest: NormCreateSessionEx() error\n");
+        Close();
+        return false;
+    }
+    NormSetLoopback(session, true);
+    NormSetGrttEstimate(session, 0.001);
+    NormSetTxRate(session, 50.0e+06);
+    instance_id = (NormSessionId)rand();
+    if (!NormStartReceiver(session, 4*1024*1024) ||
+        !NormStartSender(session, instance_id, 4*1024*1024, 1400, 16, 4))
+    {
+        fprintf(stderr, "normApiTest: error starting loopback sender/receiver\n");
+        Close();
+        return false;
+    }
+    return true;
+}  // end NormLoopback::Open()
+
+void NormLoopback::Close()
+{
+    if (NORM_SESSION_INVALID != session)
+    {
+        NormDestroySession(session);
+        session = NORM_SESSION_INVALID;
+    }
+    if (NORM_INSTANCE_INVALID != instance)
+    {
+        NormDestroyInstance(instance);
+        instance = NORM_INSTANCE_INVALID;
+    }
+}  // end NormLoopback::Close()
+
+// Enqueues data objects without retrieving any events until the (minimum
+// size) event queue overflows and then checks that every object was still
+// accepted and received (i.e., its RX_OBJECT_NEW/COMPLETED weren't dropped)
+static bool TestEventOverflow()
+{
+    const unsigned int OBJECT_COUNT = 200;
+    const UINT32 OBJECT_SIZE = 4000;
+    NormLoopback loopback;
+    if (!loopback.Open(6101)) return false;
+    NormInstanceHandle instance = loopback.GetInstance();
+    NormSetEventQueueLimit(instance, 0);  // (rounded up to the minimum ring size)
+    NormSetTxCacheBounds(loopback.GetSession(), 16*1024*1024, OBJECT_COUNT, OBJECT_COUNT);
+    char* txData = new char[OBJECT_COUNT * OBJECT_SIZE];
+    for (unsigned int i = 0; i < OBJECT_COUNT; i++)
+    {
+        char* dataPtr = txData + (i * OBJECT_SIZE);
+        FillPattern(dataPtr, OBJECT_SIZE, i);
+        if (NORM_OBJECT_INVALID == NormDataEnqueue(loopback.GetSession(), dataPtr, OBJECT_SIZE))
+        {
+            fprintf(stderr, "normApiTest: overflow: NormDataEnqueue() error\n");
+            delete[] txData;
+            return false;
+        }
+    }
+    // Let the transfer complete with no events retrieved
+    SleepSec(3.0);
+    unsigned long overflowCount = NormGetEventOverflowCount(instance);
+    bool received[OBJECT_COUNT];
+    memset(received, 0, sizeof(received));
+    unsigned int newCount = 0;
+    unsigned int rxCount = 0;
+    NormEvent theEvent;
+    while ((rxCount < OBJECT_COUNT) && loopback.GetNextEvent(theEvent, 5.0))
+    {
+        if (NORM_RX_OBJECT_NEW == theEvent.type)
+        {
+            newCount++;
+        }
+        else if (NORM_RX_OBJECT_COMPLETED == theEvent.type)
+        {
+            UINT32 len = (UINT32)NormObjectGetSize(theEvent.object);
+            int index = CheckPattern(NormDataAccessData(theEvent.object), len, OBJECT_SIZE);
+            if ((index < 0) || ((unsigned int)index >= OBJECT_COUNT) || received[index])
+            {
+                fprintf(stderr, "normApiTest: overflow: invalid received content\n");
+                break;
+            }
+            received[index] = true;
+            rxCount++;
+        }
+    }
+    loopback.Close();
+    delete[] txData;
+    fprintf(stderr, "normApiTest: overflow: overflowCount:%lu newCount:%u rxCount:%u\n",
+                    overflowCount, newCount, rxCount);
+    return ((0 != overflowCount) && (OBJECT_COUNT == newCount) && (OBJECT_COUNT == rxCount));
+}  // end TestEventOverflow()
+
+// Stream content is a byte pattern derived from the stream offset so
+// that content can be checked as it is read (in any size pieces)
+static char StreamByte(UINT32 offset)
+{
+    return (char)((offset % 251) ^ (offset >> 10));
+}  // end StreamByte()
+
+// Sends a stream (written with NormStreamWrite() via a "write ring" if
+// "writeRing" is set) and reads it with NormStreamRead() or, if "peek"
+// is set, NormStreamPeekSegments()/NormStreamConsume(), checking that 
+// all of the content is received in order
+static bool RunStreamTest(const char* name, UINT16 port, bool writeRing, bool peek)
+{
+    const UINT32 STREAM_SIZE = 4*1024*1024;
+    const UINT32 WRITE_SIZE = 1000;
+    NormLoopback loopback;
+    if (!loopback.Open(port)) return false;
+    NormObjectHandle txStream = NormStreamOpen(loopback.GetSession(), 1024*1024);
+    if (NORM_OBJECT_INVALID == txStream)
+    {
+        fprintf(stderr, "normApiTest: %s: NormStreamOpen() error\n", name);
+        return false;
+    }
+    if (writeRing && !NormStreamSetWriteRing(txStream, 64*1024))
+    {
+        fprintf(stderr, "normApiTest: %s: NormStreamSetWriteRing() error\n", name);
+        return false;
+    }
+    UINT32 txOffset = 0;
+    UINT32 rxOffset = 0;
+    bool flushed = false;
+    bool result = true;
+    char buffer[4096];
+    while (result && (rxOffset < STREAM_SIZE))
+    {
+        // Write as much as the stream will take
+        while (txOffset < STREAM_SIZE)
+        {
+            UINT32 len = STREAM_SIZE - txOffset;
+            if (len > WRITE_SIZE) len = WRITE_SIZE;
+            for (UINT32 i = 0; i < len; i++)
+                buffer[i] = StreamByte(txOffset + i);
+            UINT32 count = NormStreamWrite(txStream, buffer, len);
+            txOffset += count;
+            if (count < len) break;  // wait for NORM_TX_QUEUE_VACANCY
+        }
+        if ((STREAM_SIZE == txOffset) && !flushed)
+        {
+            NormStreamFlush(txStream);
+            flushed = true;
+        }
+        NormEvent theEvent;
+        if (!loopback.GetNextEvent(theEvent, 5.0))
+        {
+            fprintf(stderr, "normApiTest: %s: timeout (rxOffset:%lu)\n", name, (unsigned long)rxOffset);
+            result = false;
+            break;
+        }
+        if (NORM_RX_OBJECT_UPDATED != theEvent.type) continue;
+        NormObjectHandle rxStream = theEvent.object;
+        UINT32 count;
+        do
+        {
+            count = 0;
+            if (peek)
+            {
+                struct iovec iov[16];
+                int iovCount = NormStreamPeekSegments(rxStream, iov, 16);
+                if (iovCount < 0)
+                {
+                    fprintf(stderr, "normApiTest: %s: stream break\n", name);
+                    result = false;
+                    break;
+                }
+                for (int i = 0; i < iovCount; i++)
+                {
+                    const char* ptr = (const char*)iov[i].iov_base;
+                    for (size_t j = 0; j < iov[i].iov_len; j++)
+                    {
+                        if (ptr[j] != StreamByte(rxOffset + count))
+                            result = false;
+                        count++;
+                    }
+                }
+                if ((0 != count) && !NormStreamConsume(rxStream, count))
+                {
+                    fprintf(stderr, "normApiTest: %s: NormStreamConsume() error\n", name);
+                    result = false;
+                }
+            }
+            else
+            {
+                unsigned int len = sizeof(buffer);
+                if (!NormStreamRead(rxStream, buffer, &len))
+                {
+                    fprintf(stderr, "normApiTest: %s: stream break\n", name);
+                    result = false;
+                    break;
+                }
+                for (count = 0; count < len; count++)
+                {
+                    if (buffer[count] != StreamByte(rxOffset + count))
+                        result = false;
+                }
+            }
+            if (!result) 
+                fprintf(stderr, "normApiTest: %s: invalid content near offset %lu\n", name, (unsigned long)rxOffset);
+            rxOffset += count;
+        } while (result && (0 != count));
+    }
+    loopback.Close();
+    fprintf(stderr, "normApiTest: %s: txOffset:%lu rxOffset:%lu\n", name, 
+                    (unsigned long)txOffset, (unsigned long)rxOffset);
+    return (result && (STREAM_SIZE == rxOffset));
+}  // end RunStreamTest()
+
+// Fills a write ring (at a low tx rate so it stays full), checks that it
+// can't then be disabled, and that a graceful NormStreamClose() still 
+// delivers all of the ring content before the stream completes
+static bool TestWriteRingClose()
+{
+    const UINT32 STREAM_SIZE = 250000;
+    NormLoopback loopback;
+    if (!loopback.Open(6112)) return false;
+    NormSetTxRate(loopback.GetSession(), 2.0e+06);
+    NormObjectHandle txStream = NormStreamOpen(loopback.GetSession(), 64*1024);
+    if ((NORM_OBJECT_INVALID == txStream) || !NormStreamSetWriteRing(txStream, 256*1024))
+    {
+        fprintf(stderr, "normApiTest: ringclose: setup error\n");
+        return false;
+    }
+    char buffer[4096];
+    UINT32 txOffset = 0;
+    while (txOffset < STREAM_SIZE)
+    {
+        UINT32 len = STREAM_SIZE - txOffset;
+        if (len > sizeof(buffer)) len = sizeof(buffer);
+        for (UINT32 i = 0; i < len; i++)
+            buffer[i] = StreamByte(txOffset + i);
+        UINT32 count = NormStreamWrite(txStream, buffer, len);
+        txOffset += count;
+        if (count < len) break;
+    }
+    bool result = true;
+    if (NormStreamSetWriteRing(txStream, 0))
+    {
+        fprintf(stderr, "normApiTest: ringclose: write ring with content was disabled\n");
+        result = false;
+    }
+    NormStreamClose(txStream, true);
+    UINT32 rxOffset = 0;
+    bool completed = false;
+    NormEvent theEvent;
+    while (result && !completed && loopback.GetNextEvent(theEvent, 5.0))
+    {
+        if (NORM_RX_OBJECT_COMPLETED == theEvent.type)
+            completed = true;
+        else if (NORM_RX_OBJECT_UPDATED != theEvent.type)
+            continue;
+        unsigned int len;
+        do
+        {
+            len = sizeof(buffer);
+            if (!NormStreamRead(theEvent.object, buffer, &len)) break;
+            for (unsigned int i = 0; i < len; i++)
+            {
+                if (buffer[i] != StreamByte(rxOffset + i))
+                    result = false;
+            }
+            rxOffset += len;
+        } while (result && (0 != len));
+    }
+    loopback.Close();
+    fprintf(stderr, "normApiTest: ringclose: txOffset:%lu rxOffset:%lu completed:%d\n",
+                    (unsigned long)txOffset, (unsigned long)rxOffset, completed);
+    return (result && completed && (txOffset == rxOffset));
+}  // end TestWriteRingClose()
+
+static bool TestWriteRing()
+{
+    return RunStreamTest("ring", 6102, true, false);
+}  // end TestWriteRing()
+
+static bool TestPeekSegments()
+{
+    return RunStreamTest("peek", 6103, false, true);
+}  // end TestPeekSegments()
+
+// Checks the status getters that read NORM thread published status
+// (without suspending the NORM thread) during a data object transfer
+static bool TestStatusGetters()
+{
+    const UINT32 OBJECT_SIZE = 1024*1024;
+    const double TX_RATE = 20.0e+06;
+    NormLoopback loopback;
+    if (!loopback.Open(6106)) return false;
+    NormSessionHandle session = loopback.GetSession();
+    NormSetTxRate(session, TX_RATE);
+    double txRate = NormGetTxRate(session);
+    double grtt = NormGetGrttEstimate(session);
+    bool result = true;
+    if ((txRate < (0.99 * TX_RATE)) || (txRate > (1.01 * TX_RATE)) || (grtt <= 0.0))
+    {
+        fprintf(stderr, "normApiTest: getters: invalid txRate:%lf or grtt:%lf\n", txRate, grtt);
+        result = false;
+    }
+    char* txData = new char[OBJECT_SIZE];
+    FillPattern(txData, OBJECT_SIZE, 1);
+    if (NORM_OBJECT_INVALID == NormDataEnqueue(session, txData, OBJECT_SIZE))
+    {
+        fprintf(stderr, "normApiTest: getters: NormDataEnqueue() error\n");
+        result = false;
+    }
+    NormSize lastPending = OBJECT_SIZE;
+    unsigned int updateCount = 0;
+    bool completed = false;
+    NormEvent theEvent;
+    while (result && !completed && loopback.GetNextEvent(theEvent, 5.0))
+    {
+        switch (theEvent.type)
+        {
+            case NORM_RX_OBJECT_UPDATED:
+            {
+                // (published status may lag, but never goes backwards)
+                NormSize pending = NormObjectGetBytesPending(theEvent.object);
+                if (pending > lastPending)
+                {
+                    fprintf(stderr, "normApiTest: getters: bytes pending increased from %lu to %lu\n",
+                                    (unsigned long)lastPending, (unsigned long)pending);
+                    result = false;
+                }
+                lastPending = pending;
+                updateCount++;
+                break;
+            }
+            case NORM_RX_OBJECT_COMPLETED:
+            {
+                NormSize pending = NormObjectGetBytesPending(theEvent.object);
+                double senderGrtt = NormNodeGetGrtt(theEvent.sender);
+                if ((0 != pending) || (senderGrtt <= 0.0) ||
+                    (1 != CheckPattern(NormDataAccessData(theEvent.object), 
+                                       (UINT32)NormObjectGetSize(theEvent.object), OBJECT_SIZE)))
+                {
+                    fprintf(stderr, "normApiTest: getters: invalid completion status (pending:%lu grtt:%lf)\n",
+                                    (unsigned long)pending, senderGrtt);
+                    result = false;
+                }
+                completed = true;
+                break;
+            }
+            default:
+                break;
+        }
+    }
+    loopback.Close();
+    delete[] txData;
+    fprintf(stderr, "normApiTest: getters: updateCount:%u completed:%d\n", updateCount, completed);
+    return (result && completed);
+}  // end TestStatusGetters()
+
+static const char* GetTempDir()
+{
+#ifdef WIN32
+    const char* tempDir = getenv("TEMP");
+    return ((NULL != tempDir) ? tempDir : ".");
+#else
+    const char* tempDir = getenv("TMPDIR");
+    return ((NULL != tempDir) ? tempDir : "/tmp");
+#endif // if/else WIN32
+}  // end GetTempDir()
+
+// Creates a uniquely-named (empty) file in the temp directory
+static bool MakeTempFile(char* path)
+{
+    snprintf(path, PATH_MAX, "%s%cnormApiTestXXXXXX", GetTempDir(), PROTO_PATH_DELIMITER);
+#ifdef WIN32
+    return (NULL != _mktemp(path));
+#else
+    int fd = mkstemp(path);
+    if (fd < 0) return false;
+    close(fd);
+    return true;
+#endif // if/else WIN32
+}  // end MakeTempFile()
+
+// Creates a uniquely-named (empty) directory in the temp directory
+static bool MakeTempDir(char* path)
+{
+    snprintf(path, PATH_MAX, "%s%cnormApiTestXXXXXX", GetTempDir(), PROTO_PATH_DELIMITER);
+#ifdef WIN32
+    return ((NULL != _mktemp(path)) && (0 != CreateDirectory(path, NULL)));
+#else
+    return (NULL != mkdtemp(path));
+#endif // if/else WIN32
+}  // end MakeTempDir()
+
+static void RemoveTempDir(const char* path)
+{
+#ifdef WIN32
+    RemoveDirectory(path);
+#else
+    rmdir(path);
+#endif // if/else WIN32
+}  // end RemoveTempDir()
+
+// Creates a temporary file of "size" bytes of StreamByte() content
+static bool MakeTestFile(char* path, UINT32 size)
+{
+    NormFile file;
+    if (!MakeTempFile(path) || !file.Open(path, O_WRONLY | O_TRUNC))
+    {
+        fprintf(stderr, "normApiTest: error creating test file\n");
+        return false;
+    }
+    char buffer[4096];
+    UINT32 offset = 0;
+    while (offset < size)
+    {
+        UINT32 len = size - offset;
+        if (len > sizeof(buffer)) len = sizeof(buffer);
+        for (UINT32 i = 0; i < len; i++)
+            buffer[i] = StreamByte(offset + i);
+        if (len != file.Write(buffer, len))
+        {
+            fprintf(stderr, "normApiTest: error writing test file\n");
+            file.Close();
+            NormFile::Unlink(path);
+            return false;
+        }
+        offset += len;
+    }
+    file.Close();
+    return true;
+}  // end MakeTestFile()
+
+// Checks that the file is "size" bytes of StreamByte() content
+static bool CheckTestFile(const char* path, UINT32 size)
+{
+    NormFile file;
+    if ((NormFile::Offset)size != NormFile::GetSize(path) || !file.Open(path, O_RDONLY))
+        return false;
+    char buffer[4096];
+    UINT32 offset = 0;
+    while (offset < size)
+    {
+        UINT32 len = size - offset;
+        if (len > sizeof(buffer)) len = sizeof(buffer);
+        if (len != file.Read(buffer, len)) break;
+        for (UINT32 i = 0; i < len; i++)
+        {
+            if (buffer[i] != StreamByte(offset + i))
+            {
+                file.Close();
+                return false;
+            }
+        }
+        offset += len;
+    }
+    file.Close();
+    return (size == offset);
+}  // end CheckTestFile()
+
+// Sends a file to a receiver with write-behind staging enabled and checks
+// that the received file is preallocated at NORM_RX_OBJECT_NEW and that
+// its content is complete by NORM_RX_OBJECT_COMPLETED
+static bool TestWriteBehind()
+{
+    const UINT32 FILE_SIZE = 3*1024*1024 + 1234;  // (a short final block)
+    char txPath[PATH_MAX];
+    if (!MakeTestFile(txPath, FILE_SIZE)) return false;
+    NormLoopback loopback;
+    if (!loopback.Open(6107))
+    {
+        NormFile::Unlink(txPath);
+        return false;
+    }
+    NormSetCacheDirectory(loopback.GetInstance(), GetTempDir());
+    NormSetRxFileWriteBehind(loopback.GetSession(), 4);
+    bool result = true;
+    if (NORM_OBJECT_INVALID == NormFileEnqueue(loopback.GetSession(), txPath))
+    {
+        fprintf(stderr, "normApiTest: writebehind: NormFileEnqueue() error\n");
+        result = false;
+    }
+    char rxPath[PATH_MAX];
+    rxPath[0] = '\0';
+    bool completed = false;
+    NormEvent theEvent;
+    while (result && !completed && loopback.GetNextEvent(theEvent, 5.0))
+    {
+        if ((NORM_RX_OBJECT_NEW != theEvent.type) && (NORM_RX_OBJECT_COMPLETED != theEvent.type))
+            continue;
+        if (!NormFileGetName(theEvent.object, rxPath, PATH_MAX))
+        {
+            fprintf(stderr, "normApiTest: writebehind: NormFileGetName() error\n");
+            result = false;
+        }
+        else if (NORM_RX_OBJECT_NEW == theEvent.type)
+        {
+            // The file is sized when accepted (before any segments are written)
+            NormFile::Offset size = NormFile::GetSize(rxPath);
+            if ((NormFile::Offset)FILE_SIZE != size)
+            {
+                fprintf(stderr, "normApiTest: writebehind: accepted file size %ld not preallocated\n", (long)size);
+                result = false;
+            }
+        }
+        else
+        {
+            completed = true;
+            if (!CheckTestFile(rxPath, FILE_SIZE))
+            {
+                fprintf(stderr, "normApiTest: writebehind: invalid received file content\n");
+                result = false;
+            }
+        }
+    }
+    loopback.Close();
+    NormFile::Unlink(txPath);
+    if ('\0' != rxPath[0]) NormFile::Unlink(rxPath);
+    fprintf(stderr, "normApiTest: writebehind: completed:%d\n", completed);
+    return (result && completed);
+}  // end TestWriteBehind()
+
+// Sends a file with sender read-ahead enabled and tx loss so repairs of
+// blocks older than the read-ahead window are interleaved with reads of
+// the blocks ahead of transmission, and checks the received content
+static bool TestReadAhead()
+{
+    const UINT32 FILE_SIZE = 3*1024*1024 + 1234;  // (a short final block)
+    char txPath[PATH_MAX];
+    if (!MakeTestFile(txPath, FILE_SIZE)) return false;
+    NormLoopback loopback;
+    if (!loopback.Open(6114))
+    {
+        NormFile::Unlink(txPath);
+        return false;
+    }
+    NormSetCacheDirectory(loopback.GetInstance(), GetTempDir());
+    NormSetTxFileReadAhead(loopback.GetSession(), 4);
+    NormSetTxLoss(loopback.GetSession(), 10.0);
+    bool result = true;
+    if (NORM_OBJECT_INVALID == NormFileEnqueue(loopback.GetSession(), txPath))
+    {
+        fprintf(stderr, "normApiTest: readahead: NormFileEnqueue() error\n");
+        result = false;
+    }
+    char rxPath[PATH_MAX];
+    rxPath[0] = '\0';
+    bool completed = false;
+    NormEvent theEvent;
+    while (result && !completed && loopback.GetNextEvent(theEvent, 5.0))
+    {
+        if (NORM_RX_OBJECT_COMPLETED != theEvent.type) continue;
+        completed = true;
+        if (!NormFileGetName(theEvent.object, rxPath, PATH_MAX) || !CheckTestFile(rxPath, FILE_SIZE))
+        {
+            fprintf(stderr, "normApiTest: readahead: invalid received file content\n");
+            result = false;
+        }
+    }
+    loopback.Close();
+    NormFile::Unlink(txPath);
+    if ('\0' != rxPath[0]) NormFile::Unlink(rxPath);
+    fprintf(stderr, "normApiTest: readahead: completed:%d\n", completed);
+    return (result && completed);
+}  // end TestReadAhead()
+
+// Stops the receiver partway through a file transfer and checks that
+// the restarted receiver resumes it (i.e., its resume sidecar is found and
+// the partially received file is taken up) and receives it completely
+static bool TestFileResume()
+{
+    const UINT32 FILE_SIZE = 8*1024*1024;
+    char txPath[PATH_MAX];
+    if (!MakeTestFile(txPath, FILE_SIZE)) return false;
+    NormLoopback loopback;
+    if (!loopback.Open(6108))
+    {
+        NormFile::Unlink(txPath);
+        return false;
+    }
+    NormSessionHandle session = loopback.GetSession();
+    NormSetTxRate(session, 16.0e+06);  // (so the transfer takes a few seconds)
+    NormSetCacheDirectory(loopback.GetInstance(), GetTempDir());
+    NormSetRxFileResume(session, true);
+    NormSetDefaultSyncPolicy(session, NORM_SYNC_ALL);
+    // The sidecar is named for the sender id, instance id, and object id 
+    // (the first object sent by a session has transport id zero)
+    char sidecarPath[PATH_MAX];
+    sprintf(sidecarPath, "%s%c.normResume-%08lx-%04hx-%04hx", GetTempDir(), PROTO_PATH_DELIMITER,
+            1UL, (UINT16)loopback.GetSenderInstanceId(), (UINT16)0);
+    bool result = true;
+    if (NORM_OBJECT_INVALID == NormFileEnqueue(session, txPath))
+    {
+        fprintf(stderr, "normApiTest: resume: NormFileEnqueue() error\n");
+        result = false;
+    }
+    // 1) Receive about half of the file and stop the receiver
+    char partPath[PATH_MAX];
+    partPath[0] = '\0';
+    bool stopped = false;
+    NormEvent theEvent;
+    while (result && !stopped && loopback.GetNextEvent(theEvent, 5.0))
+    {
+        if (NORM_RX_OBJECT_NEW == theEvent.type)
+        {
+            result = NormFileGetName(theEvent.object, partPath, PATH_MAX);
+        }
+        else if (NORM_RX_OBJECT_UPDATED == theEvent.type)
+        {
+            if (NormObjectGetBytesPending(theEvent.object) < (FILE_SIZE / 2))
+            {
+                NormStopReceiver(session);
+                stopped = true;
+            }
+        }
+        else if (NORM_RX_OBJECT_COMPLETED == theEvent.type)
+        {
+            fprintf(stderr, "normApiTest: resume: completed before receiver was stopped\n");
+            result = false;
+        }
+    }
+    if (result && (!stopped || !NormFile::Exists(sidecarPath) || !NormFile::Exists(partPath)))
+    {
+        fprintf(stderr, "normApiTest: resume: no resume sidecar and partial file after stop\n");
+        result = false;
+    }
+    // 2) Restart the receiver and let it resume and complete the file
+    char rxPath[PATH_MAX];
+    rxPath[0] = '\0';
+    bool completed = false;
+    if (result && !NormStartReceiver(session, 4*1024*1024))
+    {
+        fprintf(stderr, "normApiTest: resume: NormStartReceiver() error\n");
+        result = false;
+    }
+    while (result && !completed && loopback.GetNextEvent(theEvent, 5.0))
+    {
+        if (NORM_RX_OBJECT_NEW == theEvent.type)
+        {
+            // The partial file is renamed to the newly accepted path
+            if (!NormFileGetName(theEvent.object, rxPath, PATH_MAX) || NormFile::Exists(partPath))
+            {
+                fprintf(stderr, "normApiTest: resume: partial file was not resumed\n");
+                result = false;
+            }
+        }
+        else if (NORM_RX_OBJECT_COMPLETED == theEvent.type)
+        {
+            completed = true;
+            if (!CheckTestFile(rxPath, FILE_SIZE) || NormFile::Exists(sidecarPath))
+            {
+                fprintf(stderr, "normApiTest: resume: invalid received file (or sidecar not removed)\n");
+                result = false;
+            }
+        }
+    }
+    loopback.Close();
+    NormFile::Unlink(txPath);
+    if (('\0' != partPath[0]) && NormFile::Exists(partPath)) NormFile::Unlink(partPath);
+    if ('\0' != rxPath[0]) NormFile::Unlink(rxPath);
+    if (NormFile::Exists(sidecarPath)) NormFile::Unlink(sidecarPath);
+    fprintf(stderr, "normApiTest: resume: stopped:%d completed:%d\n", stopped, completed);
+    return (result && completed);
+}  // end TestFileResume()
+
+// Counts NormDataEnqueueV() extent releases
+struct ExtentReleaseCount
+{
+    unsigned int    count;
+    size_t          bytes;
+};
+
+static void OnExtentRelease(void* /*extentPtr*/, size_t extentLen, const void* releaseData)
+{
+    ExtentReleaseCount* release = (ExtentReleaseCount*)releaseData;
+    release->count++;
+    release->bytes += extentLen;
+}  // end OnExtentRelease()
+
+// (Re)writes a small file at "path"
+static bool WriteSmallFile(const char* path, const char* text)
+{
+    FILE* file = fopen(path, "w");
+    if (NULL == file) return false;
+    bool result = (EOF != fputs(text, file));
+    return ((0 == fclose(file)) && result);
+}  // end WriteSmallFile()
+
+// Checks the "updates only" directory rescan used for the norm app's 
+// "repeat" mode: the first pass lists both files, then a file updated
+// after the first pass is listed by a later pass (once the pass that
+// notices its newer update time has set the next window) and the
+// unchanged file is not listed again
+static bool TestFileListUpdates()
+{
+    char dirPath[PATH_MAX];
+    if (!MakeTempDir(dirPath))
+    {
+        fprintf(stderr, "normApiTest: rescan: error creating temp directory\n");
+        return false;
+    }
+    char pathA[PATH_MAX];
+    char pathB[PATH_MAX];
+    snprintf(pathA, PATH_MAX, "%s%ca", dirPath, PROTO_PATH_DELIMITER);
+    snprintf(pathB, PATH_MAX, "%s%cb", dirPath, PROTO_PATH_DELIMITER);
+    bool result = WriteSmallFile(pathA, "a") && WriteSmallFile(pathB, "b");
+    NormFileList fileList;
+    fileList.InitUpdateTime(true);
+    if (result) result = fileList.Append(dirPath);
+    if (!result) fprintf(stderr, "normApiTest: rescan: setup error\n");
+    const unsigned int PASS_COUNT = 3;
+    unsigned int count[PASS_COUNT];
+    bool listedA = false;
+    for (unsigned int pass = 0; result && (pass < PASS_COUNT); pass++)
+    {
+        if (1 == pass)
+        {
+            // (update times have one second resolution)
+            SleepSec(1.1);
+            if (!WriteSmallFile(pathA, "aa"))
+            {
+                fprintf(stderr, "normApiTest: rescan: error updating file\n");
+                result = false;
+                break;
+            }
+        }
+        if (0 != pass) fileList.ResetIterator();
+        count[pass] = 0;
+        char path[PATH_MAX];
+        while (fileList.GetNextFile(path))
+        {
+            count[pass]++;
+            if ((PASS_COUNT - 1) == pass) 
+                listedA = (0 == strcmp(path, pathA));
+        }
+    }
+    NormFile::Unlink(pathA);
+    NormFile::Unlink(pathB);
+    RemoveTempDir(dirPath);
+    if (!result) return false;
+    fprintf(stderr, "normApiTest: rescan: pass counts:%u %u %u listedA:%d\n", 
+                    count[0], count[1], count[2], listedA);
+    return ((2 == count[0]) && (0 == count[1]) && (1 == count[2]) && listedA);
+}  // end TestFileListUpdates()
+
+// Enqueues a data object from three separate extents, checks that the 
+// receiver gets their concatenation, and then that cancelling the tx 
+// object releases each extent exactly once
+static bool TestDataEnqueueV()
+{
+    const UINT32 EXTENT_SIZE[3] = {16, 100, 100000};
+    const UINT32 OBJECT_SIZE = EXTENT_SIZE[0] + EXTENT_SIZE[1] + EXTENT_SIZE[2];
+    NormLoopback loopback;
+    if (!loopback.Open(6104)) return false;
+    // The extents are separately allocated pieces of the pattern content
+    char* content = new char[OBJECT_SIZE];
+    FillPattern(content, OBJECT_SIZE, 7);
+    struct iovec iov[3];
+    UINT32 offset = 0;
+    for (unsigned int i = 0; i < 3; i++)
+    {
+        char* extent = new char[EXTENT_SIZE[i]];
+        memcpy(extent, content + offset, EXTENT_SIZE[i]);
+        iov[i].iov_base = extent;
+        iov[i].iov_len = EXTENT_SIZE[i];
+        offset += EXTENT_SIZE[i];
+    }
+    ExtentReleaseCount release;
+    release.count = 0;
+    release.bytes = 0;
+    bool result = true;
+    NormObjectHandle txObject = NormDataEnqueueV(loopback.GetSession(), iov, 3, OnExtentRelease, &release);
+    if (NORM_OBJECT_INVALID == txObject)
+    {
+        fprintf(stderr, "normApiTest: datav: NormDataEnqueueV() error\n");
+        result = false;
+    }
+    bool completed = false;
+    NormEvent theEvent;
+    while (result && !completed && loopback.GetNextEvent(theEvent, 5.0))
+    {
+        if (NORM_RX_OBJECT_COMPLETED != theEvent.type) continue;
+        completed = true;
+        const char* data = NormDataAccessData(theEvent.object);
+        if ((OBJECT_SIZE != (UINT32)NormObjectGetSize(theEvent.object)) || 
+            (0 != memcmp(data, content, OBJECT_SIZE)))
+        {
+            fprintf(stderr, "normApiTest: datav: invalid received content\n");
+            result = false;
+        }
+    }
+    if (result && (0 != release.count))
+    {
+        fprintf(stderr, "normApiTest: datav: extents released before the object was purged\n");
+        result = false;
+    }
+    if (NORM_OBJECT_INVALID != txObject) NormObjectCancel(txObject);
+    if (result && ((3 != release.count) || (OBJECT_SIZE != release.bytes)))
+    {
+        fprintf(stderr, "normApiTest: datav: release count:%u bytes:%lu (expected 3 and %lu)\n",
+                        release.count, (unsigned long)release.bytes, (unsigned long)OBJECT_SIZE);
+        result = false;
+    }
+    loopback.Close();
+    for (unsigned int i = 0; i < 3; i++)
+        delete[] (char*)iov[i].iov_base;
+    delete[] content;
+    fprintf(stderr, "normApiTest: datav: completed:%d releaseCount:%u\n", completed, release.count);
+    return (result && completed);
+}  // end TestDataEnqueueV()
+
+// Forces NormDataEnqueueV() to fail (a one object tx cache whose only
+// object is still pending) and checks that the extents of the failed
+// enqueue are left to the caller, i.e. never released
+static bool TestDataEnqueueVFailure()
+{
+    const UINT32 OBJECT_SIZE = 1024*1024;
+    const UINT32 EXTENT_SIZE = 1000;
+    NormLoopback loopback;
+    if (!loopback.Open(6109)) return false;
+    NormSessionHandle session = loopback.GetSession();
+    NormSetTxCacheBounds(session, 16*1024*1024, 1, 1);
+    char* txData = new char[OBJECT_SIZE];
+    FillPattern(txData, OBJECT_SIZE, 1);
+    char* extent = new char[EXTENT_SIZE];
+    FillPattern(extent, EXTENT_SIZE, 2);
+    struct iovec iov[2];
+    iov[0].iov_base = extent;
+    iov[0].iov_len = EXTENT_SIZE / 2;
+    iov[1].iov_base = extent + (EXTENT_SIZE / 2);
+    iov[1].iov_len = EXTENT_SIZE / 2;
+    ExtentReleaseCount release;
+    release.count = 0;
+    release.bytes = 0;
+    bool result = true;
+    NormObjectHandle txObject = NormDataEnqueue(session, txData, OBJECT_SIZE);
+    if (NORM_OBJECT_INVALID == txObject)
+    {
+        fprintf(stderr, "normApiTest: datavfail: NormDataEnqueue() error\n");
+        result = false;
+    }
+    // (the 1 MB object is still pending, so this can't be enqueued)
+    else if (NORM_OBJECT_INVALID != NormDataEnqueueV(session, iov, 2, OnExtentRelease, &release))
+    {
+        fprintf(stderr, "normApiTest: datavfail: NormDataEnqueueV() unexpectedly succeeded\n");
+        result = false;
+    }
+    else if (0 != release.count)
+    {
+        fprintf(stderr, "normApiTest: datavfail: extents of failed enqueue were released (count:%u)\n", 
+                        release.count);
+        result = false;
+    }
+    loopback.Close();
+    if (result && (0 != release.count))
+    {
+        fprintf(stderr, "normApiTest: datavfail: extents released at session close (count:%u)\n", 
+                        release.count);
+        result = false;
+    }
+    delete[] extent;
+    delete[] txData;
+    fprintf(stderr, "normApiTest: datavfail: releaseCount:%u\n", release.count);
+    return result;
+}  // end TestDataEnqueueVFailure()
+
+// Application memory that received data objects are placed into
+struct PlacementRegion
+{
+    char*           buffer;
+    UINT32          slotSize;
+    unsigned int    slotCount;
+    unsigned int    placeCount;  // (slots used so far)
+};
+
+static char* OnDataPlacement(const void* userData, NormObjectHandle /*objectHandle*/, UINT32 dataLen)
+{
+    PlacementRegion* region = (PlacementRegion*)userData;
+    if ((dataLen > region->slotSize) || (region->placeCount >= region->slotCount))
+        return NULL;  // use default allocation
+    return (region->buffer + (region->placeCount++ * region->slotSize));
+}  // end OnDataPlacement()
+
+// Checks that received data objects are placed directly into the slots
+// of an application "region" given by the data placement callback (with
+// the session run by the last of the instance's "threadCount" threads)
+static bool RunPlacementTest(const char* name, UINT16 port, unsigned int threadCount)
+{
+    const unsigned int OBJECT_COUNT = 10;
+    const UINT32 OBJECT_SIZE = 50000;
+    NormLoopback loopback;
+    if (!loopback.Open(port, threadCount)) return false;
+    PlacementRegion region;
+    region.buffer = new char[OBJECT_COUNT * OBJECT_SIZE];
+    region.slotSize = OBJECT_SIZE;
+    region.slotCount = OBJECT_COUNT;
+    region.placeCount = 0;
+    bool result = NormSetRxDataPlacement(loopback.GetInstance(), OnDataPlacement, &region);
+    char* txData = new char[OBJECT_COUNT * OBJECT_SIZE];
+    for (unsigned int i = 0; result && (i < OBJECT_COUNT); i++)
+    {
+        char* dataPtr = txData + (i * OBJECT_SIZE);
+        FillPattern(dataPtr, OBJECT_SIZE, i);
+        result = (NORM_OBJECT_INVALID != NormDataEnqueue(loopback.GetSession(), dataPtr, OBJECT_SIZE));
+    }
+    if (!result) fprintf(stderr, "normApiTest: %s: setup error\n", name);
+    bool received[OBJECT_COUNT];
+    memset(received, 0, sizeof(received));
+    unsigned int rxCount = 0;
+    NormEvent theEvent;
+    while (result && (rxCount < OBJECT_COUNT) && loopback.GetNextEvent(theEvent, 5.0))
+    {
+        if (NORM_RX_OBJECT_COMPLETED != theEvent.type) continue;
+        const char* data = NormDataAccessData(theEvent.object);
+        // The content must be within (at a slot of) the region
+        size_t regionOffset = (size_t)(data - region.buffer);
+        if ((data < region.buffer) || (regionOffset >= (OBJECT_COUNT * OBJECT_SIZE)) ||
+            (0 != (regionOffset % OBJECT_SIZE)))
+        {
+            fprintf(stderr, "normApiTest: %s: content not placed in the app region\n", name);
+            result = false;
+            break;
+        }
+        int index = CheckPattern(data, (UINT32)NormObjectGetSize(theEvent.object), OBJECT_SIZE);
+        if ((index < 0) || ((unsigned int)index >= OBJECT_COUNT) || received[index])
+        {
+            fprintf(stderr, "normApiTest: %s: invalid received content\n", name);
+            result = false;
+            break;
+        }
+        received[index] = true;
+        rxCount++;
+    }
+    loopback.Close();
+    delete[] txData;
+    delete[] region.buffer;
+    fprintf(stderr, "normApiTest: %s: placeCount:%u rxCount:%u\n", name, region.placeCount, rxCount);
+    return (result && (OBJECT_COUNT == rxCount) && (OBJECT_COUNT == region.placeCount));
+}  // end RunPlacementTest()
+
+static bool TestDataPlacement()
+{
+    return RunPlacementTest("placement", 6105, 1);
+}  // end TestDataPlacement()
+
+// (the placement callback is set for all of a multi-threaded instance's threads)
+static bool TestDataPlacementSharded()
+{
+    return RunPlacementTest("placementsharded", 6115, 2);
+}  // end TestDataPlacementSharded()
+
+// Event callback state (the callback runs on the NORM thread)
+struct CallbackState
+{
+    NormSessionHandle   session;
+    volatile bool       inCallback;
+    volatile bool       nested;       // set if the callback was re-entered
+    volatile bool       error;
+    volatile unsigned   rxNewCount;
+    volatile unsigned   rxCancelCount;
+    volatile unsigned   rxCompleteCount;
+    volatile unsigned   txPurgedCount;
+    volatile bool       purgedInHandler;  // TX_OBJECT_PURGED passed while it was raised
+    volatile bool       inFlushHandler;
+    char*               txData;
+    UINT32              txSize;
+    volatile bool       requeued;
+};
+
+static void InitCallbackState(CallbackState& state, NormSessionHandle session)
+{
+    memset(&state, 0, sizeof(state));
+    state.session = session;
+}  // end InitCallbackState()
+
+// Cancels every other new receive object from within the callback (the 
+// cancellation is deferred so the handle must still be usable)
+static void OnReentryEvent(const void* userData, const NormEvent* theEvent)
+{
+    CallbackState* state = (CallbackState*)userData;
+    if (state->inCallback) state->nested = true;
+    state->inCallback = true;
+    switch (theEvent->type)
+    {
+        case NORM_RX_OBJECT_NEW:
+            if (0 == (++state->rxNewCount % 2))
+            {
+                NormObjectCancel(theEvent->object);
+                if (NORM_OBJECT_DATA != NormObjectGetType(theEvent->object))
+                    state->error = true;
+                state->rxCancelCount++;
+            }
+            break;
+        case NORM_RX_OBJECT_COMPLETED:
+            if (CheckPattern(NormDataAccessData(theEvent->object), 
+                             (UINT32)NormObjectGetSize(theEvent->object), 200000) < 0)
+                state->error = true;
+            state->rxCompleteCount++;
+            break;
+        default:
+            break;
+    }
+    state->inCallback = false;
+}  // end OnReentryEvent()
+
+// Checks that NormObjectCancel() called from the event callback for
+// NORM_RX_OBJECT_NEW is safe and that the cancelled objects never complete
+static bool TestCallbackReentry()
+{
+    const unsigned int OBJECT_COUNT = 10;
+    const UINT32 OBJECT_SIZE = 200000;
+    NormLoopback loopback;
+    if (!loopback.Open(6110)) return false;
+    CallbackState state;
+    InitCallbackState(state, loopback.GetSession());
+    bool result = NormSetEventCallback(loopback.GetInstance(), OnReentryEvent, &state);
+    char* txData = new char[OBJECT_COUNT * OBJECT_SIZE];
+    for (unsigned int i = 0; result && (i < OBJECT_COUNT); i++)
+    {
+        char* dataPtr = txData + (i * OBJECT_SIZE);
+        FillPattern(dataPtr, OBJECT_SIZE, i);
+        result = (NORM_OBJECT_INVALID != NormDataEnqueue(loopback.GetSession(), dataPtr, OBJECT_SIZE));
+    }
+    if (!result) fprintf(stderr, "normApiTest: reentry: setup error\n");
+    // (let any cancelled objects "complete" if the cancellation failed)
+    for (double t = 0.0; result && (t < 5.0); t += 0.01)
+    {
+        if ((state.rxNewCount >= OBJECT_COUNT) && 
+            ((state.rxCompleteCount + state.rxCancelCount) >= OBJECT_COUNT))
+        {
+            SleepSec(0.5);
+            break;
+        }
+        SleepSec(0.01);
+    }
+    // No events should have been queued for NormGetNextEvent()
+    NormEvent theEvent;
+    if (0 != NormGetNextEvents(loopback.GetInstance(), &theEvent, 1, 0.0))
+    {
+        fprintf(stderr, "normApiTest: reentry: event queued in callback mode\n");
+        result = false;
+    }
+    loopback.Close();
+    delete[] txData;
+    fprintf(stderr, "normApiTest: reentry: new:%u cancelled:%u completed:%u nested:%d error:%d\n",
+                    state.rxNewCount, state.rxCancelCount, state.rxCompleteCount, state.nested, state.error);
+    return (result && !state.nested && !state.error && (OBJECT_COUNT == state.rxNewCount) &&
+            ((OBJECT_COUNT / 2) == state.rxCancelCount) && ((OBJECT_COUNT / 2) == state.rxCompleteCount));
+}  // end TestCallbackReentry()
+
+// Re-enqueues from within the callback for NORM_TX_FLUSH_COMPLETED so 
+// the (one object) tx cache purges the prior object, raising a 
+// NORM_TX_OBJECT_PURGED event that must be passed after it returns
+static void OnHeldEvent(const void* userData, const NormEvent* theEvent)
+{
+    CallbackState* state = (CallbackState*)userData;
+    if (state->inCallback) state->nested = true;
+    state->inCallback = true;
+    switch (theEvent->type)
+    {
+        case NORM_TX_FLUSH_COMPLETED:
+            if (!state->requeued)
+            {
+                state->requeued = true;
+                state->inFlushHandler = true;
+                if (NORM_OBJECT_INVALID == NormDataEnqueue(state->session, state->txData, state->txSize))
+                    state->error = true;
+                state->inFlushHandler = false;
+            }
+            break;
+        case NORM_TX_OBJECT_PURGED:
+            if (state->inFlushHandler) state->purgedInHandler = true;
+            state->txPurgedCount++;
+            break;
+        case NORM_RX_OBJECT_COMPLETED:
+            state->rxCompleteCount++;
+            break;
+        default:
+            break;
+    }
+    state->inCallback = false;
+}  // end OnHeldEvent()
+
+// Checks that events raised by API calls made from the event callback are
+// passed to it once it returns (rather than left in the event queue)
+static bool TestCallbackHeldEvents()
+{
+    const UINT32 OBJECT_SIZE = 10000;
+    NormLoopback loopback;
+    if (!loopback.Open(6111)) return false;
+    NormSessionHandle session = loopback.GetSession();
+    NormSetTxCacheBounds(session, 16*1024*1024, 1, 1);
+    CallbackState state;
+    InitCallbackState(state, session);
+    state.txData = new char[OBJECT_SIZE];
+    state.txSize = OBJECT_SIZE;
+    FillPattern(state.txData, OBJECT_SIZE, 1);
+    bool result = NormSetEventCallback(loopback.GetInstance(), OnHeldEvent, &state) &&
+                  (NORM_OBJECT_INVALID != NormDataEnqueue(session, state.txData, OBJECT_SIZE));
+    if (!result) fprintf(stderr, "normApiTest: held: setup error\n");
+    volatile bool done = false;
+    for (double t = 0.0; result && !done && (t < 5.0); t += 0.01)
+    {
+        done = (0 != state.txPurgedCount) && (state.rxCompleteCount >= 2);
+        if (!done) SleepSec(0.01);
+    }
+    NormEvent theEvent;
+    if (0 != NormGetNextEvents(loopback.GetInstance(), &theEvent, 1, 0.0))
+    {
+        fprintf(stderr, "normApiTest: held: event queued in callback mode\n");
+        result = false;
+    }
+    loopback.Close();
+    delete[] state.txData;
+    fprintf(stderr, "normApiTest: held: purged:%u completed:%u purgedInHandler:%d nested:%d error:%d\n",
+                    state.txPurgedCount, state.rxCompleteCount, state.purgedInHandler, state.nested, state.error);
+    return (result && done && !state.nested && !state.error && !state.purgedInHandler);
+}  // end TestCallbackHeldEvents()
+
+// Runs the loopback session on the second thread of a two thread instance
+// and checks that the application's instance handle is what NormGetInstance()
+// returns for it (and for the sessions of its events)
+static bool TestShardedInstance()
+{
+    const unsigned int OBJECT_COUNT = 5;
+    const UINT32 OBJECT_SIZE = 10000;
+    NormLoopback loopback;
+    if (!loopback.Open(6113, 2)) return false;
+    NormInstanceHandle instance = loopback.GetInstance();
+    bool result = true;
+    if (instance != NormGetInstance(loopback.GetSession()))
+    {
+        fprintf(stderr, "normApiTest: sharded: NormGetInstance() didn't return the instance\n");
+        result = false;
+    }
+    char* txData = new char[OBJECT_COUNT * OBJECT_SIZE];
+    for (unsigned int i = 0; result && (i < OBJECT_COUNT); i++)
+    {
+        char* dataPtr = txData + (i * OBJECT_SIZE);
+        FillPattern(dataPtr, OBJECT_SIZE, i);
+        result = (NORM_OBJECT_INVALID != NormDataEnqueue(loopback.GetSession(), dataPtr, OBJECT_SIZE));
+    }
+    unsigned int rxCount = 0;
+    NormEvent theEvent;
+    while (result && (rxCount < OBJECT_COUNT) && loopback.GetNextEvent(theEvent, 5.0))
+    {
+        if (instance != NormGetInstance(theEvent.session))
+        {
+            fprintf(stderr, "normApiTest: sharded: event session instance mismatch\n");
+            result = false;
+        }
+        if (NORM_RX_OBJECT_COMPLETED != theEvent.type) continue;
+        if (CheckPattern(NormDataAccessData(theEvent.object), 
+                         (UINT32)NormObjectGetSize(theEvent.object), OBJECT_SIZE) < 0)
+        {
+            fprintf(stderr, "normApiTest: sharded: invalid received content\n");
+            result = false;
+        }
+        rxCount++;
+    }
+    unsigned long overflowCount = NormGetEventOverflowCount(instance);
+    loopback.Close();
+    delete[] txData;
+    fprintf(stderr, "normApiTest: sharded: rxCount:%u overflowCount:%lu\n", rxCount, overflowCount);
+    return (result && (OBJECT_COUNT == rxCount) && (0 == overflowCount));
+}  // end TestShardedInstance()
+
+typedef bool (*TestFunction)();
+struct TestItem
+{
+    const char*     name;
+    TestFunction    func;
+};
+static const TestItem TEST_LIST[] =
+{
+    {"overflow",    TestEventOverflow},
+    {"ring",        TestWriteRing},
+    {"ringclose",   TestWriteRingClose},
+    {"peek",        TestPeekSegments},
+    {"getters",     TestStatusGetters},
+    {"writebehind", TestWriteBehind},
+    {"readahead",   TestReadAhead},
+    {"resume",      TestFileResume},
+    {"rescan",      TestFileListUpdates},
+    {"datav",       TestDataEnqueueV},
+    {"datavfail",   TestDataEnqueueVFailure},
+    {"placement",   TestDataPlacement},
+    {"placementsharded", TestDataPlacementSharded},
+    {"reentry",     TestCallbackReentry},
+    {"held",        TestCallbackHeldEvents},
+    {"sharded",     TestShardedInstance},
+    {NULL,          NULL}
+};
+
+int main(int argc, char* argv[])
+{
+    const TestItem* test = TEST_LIST;
+    if (argc > 1)
+    {
+        while ((NULL != test->name) && (0 != strcmp(test->name, argv[1]))) test++;
+    }
+    if ((2 != argc) || (NULL == test->name))
+    {
+        fprintf(stderr, "Usage: normApiTest <testName>\n   tests:");
+        for (test = TEST_LIST; NULL != test->name; test++)
+            fprintf(stderr, " %s", test->name);
+        fprintf(stderr, "\n");
+        return -1;
+    }
+    bool result = test->func();
+    fprintf(stderr, "normApiTest: %s: %s\n", test->name, result ? "passed" : "FAILED");
+    return (result ? 0 : -1);
+}  // end main()
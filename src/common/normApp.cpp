@@ -90,6 +90,9 @@ class NormApp : public NormController, public ProtoApp
                         class NormObject*     object);
         
         bool OnIntervalTimeout(ProtoTimer& theTimer);
+        void OnTxFileQueued(NormFileObject* obj);
+        UINT16 GetTxFileInfo(const char* fileName, char* infoBuffer);
+        bool BuildTxBundle();
         void OnControlEvent(ProtoSocket& theSocket, ProtoSocket::Event theEvent);
     
         static const char* const cmd_list[];
@@ -172,6 +175,10 @@ class NormApp : public NormController, public ProtoApp
         char                tx_file_name[PATH_MAX];
         bool                tx_file_info;
         ProtoTree           tx_file_cache; 
+        unsigned long       tx_bundle_max;    // files smaller than this are bundled (0 = no bundling)
+        NormFileBundle      tx_bundle;
+        bool                tx_bundle_pending;
+        bool                tx_compress;
         bool                tx_one_shot;
         bool                tx_ack_shot;
         bool                tx_file_queued;
@@ -205,6 +212,7 @@ class NormApp : public NormController, public ProtoApp
         int                 rx_robust_factor;
         bool                rx_persistent;
         bool                process_aborted_files;
+        bool                rx_resume;
         bool                preallocate_sender;
         NormSenderNode::RepairBoundary repair_boundary;
         
@@ -242,12 +250,12 @@ NormApp::NormApp()
    backoff_factor(NormSession::DEFAULT_BACKOFF_FACTOR), grtt_estimate(NormSession::DEFAULT_GRTT_ESTIMATE), 
    grtt_probing_mode(NormSession::PROBE_ACTIVE), group_size(NormSession::DEFAULT_GSIZE_ESTIMATE),
    tx_buffer_size(1024*1024), tx_sock_buffer_size(0), tx_cache_min(8), tx_cache_max(256), tx_cache_size((UINT32)20*1024*1024),
-   tx_file_info(true), tx_one_shot(false), tx_ack_shot(false), tx_file_queued(false),
+   tx_file_info(true), tx_bundle_max(0), tx_bundle_pending(false), tx_compress(false), tx_one_shot(false), tx_ack_shot(false), tx_file_queued(false),
    tx_robust_factor(NormSession::DEFAULT_ROBUST_FACTOR), tx_object_interval(0.0), tx_repeat_count(0), 
    tx_repeat_interval(2.0), tx_repeat_clear(true), tx_requeue(0), tx_requeue_count(0), acking_node_list(NULL), 
    acking_flushes(false), watermark_pending(false), rx_buffer_size(1024*1024), rx_sock_buffer_size(0),
    rx_cache_path(NULL), post_processor(NULL), unicast_nacks(false), silent_receiver(false), 
-   low_delay(false), realtime(false), rx_robust_factor(NormSession::DEFAULT_ROBUST_FACTOR), rx_persistent(true), process_aborted_files(false),
+   low_delay(false), realtime(false), rx_robust_factor(NormSession::DEFAULT_ROBUST_FACTOR), rx_persistent(true), process_aborted_files(false), rx_resume(false),
    preallocate_sender(false), repair_boundary(NormSenderNode::BLOCK_BOUNDARY), tracing(false), tx_loss(0.0), rx_loss(0.0)
 {
     control_pipe.SetListener(this, &NormApp::OnControlEvent);
@@ -275,6 +283,7 @@ NormApp::~NormApp()
     if (interface_name) delete[] interface_name;
     
     tx_file_cache.Destroy();
+    if (tx_bundle_pending) NormFile::Unlink(tx_bundle.GetPath());
     
     if (rx_cache_path) delete[] rx_cache_path;
     if (post_processor) delete post_processor;
@@ -347,6 +356,8 @@ const char* const NormApp::cmd_list[] =
     "+repeatcount",  // How many times to repeat the file/directory list tx
     "+rinterval",    // Interval (sec) between file/directory list repeats
     "+requeue",      // <count> how many times files are retransmitted w/ same objId
+    "+bundle",       // <sizeMax> send files smaller than <sizeMax> bytes packed into bundle objects of about <sizeMax>
+    "-compress",     // send files compressed (when that makes them smaller)
     "+boundary",     // 'block' or 'file' to set NORM_REPAIR_BOUNDARY (default is 'block')
     "-oneshot",      // Transmit file(s), exiting upon TX_FLUSH_COMPLETED
     "-ackshot",      // Transmit file(s), exiting upon TX_WATERMARK_COMPLETED
@@ -377,6 +388,7 @@ const char* const NormApp::cmd_list[] =
     "-realtime",     // for NACKing (non-silent) receivers, flips buffer mgmnt to favor low latency over reliability
     "+rxpersist",    // "off" or "on" to make receiver keep state on sender forever ("on" by default)
     "-saveAborts",   // save (and possibly post-process) aborted receive files\n"
+    "-rxresume",     // keep partially received files and their state to resume reception after restart
     "+processor",    // receive file post processing command
     "+instance",     // specify norm instance name for remote control commands
     "-precise",      // run the NormApp ProtoDispatcher in "precise timing" mode
@@ -420,6 +432,8 @@ void NormApp::ShowHelp()
         "   +repeatcount,  // How many times to repeat the file/directory list tx\n"
         "   +rinterval,    // Interval (sec) between file/directory list repeats\n"
         "   +requeue,      // <count> how many times files are retransmitted w/ same objId\n"
+        "   +bundle,       // <sizeMax> send files smaller than <sizeMax> bytes packed into bundle objects of about <sizeMax>\n"
+        "   -compress,     // send files compressed (when that makes them smaller, all receivers must support it)\n"
         "   +boundary      // 'block' or 'file' to set NORM_REPAIR_BOUNDARY (default is 'block')\n"
         "   -oneshot,      // Exit upon sender TX_FLUSH_COMPLETED event (sender exits after transmission)\n"
         "   -ackshot,      // Exit upon sender TX_WATERMARK_COMPLETED event (sender exits after transmission)\n"
@@ -448,6 +462,7 @@ void NormApp::ShowHelp()
         "   -realtime,     // for NACKing (non-silent) receivers, flips buffer mgmnt to favor low latency over reliability\n"
         "   +rxpersist,    // 'off' or 'on' to make receiver keep state on sender forever ('on' by default)\n"
         "   -saveAborts,   // save (and possibly post-process) aborted receive files\n"
+        "   -rxresume,     // keep partially received files and their state to resume reception after restart\n"
         "   +processor,    // receive file post processing command\n"
         "   +instance,     // specify norm instance name for remote control commands\n"
         "   -precise,      // run the NormApp ProtoDispatcher in 'precise timing' mode\n"
@@ -911,6 +926,18 @@ bool NormApp::OnCommand(const char* cmd, const char* val)
     {
         tx_requeue = tx_requeue_count = atoi(val); 
     } 
+    else if (!strncmp("bundle", cmd, len))
+    {
+        if (1 != sscanf(val, "%lu", &tx_bundle_max))
+        {
+            PLOG(PL_FATAL, "NormApp::OnCommand(bundle) invalid bundle size: %s\n", val);
+            return false;
+        }
+    }
+    else if (!strncmp("compress", cmd, len))
+    {
+        tx_compress = true;
+    }
     else if (!strncmp("boundary", cmd, len))
     {
         if (0 == strcmp("block", val))
@@ -1199,6 +1226,10 @@ bool NormApp::OnCommand(const char* cmd, const char* val)
     {
         process_aborted_files = true;
     }
+    else if (!strncmp("rxresume", cmd, len))
+    {
+        rx_resume = true;
+    }
     else if (!strncmp("push", cmd, len))
     {
         push_mode = true;
@@ -1630,6 +1661,16 @@ void NormApp::Notify(NormController::Event event,
             PLOG(PL_DEBUG, "NormApp::Notify(TX_OBJECT_SENT) ...\n");
             break;
             
+        case TX_OBJECT_PURGED:
+            PLOG(PL_DEBUG, "NormApp::Notify(TX_OBJECT_PURGED) ...\n");
+            // Delete our temporary bundle files once they're no longer needed
+            if ((NULL != object) && (NormObject::FILE == object->GetType()) &&
+                NormFileBundle::IsBundleInfo(object->GetInfo(), object->GetInfoLength()))
+            {
+                NormFile::Unlink(static_cast<NormFileObject*>(object)->GetPath());
+            }
+            break;
+            
         case TX_FLUSH_COMPLETED:
             PLOG(PL_DEBUG, "NormApp::Notify(TX_FLUSH_COMPLETED) ...\n");
             if (tx_one_shot)
@@ -1775,6 +1816,9 @@ void NormApp::Notify(NormController::Event event,
             {
                 case NormObject::FILE:
                 {
+                    // Bundles keep their temp name and are unpacked upon completion
+                    if (NormFileBundle::IsBundleInfo(object->GetInfo(), object->GetInfoLength()))
+                        break;
                     // Rename rx file using newly received info
                     char fileName[PATH_MAX];
                     strncpy(fileName, rx_cache_path, PATH_MAX);
@@ -1978,7 +2022,25 @@ void NormApp::Notify(NormController::Event event,
                 {
                     const char* filePath = static_cast<NormFileObject*>(object)->GetPath();
                     //DMSG(0, "norm: Completed rx file: %s\n", filePath);
-                    if (post_processor->IsEnabled())
+                    if (NormFileBundle::IsBundleInfo(object->GetInfo(), object->GetInfoLength()))
+                    {
+                        // Unpack (and post process) the bundled files, then delete the bundle
+                        NormFileBundle bundle;
+                        if (bundle.Open(filePath))
+                        {
+                            char memberPath[PATH_MAX];
+                            while (bundle.Extract(rx_cache_path, memberPath))
+                            {
+                                if (post_processor->IsEnabled() && !post_processor->ProcessFile(memberPath))
+                                    PLOG(PL_ERROR, "norm: post processing error\n");
+                            }
+                            if (!bundle.IsDone())
+                                PLOG(PL_ERROR, "norm: error unpacking rx file bundle\n");
+                            bundle.Close();
+                        }
+                        NormFile::Unlink(filePath);
+                    }
+                    else if (post_processor->IsEnabled())
                     {
                         if (!post_processor->ProcessFile(filePath))
                         {
@@ -2015,7 +2077,13 @@ void NormApp::Notify(NormController::Event event,
                 case NormObject::FILE:
                 {
                     const char* filePath = static_cast<NormFileObject*>(object)->GetPath();
-                    if (process_aborted_files)
+                    if (rx_resume)
+                    {
+                        // keep the partial file (and its resume state)
+                    }
+                    // (partial bundles are always discarded)
+                    else if (process_aborted_files &&
+                        !NormFileBundle::IsBundleInfo(object->GetInfo(), object->GetInfoLength()))
                     {
                         // in case file size isn't padded properly
                         static_cast<NormFileObject*>(object)->PadToSize();
@@ -2056,10 +2124,137 @@ void NormApp::Notify(NormController::Event event,
 }  // end NormApp::Notify()
 
 
+// Builds the NORM_INFO (name relative to the current tx_file_list
+// base path with '/' delimiters) for a tx file and returns its length
+UINT16 NormApp::GetTxFileInfo(const char* fileName, char* infoBuffer)
+{
+    char pathName[PATH_MAX];
+    tx_file_list.GetCurrentBasePath(pathName);
+    size_t len = strlen(pathName);
+    len = MIN(len, PATH_MAX);
+    size_t maxLen = PATH_MAX - len;
+    const char* ptr = fileName + len;
+    len = strlen(ptr);
+    len = MIN(len, maxLen);
+    // (TBD) Make sure len <= segment_size)
+    strncpy(infoBuffer, ptr, len);
+    // Normalize directory delimiters in file name info
+    for (unsigned int i = 0; i < len; i++)
+    {
+        if (PROTO_PATH_DELIMITER == infoBuffer[i]) 
+            infoBuffer[i] = '/';
+    }
+    return (UINT16)len;
+}  // end NormApp::GetTxFileInfo()
+
+// Packs consecutive tx files smaller than "tx_bundle_max" into "tx_bundle"
+// until it reaches about "tx_bundle_max" bytes.  A larger file that is
+// encountered is left in "tx_file_name" to be sent on its own.  (The
+// bundle is closed early if the tx_file_list directory scan falls behind.)
+// Returns false if no files were bundled.
+bool NormApp::BuildTxBundle()
+{
+    char fileName[PATH_MAX];
+    NormFile::Offset fileSize;
+    while (tx_file_list.IsReady() && tx_file_list.GetNextFile(fileName, &fileSize))
+    {
+        if ((NormFile::Offset)tx_bundle_max <= fileSize)
+        {
+            strcpy(tx_file_name, fileName);
+            break;
+        }
+        if (!tx_bundle.IsOpen())
+        {
+            if (!tx_bundle.Create(NormFile::GetTempDir()))
+            {
+                PLOG(PL_ERROR, "NormApp::BuildTxBundle() error creating bundle (sending file unbundled)\n");
+                strcpy(tx_file_name, fileName);
+                return false;
+            }
+        }
+        char fileNameInfo[PATH_MAX];
+        UINT16 infoLen = GetTxFileInfo(fileName, fileNameInfo);
+        if (!tx_bundle.Append(fileName, fileNameInfo, infoLen))
+        {
+            if (tx_bundle.IsOpen()) continue;  // skip unreadable file
+            PLOG(PL_ERROR, "NormApp::BuildTxBundle() error writing bundle\n");
+            NormFile::Unlink(tx_bundle.GetPath());
+            return false;
+        }
+        if (tx_bundle.GetSize() >= (NormFile::Offset)tx_bundle_max) break;
+    }
+    if (!tx_bundle.IsOpen()) return false;
+    tx_bundle.Close();
+    if (0 == tx_bundle.GetCount())
+    {
+        NormFile::Unlink(tx_bundle.GetPath());
+        return false;
+    }
+    return true;
+}  // end NormApp::BuildTxBundle()
+
+// Common bookkeeping after a tx file (or bundle) object has been enqueued
+void NormApp::OnTxFileQueued(NormFileObject* obj)
+{
+    tx_file_queued = true;
+    
+    struct timeval currentTime;
+    ProtoSystemTime(currentTime);
+    time_t secs = (time_t)currentTime.tv_sec;
+    struct tm* timePtr = gmtime(&secs); 
+    PLOG(PL_INFO, "%02d:%02d:%02d.%06lu enqueued tx object>%hu sender>%lu\n",
+		    timePtr->tm_hour, timePtr->tm_min, timePtr->tm_sec, 
+		    (unsigned long)currentTime.tv_usec, (UINT16)obj->GetId(), session->LocalNodeId());
+    
+    // save last obj/block/seg id for later in case needed
+    tx_last_object_id = obj->GetId();
+    tx_last_block_id = obj->GetFinalBlockId();
+    tx_last_segment_id = obj->GetBlockSize(tx_last_block_id) - 1;
+    if (!watermark_pending && (NULL != acking_node_list) && !tx_ack_shot)
+    {
+        session->SenderSetWatermark(tx_last_object_id, 
+                                    tx_last_block_id,
+                                    tx_last_segment_id,
+                                    acking_flushes);
+        watermark_pending = true;  // only allow one pending watermark at a time
+    }
+    interval_timer.SetInterval(tx_object_interval);
+}  // end NormApp::OnTxFileQueued()
+
 bool NormApp::OnIntervalTimeout(ProtoTimer& theTimer)
 {
     char fileName[PATH_MAX];
-    if (('\0' != tx_file_name[0]) || tx_file_list.GetNextFile(fileName))
+    if (!tx_bundle_pending && ('\0' == tx_file_name[0]) && !tx_file_list.IsReady())
+    {
+        // The tx_file_list directory scan hasn't caught up, so
+        // check back shortly instead of blocking here
+        if (interval_timer.IsActive()) interval_timer.Deactivate();
+        interval_timer.SetInterval(0.010);
+        ActivateTimer(interval_timer);
+        return false;
+    }
+    if (tx_bundle_pending || 
+        ((0 != tx_bundle_max) && ('\0' == tx_file_name[0]) && BuildTxBundle()))
+    {
+        tx_repeat_clear = true;
+        // Bundles are marked with their NORM_INFO (member 
+        // file names are carried in the bundle's index)
+        NormFileObject* obj = session->QueueTxFile(tx_bundle.GetPath(), 
+                                                   NormFileBundle::GetInfo(),
+                                                   NormFileBundle::GetInfoLength());
+        if (NULL == obj)
+        {
+            // As below, assume flow control and re-attempt upon TX_QUEUE_EMPTY
+            PLOG(PL_DEBUG, "NormApp::OnIntervalTimeout() error queuing tx bundle: %s\n", tx_bundle.GetPath());
+            tx_bundle_pending = true;
+            if (interval_timer.IsActive()) interval_timer.Deactivate();
+            return false;
+        }
+        tx_bundle_pending = false;
+        PLOG(PL_DEBUG, "NormApp::OnIntervalTimeout() queued bundle of %lu files\n", tx_bundle.GetCount());
+        OnTxFileQueued(obj);
+    }
+    else if (('\0' != tx_file_name[0]) || tx_file_list.GetNextFile(fileName))
     {
         tx_repeat_clear = true;
         
@@ -2070,24 +2265,9 @@ bool NormApp::OnIntervalTimeout(ProtoTimer& theTimer)
         else
             strcpy(fileName, tx_file_name);  // used cached tx_file_name for enqueue re-attempt
         
-        // 1) Build up the full path name of the file
-        char pathName[PATH_MAX];
-        tx_file_list.GetCurrentBasePath(pathName);
-        size_t len = strlen(pathName);
-        len = MIN(len, PATH_MAX);
-        size_t maxLen = PATH_MAX - len;
-        char* ptr = fileName + len;
-        len = strlen(ptr);
-        len = MIN(len, maxLen);
-        // (TBD) Make sure len <= segment_size)
+        // 1) Build up the file name info
         char fileNameInfo[PATH_MAX];
-        strncpy(fileNameInfo, ptr, len);
-        // Normalize directory delimiters in file name info
-        for (unsigned int i = 0; i < len; i++)
-        {
-            if (PROTO_PATH_DELIMITER == fileNameInfo[i]) 
-                fileNameInfo[i] = '/';
-        }
+        UINT16 len = GetTxFileInfo(fileName, fileNameInfo);
         
         FileCacheItem* fileCacheItem = NULL;
         NormFileObject* obj = NULL;
@@ -2156,32 +2336,7 @@ bool NormApp::OnIntervalTimeout(ProtoTimer& theTimer)
                     fileCacheItem->SetObjectId(obj->GetId());
             }
         }
-        
-        tx_file_queued = true;
-        
-        
-        struct timeval currentTime;
-        ProtoSystemTime(currentTime);
-        time_t secs = (time_t)currentTime.tv_sec;
-        struct tm* timePtr = gmtime(&secs); 
-        PLOG(PL_INFO, "%02d:%02d:%02d.%06lu enqueued tx object>%hu sender>%lu\n",
-		        timePtr->tm_hour, timePtr->tm_min, timePtr->tm_sec, 
-		        (unsigned long)currentTime.tv_usec, (UINT16)obj->GetId(), session->LocalNodeId());
-        
-        // save last obj/block/seg id for later in case needed
-        tx_last_object_id = obj->GetId();
-        tx_last_block_id = obj->GetFinalBlockId();
-        tx_last_segment_id = obj->GetBlockSize(tx_last_block_id) - 1;
-        if (!watermark_pending && (NULL != acking_node_list) && !tx_ack_shot)
-        {
-            session->SenderSetWatermark(tx_last_object_id, 
-                                        tx_last_block_id,
-                                        tx_last_segment_id,
-                                        acking_flushes);
-            watermark_pending = true;  // only allow one pending watermark at a time
-        }
-        //DMSG(0, "norm: File \"%s\" queued for transmission.\n", fileName);
-        interval_timer.SetInterval(tx_object_interval);
+        OnTxFileQueued(obj);
     }
     else if (0 != tx_requeue_count)
     {
@@ -2321,6 +2476,7 @@ bool NormApp::OnStartup(int argc, const char*const* argv)
             session->SenderSetGroupSize(group_size);
             session->SetTxRobustFactor(tx_robust_factor);
             session->SetTxCacheBounds(tx_cache_size, tx_cache_min, tx_cache_max);
+            session->SetTxCompression(tx_compress);
             if (!AddAckingNodes(acking_node_list))
             {
                 PLOG(PL_FATAL, "NormApp::OnStartup() error: bad acking node list\n");
@@ -2383,6 +2539,12 @@ bool NormApp::OnStartup(int argc, const char*const* argv)
                 session->RcvrSetRealtime(true);           
             session->SetRxRobustFactor(rx_robust_factor);
             session->ReceiverSetDefaultRepairBoundary(repair_boundary);
+            if (rx_resume)
+            {
+                // Sync to objects already in progress so they may be resumed
+                session->SetRxFileResume(true);
+                session->ReceiverSetDefaultSyncPolicy(NormSenderNode::SYNC_ALL);
+            }
             if (!session->StartReceiver(rx_buffer_size))
             {
                 PLOG(PL_FATAL, "NormApp::OnStartup() start receiver error!\n");
@@ -0,0 +1,722 @@
+#include "normBitmask.h"
+
+#include <string.h>  // for memset()
+
+#if defined(_MSC_VER) && defined(_WIN64)
+#include <intrin.h>  // for _BitScanForward64(), etc
+#endif // _MSC_VER && _WIN64
+
+// Index of lowest set bit of a (non-zero) word
+static inline UINT32 NormBitLow(UINT64 word)
+{
+#if defined(__GNUC__)
+    return (UINT32)__builtin_ctzll(word);
+#elif defined(_MSC_VER) && defined(_WIN64)
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return (UINT32)index;
+#else
+    UINT32 index = 0;
+    if (0 == (word & 0xffffffff)) {word >>= 32; index += 32;}
+    if (0 == (word & 0xffff)) {word >>= 16; index += 16;}
+    if (0 == (word & 0xff)) {word >>= 8; index += 8;}
+    while (0 == (word & 0x01)) {word >>= 1; index++;}
+    return index;
+#endif
+}  // end NormBitLow()
+
+// Index of highest set bit of a (non-zero) word
+static inline UINT32 NormBitHigh(UINT64 word)
+{
+#if defined(__GNUC__)
+    return (UINT32)(63 - __builtin_clzll(word));
+#elif defined(_MSC_VER) && defined(_WIN64)
+    unsigned long index;
+    _BitScanReverse64(&index, word);
+    return (UINT32)index;
+#else
+    UINT32 index = 0;
+    if (0 != (word >> 32)) {word >>= 32; index += 32;}
+    if (0 != (word >> 16)) {word >>= 16; index += 16;}
+    if (0 != (word >> 8)) {word >>= 8; index += 8;}
+    while (0 != (word >>= 1)) index++;
+    return index;
+#endif
+}  // end NormBitHigh()
+
+static inline UINT32 NormBitCount(UINT64 word)
+{
+#if defined(__GNUC__)
+    return (UINT32)__builtin_popcountll(word);
+#else
+    word = word - ((word >> 1) & 0x5555555555555555ULL);
+    word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+    word = (word + (word >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    return (UINT32)((word * 0x0101010101010101ULL) >> 56);
+#endif
+}  // end NormBitCount()
+
+// Sets (or clears) "count" bits starting at "index", a word at a time
+static void NormFillBits(UINT64* mask, UINT32 index, UINT32 count, bool value)
+{
+    UINT32 w = index >> 6;
+    UINT32 bit = index & 0x3f;
+    if ((0 != bit) && (0 != count))
+    {
+        UINT32 n = 64 - bit;
+        if (n > count) n = count;
+        UINT64 bits = (((UINT64)1 << n) - 1) << bit;
+        if (value)
+            mask[w] |= bits;
+        else
+            mask[w] &= ~bits;
+        count -= n;
+        w++;
+    }
+    UINT64 fill = value ? ~((UINT64)0) : (UINT64)0;
+    while (count >= 64)
+    {
+        mask[w++] = fill;
+        count -= 64;
+    }
+    if (0 != count)
+    {
+        UINT64 bits = ((UINT64)1 << count) - 1;
+        if (value)
+            mask[w] |= bits;
+        else
+            mask[w] &= ~bits;
+    }
+}  // end NormFillBits()
+
+// Finds first set bit in range [index, limit)
+static bool NormFindNextSet(const UINT64* mask, UINT32& index, UINT32 limit)
+{
+    if (index >= limit) return false;
+    UINT32 w = index >> 6;
+    UINT32 wordEnd = (limit + 63) >> 6;
+    UINT64 word = mask[w] & (~((UINT64)0) << (index & 0x3f));
+    while (0 == word)
+    {
+        if (++w >= wordEnd) return false;
+        word = mask[w];
+    }
+    UINT32 pos = (w << 6) + NormBitLow(word);
+    if (pos >= limit) return false;
+    index = pos;
+    return true;
+}  // end NormFindNextSet()
+
+// Finds last set bit in range [floor, index]
+static bool NormFindPrevSet(const UINT64* mask, UINT32& index, UINT32 floor)
+{
+    if (index < floor) return false;
+    UINT32 w = index >> 6;
+    UINT32 wordFloor = floor >> 6;
+    UINT64 word = mask[w] & (~((UINT64)0) >> (63 - (index & 0x3f)));
+    while (0 == word)
+    {
+        if (w <= wordFloor) return false;
+        word = mask[--w];
+    }
+    UINT32 pos = (w << 6) + NormBitHigh(word);
+    if (pos < floor) return false;
+    index = pos;
+    return true;
+}  // end NormFindPrevSet()
+
+NormBitmask::NormBitmask()
+ : mask(NULL), mask_len(0), num_bits(0), first_set(0)
+{
+}
+
+NormBitmask::~NormBitmask()
+{
+    Destroy();
+}
+
+bool NormBitmask::Init(UINT32 numBits)
+{
+    if (NULL != mask) Destroy();
+    UINT32 len = (numBits + 63) >> 6;
+    if (0 == len) len = 1;
+    if (!(mask = new UINT64[len])) return false;
+    mask_len = len;
+    num_bits = numBits;
+    Clear();
+    return true;
+}  // end NormBitmask::Init()
+
+void NormBitmask::Destroy()
+{
+    if (NULL != mask)
+    {
+        delete[] mask;
+        mask = NULL;
+    }
+    mask_len = num_bits = first_set = 0;
+}  // end NormBitmask::Destroy()
+
+void NormBitmask::Clear()
+{
+    if (NULL != mask) memset(mask, 0, mask_len*sizeof(UINT64));
+    first_set = num_bits;
+}  // end NormBitmask::Clear()
+
+void NormBitmask::Reset(UINT32 index)
+{
+    Clear();
+    if (index < num_bits) SetBits(index, num_bits - index);
+}  // end NormBitmask::Reset()
+
+void NormBitmask::UpdateFirstSet(UINT32 index)
+{
+    if (!NormFindNextSet(mask, index, num_bits)) index = num_bits;
+    first_set = index;
+}  // end NormBitmask::UpdateFirstSet()
+
+bool NormBitmask::Set(UINT32 index)
+{
+    if (index >= num_bits) return false;
+    mask[index >> 6] |= ((UINT64)1 << (index & 0x3f));
+    if (index < first_set) first_set = index;
+    return true;
+}  // end NormBitmask::Set()
+
+bool NormBitmask::Unset(UINT32 index)
+{
+    if (index >= num_bits) return false;
+    mask[index >> 6] &= ~((UINT64)1 << (index & 0x3f));
+    if (index == first_set) UpdateFirstSet(index);
+    return true;
+}  // end NormBitmask::Unset()
+
+bool NormBitmask::SetBits(UINT32 index, UINT32 count)
+{
+    if (0 == count) return true;
+    if ((index >= num_bits) || (count > (num_bits - index))) return false;
+    NormFillBits(mask, index, count, true);
+    if (index < first_set) first_set = index;
+    return true;
+}  // end NormBitmask::SetBits()
+
+bool NormBitmask::UnsetBits(UINT32 index, UINT32 count)
+{
+    if ((index >= num_bits) || (0 == count)) return true;
+    if (count > (num_bits - index)) count = num_bits - index;
+    NormFillBits(mask, index, count, false);
+    if ((first_set >= index) && ((first_set - index) < count))
+        UpdateFirstSet(index + count);
+    return true;
+}  // end NormBitmask::UnsetBits()
+
+bool NormBitmask::GetNextSet(UINT32& index) const
+{
+    if (index <= first_set)
+    {
+        index = first_set;
+        return IsSet();
+    }
+    return NormFindNextSet(mask, index, num_bits);
+}  // end NormBitmask::GetNextSet()
+
+bool NormBitmask::GetPrevSet(UINT32& index) const
+{
+    if (!IsSet() || (index < first_set)) return false;
+    if (index >= num_bits) index = num_bits - 1;
+    return NormFindPrevSet(mask, index, first_set);
+}  // end NormBitmask::GetPrevSet()
+
+bool NormBitmask::GetNextUnset(UINT32& index) const
+{
+    UINT32 w = index >> 6;
+    if (index >= num_bits) return false;
+    UINT64 word = ~mask[w] & (~((UINT64)0) << (index & 0x3f));
+    while (0 == word)
+    {
+        if (++w >= mask_len) return false;
+        word = ~mask[w];
+    }
+    UINT32 pos = (w << 6) + NormBitLow(word);
+    if (pos >= num_bits) return false;
+    index = pos;
+    return true;
+}  // end NormBitmask::GetNextUnset()
+
+UINT32 NormBitmask::GetSetCount() const
+{
+    UINT32 count = 0;
+    if (!IsSet()) return 0;
+    for (UINT32 i = (first_set >> 6); i < mask_len; i++)
+        count += NormBitCount(mask[i]);
+    return count;
+}  // end NormBitmask::GetSetCount()
+
+bool NormBitmask::Copy(const NormBitmask& b)
+{
+    if (b.num_bits > num_bits) return false;
+    memcpy(mask, b.mask, b.mask_len*sizeof(UINT64));
+    if (mask_len > b.mask_len)
+        memset(mask + b.mask_len, 0, (mask_len - b.mask_len)*sizeof(UINT64));
+    first_set = b.IsSet() ? b.first_set : num_bits;
+    return true;
+}  // end NormBitmask::Copy()
+
+bool NormBitmask::Add(const NormBitmask& b)
+{
+    if (b.num_bits > num_bits) return false;
+    if (!b.IsSet()) return true;
+    for (UINT32 i = (b.first_set >> 6); i < b.mask_len; i++)
+        mask[i] |= b.mask[i];
+    if (b.first_set < first_set) first_set = b.first_set;
+    return true;
+}  // end NormBitmask::Add()
+
+bool NormBitmask::Subtract(const NormBitmask& b)
+{
+    UINT32 len = (b.mask_len < mask_len) ? b.mask_len : mask_len;
+    for (UINT32 i = 0; i < len; i++)
+        mask[i] &= ~b.mask[i];
+    UpdateFirstSet(first_set);
+    return true;
+}  // end NormBitmask::Subtract()
+
+bool NormBitmask::XCopy(const NormBitmask& b)
+{
+    if (b.num_bits > num_bits) return false;
+    for (UINT32 i = 0; i < b.mask_len; i++)
+        mask[i] = b.mask[i] & ~mask[i];
+    if (mask_len > b.mask_len)
+        memset(mask + b.mask_len, 0, (mask_len - b.mask_len)*sizeof(UINT64));
+    // (b's bits at/after num_bits are always zero)
+    UpdateFirstSet(b.IsSet() ? b.first_set : num_bits);
+    return true;
+}  // end NormBitmask::XCopy()
+
+bool NormBitmask::Multiply(const NormBitmask& b)
+{
+    UINT32 len = (b.mask_len < mask_len) ? b.mask_len : mask_len;
+    for (UINT32 i = 0; i < len; i++)
+        mask[i] &= b.mask[i];
+    if (mask_len > len)
+        memset(mask + len, 0, (mask_len - len)*sizeof(UINT64));
+    UpdateFirstSet(first_set);
+    return true;
+}  // end NormBitmask::Multiply()
+
+bool NormBitmask::Xor(const NormBitmask& b)
+{
+    if (b.num_bits > num_bits) return false;
+    for (UINT32 i = 0; i < b.mask_len; i++)
+        mask[i] ^= b.mask[i];
+    UpdateFirstSet((b.first_set < first_set) ? b.first_set : first_set);
+    return true;
+}  // end NormBitmask::Xor()
+
+void NormBitmask::Display(FILE* stream) const
+{
+    for (UINT32 i = 0; i < num_bits; i++)
+    {
+        fprintf(stream, Test(i) ? "1" : "0");
+        if (0x3f == (i & 0x3f)) fprintf(stream, "\n");
+    }
+}  // end NormBitmask::Display()
+
+
+NormSlidingMask::NormSlidingMask()
+ : mask(NULL), mask_len(0), cap_bits(0), num_bits(0),
+   range_mask(0xffffffff), range_sign(0x80000000),
+   start(0), end(0), offset(0)
+{
+}
+
+NormSlidingMask::~NormSlidingMask()
+{
+    Destroy();
+}
+
+bool NormSlidingMask::Init(INT32 numBits, UINT32 rangeMask)
+{
+    if (numBits < 0) return false;
+    if (NULL != mask) Destroy();
+    UINT32 len = ((UINT32)numBits + 63) >> 6;
+    if (0 == len) len = 1;
+    if (!(mask = new UINT64[len])) return false;
+    memset(mask, 0, len*sizeof(UINT64));
+    mask_len = len;
+    cap_bits = len << 6;
+    num_bits = numBits;
+    range_mask = rangeMask;
+    range_sign = rangeMask ^ (rangeMask >> 1);
+    start = end = cap_bits;
+    offset = 0;
+    return true;
+}  // end NormSlidingMask::Init()
+
+bool NormSlidingMask::Resize(INT32 numBits)
+{
+    if (numBits < 0) return false;
+    bool wasSet = IsSet();
+    UINT32 span = wasSet ? Span() : 0;
+    if (span > (UINT32)numBits) return false;  // current content won't fit
+    UINT32 len = ((UINT32)numBits + 63) >> 6;
+    if (0 == len) len = 1;
+    if (len == mask_len)
+    {
+        num_bits = numBits;
+        return true;
+    }
+    UINT64* newMask = new UINT64[len];
+    if (NULL == newMask) return false;
+    memset(newMask, 0, len*sizeof(UINT64));
+    // Copy set bits, rebasing the first set bit to position zero
+    UINT32 delta = 0;
+    while (delta < span)
+    {
+        delta += ScanForward(Position(delta), span - delta);
+        if (delta >= span) break;
+        newMask[delta >> 6] |= ((UINT64)1 << (delta & 0x3f));
+        delta++;
+    }
+    delete[] mask;
+    mask = newMask;
+    mask_len = len;
+    cap_bits = len << 6;
+    num_bits = numBits;
+    if (wasSet)
+    {
+        start = 0;
+        end = span - 1;
+    }
+    else
+    {
+        start = end = cap_bits;
+    }
+    return true;
+}  // end NormSlidingMask::Resize()
+
+void NormSlidingMask::Destroy()
+{
+    if (NULL != mask)
+    {
+        delete[] mask;
+        mask = NULL;
+    }
+    mask_len = cap_bits = 0;
+    num_bits = 0;
+    start = end = offset = 0;
+}  // end NormSlidingMask::Destroy()
+
+void NormSlidingMask::Clear()
+{
+    if (IsSet()) FillPositions(start, Span(), false);
+    start = end = cap_bits;
+}  // end NormSlidingMask::Clear()
+
+void NormSlidingMask::Reset(UINT32 index)
+{
+    Clear();
+    if (num_bits > 0)
+    {
+        start = 0;
+        end = (UINT32)num_bits - 1;
+        offset = index & RangeMask();
+        FillPositions(0, (UINT32)num_bits, true);
+    }
+}  // end NormSlidingMask::Reset()
+
+UINT32 NormSlidingMask::ScanForward(UINT32 pos, UINT32 limit) const
+{
+    UINT32 first = cap_bits - pos;
+    if (first > limit) first = limit;
+    UINT32 index = pos;
+    if (NormFindNextSet(mask, index, pos + first)) return (index - pos);
+    if (limit > first)
+    {
+        index = 0;
+        if (NormFindNextSet(mask, index, limit - first)) return (first + index);
+    }
+    return limit;
+}  // end NormSlidingMask::ScanForward()
+
+UINT32 NormSlidingMask::ScanBackward(UINT32 pos, UINT32 limit) const
+{
+    UINT32 first = pos + 1;
+    if (first > limit) first = limit;
+    UINT32 index = pos;
+    if (NormFindPrevSet(mask, index, pos + 1 - first)) return (pos - index);
+    if (limit > first)
+    {
+        index = cap_bits - 1;
+        if (NormFindPrevSet(mask, index, cap_bits - (limit - first)))
+            return (first + (cap_bits - 1 - index));
+    }
+    return limit;
+}  // end NormSlidingMask::ScanBackward()
+
+void NormSlidingMask::FillPositions(UINT32 pos, UINT32 count, bool value)
+{
+    UINT32 first = cap_bits - pos;
+    if (first > count) first = count;
+    NormFillBits(mask, pos, first, value);
+    if (count > first) NormFillBits(mask, 0, count - first, value);
+}  // end NormSlidingMask::FillPositions()
+
+bool NormSlidingMask::Test(UINT32 index) const
+{
+    if (!IsSet()) return false;
+    INT32 delta = Difference(index, offset);
+    if ((delta < 0) || ((UINT32)delta >= Span())) return false;
+    return TestPosition(Position((UINT32)delta));
+}  // end NormSlidingMask::Test()
+
+bool NormSlidingMask::CanSet(UINT32 index) const
+{
+    if (!IsSet()) return (num_bits > 0);
+    INT32 delta = Difference(index, offset);
+    if (delta >= 0)
+        return (delta < num_bits);
+    UINT32 back = (UINT32)0 - (UINT32)delta;
+    return (back <= ((UINT32)num_bits - Span()));
+}  // end NormSlidingMask::CanSet()
+
+bool NormSlidingMask::Set(UINT32 index)
+{
+    if (!IsSet())
+    {
+        if (num_bits <= 0) return false;
+        start = end = 0;
+        offset = index & RangeMask();
+        mask[0] |= (UINT64)1;
+        return true;
+    }
+    INT32 delta = Difference(index, offset);
+    UINT32 pos;
+    if (delta >= 0)
+    {
+        if (delta >= num_bits) return false;
+        pos = Position((UINT32)delta);
+        if ((UINT32)delta >= Span()) end = pos;
+    }
+    else
+    {
+        UINT32 back = (UINT32)0 - (UINT32)delta;
+        if (back > ((UINT32)num_bits - Span())) return false;
+        pos = (start >= back) ? (start - back) : (start + cap_bits - back);
+        start = pos;
+        offset = index & RangeMask();
+    }
+    mask[pos >> 6] |= ((UINT64)1 << (pos & 0x3f));
+    return true;
+}  // end NormSlidingMask::Set()
+
+bool NormSlidingMask::Unset(UINT32 index)
+{
+    if (!Test(index)) return true;
+    UINT32 span = Span();
+    UINT32 delta = (UINT32)Difference(index, offset);
+    UINT32 pos = Position(delta);
+    mask[pos >> 6] &= ~((UINT64)1 << (pos & 0x3f));
+    if (1 == span)
+    {
+        start = end = cap_bits;
+    }
+    else if (0 == delta)
+    {
+        // Find new first set bit (the "end" bit is still set)
+        UINT32 dist = 1 + ScanForward(Position(1), span - 1);
+        start = Position(dist);
+        offset = (offset + dist) & RangeMask();
+    }
+    else if ((span - 1) == delta)
+    {
+        // Find new last set bit (the "start" bit is still set)
+        UINT32 dist = ScanBackward(Position(delta - 1), delta);
+        end = Position(delta - 1 - dist);
+    }
+    return true;
+}  // end NormSlidingMask::Unset()
+
+bool NormSlidingMask::SetBits(UINT32 index, INT32 count)
+{
+    if (count <= 0) return true;
+    if (count > num_bits) return false;
+    UINT32 lastIndex = (index + (UINT32)count - 1) & RangeMask();
+    if (!CanSet(index) || !CanSet(lastIndex)) return false;
+    Set(index);  // these establish new first/last positions as needed
+    Set(lastIndex);
+    UINT32 delta = (UINT32)Difference(index, offset);
+    FillPositions(Position(delta), (UINT32)count, true);
+    return true;
+}  // end NormSlidingMask::SetBits()
+
+bool NormSlidingMask::UnsetBits(UINT32 index, INT32 count)
+{
+    if (!IsSet() || (count <= 0)) return true;
+    UINT32 span = Span();
+    INT32 delta = Difference(index, offset);
+    UINT32 first, num;
+    if (delta < 0)
+    {
+        UINT32 back = (UINT32)0 - (UINT32)delta;
+        if (back >= (UINT32)count) return true;
+        first = 0;
+        num = (UINT32)count - back;
+    }
+    else
+    {
+        if ((UINT32)delta >= span) return true;
+        first = (UINT32)delta;
+        num = (UINT32)count;
+    }
+    if (num > (span - first)) num = span - first;
+    FillPositions(Position(first), num, false);
+    if (0 == first)
+    {
+        if (num == span)
+        {
+            start = end = cap_bits;
+        }
+        else
+        {
+            UINT32 dist = num + ScanForward(Position(num), span - num);
+            start = Position(dist);
+            offset = (offset + dist) & RangeMask();
+        }
+    }
+    else if ((first + num) == span)
+    {
+        UINT32 dist = ScanBackward(Position(first - 1), first);
+        end = Position(first - 1 - dist);
+    }
+    return true;
+}  // end NormSlidingMask::UnsetBits()
+
+bool NormSlidingMask::GetNextSet(UINT32& index) const
+{
+    if (!IsSet()) return false;
+    INT32 delta = Difference(index, offset);
+    if (delta <= 0)
+    {
+        index = offset;
+        return true;
+    }
+    UINT32 span = Span();
+    if ((UINT32)delta >= span) return false;
+    UINT32 dist = ScanForward(Position((UINT32)delta), span - (UINT32)delta);
+    index = (offset + (UINT32)delta + dist) & RangeMask();
+    return true;
+}  // end NormSlidingMask::GetNextSet()
+
+bool NormSlidingMask::GetPrevSet(UINT32& index) const
+{
+    if (!IsSet()) return false;
+    INT32 delta = Difference(index, offset);
+    if (delta < 0) return false;
+    UINT32 span = Span();
+    if ((UINT32)delta >= span)
+    {
+        index = (offset + span - 1) & RangeMask();
+        return true;
+    }
+    UINT32 dist = ScanBackward(Position((UINT32)delta), (UINT32)delta + 1);
+    index = (offset + (UINT32)delta - dist) & RangeMask();
+    return true;
+}  // end NormSlidingMask::GetPrevSet()
+
+bool NormSlidingMask::Copy(const NormSlidingMask& b)
+{
+    if (&b == this) return true;
+    Clear();
+    return Add(b);
+}  // end NormSlidingMask::Copy()
+
+bool NormSlidingMask::Add(const NormSlidingMask& b)
+{
+    if (&b == this) return true;
+    UINT32 index;
+    bool more = b.GetFirstSet(index);
+    while (more)
+    {
+        if (!Set(index)) return false;
+        index = (index + 1) & b.RangeMask();
+        more = b.GetNextSet(index);
+    }
+    return true;
+}  // end NormSlidingMask::Add()
+
+bool NormSlidingMask::Subtract(const NormSlidingMask& b)
+{
+    if (&b == this)
+    {
+        Clear();
+        return true;
+    }
+    UINT32 index;
+    bool more = GetFirstSet(index);
+    while (more)
+    {
+        if (b.Test(index)) Unset(index);
+        index = (index + 1) & RangeMask();
+        more = GetNextSet(index);
+    }
+    return true;
+}  // end NormSlidingMask::Subtract()
+
+bool NormSlidingMask::XCopy(const NormSlidingMask& b)
+{
+    // b & ~this == (this & b) ^ b
+    if (&b == this)
+    {
+        Clear();
+        return true;
+    }
+    Multiply(b);
+    return Xor(b);
+}  // end NormSlidingMask::XCopy()
+
+bool NormSlidingMask::Multiply(const NormSlidingMask& b)
+{
+    if (&b == this) return true;
+    UINT32 index;
+    bool more = GetFirstSet(index);
+    while (more)
+    {
+        if (!b.Test(index)) Unset(index);
+        index = (index + 1) & RangeMask();
+        more = GetNextSet(index);
+    }
+    return true;
+}  // end NormSlidingMask::Multiply()
+
+bool NormSlidingMask::Xor(const NormSlidingMask& b)
+{
+    if (&b == this)
+    {
+        Clear();
+        return true;
+    }
+    UINT32 index;
+    bool more = b.GetFirstSet(index);
+    while (more)
+    {
+        if (Test(index))
+            Unset(index);
+        else if (!Set(index))
+            return false;
+        index = (index + 1) & b.RangeMask();
+        more = b.GetNextSet(index);
+    }
+    return true;
+}  // end NormSlidingMask::Xor()
+
+void NormSlidingMask::Display(FILE* stream) const
+{
+    UINT32 index = offset;
+    for (INT32 i = 0; i < num_bits; i++)
+    {
+        fprintf(stream, Test(index) ? "1" : "0");
+        if (0x3f == (i & 0x3f)) fprintf(stream, "\n");
+        index = (index + 1) & RangeMask();
+    }
+}  // end NormSlidingMask::Display()
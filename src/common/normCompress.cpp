@@ -0,0 +1,423 @@
+#include "normCompress.h"
+
+#include <string.h>  // for memcpy(), memcmp()
+
+const char NormCompressor::FRAME_MAGIC[4] = {'N', 'R', 'M', 'Z'};
+
+static inline UINT32 NormRead32(const UINT8* ptr)
+{
+    UINT32 value;
+    memcpy(&value, ptr, 4);  // (unaligned-safe)
+    return value;
+}
+
+static inline UINT32 NormHash32(UINT32 value, unsigned int hashBits)
+{
+    return ((value * 2654435761U) >> (32 - hashBits));
+}
+
+// Writes an LZ4 length extension (the part beyond the token's 4-bit field)
+static inline UINT8* NormWriteLength(UINT8* op, UINT32 len)
+{
+    while (len >= 255)
+    {
+        *op++ = 255;
+        len -= 255;
+    }
+    *op++ = (UINT8)len;
+    return op;
+}
+
+UINT32 NormCompressor::Compress(const char* src, UINT32 srcLen, char* dst, UINT32 dstMax)
+{
+    const UINT8* const base = (const UINT8*)src;
+    const UINT8* const end = base + srcLen;
+    const UINT8* ip = base;
+    const UINT8* anchor = base;   // start of pending literals
+    UINT8* op = (UINT8*)dst;
+    UINT8* const oend = op + dstMax;
+
+    // Hash table of (position + 1) of the last occurrence of each 4-byte sequence
+    UINT32 table[1 << HASH_BITS];
+    memset(table, 0, sizeof(table));
+
+    if (srcLen > MATCH_LIMIT)
+    {
+        const UINT8* const matchStartLimit = end - MATCH_LIMIT;
+        const UINT8* const matchEndLimit = end - LAST_LITERALS;
+        unsigned int misses = 0;
+        while (ip <= matchStartLimit)
+        {
+            UINT32 sequence = NormRead32(ip);
+            UINT32 h = NormHash32(sequence, HASH_BITS);
+            const UINT8* ref = base + table[h] - 1;
+            bool found = ((0 != table[h]) && ((ip - ref) <= MAX_OFFSET) &&
+                          (sequence == NormRead32(ref)));
+            table[h] = (UINT32)(ip - base) + 1;
+            if (!found)
+            {
+                // Skip ahead faster through incompressible content
+                ip += 1 + (misses++ >> 6);
+                continue;
+            }
+            misses = 0;
+            // Extend the match backward over pending literals and then forward
+            while ((ip > anchor) && (ref > base) && (ip[-1] == ref[-1]))
+            {
+                ip--;
+                ref--;
+            }
+            const UINT8* mp = ip + MIN_MATCH;
+            const UINT8* rp = ref + MIN_MATCH;
+            while ((mp < matchEndLimit) && (*mp == *rp))
+            {
+                mp++;
+                rp++;
+            }
+            UINT32 literalLen = (UINT32)(ip - anchor);
+            UINT32 matchLen = (UINT32)(mp - ip) - MIN_MATCH;
+            // (token + literal length ext + literals + offset + match length ext)
+            if ((UINT32)(oend - op) < (1 + (literalLen/255 + 1) + literalLen + 2 + (matchLen/255 + 1)))
+                return 0;
+            UINT8* token = op++;
+            *token = (UINT8)(((literalLen < 15) ? literalLen : 15) << 4);
+            if (literalLen >= 15) op = NormWriteLength(op, literalLen - 15);
+            memcpy(op, anchor, literalLen);
+            op += literalLen;
+            UINT16 offset = (UINT16)(ip - ref);
+            *op++ = (UINT8)(offset & 0xff);  // (little-endian)
+            *op++ = (UINT8)(offset >> 8);
+            *token |= (UINT8)((matchLen < 15) ? matchLen : 15);
+            if (matchLen >= 15) op = NormWriteLength(op, matchLen - 15);
+            // Index a position within the match to improve the next search
+            if ((mp - 2) > ip)
+                table[NormHash32(NormRead32(mp - 2), HASH_BITS)] = (UINT32)(mp - 2 - base) + 1;
+            anchor = ip = mp;
+        }
+    }
+    // Final literals
+    UINT32 literalLen = (UINT32)(end - anchor);
+    if ((UINT32)(oend - op) < (1 + (literalLen/255 + 1) + literalLen))
+        return 0;
+    UINT8* token = op++;
+    *token = (UINT8)(((literalLen < 15) ? literalLen : 15) << 4);
+    if (literalLen >= 15) op = NormWriteLength(op, literalLen - 15);
+    memcpy(op, anchor, literalLen);
+    op += literalLen;
+    return (UINT32)(op - (UINT8*)dst);
+}  // end NormCompressor::Compress()
+
+bool NormCompressor::Decompress(const char* src, UINT32 srcLen, char* dst, UINT32 dstLen)
+{
+    const UINT8* ip = (const UINT8*)src;
+    const UINT8* const iend = ip + srcLen;
+    UINT8* op = (UINT8*)dst;
+    UINT8* const oend = op + dstLen;
+    while (ip < iend)
+    {
+        UINT8 token = *ip++;
+        // Literals
+        UINT32 literalLen = token >> 4;
+        if (15 == literalLen)
+        {
+            UINT8 ext;
+            do
+            {
+                if (ip >= iend) return false;
+                ext = *ip++;
+                literalLen += ext;
+            } while (255 == ext);
+        }
+        if (((UINT32)(iend - ip) < literalLen) || ((UINT32)(oend - op) < literalLen))
+            return false;
+        memcpy(op, ip, literalLen);
+        ip += literalLen;
+        op += literalLen;
+        if (ip == iend) break;  // (the last sequence has no match)
+        // Match
+        if ((iend - ip) < 2) return false;
+        UINT32 offset = ip[0] | ((UINT32)ip[1] << 8);
+        ip += 2;
+        if ((0 == offset) || (offset > (UINT32)(op - (UINT8*)dst)))
+            return false;
+        UINT32 matchLen = token & 0x0f;
+        if (15 == matchLen)
+        {
+            UINT8 ext;
+            do
+            {
+                if (ip >= iend) return false;
+                ext = *ip++;
+                matchLen += ext;
+            } while (255 == ext);
+        }
+        matchLen += MIN_MATCH;
+        if ((UINT32)(oend - op) < matchLen) return false;
+        const UINT8* ref = op - offset;
+        if (offset >= matchLen)
+        {
+            memcpy(op, ref, matchLen);
+            op += matchLen;
+        }
+        else
+        {
+            // Overlapping copy (repeats the last "offset" bytes)
+            while (matchLen--) *op++ = *ref++;
+        }
+    }
+    return (op == oend);
+}  // end NormCompressor::Decompress()
+
+void NormCompressor::WriteHeader(char* buffer, NormFile::Offset dataSize, UINT32 chunkSize)
+{
+    memcpy(buffer, FRAME_MAGIC, 4);
+    UINT64 size = (UINT64)dataSize;
+    for (int i = 0; i < 8; i++)
+        buffer[4 + i] = (char)(size >> (8 * (7 - i)));
+    UINT32 chunk = htonl(chunkSize);
+    memcpy(buffer + 12, &chunk, 4);
+}  // end NormCompressor::WriteHeader()
+
+bool NormCompressor::ReadHeader(const char* buffer, NormFile::Offset& dataSize, UINT32& chunkSize)
+{
+    if (0 != memcmp(buffer, FRAME_MAGIC, 4)) return false;
+    UINT64 size = 0;
+    for (int i = 0; i < 8; i++)
+        size = (size << 8) | (UINT8)buffer[4 + i];
+    UINT32 chunk;
+    memcpy(&chunk, buffer + 12, 4);
+    dataSize = (NormFile::Offset)size;
+    chunkSize = ntohl(chunk);
+    // (the chunk size sets buffer allocations, so an untrusted header
+    //  mustn't be allowed to ask for more than MAX_CHUNK_SIZE)
+    return ((0 != chunkSize) && (chunkSize <= MAX_CHUNK_SIZE) && (dataSize >= 0));
+}  // end NormCompressor::ReadHeader()
+
+UINT32 NormCompressor::WriteChunk(const char* data, UINT32 dataLen, char* buffer, UINT32 bufferMax)
+{
+    if (bufferMax <= CHUNK_HEADER_SIZE) return 0;
+    UINT32 chunkLen = Compress(data, dataLen, buffer + CHUNK_HEADER_SIZE,
+                               MIN(dataLen - 1, bufferMax - CHUNK_HEADER_SIZE));
+    if (0 == chunkLen)
+    {
+        // Store incompressible content as is
+        if ((bufferMax - CHUNK_HEADER_SIZE) < dataLen) return 0;
+        memcpy(buffer + CHUNK_HEADER_SIZE, data, dataLen);
+        chunkLen = dataLen | CHUNK_STORED;
+    }
+    UINT32 header = htonl(chunkLen);
+    memcpy(buffer, &header, CHUNK_HEADER_SIZE);
+    return (CHUNK_HEADER_SIZE + (chunkLen & ~CHUNK_STORED));
+}  // end NormCompressor::WriteChunk()
+
+UINT32 NormCompressor::CompressData(const char* data, UINT32 dataLen, UINT32 chunkSize,
+                                    char* buffer, UINT32 bufferMax)
+{
+    if (0 == chunkSize) return 0;
+    if (chunkSize > MAX_CHUNK_SIZE) chunkSize = MAX_CHUNK_SIZE;
+    bufferMax = MIN(bufferMax, dataLen);  // (must be smaller to be worthwhile)
+    if (bufferMax <= FRAME_HEADER_SIZE) return 0;
+    WriteHeader(buffer, dataLen, chunkSize);
+    UINT32 frameLen = FRAME_HEADER_SIZE;
+    UINT32 offset = 0;
+    while (offset < dataLen)
+    {
+        UINT32 len = MIN(chunkSize, dataLen - offset);
+        UINT32 chunkLen = WriteChunk(data + offset, len, buffer + frameLen, bufferMax - frameLen);
+        if (0 == chunkLen) return 0;
+        frameLen += chunkLen;
+        offset += len;
+    }
+    return (frameLen < dataLen) ? frameLen : 0;
+}  // end NormCompressor::CompressData()
+
+bool NormCompressor::GetDataSize(const char* frame, UINT32 frameLen, NormFile::Offset& dataSize)
+{
+    UINT32 chunkSize;
+    if ((frameLen < FRAME_HEADER_SIZE) || !ReadHeader(frame, dataSize, chunkSize))
+        return false;
+    // Each chunk has a header and decodes to at most "chunkSize" bytes, so 
+    // the frame length bounds the original size (and the buffer a receiver
+    // allocates for it) regardless of what the header claims
+    NormFile::Offset sizeMax = (NormFile::Offset)((frameLen - FRAME_HEADER_SIZE) / CHUNK_HEADER_SIZE) * 
+                               (NormFile::Offset)chunkSize;
+    return (dataSize <= sizeMax);
+}  // end NormCompressor::GetDataSize()
+
+bool NormCompressor::DecompressData(const char* frame, UINT32 frameLen, char* data, UINT32 dataLen)
+{
+    NormFile::Offset dataSize;
+    UINT32 chunkSize;
+    if ((frameLen < FRAME_HEADER_SIZE) || !ReadHeader(frame, dataSize, chunkSize) ||
+        (dataSize != (NormFile::Offset)dataLen))
+    {
+        PLOG(PL_ERROR, "NormCompressor::DecompressData() error: invalid frame header\n");
+        return false;
+    }
+    UINT32 index = FRAME_HEADER_SIZE;
+    UINT32 offset = 0;
+    while (offset < dataLen)
+    {
+        UINT32 len = MIN(chunkSize, dataLen - offset);
+        UINT32 chunkLen;
+        if ((frameLen - index) < CHUNK_HEADER_SIZE) break;
+        memcpy(&chunkLen, frame + index, CHUNK_HEADER_SIZE);
+        chunkLen = ntohl(chunkLen);
+        index += CHUNK_HEADER_SIZE;
+        bool stored = (0 != (chunkLen & CHUNK_STORED));
+        chunkLen &= ~CHUNK_STORED;
+        if ((frameLen - index) < chunkLen) break;
+        if (stored ? (chunkLen != len) : !Decompress(frame + index, chunkLen, data + offset, len))
+            break;
+        if (stored) memcpy(data + offset, frame + index, len);
+        index += chunkLen;
+        offset += len;
+    }
+    if ((offset < dataLen) || (index != frameLen))
+    {
+        PLOG(PL_ERROR, "NormCompressor::DecompressData() error: invalid chunk at offset %lu\n",
+                       (unsigned long)offset);
+        return false;
+    }
+    return true;
+}  // end NormCompressor::DecompressData()
+
+bool NormCompressor::CompressFile(const char* inPath, const char* outPath, UINT32 chunkSize)
+{
+    if (0 == chunkSize) return false;
+    if (chunkSize > MAX_CHUNK_SIZE) chunkSize = MAX_CHUNK_SIZE;
+    NormFile inFile, outFile;
+    if (!inFile.Open(inPath, O_RDONLY))
+    {
+        PLOG(PL_ERROR, "NormCompressor::CompressFile() error opening file: %s\n", inPath);
+        return false;
+    }
+    NormFile::Offset inSize = inFile.GetSize();
+    if (!outFile.Open(outPath, O_WRONLY | O_CREAT | O_TRUNC))
+    {
+        PLOG(PL_ERROR, "NormCompressor::CompressFile() error opening file: %s\n", outPath);
+        return false;
+    }
+    char* inBuffer = new char[chunkSize];
+    char* outBuffer = new char[CHUNK_HEADER_SIZE + chunkSize];
+    bool result = ((NULL != inBuffer) && (NULL != outBuffer));
+    if (result)
+    {
+        char header[FRAME_HEADER_SIZE];
+        WriteHeader(header, inSize, chunkSize);
+        result = (FRAME_HEADER_SIZE == outFile.Write(header, FRAME_HEADER_SIZE));
+    }
+    NormFile::Offset inOffset = 0;
+    NormFile::Offset outSize = FRAME_HEADER_SIZE;
+    while (result && (inOffset < inSize))
+    {
+        size_t len = (size_t)MIN((NormFile::Offset)chunkSize, inSize - inOffset);
+        if (len != inFile.Read(inBuffer, len))
+        {
+            result = false;
+            break;
+        }
+        UINT32 chunkLen = WriteChunk(inBuffer, (UINT32)len, outBuffer, CHUNK_HEADER_SIZE + chunkSize);
+        if ((0 == chunkLen) || (chunkLen != outFile.Write(outBuffer, chunkLen)))
+        {
+            result = false;
+            break;
+        }
+        inOffset += len;
+        outSize += chunkLen;
+        // (give up as soon as it's clear compression isn't worthwhile)
+        if (outSize >= inSize) result = false;
+    }
+    if (NULL != inBuffer) delete[] inBuffer;
+    if (NULL != outBuffer) delete[] outBuffer;
+    inFile.Close();
+    outFile.Close();
+    if (!result || (outSize >= inSize))
+    {
+        NormFile::Unlink(outPath);
+        return false;
+    }
+    return true;
+}  // end NormCompressor::CompressFile()
+
+bool NormCompressor::DecompressFile(const char* inPath, const char* outPath)
+{
+    NormFile inFile, outFile;
+    if (!inFile.Open(inPath, O_RDONLY))
+    {
+        PLOG(PL_ERROR, "NormCompressor::DecompressFile() error opening file: %s\n", inPath);
+        return false;
+    }
+    NormFile::Offset inSize = inFile.GetSize();
+    char header[FRAME_HEADER_SIZE];
+    NormFile::Offset dataSize;
+    UINT32 chunkSize;
+    if ((inSize < FRAME_HEADER_SIZE) ||
+        (FRAME_HEADER_SIZE != inFile.Read(header, FRAME_HEADER_SIZE)) ||
+        !ReadHeader(header, dataSize, chunkSize))
+    {
+        PLOG(PL_ERROR, "NormCompressor::DecompressFile() error: invalid frame header\n");
+        return false;
+    }
+    if (!outFile.Open(outPath, O_WRONLY | O_CREAT | O_TRUNC))
+    {
+        PLOG(PL_ERROR, "NormCompressor::DecompressFile() error opening file: %s\n", outPath);
+        return false;
+    }
+    char* inBuffer = new char[chunkSize];
+    char* outBuffer = new char[chunkSize];
+    bool result = ((NULL != inBuffer) && (NULL != outBuffer));
+    NormFile::Offset inOffset = FRAME_HEADER_SIZE;
+    NormFile::Offset outOffset = 0;
+    while (result && (outOffset < dataSize))
+    {
+        UINT32 len = (UINT32)MIN((NormFile::Offset)chunkSize, dataSize - outOffset);
+        UINT32 chunkLen;
+        if (((inSize - inOffset) < CHUNK_HEADER_SIZE) ||
+            (CHUNK_HEADER_SIZE != inFile.Read((char*)&chunkLen, CHUNK_HEADER_SIZE)))
+        {
+            result = false;
+            break;
+        }
+        chunkLen = ntohl(chunkLen);
+        inOffset += CHUNK_HEADER_SIZE;
+        bool stored = (0 != (chunkLen & CHUNK_STORED));
+        chunkLen &= ~CHUNK_STORED;
+        if ((chunkLen > chunkSize) || ((inSize - inOffset) < (NormFile::Offset)chunkLen) ||
+            (stored && (chunkLen != len)) ||
+            (chunkLen != inFile.Read(inBuffer, chunkLen)))
+        {
+            result = false;
+            break;
+        }
+        inOffset += chunkLen;
+        const char* data = inBuffer;
+        if (!stored)
+        {
+            if (!Decompress(inBuffer, chunkLen, outBuffer, len))
+            {
+                result = false;
+                break;
+            }
+            data = outBuffer;
+        }
+        if (len != outFile.Write(data, len))
+        {
+            result = false;
+            break;
+        }
+        outOffset += len;
+    }
+    if (NULL != inBuffer) delete[] inBuffer;
+    if (NULL != outBuffer) delete[] outBuffer;
+    inFile.Close();
+    outFile.Close();
+    if (!result || (inOffset != inSize))
+    {
+        PLOG(PL_ERROR, "NormCompressor::DecompressFile() error: invalid chunk at offset %lld\n",
+                       (long long)outOffset);
+        NormFile::Unlink(outPath);
+        return false;
+    }
+    return true;
+}  // end NormCompressor::DecompressFile()
@@ -0,0 +1,141 @@
+// This code benchmarks the NormCompressor (used for NormSession::SetTxCompression())
+// compression ratio and CPU cost.  It uses the files named on the command line
+// or, if none are given, some generated sample content (log lines, JSON telemetry,
+// and random bytes).  Content is compressed in chunks the size of a typical
+// NORM FEC source block (segmentSize * ndata).
+
+#include "normCompress.h"
+#include "protoTime.h"  // for ProtoTime
+
+#include <stdlib.h> // for rand()
+#include <stdio.h>
+
+const UINT32 SAMPLE_SIZE = 16*1024*1024;
+const UINT32 CHUNK_SIZE  = 1400 * 64;  // default segmentSize * ndata
+const unsigned int ROUNDS = 5;
+
+static void MakeSample(int type, char* buffer, UINT32 len)
+{
+    static const char* const level[] = {"INFO", "WARN", "DEBUG", "ERROR"};
+    UINT32 count = 0;
+    unsigned long seq = 0;
+    while (count < len)
+    {
+        char line[256];
+        int n;
+        switch (type)
+        {
+            case 0:  // syslog-like lines
+                n = sprintf(line, "2024-05-%02d 12:%02d:%02d.%03d host%d norm[%d]: %s sender>%lu obj>%u blk>%u seg>%u\n",
+                            (int)(seq/86400)%28+1, (int)(seq/60)%60, (int)seq%60, rand()%1000, rand()%8, 1200+rand()%4,
+                            level[rand()%4], 0xc0a80001UL + rand()%16, rand()%65536, rand()%1024, rand()%64);
+                break;
+            case 1:  // JSON telemetry
+                n = sprintf(line, "{\"id\":%lu,\"lat\":%d.%06d,\"lon\":%d.%06d,\"alt\":%d,\"hdg\":%d,\"status\":\"%s\"}\n",
+                            seq, 30 + rand()%10, rand()%1000000, -80 + rand()%10, rand()%1000000, rand()%3000, rand()%360,
+                            (0 == rand()%10) ? "degraded" : "nominal");
+                break;
+            default:  // random (incompressible) bytes
+                n = sizeof(line);
+                for (int i = 0; i < n; i++) line[i] = (char)rand();
+                break;
+        }
+        if ((UINT32)n > (len - count)) n = len - count;
+        memcpy(buffer + count, line, n);
+        count += n;
+        seq++;
+    }
+}  // end MakeSample()
+
+static bool RunTest(const char* name, const char* data, UINT32 len)
+{
+    char* frame = new char[len];
+    char* output = new char[len];
+    if ((NULL == frame) || (NULL == output))
+    {
+        fprintf(stderr, "normCompressTest: memory allocation error\n");
+        return false;
+    }
+    ProtoTime startTime, stopTime;
+    UINT32 frameLen = 0;
+    startTime.GetCurrentTime();
+    for (unsigned int r = 0; r < ROUNDS; r++)
+        frameLen = NormCompressor::CompressData(data, len, CHUNK_SIZE, frame, len);
+    stopTime.GetCurrentTime();
+    double compressTime = ProtoTime::Delta(stopTime, startTime) / ROUNDS;
+    double decompressTime = 0.0;
+    bool result = true;
+    if (0 != frameLen)
+    {
+        startTime.GetCurrentTime();
+        for (unsigned int r = 0; r < ROUNDS; r++)
+            result &= NormCompressor::DecompressData(frame, frameLen, output, len);
+        stopTime.GetCurrentTime();
+        decompressTime = ProtoTime::Delta(stopTime, startTime) / ROUNDS;
+        if (!result || (0 != memcmp(data, output, len)))
+        {
+            fprintf(stderr, "normCompressTest: %s: error: decompressed content mismatch\n", name);
+            result = false;
+        }
+    }
+    double mbytes = (double)len / (1024.0 * 1024.0);
+    fprintf(stderr, "normCompressTest: %s (%u bytes)\n", name, len);
+    if (0 != frameLen)
+    {
+        fprintf(stderr, "   ratio:      %lf (%u bytes compressed)\n", (double)len / (double)frameLen, frameLen);
+        fprintf(stderr, "   compress:   %lf MB/sec\n", mbytes / compressTime);
+        fprintf(stderr, "   decompress: %lf MB/sec\n", mbytes / decompressTime);
+    }
+    else
+    {
+        fprintf(stderr, "   ratio:      1.0 (not compressible, sent as is)\n");
+        fprintf(stderr, "   compress:   %lf MB/sec (to detect)\n", mbytes / compressTime);
+    }
+    delete[] frame;
+    delete[] output;
+    return result;
+}  // end RunTest()
+
+int main(int argc, char* argv[])
+{
+    bool result = true;
+    if (argc > 1)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            NormFile file;
+            NormFile::Offset size = NormFile::GetSize(argv[i]);
+            if ((size <= 0) || (size > (NormFile::Offset)0x7fffffff) || !file.Open(argv[i], O_RDONLY))
+            {
+                fprintf(stderr, "normCompressTest: error opening file \"%s\"\n", argv[i]);
+                return -1;
+            }
+            char* data = new char[(size_t)size];
+            if ((NULL == data) || ((size_t)size != file.Read(data, (size_t)size)))
+            {
+                fprintf(stderr, "normCompressTest: error reading file \"%s\"\n", argv[i]);
+                return -1;
+            }
+            result &= RunTest(argv[i], data, (UINT32)size);
+            delete[] data;
+        }
+    }
+    else
+    {
+        static const char* const sampleName[] = {"log", "json", "random"};
+        char* data = new char[SAMPLE_SIZE];
+        if (NULL == data)
+        {
+            fprintf(stderr, "normCompressTest: memory allocation error\n");
+            return -1;
+        }
+        srand(1);
+        for (int type = 0; type < 3; type++)
+        {
+            MakeSample(type, data, SAMPLE_SIZE);
+            result &= RunTest(sampleName[type], data, SAMPLE_SIZE);
+        }
+        delete[] data;
+    }
+    return result ? 0 : -1;
+}  // end main()
@@ -2,15 +2,20 @@
 
 #include <string.h>  // for strerror()
 #include <stdio.h>   // for rename()
+#include <stdlib.h>  // for getenv(), mkstemp()
 #ifdef WIN32
 #ifndef _WIN32_WCE
 #include <errno.h>
 #include <direct.h>
 #include <share.h>
 #include <io.h>
+#include <sys/utime.h>  // for _utime()
 #endif // !_WIN32_WCE
 #else
 #include <unistd.h>
+#include <utime.h>    // for utime()
+#include <pthread.h>  // for NormFileIo helper threads
+#include <sys/mman.h> // for mmap()
 // Most don't have the dirfd() function
 #ifndef HAVE_DIRFD
 static inline int dirfd(DIR *dir) {return (dir->dd_fd);}
@@ -456,6 +461,177 @@ bool NormFile::Pad(Offset theOffset)
     return true; 
 }  // end NormFile::Pad()
 
+bool NormFile::Allocate(Offset theSize)
+{
+#ifdef HAVE_FALLOCATE
+    if (theSize > GetSize())
+    {
+        if (0 == fallocate(fd, 0, 0, theSize)) return true;
+        if ((EOPNOTSUPP != errno) && (ENOSYS != errno))
+        {
+            PLOG(PL_ERROR, "NormFile::Allocate() fallocate() error: %s\n", GetErrorString());
+            return false;
+        }
+        // else file system doesn't support it, so fall back to Pad()
+    }
+#endif // HAVE_FALLOCATE
+    return Pad(theSize);
+}  // end NormFile::Allocate()
+
+size_t NormFile::ReadAt(Offset theOffset, char* buffer, size_t len)
+{
+    ASSERT(IsOpen());
+#ifdef WIN32
+    if ((theOffset != offset) && !Seek(theOffset)) return 0;
+    return Read(buffer, len);
+#else
+    size_t got = 0;
+    while (got < len)
+    {
+        ssize_t result = pread(fd, buffer+got, len-got, theOffset+(Offset)got);
+        if (result <= 0)
+        {
+            if ((result < 0) && (EINTR == errno)) continue;
+            PLOG(PL_FATAL, "NormFile::ReadAt() pread(%lu) result:%d error:%s (offset:%lld)\n", 
+                    (unsigned long)len, (int)result, (0 == result) ? "end-of-file" : GetErrorString(), 
+                    (long long)theOffset);
+            break;
+        }
+        got += result;
+    }
+    return got;
+#endif // if/else WIN32
+}  // end NormFile::ReadAt()
+
+size_t NormFile::WriteAt(Offset theOffset, const char* buffer, size_t len)
+{
+    ASSERT(IsOpen());
+#ifdef WIN32
+    if ((theOffset != offset) && !Seek(theOffset)) return 0;
+    return Write(buffer, len);
+#else
+    size_t put = 0;
+    while (put < len)
+    {
+        ssize_t result = pwrite(fd, buffer+put, len-put, theOffset+(Offset)put);
+        if (result < 0)
+        {
+            if (EINTR != errno)
+            {
+                PLOG(PL_FATAL, "NormFile::WriteAt() pwrite() error: %s\n", GetErrorString());
+                break;
+            }
+        }
+        else
+        {
+            put += result;
+        }
+    }
+    return put;
+#endif // if/else WIN32
+}  // end NormFile::WriteAt()
+
+size_t NormFile::WriteAtV(Offset theOffset, const struct iovec* iov, int iovCount)
+{
+    ASSERT(IsOpen());
+    size_t put = 0;
+#ifdef HAVE_PWRITEV
+    size_t total = 0;
+    for (int i = 0; i < iovCount; i++)
+        total += iov[i].iov_len;
+    ssize_t result;
+    do
+    {
+        result = pwritev(fd, iov, iovCount, theOffset);
+    } while ((result < 0) && (EINTR == errno));
+    if (result < 0)
+    {
+        PLOG(PL_FATAL, "NormFile::WriteAtV() pwritev() error: %s\n", GetErrorString());
+        return 0;
+    }
+    put = result;
+    if (put == total) return put;
+#endif // HAVE_PWRITEV
+    // Write any (remaining) content one buffer at a time
+    size_t skip = put;
+    for (int i = 0; i < iovCount; i++)
+    {
+        size_t len = iov[i].iov_len;
+        if (skip >= len)
+        {
+            skip -= len;
+            continue;
+        }
+        len -= skip;
+        size_t result = WriteAt(theOffset + (Offset)put, (const char*)iov[i].iov_base + skip, len);
+        put += result;
+        if (result != len) break;
+        skip = 0;
+    }
+    return put;
+}  // end NormFile::WriteAtV()
+
+char* NormFile::Map(Offset theOffset, size_t length)
+{
+    ASSERT(IsOpen());
+#ifdef WIN32
+    // (TBD) support WIN32 file mapping
+    return NULL;
+#else
+    ASSERT(0 == (theOffset % GetPageSize()));
+    int prot = PROT_READ;
+    if (O_RDWR == (flags & O_ACCMODE)) prot |= PROT_WRITE;
+    void* addr = mmap(NULL, length, prot, MAP_SHARED, fd, theOffset);
+    if (MAP_FAILED == addr)
+    {
+        PLOG(PL_WARN, "NormFile::Map() mmap() error: %s\n", GetErrorString());
+        return NULL;
+    }
+    return (char*)addr;
+#endif // if/else WIN32
+}  // end NormFile::Map()
+
+void NormFile::Unmap(char* addr, size_t length)
+{
+#ifndef WIN32
+    if (0 != munmap(addr, length))
+        PLOG(PL_ERROR, "NormFile::Unmap() munmap() error: %s\n", GetErrorString());
+#endif // !WIN32
+}  // end NormFile::Unmap()
+
+// These are only hints, so errors are ignored
+void NormFile::Advise(char* addr, size_t length, Advice advice)
+{
+#ifndef WIN32
+    // Round "addr" down to its page boundary
+    size_t pageOffset = (size_t)addr % GetPageSize();
+    addr -= pageOffset;
+    length += pageOffset;
+    switch (advice)
+    {
+        case ADVISE_SEQUENTIAL:
+            madvise(addr, length, MADV_SEQUENTIAL);
+            break;
+        case ADVISE_WILLNEED:
+            madvise(addr, length, MADV_WILLNEED);
+            break;
+    }
+#endif // !WIN32
+}  // end NormFile::Advise()
+
+size_t NormFile::GetPageSize()
+{
+#ifdef WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (size_t)info.dwAllocationGranularity;
+#else
+    static size_t pageSize = 0;
+    if (0 == pageSize) pageSize = (size_t)sysconf(_SC_PAGESIZE);
+    return pageSize;
+#endif // if/else WIN32
+}  // end NormFile::GetPageSize()
+
 NormFile::Offset NormFile::GetSize() const
 {
     ASSERT(IsOpen());
@@ -824,6 +1000,286 @@ void NormDirectoryIterator::NormDirectory::RecursiveCatName(char* ptr)
     strncat(ptr, path, PATH_MAX-len);
 }  // end NormDirectoryIterator::NormDirectory::RecursiveCatName()
 
+/***********************************************
+ * The NormDirectoryScanner is a multi-threaded alternative
+ * to the NormDirectoryIterator.  Helper threads pop directories
+ * from a shared stack, read them (readdir() buffers the getdents() 
+ * system call) and "fstatat()" entries relative to the open
+ * directory, pushing subdirectories back onto the stack and 
+ * appending regular files to a bounded queue for the consumer.
+ */
+
+NormDirectoryScanner::Item::Item(const char* theName, NormFile::Offset theSize, time_t theTime)
+ : size(theSize), update_time(theTime), next(NULL)
+{
+    size_t len = strlen(theName);
+    name = new char[len + 1];
+    if (NULL != name) strcpy(name, theName);
+}
+
+NormDirectoryScanner::Item::~Item()
+{
+    if (NULL != name) delete[] name;
+}
+
+NormDirectoryScanner::NormDirectoryScanner()
+ : thread_count(0), dir_list(NULL), file_head(NULL), file_tail(NULL),
+   file_count(0), busy_count(0), stopping(false)
+{
+    path[0] = '\0';
+}
+
+NormDirectoryScanner::~NormDirectoryScanner()
+{
+    Close();
+}
+
+#ifdef WIN32
+bool NormDirectoryScanner::Open(const char* thePath)
+{
+    return false;  // not supported, use NormDirectoryIterator instead
+}  // end NormDirectoryScanner::Open() (WIN32)
+
+void NormDirectoryScanner::Close()
+{
+}  // end NormDirectoryScanner::Close() (WIN32)
+
+bool NormDirectoryScanner::GetNextFile(char* fileName, NormFile::Offset& fileSize, time_t& updateTime)
+{
+    return false;
+}  // end NormDirectoryScanner::GetNextFile() (WIN32)
+
+bool NormDirectoryScanner::IsReady()
+{
+    return true;
+}  // end NormDirectoryScanner::IsReady() (WIN32)
+#else
+bool NormDirectoryScanner::Open(const char* thePath)
+{
+    if (IsOpen()) Close();
+    size_t len = strlen(thePath);
+    if ((0 == len) || (len >= (PATH_MAX - 1)))
+    {
+        PLOG(PL_FATAL, "NormDirectoryScanner::Open() invalid path: %s\n", thePath);
+        return false;
+    }
+    strcpy(path, thePath);
+    if (PROTO_PATH_DELIMITER != path[len-1])
+    {
+        path[len++] = PROTO_PATH_DELIMITER;
+        path[len] = '\0';
+    }
+    if (0 != access(path, X_OK))
+    {
+        PLOG(PL_FATAL, "NormDirectoryScanner::Open() can't access directory: %s\n", thePath);
+        return false;
+    }
+    // The scan starts with the top level directory (empty relative name)
+    if (NULL == (dir_list = new Item("")))
+    {
+        PLOG(PL_FATAL, "NormDirectoryScanner::Open() new Item error: %s\n", GetErrorString());
+        return false;
+    }
+    pthread_mutex_init(&mutex, NULL);
+    pthread_cond_init(&scan_cond, NULL);
+    stopping = false;
+    while (thread_count < THREAD_COUNT)
+    {
+        if (0 != pthread_create(&thread[thread_count], NULL, Run, this))
+        {
+            PLOG(PL_ERROR, "NormDirectoryScanner::Open() pthread_create() error: %s\n", GetErrorString());
+            break;
+        }
+        thread_count++;
+    }
+    if (0 == thread_count)
+    {
+        DestroyItems();
+        pthread_cond_destroy(&scan_cond);
+        pthread_mutex_destroy(&mutex);
+        return false;
+    }
+    return true;
+}  // end NormDirectoryScanner::Open()
+
+void NormDirectoryScanner::Close()
+{
+    if (!IsOpen()) return;
+    pthread_mutex_lock(&mutex);
+    stopping = true;
+    pthread_cond_broadcast(&scan_cond);
+    pthread_mutex_unlock(&mutex);
+    for (unsigned int i = 0; i < thread_count; i++)
+        pthread_join(thread[i], NULL);
+    thread_count = 0;
+    DestroyItems();
+    pthread_cond_destroy(&scan_cond);
+    pthread_mutex_destroy(&mutex);
+}  // end NormDirectoryScanner::Close()
+
+void NormDirectoryScanner::DestroyItems()
+{
+    Item* item;
+    while (NULL != (item = dir_list))
+    {
+        dir_list = item->next;
+        delete item;
+    }
+    while (NULL != (item = file_head))
+    {
+        file_head = item->next;
+        delete item;
+    }
+    file_tail = NULL;
+    file_count = busy_count = 0;
+}  // end NormDirectoryScanner::DestroyItems()
+
+bool NormDirectoryScanner::GetNextFile(char* fileName, NormFile::Offset& fileSize, time_t& updateTime)
+{
+    if (!IsOpen()) return false;
+    pthread_mutex_lock(&mutex);
+    while ((NULL == file_head) && !IsDone())
+        pthread_cond_wait(&scan_cond, &mutex);
+    Item* item = file_head;
+    if (NULL != item)
+    {
+        if (NULL == (file_head = item->next)) file_tail = NULL;
+        if (QUEUE_MAX == file_count--)
+            pthread_cond_broadcast(&scan_cond);  // queue space now available
+    }
+    pthread_mutex_unlock(&mutex);
+    if (NULL == item) return false;  // scan complete
+    strncpy(fileName, item->name, PATH_MAX);
+    fileSize = item->size;
+    updateTime = item->update_time;
+    delete item;
+    return true;
+}  // end NormDirectoryScanner::GetNextFile()
+
+bool NormDirectoryScanner::IsReady()
+{
+    if (!IsOpen()) return true;
+    pthread_mutex_lock(&mutex);
+    bool result = ((NULL != file_head) || IsDone());
+    pthread_mutex_unlock(&mutex);
+    return result;
+}  // end NormDirectoryScanner::IsReady()
+
+void* NormDirectoryScanner::Run(void* arg)
+{
+    NormDirectoryScanner* scanner = (NormDirectoryScanner*)arg;
+    pthread_mutex_lock(&scanner->mutex);
+    while (!scanner->stopping)
+    {
+        Item* dir = scanner->dir_list;
+        if (NULL == dir)
+        {
+            if (scanner->IsDone()) break;
+            // Wait for another thread to find more subdirectories
+            pthread_cond_wait(&scanner->scan_cond, &scanner->mutex);
+            continue;
+        }
+        scanner->dir_list = dir->next;
+        scanner->busy_count++;
+        pthread_mutex_unlock(&scanner->mutex);
+        scanner->Scan(*dir);
+        delete dir;
+        pthread_mutex_lock(&scanner->mutex);
+        scanner->busy_count--;
+        // (the scan may be complete now)
+        if (scanner->IsDone()) pthread_cond_broadcast(&scanner->scan_cond);
+    }
+    pthread_mutex_unlock(&scanner->mutex);
+    return NULL;
+}  // end NormDirectoryScanner::Run()
+
+void NormDirectoryScanner::Scan(const Item& dir)
+{
+    char dirPath[PATH_MAX];
+    size_t pathLen = strlen(path);
+    size_t dirLen = strlen(dir.name);
+    if ((pathLen + dirLen) >= PATH_MAX) return;
+    memcpy(dirPath, path, pathLen);
+    strcpy(dirPath + pathLen, dir.name);
+    DIR* dptr = opendir(dirPath);
+    if (NULL == dptr)
+    {
+        PLOG(PL_WARN, "NormDirectoryScanner::Scan() can't open directory: %s\n", dirPath);
+        return;
+    }
+    int dirFd = dirfd(dptr);
+    char name[PATH_MAX];
+    memcpy(name, dir.name, dirLen);
+    struct dirent* dp;
+    while (NULL != (dp = readdir(dptr)))
+    {
+        // Make sure it's not "." or ".."
+        if (('.' == dp->d_name[0]) &&
+            (('\0' == dp->d_name[1]) || (('.' == dp->d_name[1]) && ('\0' == dp->d_name[2]))))
+        {
+            continue;  // skip "." and ".." directory names
+        }
+        size_t nameLen = strlen(dp->d_name);
+        if ((pathLen + dirLen + nameLen + 1) >= PATH_MAX) continue;
+        strcpy(name + dirLen, dp->d_name);
+        bool isDirectory = false;
+        struct stat info;
+#ifdef DT_DIR
+        // (directories need not be stat'ed when the type is provided)
+        if (DT_DIR == dp->d_type)
+            isDirectory = true;
+        else 
+#endif // DT_DIR
+        if (0 != fstatat(dirFd, dp->d_name, &info, 0))
+            continue;  // (the entry may have gone away)
+        else if (S_ISDIR(info.st_mode))
+            isDirectory = true;
+        else if (!S_ISREG(info.st_mode))
+            continue;  // not a directory or regular file
+        Item* item;
+        if (isDirectory)
+        {
+            name[dirLen + nameLen] = PROTO_PATH_DELIMITER;
+            name[dirLen + nameLen + 1] = '\0';
+            item = new Item(name);
+        }
+        else
+        {
+            item = new Item(name, (NormFile::Offset)info.st_size, (time_t)info.st_ctime);
+        }
+        if ((NULL == item) || (NULL == item->name))
+        {
+            PLOG(PL_ERROR, "NormDirectoryScanner::Scan() new Item error: %s\n", GetErrorString());
+            if (NULL != item) delete item;
+            continue;
+        }
+        pthread_mutex_lock(&mutex);
+        if (isDirectory)
+        {
+            item->next = dir_list;
+            dir_list = item;
+        }
+        else
+        {
+            // Wait for queue space (the consumer is behind)
+            while ((file_count >= QUEUE_MAX) && !stopping)
+                pthread_cond_wait(&scan_cond, &mutex);
+            if (NULL != file_tail)
+                file_tail->next = item;
+            else
+                file_head = item;
+            file_tail = item;
+            file_count++;
+        }
+        bool stop = stopping;
+        pthread_cond_broadcast(&scan_cond);
+        pthread_mutex_unlock(&mutex);
+        if (stop) break;
+    }
+    closedir(dptr);
+}  // end NormDirectoryScanner::Scan()
+#endif // if/else WIN32
+
 // Below are some static routines for getting file/directory information
 
 // Is the named item a valid directory or file (or neither)??
@@ -955,6 +1411,90 @@ time_t NormFile::GetUpdateTime(const char* path)
 #endif // if/else _WIN32_WCE
 }  // end NormFile::GetUpdateTime()
 
+// Unlike GetUpdateTime(), this returns the file content modification time
+time_t NormFile::GetModifyTime(const char* path)
+{
+#ifdef _WIN32_WCE
+    return GetUpdateTime(path);
+#else
+#ifdef WIN32
+    struct _stati64 info;
+    int result = _stati64(path, &info);
+#else
+    struct stat info; 
+    int result = stat(path, &info);
+#endif // if/else WIN32   
+    return ((0 != result) ? (time_t)0 : (time_t)info.st_mtime);
+#endif // if/else _WIN32_WCE
+}  // end NormFile::GetModifyTime()
+
+bool NormFile::SetModifyTime(const char* path, time_t modifyTime)
+{
+#ifdef _WIN32_WCE
+    return false;  // not supported
+#else
+#ifdef WIN32
+    struct _utimbuf times;
+    times.actime = times.modtime = modifyTime;
+    if (0 != _utime(path, &times))
+#else
+    struct utimbuf times;
+    times.actime = times.modtime = modifyTime;
+    if (0 != utime(path, &times))
+#endif // if/else WIN32
+    {
+        PLOG(PL_ERROR, "NormFile::SetModifyTime() utime() error: %s\n", GetErrorString());
+        return false;
+    }
+    return true;
+#endif // if/else _WIN32_WCE
+}  // end NormFile::SetModifyTime()
+
+bool NormFile::MakeTemp(const char* dirPath, const char* prefix, char* pathBuffer)
+{
+    const char* const suffix = "XXXXXX";
+    size_t dirLen = strlen(dirPath);
+    if ((dirLen + strlen(prefix) + strlen(suffix) + 2) > PATH_MAX)
+    {
+        PLOG(PL_ERROR, "NormFile::MakeTemp() error: directory path too long\n");
+        return false;
+    }
+    strcpy(pathBuffer, dirPath);
+    if ((0 != dirLen) && (PROTO_PATH_DELIMITER != pathBuffer[dirLen - 1]))
+    {
+        pathBuffer[dirLen++] = PROTO_PATH_DELIMITER;
+        pathBuffer[dirLen] = '\0';
+    }
+    strcat(pathBuffer, prefix);
+    strcat(pathBuffer, suffix);
+#if defined(_WIN32_WCE)
+    bool tempOK = false;  // (TBD) support temp files on WinCE
+#elif defined(WIN32)
+    bool tempOK = (NULL != _mktemp(pathBuffer));
+#else
+    int tempFd = mkstemp(pathBuffer);
+    bool tempOK = (tempFd >= 0);
+    if (tempOK) close(tempFd);
+#endif // if/else _WIN32_WCE / WIN32 / UNIX
+    if (!tempOK)
+    {
+        PLOG(PL_ERROR, "NormFile::MakeTemp() error: %s\n", GetErrorString());
+        return false;
+    }
+    return true;
+}  // end NormFile::MakeTemp()
+
+const char* NormFile::GetTempDir()
+{
+#ifdef WIN32
+    const char* tempDir = getenv("TEMP");
+    return ((NULL != tempDir) ? tempDir : ".");
+#else
+    const char* tempDir = getenv("TMPDIR");
+    return ((NULL != tempDir) ? tempDir : "/tmp");
+#endif // if/else WIN32
+}  // end NormFile::GetTempDir()
+
 bool NormFile::IsLocked(const char* path)
 {
     // If file doesn't exist, it's not locked
@@ -1112,7 +1652,7 @@ bool NormFileList::Remove(const char* path)
     return false;
 }  // end NormFileList::Remove()
 
-bool NormFileList::GetNextFile(char* pathBuffer)
+bool NormFileList::GetNextFile(char* pathBuffer, NormFile::Offset* fileSize)
 {
     if (!next)
     {
@@ -1122,7 +1662,7 @@ bool NormFileList::GetNextFile(char* pathBuffer)
     if (next)
     {
         if (next->GetNextFile(pathBuffer, reset, updates_only,
-                              last_time, this_time, big_time))
+                              last_time, this_time, big_time, fileSize))
         {
             reset = false;
             return true;
@@ -1133,7 +1673,7 @@ bool NormFileList::GetNextFile(char* pathBuffer)
             {
                 next = next->next;
                 reset = true;
-                return GetNextFile(pathBuffer);
+                return GetNextFile(pathBuffer, fileSize);
             }
             else
             {
@@ -1148,6 +1688,17 @@ bool NormFileList::GetNextFile(char* pathBuffer)
     }
 }  // end NormFileList::GetNextFile()
 
+bool NormFileList::IsReady()
+{
+    if (NULL == next)
+    {
+        if (NULL == head) return true;  // empty list
+        next = head;
+        reset = true;
+    }
+    return next->IsReady(reset);
+}  // end NormFileList::IsReady()
+
 void NormFileList::GetCurrentBasePath(char* pathBuffer)
 {
     if (next)
@@ -1198,23 +1749,25 @@ NormFileList::FileItem::~FileItem()
 {
 }
 
-bool NormFileList::FileItem::GetNextFile(char*   thePath,
-                                         bool    reset,
-                                         bool    updatesOnly,
-                                         time_t  lastTime,
-                                         time_t  thisTime,
-                                         time_t& bigTime)
+bool NormFileList::FileItem::GetNextFile(char*              thePath,
+                                         bool               reset,
+                                         bool               updatesOnly,
+                                         time_t             lastTime,
+                                         time_t             thisTime,
+                                         time_t&            bigTime,
+                                         NormFile::Offset*  fileSize)
 {
     if (reset)
     {
         if (updatesOnly)
         {
-            time_t updateTime = NormFile::GetUpdateTime(thePath);
+            time_t updateTime = NormFile::GetUpdateTime(path);
             if (updateTime > bigTime) bigTime = updateTime;
             if ((updateTime <= lastTime) || (updateTime > thisTime))
                 return false;
         }
         strncpy(thePath, path, PATH_MAX);
+        if (NULL != fileSize) *fileSize = NormFile::GetSize(path);
         return true;
     }
     else
@@ -1224,22 +1777,24 @@ bool NormFileList::FileItem::GetNextFile(char*   thePath,
 }  // end NormFileList::FileItem::GetNextFile()
 
 NormFileList::DirectoryItem::DirectoryItem(const char* thePath)
- : NormFileList::FileItem(thePath)
+ : NormFileList::FileItem(thePath), scan_started(false)
 {    
     
 }
 
 NormFileList::DirectoryItem::~DirectoryItem()
 {
+    scanner.Close();
     diterator.Close();
 }
 
-bool NormFileList::DirectoryItem::GetNextFile(char*   thePath,
-                                              bool    reset,
-                                              bool    updatesOnly,
-                                              time_t  lastTime,
-                                              time_t  thisTime,
-                                              time_t& bigTime)
+bool NormFileList::DirectoryItem::GetNextFile(char*              thePath,
+                                              bool               reset,
+                                              bool               updatesOnly,
+                                              time_t             lastTime,
+                                              time_t             thisTime,
+                                              time_t&            bigTime,
+                                              NormFile::Offset*  fileSize)
 {
      if (reset)
      {
@@ -1256,11 +1811,18 @@ bool NormFileList::DirectoryItem::GetNextFile(char*   thePath,
             if ((updateTime <= lastTime) || (updateTime > thisTime))
                 return false;
         } */
-        if (!diterator.Open(path))
+        // The NormDirectoryScanner reads ahead in parallel with
+        // transmission where supported (else iterate synchronously)
+        if (!scan_started)
         {
-            PLOG(PL_FATAL, "NormFileList::DirectoryItem::GetNextFile() Directory iterator init error\n");
-            return false;   
-        } 
+            scanner.Close();
+            if (!scanner.Open(path) && !diterator.Open(path))
+            {
+                PLOG(PL_FATAL, "NormFileList::DirectoryItem::GetNextFile() Directory iterator init error\n");
+                return false;   
+            } 
+        }
+        scan_started = false;
      }
      strncpy(thePath, path, PATH_MAX);
      size_t len = strlen(thePath);
@@ -1271,13 +1833,20 @@ bool NormFileList::DirectoryItem::GetNextFile(char*   thePath,
          if (len < PATH_MAX) thePath[len] = '\0';
      }  
      char tempPath[PATH_MAX];
-     while (diterator.GetNextFile(tempPath))
+     NormFile::Offset size = 0;
+     time_t updateTime = 0;
+     while (scanner.IsOpen() ? scanner.GetNextFile(tempPath, size, updateTime) :
+                               diterator.GetNextFile(tempPath))
      {
          size_t maxLen = PATH_MAX - len;
          strncat(thePath, tempPath, maxLen);
+         if (!scanner.IsOpen())
+         {
+             if (updatesOnly) updateTime = NormFile::GetUpdateTime(thePath);
+             if (NULL != fileSize) size = NormFile::GetSize(thePath);
+         }
          if (updatesOnly)
          {
-            time_t updateTime = NormFile::GetUpdateTime(thePath);
             if (updateTime > bigTime) bigTime = updateTime;
             if ((updateTime <= lastTime) || (updateTime > thisTime))
             {
@@ -1285,7 +1854,479 @@ bool NormFileList::DirectoryItem::GetNextFile(char*   thePath,
                 continue;
             }
          }
+         if (NULL != fileSize) *fileSize = size;
          return true;
      }
      return false;
 }  // end NormFileList::DirectoryItem::GetNextFile()
+
+bool NormFileList::DirectoryItem::IsReady(bool reset)
+{
+    if (reset && !scan_started)
+    {
+        // Start the scan now so files are queued by the time
+        // GetNextFile() is called
+        scanner.Close();
+        scan_started = scanner.Open(path);
+    }
+    return (scanner.IsOpen() ? scanner.IsReady() : true);
+}  // end NormFileList::DirectoryItem::IsReady()
+
+/******************************************
+* NormFileBundle implementation
+*/
+
+const char NormFileBundle::BUNDLE_INFO[BUNDLE_INFO_LEN] = 
+    {'\0', 'n', 'o', 'r', 'm', 'B', 'u', 'n', 'd', 'l', 'e'};
+const char NormFileBundle::BUNDLE_MAGIC[MAGIC_SIZE] = 
+    {'N', 'O', 'R', 'M', 'B', 'N', 'D', 'L'};
+
+NormFileBundle::NormFileBundle()
+ : bundle_size(0), file_count(0), done(false)
+{
+    path[0] = '\0';
+}
+
+NormFileBundle::~NormFileBundle()
+{
+    Close();
+}
+
+void NormFileBundle::Close()
+{
+    if (file.IsOpen()) file.Close();
+}  // end NormFileBundle::Close()
+
+bool NormFileBundle::Create(const char* dirPath)
+{
+    Close();
+    bundle_size = 0;
+    file_count = 0;
+    done = false;
+    if (!NormFile::MakeTemp(dirPath, "normBundle", path))
+    {
+        PLOG(PL_ERROR, "NormFileBundle::Create() error creating bundle file\n");
+        path[0] = '\0';
+        return false;
+    }
+    if (!file.Open(path, O_WRONLY | O_CREAT | O_TRUNC))
+    {
+        PLOG(PL_ERROR, "NormFileBundle::Create() error opening bundle file\n");
+        NormFile::Unlink(path);
+        path[0] = '\0';
+        return false;
+    }
+    if (MAGIC_SIZE != file.Write(BUNDLE_MAGIC, MAGIC_SIZE))
+    {
+        PLOG(PL_ERROR, "NormFileBundle::Create() error writing bundle file\n");
+        file.Close();
+        NormFile::Unlink(path);
+        path[0] = '\0';
+        return false;
+    }
+    bundle_size = MAGIC_SIZE;
+    return true;
+}  // end NormFileBundle::Create()
+
+// Appends the content of "filePath" with the (relative) "name" as its index entry.  
+// If the bundle can't be written, the bundle is closed (i.e., IsOpen() is false 
+// and the bundle is unusable).
+bool NormFileBundle::Append(const char* filePath, const char* name, UINT16 nameLen)
+{
+    if (!file.IsOpen()) return false;
+    char buffer[COPY_BUFFER_SIZE];
+    if ((0 == nameLen) || (nameLen > (COPY_BUFFER_SIZE - ENTRY_HEADER_SIZE)))
+    {
+        PLOG(PL_ERROR, "NormFileBundle::Append() error: invalid name length\n");
+        return false;
+    }
+    NormFile input;
+    if (!input.Open(filePath, O_RDONLY))
+    {
+        PLOG(PL_ERROR, "NormFileBundle::Append() error opening file \"%s\"\n", filePath);
+        return false;
+    }
+    NormFile::Offset size = input.GetSize();
+    UINT32 mtime = (UINT32)NormFile::GetModifyTime(filePath);
+    UINT64 size64 = (UINT64)size;
+    // Index entry fields are in network (big endian) byte order
+    buffer[0] = (char)(nameLen >> 8);
+    buffer[1] = (char)nameLen;
+    buffer[2] = buffer[3] = 0;  // reserved
+    for (unsigned int i = 0; i < 4; i++)
+        buffer[4 + i] = (char)(mtime >> (8 * (3 - i)));
+    for (unsigned int i = 0; i < 8; i++)
+        buffer[8 + i] = (char)(size64 >> (8 * (7 - i)));
+    memcpy(buffer + ENTRY_HEADER_SIZE, name, nameLen);
+    size_t len = ENTRY_HEADER_SIZE + nameLen;
+    if (len != file.Write(buffer, len))
+    {
+        PLOG(PL_ERROR, "NormFileBundle::Append() error writing bundle index\n");
+        file.Close();
+        return false;
+    }
+    bundle_size += len;
+    NormFile::Offset remaining = size;
+    while (remaining > 0)
+    {
+        len = (remaining < COPY_BUFFER_SIZE) ? (size_t)remaining : (size_t)COPY_BUFFER_SIZE;
+        size_t result = input.Read(buffer, len);
+        if (result < len)
+        {
+            // The file shrank while being read, so zero-fill
+            // to keep the bundle consistent with its index
+            PLOG(PL_WARN, "NormFileBundle::Append() warning: short read of file \"%s\"\n", filePath);
+            memset(buffer + result, 0, len - result);
+        }
+        if (len != file.Write(buffer, len))
+        {
+            PLOG(PL_ERROR, "NormFileBundle::Append() error writing bundle content\n");
+            file.Close();
+            return false;
+        }
+        remaining -= len;
+    }
+    bundle_size += size;
+    file_count++;
+    return true;
+}  // end NormFileBundle::Append()
+
+bool NormFileBundle::Open(const char* bundlePath)
+{
+    Close();
+    bundle_size = 0;
+    file_count = 0;
+    done = false;
+    strncpy(path, bundlePath, PATH_MAX);
+    path[PATH_MAX - 1] = '\0';
+    if (!file.Open(path, O_RDONLY))
+    {
+        PLOG(PL_ERROR, "NormFileBundle::Open() error opening bundle file\n");
+        return false;
+    }
+    char magic[MAGIC_SIZE];
+    if ((MAGIC_SIZE != file.Read(magic, MAGIC_SIZE)) || 
+        (0 != memcmp(magic, BUNDLE_MAGIC, MAGIC_SIZE)))
+    {
+        PLOG(PL_ERROR, "NormFileBundle::Open() error: \"%s\" is not a bundle\n", path);
+        file.Close();
+        return false;
+    }
+    bundle_size = file.GetSize();
+    return true;
+}  // end NormFileBundle::Open()
+
+// Extracts the next member file into "dirPath" and returns its full path in 
+// "pathBuffer".  Members with unsafe names (absolute or with ".." components)
+// or that are locked are skipped.  Returns false at end of bundle (IsDone())
+// or upon error.
+bool NormFileBundle::Extract(const char* dirPath, char* pathBuffer)
+{
+    if (!file.IsOpen() || done) return false;
+    char buffer[COPY_BUFFER_SIZE];
+    size_t dirLen = strlen(dirPath);
+    while (true)
+    {
+        if (file.GetOffset() >= bundle_size)
+        {
+            done = true;  // end of bundle
+            return false;
+        }
+        if (ENTRY_HEADER_SIZE != file.Read(buffer, ENTRY_HEADER_SIZE))
+        {
+            PLOG(PL_ERROR, "NormFileBundle::Extract() error: truncated bundle index\n");
+            return false;
+        }
+        UINT16 nameLen = ((UINT16)(UINT8)buffer[0] << 8) | (UINT8)buffer[1];
+        UINT32 mtime = 0;
+        for (unsigned int i = 0; i < 4; i++)
+            mtime = (mtime << 8) | (UINT8)buffer[4 + i];
+        UINT64 size64 = 0;
+        for (unsigned int i = 0; i < 8; i++)
+            size64 = (size64 << 8) | (UINT8)buffer[8 + i];
+        NormFile::Offset size = (NormFile::Offset)size64;
+        if ((0 == nameLen) || (nameLen > (COPY_BUFFER_SIZE - ENTRY_HEADER_SIZE)) ||
+            (size < 0) || (size > (bundle_size - file.GetOffset())))
+        {
+            PLOG(PL_ERROR, "NormFileBundle::Extract() error: invalid bundle index\n");
+            return false;
+        }
+        if (nameLen != file.Read(buffer, nameLen))
+        {
+            PLOG(PL_ERROR, "NormFileBundle::Extract() error: truncated bundle index\n");
+            return false;
+        }
+        // Validate the name and build the full path, converting
+        // '/' in the name to the local directory delimiter
+        bool nameOK = ('/' != buffer[0]) && (PROTO_PATH_DELIMITER != buffer[0]) &&
+                      ((dirLen + nameLen) < PATH_MAX);
+        const char* item = buffer;
+        for (UINT16 i = 0; nameOK && (i <= nameLen); i++)
+        {
+            if ((i == nameLen) || ('/' == buffer[i]) || (PROTO_PATH_DELIMITER == buffer[i]))
+            {
+                if (((buffer + i) == item) || (((item + 2) == (buffer + i)) && ('.' == item[0]) && ('.' == item[1])))
+                    nameOK = false;  // empty or ".." path component
+                item = buffer + i + 1;
+            }
+            else if ('\0' == buffer[i])
+            {
+                nameOK = false;
+            }
+        }
+        if (nameOK)
+        {
+            strcpy(pathBuffer, dirPath);
+            for (UINT16 i = 0; i < nameLen; i++)
+                pathBuffer[dirLen + i] = ('/' == buffer[i]) ? PROTO_PATH_DELIMITER : buffer[i];
+            pathBuffer[dirLen + nameLen] = '\0';
+            if (NormFile::IsLocked(pathBuffer)) 
+            {
+                PLOG(PL_ERROR, "NormFileBundle::Extract() error: file \"%s\" is locked\n", pathBuffer);
+                nameOK = false;
+            }
+        }
+        else
+        {
+            PLOG(PL_ERROR, "NormFileBundle::Extract() error: invalid file name in bundle\n");
+        }
+        NormFile output;
+        if (nameOK && !output.Open(pathBuffer, O_WRONLY | O_CREAT | O_TRUNC))
+        {
+            PLOG(PL_ERROR, "NormFileBundle::Extract() error creating file \"%s\"\n", pathBuffer);
+            nameOK = false;
+        }
+        if (!nameOK)
+        {
+            // Skip this member's content
+            if (!file.Seek(file.GetOffset() + size)) return false;
+            continue;
+        }
+        NormFile::Offset remaining = size;
+        while (remaining > 0)
+        {
+            size_t len = (remaining < COPY_BUFFER_SIZE) ? (size_t)remaining : (size_t)COPY_BUFFER_SIZE;
+            if (len != file.Read(buffer, len))
+            {
+                PLOG(PL_ERROR, "NormFileBundle::Extract() error: truncated bundle content\n");
+                output.Close();
+                NormFile::Unlink(pathBuffer);
+                return false;
+            }
+            if (len != output.Write(buffer, len))
+            {
+                PLOG(PL_ERROR, "NormFileBundle::Extract() error writing file \"%s\"\n", pathBuffer);
+                output.Close();
+                NormFile::Unlink(pathBuffer);
+                return false;
+            }
+            remaining -= len;
+        }
+        output.Close();
+        NormFile::SetModifyTime(pathBuffer, (time_t)mtime);
+        file_count++;
+        return true;
+    }
+}  // end NormFileBundle::Extract()
+
+
+
+/******************************************
+* NormFileIo implementation
+*/
+
+NormFileIo::Request::Request()
+ : req_file(NULL), req_offset(0), req_buffer(NULL), req_length(0), 
+   status(IDLE), next(NULL)
+{
+}
+
+NormFileIo::Request::~Request()
+{
+    if (IsPending()) NormFileIo::Cancel(*this);
+}
+
+void NormFileIo::Request::Init(NormFile&           file, 
+                               NormFile::Offset    offset, 
+                               char*               buffer, 
+                               size_t              length)
+{
+    ASSERT(!IsPending());
+    req_file = &file;
+    req_offset = offset;
+    req_buffer = buffer;
+    req_length = length;
+    NormAtomicStore(&status, IDLE);
+}  // end NormFileIo::Request::Init()
+
+#ifdef WIN32
+
+// (TBD) use overlapped i/o on WIN32
+bool NormFileIo::Retain()
+{
+    return false;
+}  // end NormFileIo::Retain()
+
+void NormFileIo::Release()
+{
+}  // end NormFileIo::Release()
+
+bool NormFileIo::Submit(Request& /*request*/)
+{
+    return false;
+}  // end NormFileIo::Submit()
+
+bool NormFileIo::Cancel(Request& /*request*/, bool /*wait*/)
+{
+    return true;
+}  // end NormFileIo::Cancel()
+
+#else
+
+// The request queue and helper thread state is shared by all NORM
+// sessions (and instances) in the process.
+static pthread_mutex_t          norm_io_ref_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t          norm_io_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t           norm_io_queue_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t           norm_io_done_cond = PTHREAD_COND_INITIALIZER;
+static NormFileIo::Request*     norm_io_queue_head = NULL;
+static NormFileIo::Request*     norm_io_queue_tail = NULL;
+static unsigned int             norm_io_ref_count = 0;
+static unsigned int             norm_io_thread_count = 0;
+static pthread_t                norm_io_thread[NormFileIo::THREAD_COUNT];
+static bool                     norm_io_stopping = true;
+
+void NormFileIo::Request::Execute()
+{
+    size_t got = req_file->ReadAt(req_offset, req_buffer, req_length);
+    NormAtomicStore(&status, (got == req_length) ? DONE : FAILED);
+}  // end NormFileIo::Request::Execute()
+
+void* NormFileIo::Run(void* /*arg*/)
+{
+    pthread_mutex_lock(&norm_io_mutex);
+    while (!norm_io_stopping)
+    {
+        Request* request = norm_io_queue_head;
+        if (NULL == request)
+        {
+            pthread_cond_wait(&norm_io_queue_cond, &norm_io_mutex);
+            continue;
+        }
+        norm_io_queue_head = request->next;
+        if (NULL == norm_io_queue_head) norm_io_queue_tail = NULL;
+        request->next = NULL;
+        NormAtomicStore(&request->status, Request::BUSY);
+        pthread_mutex_unlock(&norm_io_mutex);
+        request->Execute();
+        pthread_mutex_lock(&norm_io_mutex);
+        pthread_cond_broadcast(&norm_io_done_cond);
+    }
+    pthread_mutex_unlock(&norm_io_mutex);
+    return NULL;
+}  // end NormFileIo::Run()
+
+bool NormFileIo::Retain()
+{
+    // (the "norm_io_ref_mutex" serializes helper thread startup/shutdown)
+    pthread_mutex_lock(&norm_io_ref_mutex);
+    if (0 == norm_io_ref_count)
+    {
+        pthread_mutex_lock(&norm_io_mutex);
+        norm_io_stopping = false;
+        pthread_mutex_unlock(&norm_io_mutex);
+        while (norm_io_thread_count < THREAD_COUNT)
+        {
+            if (0 != pthread_create(&norm_io_thread[norm_io_thread_count], NULL, Run, NULL))
+            {
+                PLOG(PL_ERROR, "NormFileIo::Retain() pthread_create() error: %s\n", GetErrorString());
+                break;
+            }
+            norm_io_thread_count++;
+        }
+        if (0 == norm_io_thread_count)
+        {
+            pthread_mutex_unlock(&norm_io_ref_mutex);
+            return false;
+        }
+    }
+    norm_io_ref_count++;
+    pthread_mutex_unlock(&norm_io_ref_mutex);
+    return true;
+}  // end NormFileIo::Retain()
+
+void NormFileIo::Release()
+{
+    pthread_mutex_lock(&norm_io_ref_mutex);
+    ASSERT(0 != norm_io_ref_count);
+    if (0 == --norm_io_ref_count)
+    {
+        pthread_mutex_lock(&norm_io_mutex);
+        norm_io_stopping = true;
+        pthread_cond_broadcast(&norm_io_queue_cond);
+        pthread_mutex_unlock(&norm_io_mutex);
+        for (unsigned int i = 0; i < norm_io_thread_count; i++)
+            pthread_join(norm_io_thread[i], NULL);
+        norm_io_thread_count = 0;
+    }
+    pthread_mutex_unlock(&norm_io_ref_mutex);
+}  // end NormFileIo::Release()
+
+bool NormFileIo::Submit(Request& request)
+{
+    ASSERT(!request.IsPending());
+    pthread_mutex_lock(&norm_io_mutex);
+    if (norm_io_stopping)
+    {
+        pthread_mutex_unlock(&norm_io_mutex);
+        return false;
+    }
+    request.next = NULL;
+    NormAtomicStore(&request.status, Request::QUEUED);
+    if (NULL != norm_io_queue_tail)
+        norm_io_queue_tail->next = &request;
+    else
+        norm_io_queue_head = &request;
+    norm_io_queue_tail = &request;
+    pthread_cond_signal(&norm_io_queue_cond);
+    pthread_mutex_unlock(&norm_io_mutex);
+    return true;
+}  // end NormFileIo::Submit()
+
+bool NormFileIo::Cancel(Request& request, bool wait)
+{
+    pthread_mutex_lock(&norm_io_mutex);
+    if (Request::QUEUED == request.GetStatus())
+    {
+        // Unlink it from the queue
+        Request* prev = NULL;
+        Request* next = norm_io_queue_head;
+        while ((NULL != next) && (&request != next))
+        {
+            prev = next;
+            next = next->next;
+        }
+        ASSERT(NULL != next);
+        if (NULL != prev)
+            prev->next = request.next;
+        else
+            norm_io_queue_head = request.next;
+        if (norm_io_queue_tail == &request) norm_io_queue_tail = prev;
+        request.next = NULL;
+        NormAtomicStore(&request.status, Request::IDLE);
+    }
+    bool result = true;
+    if (wait)
+    {
+        while (Request::BUSY == request.GetStatus())
+            pthread_cond_wait(&norm_io_done_cond, &norm_io_mutex);
+    }
+    else
+    {
+        result = (Request::BUSY != request.GetStatus());
+    }
+    pthread_mutex_unlock(&norm_io_mutex);
+    return result;
+}  // end NormFileIo::Cancel()
+
+#endif // if/else WIN32
@@ -7,7 +7,7 @@
 
 NormNode::NormNode(Type nodeType, class NormSession& theSession, NormNodeId nodeId)
  : session(theSession), node_type(nodeType), id(nodeId), reference_count(1), user_data(NULL),
-   parent(NULL), right(NULL), left(NULL)
+   parent(NULL), right(NULL), left(NULL), is_red(false)
 {
 }
 
@@ -69,7 +69,7 @@ NormSenderNode::NormSenderNode(class NormSession& theSession, NormNodeId nodeId)
    repair_boundary(BLOCK_BOUNDARY), decoder(NULL), erasure_loc(NULL),
    retrieval_loc(NULL), retrieval_pool(NULL), ack_pending(false), 
    ack_ex_pending(false), ack_ex_buffer(NULL), ack_ex_length(0),
-   notify_on_grtt_update(true),
+   notify_on_grtt_update(1),
    cc_sequence(0), cc_enable(false), cc_feedback_needed(false), cc_rate(0.0), 
    rtt_confirmed(false), is_clr(false), is_plr(false),
    slow_start(true), send_rate(0.0), recv_rate(0.0), recv_rate_prev(0.0),
@@ -106,6 +106,7 @@ NormSenderNode::NormSenderNode(class NormSession& theSession, NormNodeId nodeId)
     grtt_send_time.tv_usec = 0;
     grtt_quantized = NormQuantizeRtt(NormSession::DEFAULT_GRTT_ESTIMATE);
     grtt_estimate = NormUnquantizeRtt(grtt_quantized);
+    grtt_status.Publish(grtt_estimate);
     gsize_quantized = NormQuantizeGroupSize(NormSession::DEFAULT_GSIZE_ESTIMATE);
     gsize_estimate = NormUnquantizeGroupSize(gsize_quantized);
     
@@ -245,7 +246,7 @@ bool NormSenderNode::AllocateBuffers(unsigned int   bufferSpace,
     }
     
     // Segment buffers include space for NORM_OBJECT_STREAM stream payload header
-    if (!segment_pool.Init((unsigned int)numSegments, segmentSize+NormDataMsg::GetStreamPayloadHeaderLength()))
+    if (!segment_pool.Init((unsigned int)numSegments, segmentSize+NormDataMsg::GetStreamPayloadHeaderLength(), session.GetBufferLocking()))
     {
         PLOG(PL_FATAL, "NormSenderNode::AllocateBuffers() segment_pool init error\n");
         Close();
@@ -592,6 +593,7 @@ void NormSenderNode::UpdateGrttEstimate(UINT8 grttQuantized)
 {
     grtt_quantized = grttQuantized;
     grtt_estimate = NormUnquantizeRtt(grttQuantized);
+    grtt_status.Publish(grtt_estimate);
     PLOG(PL_DEBUG, "NormSenderNode::UpdateGrttEstimate() node>%lu sender>%lu new grtt: %lf sec\n",
                     (unsigned long)LocalNodeId(), (unsigned long)GetId(), grtt_estimate);
     // activity timer depends upon sender's grtt estimate
@@ -601,11 +603,8 @@ void NormSenderNode::UpdateGrttEstimate(UINT8 grttQuantized)
     activity_timer.SetInterval(activityInterval);
     if (activity_timer.IsActive()) activity_timer.Reschedule();
     // (TBD) Scale/reschedule repair_timer and/or cc_timer???
-    if (notify_on_grtt_update)
-    {
-        notify_on_grtt_update = false;
+    if (0 != NormAtomicExchange(&notify_on_grtt_update, 0))
         session.Notify(NormController::GRTT_UPDATED, this, (NormObject*)NULL);
-    }
 }  // end NormSenderNode::UpdateGrttEstimate()
 
 
@@ -1229,6 +1228,14 @@ void NormSenderNode::DeleteObject(NormObject* obj)
     }
 }  // end NormSenderNode::DeleteObject()
 
+void NormSenderNode::ServiceHeldEvents(bool flush, double& nextDelay)
+{
+    NormObjectTable::Iterator iterator(rx_table);
+    NormObject* obj;
+    while (NULL != (obj = iterator.GetNextObject()))
+        obj->ServiceHeldEvent(flush, nextDelay);
+}  // end NormSenderNode::ServiceHeldEvents()
+
 NormBlock* NormSenderNode::GetFreeBlock(NormObjectId objectId, NormBlockId blockId)
 {
     NormBlock* b = block_pool.Get();
@@ -1757,6 +1764,7 @@ void NormSenderNode::HandleObjectMessage(const NormObjectMsg& msg)
                 ASSERT(rx_table.CanInsert(objectId));
                 ASSERT(rx_pending_mask.Test(objectId));
                 if (doInsert) rx_table.Insert(obj);
+                obj->SetCompressed(msg.FlagIsSet(NormObjectMsg::FLAG_COMPRESSED));
                 // Pull out FTI parameters from header extension if we didn't get it above
                 if (!gotFTI)
                 {
@@ -1775,7 +1783,13 @@ void NormSenderNode::HandleObjectMessage(const NormObjectMsg& msg)
                                     ftiData.GetFecNumParity()))
                     {
                         session.Notify(NormController::RX_OBJECT_NEW, this, obj);
-                        if (obj->Accepted())
+                        if (obj != rx_table.Find(objectId))
+                        {
+                            // The object was removed during notification
+                            PLOG(PL_DEBUG, "NormSenderNode::HandleObjectMessage() new obj>%hu removed during notification\n", (UINT16)objectId);
+                            obj = NULL;
+                        }
+                        else if (obj->Accepted())
                         {
                             if (obj->IsStream()) 
                             {
@@ -1854,6 +1868,7 @@ void NormSenderNode::HandleObjectMessage(const NormObjectMsg& msg)
     if (NULL != obj)
     {
         obj->HandleObjectMessage(msg, msgType, blockId, segmentId);
+        obj->UpdateStatus();
         bool objIsPending = obj->IsPending();
         
         // Silent receivers may be configured to allow obj completion w/out INFO
@@ -1873,10 +1888,21 @@ void NormSenderNode::HandleObjectMessage(const NormObjectMsg& msg)
             {
                 // Streams never complete unless they are "closed" by sender
                 // and this is handled within stream control code in "normObject.cpp"
-                session.Notify(NormController::RX_OBJECT_COMPLETED, this, obj);
-                DeleteObject(obj);
-                obj = NULL;
-                completion_count++;
+                if (!obj->Decompress())
+                {
+                    // (this can only happen if the sender's content was bad)
+                    PLOG(PL_ERROR, "NormSenderNode::HandleObjectMessage() node>%lu sender>%lu obj>%hu decompression error\n",
+                                   (unsigned long)LocalNodeId(), (unsigned long)GetId(), (UINT16)obj->GetId());
+                    AbortObject(obj);
+                    obj = NULL;
+                }
+                else
+                {
+                    session.Notify(NormController::RX_OBJECT_COMPLETED, this, obj);
+                    DeleteObject(obj);
+                    obj = NULL;
+                    completion_count++;
+                }
             }
         } 
     }  // end (if (NULL != obj)  
@@ -3267,97 +3293,250 @@ void NormNodeTree::AttachNode(NormNode *node)
     node->Retain();
     node->left = NULL;
     node->right = NULL;
-    NormNode *x = root;
-    while (x)
+    node->is_red = true;
+    NormNode* y = NULL;
+    NormNode* x = root;
+    while (NULL != x)
     {
+        y = x;
         if (node->id < x->id)
+            x = x->left;
+        else
+            x = x->right;
+    }
+    node->parent = y;
+    if (NULL == y)
+        root = node;  // root _was_ NULL
+    else if (node->id < y->id)
+        y->left = node;
+    else
+        y->right = node;
+    AttachFixup(node);
+}  // end NormNodeTree::AttachNode()
+
+// Restores red-black properties after insertion of red node "x"
+void NormNodeTree::AttachFixup(NormNode* x)
+{
+    while ((NULL != x->parent) && x->parent->is_red)
+    {
+        NormNode* p = x->parent;
+        NormNode* g = p->parent;  // non-NULL since a red node is never root
+        if (p == g->left)
         {
-            if (!x->left)
+            NormNode* u = g->right;
+            if ((NULL != u) && u->is_red)
             {
-                x->left = node;
-                node->parent = x;
-                return;
+                p->is_red = false;
+                u->is_red = false;
+                g->is_red = true;
+                x = g;
             }
             else
             {
-                x = x->left;
+                if (x == p->right)
+                {
+                    x = p;
+                    RotateLeft(x);
+                    p = x->parent;
+                }
+                p->is_red = false;
+                g->is_red = true;
+                RotateRight(g);
             }
         }
         else
         {
-           if (!x->right)
-           {
-               x->right = node;
-               node->parent = x;
-               return;
-           }
-           else
-           {
-               x = x->right;
-           }   
+            NormNode* u = g->left;
+            if ((NULL != u) && u->is_red)
+            {
+                p->is_red = false;
+                u->is_red = false;
+                g->is_red = true;
+                x = g;
+            }
+            else
+            {
+                if (x == p->left)
+                {
+                    x = p;
+                    RotateRight(x);
+                    p = x->parent;
+                }
+                p->is_red = false;
+                g->is_red = true;
+                RotateLeft(g);
+            }
         }
     }
-    root = node;  // root _was_ NULL
-}  // end NormNodeTree::AttachNode()
-
+    root->is_red = false;
+}  // end NormNodeTree::AttachFixup()
 
 void NormNodeTree::DetachNode(NormNode* node)
 {
     ASSERT(NULL != node);
-    NormNode* x;
-    NormNode* y;
-    if (!node->left || !node->right)
+    NormNode* x;        // node that moves into the removed position
+    NormNode* xParent;  // (tracked separately since "x" may be NULL)
+    bool removedRed = node->is_red;
+    if (NULL == node->left)
     {
-        y = node;
+        x = node->right;
+        xParent = node->parent;
+        Transplant(node, node->right);
+    }
+    else if (NULL == node->right)
+    {
+        x = node->left;
+        xParent = node->parent;
+        Transplant(node, node->left);
     }
     else
     {
-        if (node->right)
+        // Replace "node" with its in-order successor "y"
+        NormNode* y = node->right;
+        while (y->left) y = y->left;
+        removedRed = y->is_red;
+        x = y->right;
+        if (y->parent == node)
         {
-            y = node->right;
-            while (y->left) y = y->left;
+            xParent = y;
         }
         else
         {
-            x = node;
-            y = node->parent;
-            while(y && (y->right == x))
-            {
-                x = y;
-                y = y->parent;
-            }
+            xParent = y->parent;
+            Transplant(y, y->right);
+            y->right = node->right;
+            y->right->parent = y;
         }
+        Transplant(node, y);
+        y->left = node->left;
+        y->left->parent = y;
+        y->is_red = node->is_red;
     }
-    if (y->left)
-        x = y->left;
-    else
-        x = y->right;
-    if (x) x->parent = y->parent;
-    if (!y->parent)
-        root = x;
-    else if (y == y->parent->left)
-        y->parent->left = x;
-    else
-        y->parent->right = x;
-    
-    if (node != y)
+    if (!removedRed) DetachFixup(x, xParent);
+    node->parent = node->left = node->right = NULL;
+    node->Release();  
+}  // end NormNodeTree::DetachNode()
+
+// Restores red-black properties after removal of a black node
+void NormNodeTree::DetachFixup(NormNode* x, NormNode* xParent)
+{
+    while ((x != root) && ((NULL == x) || !x->is_red))
     {
-        if ((y->parent = node->parent))
+        if (x == xParent->left)
         {
-            if (y->id < y->parent->id)
-                y->parent->left = y;
+            NormNode* w = xParent->right;  // non-NULL (black height of removed path > 0)
+            if (w->is_red)
+            {
+                w->is_red = false;
+                xParent->is_red = true;
+                RotateLeft(xParent);
+                w = xParent->right;
+            }
+            if (((NULL == w->left) || !w->left->is_red) &&
+                ((NULL == w->right) || !w->right->is_red))
+            {
+                w->is_red = true;
+                x = xParent;
+                xParent = x->parent;
+            }
             else
-                y->parent->right = y;
+            {
+                if ((NULL == w->right) || !w->right->is_red)
+                {
+                    w->left->is_red = false;
+                    w->is_red = true;
+                    RotateRight(w);
+                    w = xParent->right;
+                }
+                w->is_red = xParent->is_red;
+                xParent->is_red = false;
+                if (NULL != w->right) w->right->is_red = false;
+                RotateLeft(xParent);
+                x = root;
+            }
         }
         else
         {
-            root = y;
+            NormNode* w = xParent->left;
+            if (w->is_red)
+            {
+                w->is_red = false;
+                xParent->is_red = true;
+                RotateRight(xParent);
+                w = xParent->left;
+            }
+            if (((NULL == w->left) || !w->left->is_red) &&
+                ((NULL == w->right) || !w->right->is_red))
+            {
+                w->is_red = true;
+                x = xParent;
+                xParent = x->parent;
+            }
+            else
+            {
+                if ((NULL == w->left) || !w->left->is_red)
+                {
+                    w->right->is_red = false;
+                    w->is_red = true;
+                    RotateLeft(w);
+                    w = xParent->left;
+                }
+                w->is_red = xParent->is_red;
+                xParent->is_red = false;
+                if (NULL != w->left) w->left->is_red = false;
+                RotateRight(xParent);
+                x = root;
+            }
         }
-        if ((y->left = node->left)) y->left->parent = y;
-        if ((y->right = node->right)) y->right->parent = y;
-    }      
-    node->Release();  
-}  // end NormNodeTree::DetachNode()
+    }
+    if (NULL != x) x->is_red = false;
+}  // end NormNodeTree::DetachFixup()
+
+// Replaces subtree rooted at "u" with subtree rooted at "v"
+void NormNodeTree::Transplant(NormNode* u, NormNode* v)
+{
+    if (NULL == u->parent)
+        root = v;
+    else if (u == u->parent->left)
+        u->parent->left = v;
+    else
+        u->parent->right = v;
+    if (NULL != v) v->parent = u->parent;
+}  // end NormNodeTree::Transplant()
+
+void NormNodeTree::RotateLeft(NormNode* x)
+{
+    NormNode* y = x->right;
+    ASSERT(NULL != y);
+    x->right = y->left;
+    if (NULL != y->left) y->left->parent = x;
+    y->parent = x->parent;
+    if (NULL == x->parent)
+        root = y;
+    else if (x == x->parent->left)
+        x->parent->left = y;
+    else
+        x->parent->right = y;
+    y->left = x;
+    x->parent = y;
+}  // end NormNodeTree::RotateLeft()
+
+void NormNodeTree::RotateRight(NormNode* x)
+{
+    NormNode* y = x->left;
+    ASSERT(NULL != y);
+    x->left = y->right;
+    if (NULL != y->right) y->right->parent = x;
+    y->parent = x->parent;
+    if (NULL == x->parent)
+        root = y;
+    else if (x == x->parent->right)
+        x->parent->right = y;
+    else
+        x->parent->left = y;
+    y->right = x;
+    x->parent = y;
+}  // end NormNodeTree::RotateRight()
 
 
 void NormNodeTree::Destroy()
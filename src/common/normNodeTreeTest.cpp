@@ -0,0 +1,119 @@
+// This code benchmarks the NormNodeTree (used for the sender "acking_node_tree"
+// and receiver "sender_tree") with large node populations.  Node ids are
+// assigned sequentially (as when derived from consecutive IPv4 addresses)
+// which is the worst case for an unbalanced binary tree.
+
+#include "normSession.h"
+#include "protoTime.h"  // for ProtoTime
+
+#include <stdlib.h> // for rand(), atoi()
+#include <stdio.h>
+
+const unsigned int DEFAULT_NODE_COUNT = 10000;
+const unsigned int FIND_ROUNDS        = 10;
+
+int main(int argc, char* argv[])
+{
+    unsigned int nodeCount = DEFAULT_NODE_COUNT;
+    if (argc > 1) nodeCount = atoi(argv[1]);
+    if (0 == nodeCount)
+    {
+        fprintf(stderr, "Usage: normNodeTreeTest [<nodeCount>]\n");
+        return -1;
+    }
+
+    ProtoTime currentTime;
+    currentTime.GetCurrentTime();
+    srand((unsigned int)currentTime.usec());
+
+    ProtoDispatcher dispatcher;
+    NormSessionMgr sessionMgr(static_cast<ProtoTimerMgr&>(dispatcher),
+                              static_cast<ProtoSocket::Notifier&>(dispatcher));
+    NormSession* session = sessionMgr.NewSession("224.1.2.3", 6003, 1);
+    if (NULL == session)
+    {
+        fprintf(stderr, "normNodeTreeTest: error creating NormSession\n");
+        return -1;
+    }
+
+    NormNode** nodeList = new NormNode*[nodeCount];
+    const NormNodeId baseId = 0xc0a80001;  // 192.168.0.1
+    for (unsigned int i = 0; i < nodeCount; i++)
+        nodeList[i] = new NormAckingNode(*session, baseId + i);
+
+    NormNodeTree tree;
+    ProtoTime startTime, stopTime;
+
+    // 1) Attach nodes in (worst case) sequential id order
+    startTime.GetCurrentTime();
+    for (unsigned int i = 0; i < nodeCount; i++)
+        tree.AttachNode(nodeList[i]);
+    stopTime.GetCurrentTime();
+    double attachTime = ProtoTime::Delta(stopTime, startTime);
+
+    // 2) Lookup each node (as for incoming ACK/NACK/CC feedback)
+    unsigned int findErrors = 0;
+    startTime.GetCurrentTime();
+    for (unsigned int r = 0; r < FIND_ROUNDS; r++)
+    {
+        for (unsigned int i = 0; i < nodeCount; i++)
+        {
+            NormNodeId nodeId = baseId + (rand() % nodeCount);
+            NormNode* node = tree.FindNodeById(nodeId);
+            if ((NULL == node) || (nodeId != node->GetId())) findErrors++;
+        }
+    }
+    stopTime.GetCurrentTime();
+    double findTime = ProtoTime::Delta(stopTime, startTime);
+
+    // 3) Iterate the tree and confirm ascending id order is preserved
+    unsigned int iterateCount = 0;
+    unsigned int orderErrors = 0;
+    startTime.GetCurrentTime();
+    NormNodeTreeIterator iterator(tree);
+    NormNode* prev = NULL;
+    NormNode* next;
+    while (NULL != (next = iterator.GetNextNode()))
+    {
+        if ((NULL != prev) && (next->GetId() < prev->GetId())) orderErrors++;
+        prev = next;
+        iterateCount++;
+    }
+    stopTime.GetCurrentTime();
+    double iterateTime = ProtoTime::Delta(stopTime, startTime);
+
+    // 4) Detach nodes in random order
+    for (unsigned int i = 0; i < nodeCount; i++)
+    {
+        unsigned int j = i + (rand() % (nodeCount - i));
+        NormNode* tmp = nodeList[i];
+        nodeList[i] = nodeList[j];
+        nodeList[j] = tmp;
+    }
+    startTime.GetCurrentTime();
+    for (unsigned int i = 0; i < nodeCount; i++)
+        tree.DetachNode(nodeList[i]);
+    stopTime.GetCurrentTime();
+    double detachTime = ProtoTime::Delta(stopTime, startTime);
+    if (NULL != tree.GetRoot()) orderErrors++;
+
+    for (unsigned int i = 0; i < nodeCount; i++)
+        nodeList[i]->Release();
+    delete[] nodeList;
+    sessionMgr.DeleteSession(session);
+
+    if ((0 != findErrors) || (0 != orderErrors) || (nodeCount != iterateCount))
+    {
+        fprintf(stderr, "normNodeTreeTest: error: findErrors:%u orderErrors:%u iterateCount:%u\n",
+                        findErrors, orderErrors, iterateCount);
+        return -1;
+    }
+
+    unsigned int findCount = FIND_ROUNDS * nodeCount;
+    fprintf(stderr, "normNodeTreeTest: nodeCount:%u\n", nodeCount);
+    fprintf(stderr, "   attach:  %lf usec total (%lf usec/node)\n", 1.0e+06*attachTime, 1.0e+06*attachTime/nodeCount);
+    fprintf(stderr, "   find:    %lf usec total (%lf usec/lookup)\n", 1.0e+06*findTime, 1.0e+06*findTime/findCount);
+    fprintf(stderr, "   iterate: %lf usec total (%lf usec/node)\n", 1.0e+06*iterateTime, 1.0e+06*iterateTime/nodeCount);
+    fprintf(stderr, "   detach:  %lf usec total (%lf usec/node)\n", 1.0e+06*detachTime, 1.0e+06*detachTime/nodeCount);
+    return 0;
+}  // end main()
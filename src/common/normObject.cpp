@@ -1,5 +1,8 @@
 #include "normObject.h"
 #include "normSession.h"
+#include "normCompress.h"
+
+#include <new>  // for std::nothrow
 
 #ifndef _WIN32_WCE
 #include <fcntl.h>
@@ -15,12 +18,13 @@ NormObject::NormObject(NormObject::Type      theType,
    transport_id(transportId), segment_size(0), pending_info(false), repair_info(false),
    current_block_id(0), next_segment_id(0), 
    max_pending_block(0), max_pending_segment(0),
-   info_ptr(NULL), info_len(0), first_pass(true), accepted(false), notify_on_update(true),
-   user_data(NULL)
-#ifndef USE_PROTO_TREE
-   , next(NULL)
-#endif
+   info_ptr(NULL), info_len(0), compressed(false), first_pass(true), accepted(false), notify_on_update(true),
+   event_held(false), update_bytes(0), user_data(NULL)
 {
+    event_post_time.Zeroize();
+    Status status;
+    status.buffer_usage = 0;
+    status_snapshot.Publish(status);
     if (theSender)
     {
         nacking_mode = theSender->GetDefaultNackingMode();
@@ -151,11 +155,12 @@ bool NormObject::Open(const NormObjectSize& objectSize,
         
     // No NormBlockId wrapping for NORM_DATA or NORM_FILE objects
     // (so we zero fec_block_mask for "unsigned" value behaviors
-    // in NormBlockId and ProtoBitmask classes    
+    // in NormBlockId and NormBitmask classes    
 
     if (!IsStream()) fec_block_mask = 0;  
     
-    if (!block_buffer.Init(numBlocks.LSB(), 256, fec_block_mask))
+    // (block_buffer ring is direct-mapped for objects up to 1024 blocks)
+    if (!block_buffer.Init(numBlocks.LSB(), 1024, fec_block_mask))
     {
         PLOG(PL_FATAL, "NormObject::Open() init block_buffer error\n");  
         Close();
@@ -241,6 +246,12 @@ bool NormObject::Open(const NormObjectSize& objectSize,
     next_segment_id = 0;
     max_pending_block = 0;
     max_pending_segment = 0;
+    
+    // Everything is pending upon open
+    Status status;
+    status.bytes_pending = IsStream() ? NormObjectSize(0) : objectSize;
+    status.buffer_usage = 0;
+    status_snapshot.Publish(status);
     return true;
 }  // end NormObject::Open()
 
@@ -295,6 +306,91 @@ NormObjectSize NormObject::GetBytesPending() const
     }    
 }  // end NormObject::GetBytesPending()
 
+// Called by the NORM thread (or API with the dispatcher lock held) after
+// the object has changed state (message sent or received, stream data 
+// written or read, event posted) so "GetStatus()" readers see current 
+// values even after the object goes idle.
+void NormObject::UpdateStatus()
+{
+    Status status;
+    status.bytes_pending = GetBytesPending();
+    status.buffer_usage = IsStream() ? 
+        static_cast<NormStreamObject*>(this)->GetCurrentBufferUsage() : 0;
+    status_snapshot.Publish(status);
+}  // end NormObject::UpdateStatus()
+
+bool NormObject::CoalesceCheck(UINT32 byteCount, double& holdDelay)
+{
+    if (!session.EventCoalescing()) return true;
+    ProtoTime currentTime;
+    currentTime.GetCurrentTime();
+    if (!event_held)
+    {
+        event_held = true;
+        event_hold_time = currentTime;
+    }
+    double latencyDelay = session.GetCoalesceLatency() - ProtoTime::Delta(currentTime, event_hold_time);
+    double rateDelay = session.GetCoalesceInterval() - ProtoTime::Delta(currentTime, event_post_time);
+    bool bytesReady = (byteCount >= session.GetCoalesceBytes());
+    if ((latencyDelay < 1.0e-06) || (bytesReady && (rateDelay < 1.0e-06)))
+    {
+        event_held = false;
+        event_post_time = currentTime;
+        return true;
+    }
+    holdDelay = (bytesReady && (rateDelay < latencyDelay)) ? rateDelay : latencyDelay;
+    return false;
+}  // end NormObject::CoalesceCheck()
+
+// Called via the session "coalesce_timer" to post a held event that is due
+// (the "nextDelay" is reduced to this object's hold time if it remains held)
+void NormObject::ServiceHeldEvent(bool flush, double& nextDelay)
+{
+    if (!event_held) return;
+    NormStreamObject* stream = IsStream() ? static_cast<NormStreamObject*>(this) : NULL;
+    if (NULL == sender)
+    {
+        // A TX_QUEUE_VACANCY is only posted if the vacancy remains
+        if ((NULL == stream) || !stream->HasVacancy())
+        {
+            event_held = false;
+            return;
+        }
+        double holdDelay;
+        if (flush || CoalesceCheck(stream->GetVacancy(session.GetCoalesceBytes()), holdDelay))
+        {
+            event_held = false;
+            session.Notify(NormController::TX_QUEUE_VACANCY, (NormSenderNode*)NULL, this);
+        }
+        else if ((nextDelay < 0.0) || (holdDelay < nextDelay))
+        {
+            nextDelay = holdDelay;
+        }
+    }
+    else
+    {
+        // An RX_OBJECT_UPDATED is only posted if the application has
+        // not otherwise been notified since
+        if (!notify_on_update)
+        {
+            event_held = false;
+            return;
+        }
+        double holdDelay;
+        if (flush || CoalesceCheck(update_bytes, holdDelay))
+        {
+            event_held = false;
+            notify_on_update = false;
+            update_bytes = 0;
+            session.Notify(NormController::RX_OBJECT_UPDATED, sender, this);
+        }
+        else if ((nextDelay < 0.0) || (holdDelay < nextDelay))
+        {
+            nextDelay = holdDelay;
+        }
+    }
+}  // end NormObject::ServiceHeldEvent()
+
 // Used by sender
 bool NormObject::HandleInfoRequest(bool holdoff)
 {
@@ -1529,6 +1625,7 @@ void NormObject::HandleObjectMessage(const NormObjectMsg& msg,
                     if (WriteSegment(blockId, segmentId, data.GetPayload()))
                     {
                         objectUpdated = true;
+                        if (session.EventCoalescing()) update_bytes += segmentLength;
                         // For statistics only (TBD) #ifdef NORM_DEBUG
                         sender->IncrementRecvGoodput(segmentLength);
                     }
@@ -1616,6 +1713,7 @@ void NormObject::HandleObjectMessage(const NormObjectMsg& msg,
                                 if (WriteSegment(blockId, sid, block->GetSegment(sid)))
                                 {
                                     objectUpdated = true;
+                                    if (session.EventCoalescing()) update_bytes += segmentLength;
                                     // For statistics only (TBD) #ifdef NORM_DEBUG
                                     // "segmentLength" is not necessarily correct here (TBD - fix this)
                                     sender->IncrementRecvGoodput(segmentLength);
@@ -1641,6 +1739,7 @@ void NormObject::HandleObjectMessage(const NormObjectMsg& msg,
                     pending_mask.Unset(blockId.GetValue());
                     block_buffer.Remove(block);
                     sender->PutFreeBlock(block); 
+                    OnBlockCompleted(blockId);
                 }  // if erasureCount <= parityCount (i.e., block complete)
                 // Notify application of new data available
                 // (TBD) this could be improved for stream objects
@@ -1649,8 +1748,17 @@ void NormObject::HandleObjectMessage(const NormObjectMsg& msg,
                 {
                     if ((NULL == stream) || stream->DetermineReadReadiness() || session.RcvrIsLowDelay())
                     {
-                        notify_on_update = false;
-                        session.Notify(NormController::RX_OBJECT_UPDATED, sender, this);
+                        double holdDelay;
+                        if (CoalesceCheck(update_bytes, holdDelay))
+                        {
+                            notify_on_update = false;
+                            update_bytes = 0;
+                            session.Notify(NormController::RX_OBJECT_UPDATED, sender, this);
+                        }
+                        else
+                        {
+                            session.ActivateCoalesceTimer(holdDelay);
+                        }
                     }
                 }   
             }
@@ -1805,6 +1913,7 @@ bool NormObject::NextSenderMsg(NormObjectMsg* msg)
         default:
             break;
     }
+    if (compressed) msg->SetFlag(NormObjectMsg::FLAG_COMPRESSED);
     NormSession::FtiMode ftiMode = session.SenderFtiMode();
     if ((NULL != info_ptr) || (NormSession::FTI_INFO == ftiMode))
         msg->SetFlag(NormObjectMsg::FLAG_INFO);
@@ -1994,6 +2103,9 @@ bool NormObject::NextSenderMsg(NormObjectMsg* msg)
             block = NULL;
             continue; //return NextSenderMsg(msg);
         }
+        // Wait for any content still being loaded (e.g., file read-ahead)
+        if (((segmentId < numData) || !block->ParityReady(numData)) && !IsBlockReady(blockId))
+            return false;
         // Try to read segment 
         if (segmentId < numData)
         {
@@ -2292,9 +2404,14 @@ NormFileObject::NormFileObject(class NormSession&       theSession,
                                class NormSenderNode*    theSender,
                                const NormObjectId&      objectId)
  : NormObject(FILE, theSession, theSender, objectId), 
-   large_block_length(0), small_block_length(0)
+   large_block_length(0), small_block_length(0),
+   read_ahead(NULL), read_ahead_count(0), read_ahead_front(0), read_pending(false),
+   write_behind(NULL), write_behind_count(0),
+   file_mapped(false), map_ptr(NULL), map_offset(0), map_length(0), map_file_size(0)
 {
     path[0] = '\0';
+    resume_path[0] = '\0';
+    comp_path[0] = '\0';
 }
 
 NormFileObject::~NormFileObject()
@@ -2305,7 +2422,8 @@ NormFileObject::~NormFileObject()
 // Open file 
 bool NormFileObject::Open(const char* thePath,
                           const char* infoPtr,
-                          UINT16      infoLen)
+                          UINT16      infoLen,
+                          bool        truncate)
 {
     if (sender)  
     {
@@ -2317,7 +2435,7 @@ bool NormFileObject::Open(const char* thePath,
         }
         else
         {
-            if (file.Open(thePath, O_RDWR | O_CREAT | O_TRUNC))
+            if (file.Open(thePath, truncate ? (O_RDWR | O_CREAT | O_TRUNC) : (O_RDWR | O_CREAT)))
             {
                 if (!file.Lock())
                     PLOG(PL_WARN, "NormFileObject::Open() warning: NormFile::Lock() failure\n");
@@ -2340,7 +2458,30 @@ bool NormFileObject::Open(const char* thePath,
         }        
 			
         // We're sending this file
-        if (file.Open(thePath, O_RDONLY))
+        const char* filePath = thePath;
+        if (session.GetTxCompression())
+        {
+            // Send a compressed copy instead if that's smaller
+            UINT32 chunkSize = (UINT32)session.SenderSegmentSize() * session.SenderBlockSize();
+            if (NormFile::MakeTemp(NormFile::GetTempDir(), "normComp", comp_path))
+            {
+                if (NormCompressor::CompressFile(thePath, comp_path, chunkSize))
+                {
+                    filePath = comp_path;
+                    compressed = true;
+                }
+                else
+                {
+                    if (NormFile::Exists(comp_path)) NormFile::Unlink(comp_path);
+                    comp_path[0] = '\0';
+                }
+            }
+            else
+            {
+                comp_path[0] = '\0';
+            }
+        }
+        if (file.Open(filePath, O_RDONLY))
         {
             NormObjectSize::Offset size = file.GetSize(); 
             //if (size)
@@ -2375,6 +2516,42 @@ bool NormFileObject::Open(const char* thePath,
     }
     large_block_length = NormObjectSize(large_block_size) * segment_size;
     small_block_length = NormObjectSize(small_block_size) * segment_size;
+    if ((NULL != sender) && (0 != session.GetRxFileWriteBehind()))
+    {
+        // Set up write-behind slots so received segments are written in bulk
+        unsigned int slotCount = session.GetRxFileWriteBehind();
+        if (slotCount > (final_block_id.GetValue() + 1))
+            slotCount = final_block_id.GetValue() + 1;
+        if (NULL == (write_behind = new WriteBehindSlot[slotCount]))
+            PLOG(PL_WARN, "NormFileObject::Open() new write_behind error: %s\n", GetErrorString());
+        else
+            write_behind_count = slotCount;
+    }
+    else if ((NULL == sender) && session.GetFileMapping() && MapFile())
+    {
+        // File content is read via the mapping (no read-ahead needed)
+    }
+    else if ((NULL == sender) && (0 != session.GetTxFileReadAhead()))
+    {
+        // Set up read-ahead slots so file content is loaded by helper threads
+        unsigned int slotCount = session.GetTxFileReadAhead();
+        if (slotCount > (final_block_id.GetValue() + 1))
+            slotCount = final_block_id.GetValue() + 1;
+        if (!NormFileIo::Retain())
+        {
+            PLOG(PL_WARN, "NormFileObject::Open() warning: file read-ahead not available\n");
+        }
+        else if (NULL == (read_ahead = new ReadAheadSlot[slotCount]))
+        {
+            PLOG(PL_WARN, "NormFileObject::Open() new read_ahead error: %s\n", GetErrorString());
+            NormFileIo::Release();
+        }
+        else
+        {
+            read_ahead_count = slotCount;
+            read_ahead_front = 0;
+        }
+    }
     strncpy(path, thePath, PATH_MAX);
     size_t len = strlen(thePath);
     len = MIN(len, PATH_MAX);
@@ -2384,19 +2561,48 @@ bool NormFileObject::Open(const char* thePath,
                 
 bool NormFileObject::Accept(const char* thePath)
 {
-    if (Open(thePath))
-    {
+    // If resuming, "resumeMask" is set to the blocks already received
+    NormBitmask resumeMask;
+    bool resume = session.GetRxFileResume() && ReadResumeState(thePath, resumeMask);
+    if (Open(thePath, NULL, 0, !resume))
+    {
+        // Reserve the whole file up front (less fragmentation)
+        if (!file.Allocate(NormObject::GetSize().GetOffset()))
+            PLOG(PL_WARN, "NormFileObject::Accept() warning: NormFile::Allocate() failure\n");
+        else if (session.GetFileMapping() && MapFile())
+            CloseWriteBehind();  // segments are stored via the mapping instead
+        if (resume)
+        {
+            UINT32 index;
+            if (resumeMask.GetFirstSet(index))
+            {
+                do
+                {
+                    pending_mask.Unset(index);
+                    index++;
+                } while (resumeMask.GetNextSet(index));
+            }
+            PLOG(PL_INFO, "NormFileObject::Accept() resuming obj>%hu with %lu of %lu blocks received\n",
+                          (UINT16)transport_id, (unsigned long)resumeMask.GetSetCount(),
+                          (unsigned long)resumeMask.GetSize());
+        }
+        if ('\0' != resume_path[0]) resume_save_time.GetCurrentTime();
         NormObject::Accept(); 
         return true;  
     }
     else
     {
+        resume_path[0] = '\0';
         return false;
     }
 }  // end NormFileObject::Accept()
 
 void NormFileObject::CloseFile()
 {
+    UnmapFile();
+    CloseReadAhead();
+    if (!CloseWriteBehind())
+        PLOG(PL_ERROR, "NormFileObject::CloseFile() error writing staged segments\n");
     if (file.IsOpen())
     {
         if (NULL != sender)  // we've been receiving this file
@@ -2408,9 +2614,213 @@ void NormFileObject::CloseFile()
 void NormFileObject::Close()
 {
     CloseFile();
+    if ('\0' != resume_path[0])
+    {
+        // Keep the sidecar (with all received blocks now written) for
+        // possible resumption unless reception is complete
+        if (IsPending())
+            WriteResumeState();
+        else
+            NormFile::Unlink(resume_path);
+        resume_path[0] = '\0';
+    }
+    if ('\0' != comp_path[0])
+    {
+        NormFile::Unlink(comp_path);  // sender temp compressed copy
+        comp_path[0] = '\0';
+    }
     NormObject::Close();
 }  // end NormFileObject::Close()
 
+// Replaces the received (compressed) file content with the original
+bool NormFileObject::Decompress()
+{
+    if (!compressed) return true;
+    CloseFile();
+    char tempPath[PATH_MAX+10];
+    strcpy(tempPath, path);
+    strcat(tempPath, ".normz");
+    if (!NormCompressor::DecompressFile(path, tempPath))
+    {
+        PLOG(PL_ERROR, "NormFileObject::Decompress() error decompressing \"%s\"\n", path);
+        return false;
+    }
+    NormFile::Offset size = NormFile::GetSize(tempPath);
+    if (!file.Rename(tempPath, path))
+    {
+        PLOG(PL_ERROR, "NormFileObject::Decompress() error replacing \"%s\"\n", path);
+        NormFile::Unlink(tempPath);
+        return false;
+    }
+    object_size = NormObjectSize((NormObjectSize::Offset)size);
+    compressed = false;
+    return true;
+}  // end NormFileObject::Decompress()
+
+// Called after each block is received, this periodically updates the resume sidecar
+void NormFileObject::OnBlockCompleted(NormBlockId /*blockId*/)
+{
+    if ('\0' == resume_path[0]) return;
+    ProtoTime currentTime;
+    currentTime.GetCurrentTime();
+    if (ProtoTime::Delta(currentTime, resume_save_time) >= (double)RESUME_SAVE_INTERVAL)
+    {
+        WriteResumeState();
+        resume_save_time = currentTime;
+    }
+}  // end NormFileObject::OnBlockCompleted()
+
+// Sets "resume_path" to the sidecar path for this object in the directory of "thePath"
+// and, if a sidecar matching this object's sender, instance, and FTI is found, renames
+// its partially received file to "thePath" and sets "blockMask" to the blocks it has.
+// (The sidecar is a short text file with the identifying info, the file path, and a
+//  hex bitmask of received blocks)
+bool NormFileObject::ReadResumeState(const char* thePath, NormBitmask& blockMask)
+{
+    const char* ptr = strrchr(thePath, PROTO_PATH_DELIMITER);
+    size_t dirLen = (NULL != ptr) ? (ptr - thePath + 1) : 0;
+    if ((dirLen + 40) > PATH_MAX)
+    {
+        PLOG(PL_ERROR, "NormFileObject::ReadResumeState() error: path too long\n");
+        return false;
+    }
+    strncpy(resume_path, thePath, dirLen);
+    sprintf(resume_path + dirLen, ".normResume-%08lx-%04hx-%04hx", 
+            (unsigned long)sender->GetId(), (UINT16)sender->GetInstanceId(), (UINT16)transport_id);
+    if (!NormFile::Exists(resume_path)) return false;
+    
+    ::FILE* stateFile = fopen(resume_path, "r");  // (NormObject::FILE hides stdio FILE here)
+    if (NULL == stateFile)
+    {
+        PLOG(PL_ERROR, "NormFileObject::ReadResumeState() fopen() error: %s\n", GetErrorString());
+        return false;
+    }
+    bool result = false;
+    char line[PATH_MAX + 16];
+    unsigned long senderId, sizeMsb, sizeLsb, blockCount;
+    unsigned int instanceId, objectId, segmentSize, fecId, fecM, numData, numParity;
+    char filePath[PATH_MAX];
+    UINT32 numBlocks = final_block_id.GetValue() + 1;
+    if ((NULL != fgets(line, sizeof(line), stateFile)) && (0 == strcmp(line, "NORM_RESUME 1\n")) &&
+        (NULL != fgets(line, sizeof(line), stateFile)) &&
+        (3 == sscanf(line, "id %lx %x %x", &senderId, &instanceId, &objectId)) &&
+        (NULL != fgets(line, sizeof(line), stateFile)) &&
+        (7 == sscanf(line, "fti %lu %lu %u %u %u %u %u", &sizeMsb, &sizeLsb, &segmentSize, 
+                                                         &fecId, &fecM, &numData, &numParity)) &&
+        (NULL != fgets(line, sizeof(line), stateFile)) &&
+        (1 == sscanf(line, "blocks %lu", &blockCount)) &&
+        (NULL != fgets(line, sizeof(line), stateFile)) && (0 == strncmp(line, "path ", 5)))
+    {
+        size_t len = strlen(line + 5);
+        if ((len > 0) && ('\n' == line[5 + len - 1])) len--;
+        len = MIN(len, PATH_MAX - 1);
+        memcpy(filePath, line + 5, len);
+        filePath[len] = '\0';
+        // Make sure it's state for this very object
+        if ((senderId == (unsigned long)sender->GetId()) && 
+            (instanceId == sender->GetInstanceId()) && 
+            (objectId == (UINT16)transport_id) &&
+            (sizeMsb == (unsigned long)object_size.MSB()) && 
+            (sizeLsb == (unsigned long)object_size.LSB()) &&
+            (segmentSize == segment_size) && (fecId == fec_id) && (fecM == fec_m) &&
+            (numData == ndata) && (numParity == nparity) && (blockCount == numBlocks) &&
+            blockMask.Init(numBlocks))
+        {
+            // Read the hex bitmask (4 blocks per digit)
+            UINT32 index = 0;
+            int c;
+            result = true;
+            while ((index < numBlocks) && (EOF != (c = fgetc(stateFile))))
+            {
+                int value;
+                if ((c >= '0') && (c <= '9'))
+                    value = c - '0';
+                else if ((c >= 'a') && (c <= 'f'))
+                    value = c - 'a' + 10;
+                else if ('\n' == c)
+                    continue;
+                else
+                {
+                    result = false;
+                    break;
+                }
+                for (int i = 0; (i < 4) && (index < numBlocks); i++, index++)
+                    if (0 != (value & (0x08 >> i))) blockMask.Set(index);
+            }
+            if (index < numBlocks) result = false;
+        }
+    }
+    fclose(stateFile);
+    if (result)
+    {
+        if (!NormFile::Exists(filePath) || NormFile::IsLocked(filePath))
+        {
+            result = false;
+        }
+        else if (0 != strcmp(filePath, thePath))
+        {
+            NormFile temp;
+            result = temp.Rename(filePath, thePath);
+        }
+    }
+    if (!result)
+    {
+        PLOG(PL_WARN, "NormFileObject::ReadResumeState() discarding invalid or stale resume state\n");
+        NormFile::Unlink(resume_path);
+    }
+    return result;
+}  // end NormFileObject::ReadResumeState()
+
+// Writes received block state to the sidecar (blocks still staged for 
+// write-behind are not recorded as received)
+bool NormFileObject::WriteResumeState()
+{
+    char tempPath[PATH_MAX + 4];
+    snprintf(tempPath, PATH_MAX + 4, "%s.tmp", resume_path);
+    ::FILE* stateFile = fopen(tempPath, "w");
+    if (NULL == stateFile)
+    {
+        PLOG(PL_ERROR, "NormFileObject::WriteResumeState() fopen() error: %s\n", GetErrorString());
+        return false;
+    }
+    UINT32 numBlocks = final_block_id.GetValue() + 1;
+    fprintf(stateFile, "NORM_RESUME 1\n");
+    fprintf(stateFile, "id %08lx %04hx %04hx\n", (unsigned long)sender->GetId(), 
+                       (UINT16)sender->GetInstanceId(), (UINT16)transport_id);
+    fprintf(stateFile, "fti %lu %lu %u %u %u %u %u\n", 
+                       (unsigned long)object_size.MSB(), (unsigned long)object_size.LSB(), 
+                       (unsigned int)segment_size, (unsigned int)fec_id, (unsigned int)fec_m, 
+                       (unsigned int)ndata, (unsigned int)nparity);
+    fprintf(stateFile, "blocks %lu\n", (unsigned long)numBlocks);
+    fprintf(stateFile, "path %s\n", path);
+    const char* hex = "0123456789abcdef";
+    UINT32 index = 0;
+    while (index < numBlocks)
+    {
+        int value = 0;
+        for (int i = 0; i < 4; i++, index++)
+        {
+            if ((index < numBlocks) && !pending_mask.Test(index) && (NULL == FindWriteBehind(NormBlockId(index))))
+                value |= (0x08 >> i);
+        }
+        fputc(hex[value], stateFile);
+        if ((0 == (index & 0xff)) || (index >= numBlocks)) fputc('\n', stateFile);
+    }
+    bool result = (0 == ferror(stateFile));
+    if (0 != fclose(stateFile)) result = false;
+    if (result)
+    {
+        NormFile temp;
+        result = temp.Rename(tempPath, resume_path);
+    }
+    if (!result)
+    {
+        PLOG(PL_ERROR, "NormFileObject::WriteResumeState() error writing resume state\n");
+        NormFile::Unlink(tempPath);
+    }
+    return result;
+}  // end NormFileObject::WriteResumeState()
+
 bool NormFileObject::WriteSegment(NormBlockId   blockId, 
                                   NormSegmentId segmentId, 
                                   const char*   buffer)
@@ -2427,26 +2837,33 @@ bool NormFileObject::WriteSegment(NormBlockId   blockId,
     {
         len = segment_size;
     }
-    // Determine segment offset from blockId::segmentId
-    NormObjectSize segmentOffset;
-    NormObjectSize segmentSize = NormObjectSize(segment_size);
-    if (blockId.GetValue() < large_block_count)
-    {
-        segmentOffset = (large_block_length*blockId.GetValue()) + (segmentSize*segmentId);
-    }
-    else
+    if (file_mapped)
     {
-        segmentOffset = large_block_length*large_block_count;  // (TBD) pre-calc this 
-        UINT32 smallBlockIndex = blockId.GetValue() - large_block_count;
-        segmentOffset = segmentOffset + small_block_length*smallBlockIndex +
-                                        segmentSize*segmentId;
+        char* ptr = MapSegment(blockId, segmentId, len);
+        if (NULL != ptr)
+        {
+            memcpy(ptr, buffer, len);
+            return true;
+        }
+        // else write it with the file descriptor
     }
-	NormFile::Offset offset = segmentOffset.GetOffset();
-    if (offset != file.GetOffset())
+    if (NULL != write_behind)
     {
-        if (!file.Seek(offset)) return false; 
+        // Stage the segment for a later, coalesced write
+        WriteBehindSlot* slot = GetWriteBehind(blockId);
+        if (NULL != slot)
+        {
+            memcpy(slot->buffer + (size_t)segmentId*segment_size, buffer, len);
+            if (!slot->mask.Test(segmentId))
+            {
+                slot->mask.Set(segmentId);
+                slot->count++;
+            }
+            return true;
+        }
+        // else write it directly
     }
-    size_t nbytes = file.Write(buffer, len);
+    size_t nbytes = file.WriteAt(GetSegmentOffset(blockId, segmentId), buffer, len);
     return (nbytes == len);
 }  // end NormFileObject::WriteSegment()
 
@@ -2469,32 +2886,47 @@ UINT16 NormFileObject::ReadSegment(NormBlockId      blockId,
         len = segment_size;
     }
     
-    // Determine segment offset from blockId::segmentId
-    NormObjectSize segmentOffset;
-    NormObjectSize segmentSize = NormObjectSize(segment_size);
-    if (blockId.GetValue() < large_block_count)
+    if (file_mapped)
     {
-        segmentOffset = large_block_length*blockId.GetValue() + segmentSize*segmentId;
+        char* ptr = MapSegment(blockId, segmentId, len);
+        if (NULL != ptr)
+        {
+            memcpy(buffer, ptr, len);
+            if ((0 == segmentId) && (NULL == sender) && (blockId != final_block_id))
+            {
+                // Hint that the next block will be sent soon
+                NormBlockId nextId = blockId.GetValue() + 1;
+                NormFile::Offset nextOffset = GetSegmentOffset(nextId, 0);
+                NormFile::Offset mapEnd = map_offset + (NormFile::Offset)map_length;
+                if ((nextOffset > map_offset) && (nextOffset < mapEnd))
+                {
+                    size_t nextLength = (size_t)GetBlockSize(nextId) * segment_size;
+                    if ((nextOffset + (NormFile::Offset)nextLength) > mapEnd)
+                        nextLength = (size_t)(mapEnd - nextOffset);
+                    NormFile::Advise(map_ptr + (nextOffset - map_offset), nextLength, 
+                                     NormFile::ADVISE_WILLNEED);
+                }
+            }
+            return (UINT16)len;
+        }
+        // else read it with the file descriptor
     }
-    else
+    // Use read-ahead content when it has been loaded
+    ReadAheadSlot* slot = FindReadAhead(blockId);
+    if ((NULL != slot) && (NormFileIo::Request::DONE == slot->request.GetStatus()))
     {
-        segmentOffset = large_block_length*large_block_count;  // (TBD) pre-calc this  
-        UINT32 smallBlockIndex = blockId.GetValue() - large_block_count;
-        segmentOffset = segmentOffset + small_block_length*smallBlockIndex +
-                                        segmentSize*segmentId;
+        memcpy(buffer, slot->buffer + (size_t)segmentId*segment_size, len);
+        return (UINT16)len;
     }
-	NormFile::Offset offset = segmentOffset.GetOffset();
-    if (offset != file.GetOffset())
+    // or staged content that hasn't been written yet
+    WriteBehindSlot* staged = FindWriteBehind(blockId);
+    if ((NULL != staged) && staged->mask.Test(segmentId))
     {
-        if (!file.Seek(offset))
-        {
-            PLOG(PL_FATAL, "NormFileObject::ReadSegment() error seeking to file offset\n");
-            return 0;
-        }
+        memcpy(buffer, staged->buffer + (size_t)segmentId*segment_size, len);
+        return (UINT16)len;
     }
     
-    size_t nbytes = file.Read(buffer, len);
-    
+    size_t nbytes = file.ReadAt(GetSegmentOffset(blockId, segmentId), buffer, len);
     if (len == nbytes)
         return (UINT16)len;
     else
@@ -2528,84 +2960,650 @@ char* NormFileObject::RetrieveSegment(NormBlockId      blockId,
     }
 }  // end NormFileObject::RetrieveSegment()
 
-/////////////////////////////////////////////////////////////////
-//
-// NormDataObject Implementation
-//
-NormDataObject::NormDataObject(class NormSession&       theSession, 
-                               class NormSenderNode*    theSender,
-                               const NormObjectId&      objectId,
-                               DataFreeFunctionHandle   dataFreeFunc)
- : NormObject(DATA, theSession, theSender, objectId), 
-   large_block_length(0), small_block_length(0),
-   data_ptr(NULL), data_max(0), data_released(false),
-   data_free_func(dataFreeFunc)
+// Determine file offset from blockId::segmentId
+NormFile::Offset NormFileObject::GetSegmentOffset(NormBlockId     blockId, 
+                                                  NormSegmentId   segmentId) const
 {
-    
-}
+    NormObjectSize segmentOffset;
+    NormObjectSize segmentSize = NormObjectSize(segment_size);
+    if (blockId.GetValue() < large_block_count)
+    {
+        segmentOffset = large_block_length*blockId.GetValue() + segmentSize*segmentId;
+    }
+    else
+    {
+        segmentOffset = large_block_length*large_block_count;  // (TBD) pre-calc this  
+        UINT32 smallBlockIndex = blockId.GetValue() - large_block_count;
+        segmentOffset = segmentOffset + small_block_length*smallBlockIndex +
+                                        segmentSize*segmentId;
+    }
+    return segmentOffset.GetOffset();
+}  // end NormFileObject::GetSegmentOffset()
 
-NormDataObject::~NormDataObject()
+// Returns true when "blockId" content can be read without blocking.  Otherwise,
+// a read of the whole block is started (if needed) and "read_pending" is set
+// so the session checks back shortly.  Once a block is loaded, reads of the
+// blocks that follow it are started to keep ahead of transmission.  Repairs
+// of blocks older than the newest one checked use read-ahead content if it
+// is still there, but are otherwise read synchronously so the slots holding
+// content about to be sent are left alone.
+bool NormFileObject::IsBlockReady(NormBlockId blockId)
 {
-    Close();
-    if (data_released)
+    read_pending = false;
+    if (NULL == read_ahead) return true;  // read-ahead not enabled
+    bool repair = (blockId.GetValue() < read_ahead_front);
+    if (!repair) read_ahead_front = blockId.GetValue();
+    ReadAheadSlot* slot = FindReadAhead(blockId);
+    if ((NULL == slot) && !repair) slot = StartReadAhead(blockId, blockId);
+    if (NULL == slot) return true;  // use synchronous ReadSegment()
+    switch (slot->request.GetStatus())
+    {
+        case NormFileIo::Request::DONE:
+        {
+            if (repair) return true;
+            UINT32 nextId = blockId.GetValue();
+            for (unsigned int i = 1; i < read_ahead_count; i++)
+            {
+                if (++nextId > final_block_id.GetValue()) break;
+                if ((NULL == FindReadAhead(nextId)) && (NULL == StartReadAhead(nextId, blockId)))
+                    break;
+            }
+            return true;
+        }
+        case NormFileIo::Request::FAILED:
+            // ReadSegment() will retry synchronously (and report any error)
+            return true;
+        case NormFileIo::Request::IDLE:
+            // Submit() failed
+            return true;
+        default:
+            read_pending = true;
+            return false;
+    }
+}  // end NormFileObject::IsBlockReady()
+
+NormFileObject::ReadAheadSlot* NormFileObject::FindReadAhead(NormBlockId blockId)
+{
+    for (unsigned int i = 0; i < read_ahead_count; i++)
     {
-        if (NULL != data_ptr)
+        ReadAheadSlot* slot = read_ahead + i;
+        if ((NULL != slot->buffer) && (blockId == slot->block_id) &&
+            (NormFileIo::Request::IDLE != slot->request.GetStatus()))
         {
-            if (NULL != data_free_func)
-                data_free_func(data_ptr);
-            else
-                delete[] data_ptr;
-            data_ptr = NULL;
+            return slot;
         }
-        data_released = false;
     }
-}
+    return NULL;
+}  // end NormFileObject::FindReadAhead()
 
-// Assign data object to data ptr
-bool NormDataObject::Open(char*       dataPtr,
-                          UINT32      dataLen,
-                          bool        dataRelease,
-                          const char* infoPtr,
-                          UINT16      infoLen)
+// Starts a read of "blockId" into a slot not holding "firstId" or one of
+// the "read_ahead_count - 1" blocks that follow (i.e., content about to be
+// sent).  Idle or completed slots are preferred over ones with a read still
+// queued, and a slot whose read a helper thread is doing is never taken (its 
+// cancellation would block the protocol thread until the read completes).
+NormFileObject::ReadAheadSlot* NormFileObject::StartReadAhead(NormBlockId blockId, 
+                                                              NormBlockId firstId)
 {
-    if (data_released && (NULL != data_ptr))
+    ReadAheadSlot* victim = NULL;
+    for (unsigned int i = 0; i < read_ahead_count; i++)
     {
-        if (NULL != data_free_func)
-            data_free_func(data_ptr);
-        else
-            delete[] data_ptr;
-        data_ptr = NULL;
-        data_released = false;   
+        ReadAheadSlot* slot = read_ahead + i;
+        NormFileIo::Request::Status status = slot->request.GetStatus();
+        if ((NULL != slot->buffer) && (NormFileIo::Request::IDLE != status))
+        {
+            UINT32 delta = slot->block_id.GetValue() - firstId.GetValue();
+            if (delta < read_ahead_count) continue;  // still needed
+            if (NormFileIo::Request::BUSY == status) continue;
+            if (NormFileIo::Request::QUEUED == status)
+            {
+                if (NULL == victim) victim = slot;
+                continue;
+            }
+        }
+        victim = slot;
+        break;
     }
-    if (NULL == sender)
+    if (NULL == victim) return NULL;
+    // (a queued read may have just been taken up by a helper thread)
+    if (victim->request.IsPending() && !NormFileIo::Cancel(victim->request, false))
+        return NULL;
+    if (NULL == victim->buffer)
     {
-        // We're sending this data object
-        if (!NormObject::Open(dataLen, 
-                              infoPtr, 
-                              infoLen,
-                              session.SenderSegmentSize(),
-                              session.GetSenderFecId(),
-                              session.GetSenderFecFieldSize(),
-                              session.SenderBlockSize(),
-                              session.SenderNumParity()))
+        size_t bufferSize = (size_t)large_block_size * segment_size;
+        if (NULL == (victim->buffer = new char[bufferSize]))
         {
-            PLOG(PL_FATAL, "NormDataObject::Open() send object open error\n");
-            Close();
-            return false;
+            PLOG(PL_ERROR, "NormFileObject::StartReadAhead() new buffer error: %s\n", GetErrorString());
+            return NULL;
         }
     }
-    else
+    // The final block may end with a short segment
+    size_t length = (size_t)(GetBlockSize(blockId) - 1) * segment_size;
+    length += (blockId == final_block_id) ? final_segment_size : segment_size;
+    victim->block_id = blockId;
+    victim->request.Init(file, GetSegmentOffset(blockId, 0), victim->buffer, length);
+    if (!NormFileIo::Submit(victim->request))
+        PLOG(PL_WARN, "NormFileObject::StartReadAhead() warning: NormFileIo::Submit() failure\n");
+    return victim;
+}  // end NormFileObject::StartReadAhead()
+
+void NormFileObject::CloseReadAhead()
+{
+    if (NULL != read_ahead)
     {
-        // We're receiving this data object
-        //ASSERT(NULL == infoPtr);
+        // (the ReadAheadSlot destructor cancels any read in progress)
+        delete[] read_ahead;
+        read_ahead = NULL;
+        read_ahead_count = 0;
+        NormFileIo::Release();
     }
-    data_ptr = dataPtr;
-    data_max = dataLen;
+    read_pending = false;
+}  // end NormFileObject::CloseReadAhead()
+
+NormFileObject::WriteBehindSlot* NormFileObject::FindWriteBehind(NormBlockId blockId)
+{
+    for (unsigned int i = 0; i < write_behind_count; i++)
+    {
+        WriteBehindSlot* slot = write_behind + i;
+        if ((0 != slot->count) && (blockId == slot->block_id))
+            return slot;
+    }
+    return NULL;
+}  // end NormFileObject::FindWriteBehind()
+
+// Returns the slot staging "blockId", claiming a free one as needed.  When
+// all slots are in use, the fully staged blocks are written out together
+// (or, if none is complete, the ordinally lowest block is written)
+NormFileObject::WriteBehindSlot* NormFileObject::GetWriteBehind(NormBlockId blockId)
+{
+    WriteBehindSlot* slot = FindWriteBehind(blockId);
+    if (NULL != slot) return slot;
+    for (unsigned int i = 0; i < write_behind_count; i++)
+    {
+        if (0 == write_behind[i].count)
+        {
+            slot = write_behind + i;
+            break;
+        }
+    }
+    if (NULL == slot)
+    {
+        WriteBehindSlot** flushList = new WriteBehindSlot*[write_behind_count];
+        if (NULL == flushList)
+        {
+            PLOG(PL_ERROR, "NormFileObject::GetWriteBehind() new flushList error: %s\n", GetErrorString());
+            return NULL;
+        }
+        unsigned int flushCount = 0;
+        WriteBehindSlot* lowest = write_behind;
+        for (unsigned int i = 0; i < write_behind_count; i++)
+        {
+            WriteBehindSlot* next = write_behind + i;
+            if (next->count == GetBlockSize(next->block_id))
+                flushList[flushCount++] = next;
+            if (next->block_id.GetValue() < lowest->block_id.GetValue())
+                lowest = next;
+        }
+        if (0 == flushCount) flushList[flushCount++] = lowest;
+        slot = flushList[0];
+        bool result = FlushWriteBehind(flushList, flushCount);
+        delete[] flushList;
+        if (!result) return NULL;
+    }
+    if (NULL == slot->buffer)
+    {
+        if (NULL == (slot->buffer = new char[(size_t)large_block_size * segment_size]))
+        {
+            PLOG(PL_ERROR, "NormFileObject::GetWriteBehind() new buffer error: %s\n", GetErrorString());
+            return NULL;
+        }
+        if (!slot->mask.Init(large_block_size))
+        {
+            PLOG(PL_ERROR, "NormFileObject::GetWriteBehind() mask init error: %s\n", GetErrorString());
+            delete[] slot->buffer;
+            slot->buffer = NULL;
+            return NULL;
+        }
+    }
+    slot->block_id = blockId;
+    return slot;
+}  // end NormFileObject::GetWriteBehind()
+
+// Writes the segments staged in the listed slots (which are then freed).
+// File-contiguous runs of segments, including across consecutive blocks,
+// are gathered into a single WriteAtV() call.
+bool NormFileObject::FlushWriteBehind(WriteBehindSlot** slotList, unsigned int slotCount)
+{
+    // Put the (short) list in block order
+    for (unsigned int i = 1; i < slotCount; i++)
+    {
+        WriteBehindSlot* slot = slotList[i];
+        unsigned int j = i;
+        while ((j > 0) && (slotList[j-1]->block_id.GetValue() > slot->block_id.GetValue()))
+        {
+            slotList[j] = slotList[j-1];
+            j--;
+        }
+        slotList[j] = slot;
+    }
+    enum {IOV_COUNT_MAX = 64};
+    struct iovec iov[IOV_COUNT_MAX];
+    int iovCount = 0;
+    NormFile::Offset runOffset = 0;     // file offset of "iov[0]"
+    NormFile::Offset runEnd = 0;
+    size_t runBytes = 0;
+    bool result = true;
+    for (unsigned int i = 0; i < slotCount; i++)
+    {
+        WriteBehindSlot* slot = slotList[i];
+        NormBlockId blockId = slot->block_id;
+        UINT32 numData = GetBlockSize(blockId);
+        UINT32 segmentId = 0;
+        while (slot->mask.GetNextSet(segmentId) && (segmentId < numData))
+        {
+            // Find the end of this run of staged segments
+            UINT32 endId = segmentId;
+            if (!slot->mask.GetNextUnset(endId) || (endId > numData))
+                endId = numData;
+            size_t length = (size_t)(endId - segmentId) * segment_size;
+            if ((blockId == final_block_id) && (endId == numData))
+                length -= (segment_size - final_segment_size);
+            NormFile::Offset offset = GetSegmentOffset(blockId, segmentId);
+            if ((0 != iovCount) && ((offset != runEnd) || (IOV_COUNT_MAX == iovCount)))
+            {
+                if (runBytes != file.WriteAtV(runOffset, iov, iovCount))
+                    result = false;
+                iovCount = 0;
+            }
+            if (0 == iovCount)
+            {
+                runOffset = offset;
+                runBytes = 0;
+            }
+            iov[iovCount].iov_base = slot->buffer + (size_t)segmentId*segment_size;
+            iov[iovCount].iov_len = length;
+            iovCount++;
+            runBytes += length;
+            runEnd = offset + (NormFile::Offset)length;
+            segmentId = endId;
+        }
+        slot->mask.Clear();
+        slot->count = 0;
+    }
+    if ((0 != iovCount) && (runBytes != file.WriteAtV(runOffset, iov, iovCount)))
+        result = false;
+    if (!result)
+        PLOG(PL_ERROR, "NormFileObject::FlushWriteBehind() error writing staged segments\n");
+    return result;
+}  // end NormFileObject::FlushWriteBehind()
+
+bool NormFileObject::CloseWriteBehind()
+{
+    bool result = true;
+    if (NULL != write_behind)
+    {
+        WriteBehindSlot** flushList = new WriteBehindSlot*[write_behind_count];
+        if (NULL != flushList)
+        {
+            unsigned int flushCount = 0;
+            for (unsigned int i = 0; i < write_behind_count; i++)
+            {
+                if (0 != write_behind[i].count)
+                    flushList[flushCount++] = write_behind + i;
+            }
+            if (file.IsOpen())
+                result = FlushWriteBehind(flushList, flushCount);
+            delete[] flushList;
+        }
+        else
+        {
+            PLOG(PL_ERROR, "NormFileObject::CloseWriteBehind() new flushList error: %s\n", GetErrorString());
+            result = false;
+        }
+        delete[] write_behind;
+        write_behind = NULL;
+        write_behind_count = 0;
+    }
+    return result;
+}  // end NormFileObject::CloseWriteBehind()
+
+// Sets up memory-mapped access, mapping the first window (false if the
+// file can't be mapped and so is accessed with its file descriptor)
+bool NormFileObject::MapFile()
+{
+    if (0 == NormObject::GetSize().GetOffset()) return false;  // nothing to map
+    file_mapped = true;
+    if (NULL == MapSegment(0, 0, 0))
+    {
+        PLOG(PL_WARN, "NormFileObject::MapFile() warning: unable to map \"%s\" (using read/write)\n", path);
+        file_mapped = false;
+    }
+    return file_mapped;
+}  // end NormFileObject::MapFile()
+
+// Returns a pointer into the mapping for the given segment, remapping the 
+// window (to start at the segment's block) when the segment is beyond it.
+// NULL is returned (and the segment accessed with the file descriptor 
+// instead) for a segment before the current window (e.g., a repair), so 
+// repairs don't move the window away from the ongoing transfer, and for a 
+// segment past the current end of the file.  Touching mapped pages beyond 
+// the end of a (e.g., truncated) file raises SIGBUS, so the file size is 
+// checked with fstat() when a window is mapped and at each block start.
+char* NormFileObject::MapSegment(NormBlockId blockId, NormSegmentId segmentId, size_t len)
+{
+    NormFile::Offset offset = GetSegmentOffset(blockId, segmentId);
+    NormFile::Offset segmentEnd = offset + (NormFile::Offset)len;
+    if ((NULL != map_ptr) && (offset < map_offset)) return NULL;
+    if ((NULL == map_ptr) || (segmentEnd > (map_offset + (NormFile::Offset)map_length)))
+    {
+        UnmapFile();
+        file_mapped = true;  // (UnmapFile() clears this)
+        map_file_size = file.GetSize();
+        NormFile::Offset fileSize = NormObject::GetSize().GetOffset();
+        if (map_file_size < fileSize) fileSize = map_file_size;
+        NormFile::Offset blockOffset = GetSegmentOffset(blockId, 0);
+        NormFile::Offset windowOffset = blockOffset - (blockOffset % NormFile::GetPageSize());
+        if (windowOffset >= fileSize) return NULL;
+        size_t windowLength = (size_t)(blockOffset - windowOffset) + 
+                              (size_t)GetBlockSize(blockId) * segment_size;
+        if (windowLength < MAP_WINDOW_SIZE) windowLength = MAP_WINDOW_SIZE;
+        if ((windowOffset + (NormFile::Offset)windowLength) > fileSize)
+            windowLength = (size_t)(fileSize - windowOffset);
+        if (NULL == (map_ptr = file.Map(windowOffset, windowLength)))
+            return NULL;
+        map_offset = windowOffset;
+        map_length = windowLength;
+        NormFile::Advise(map_ptr, map_length, NormFile::ADVISE_SEQUENTIAL);
+    }
+    else if (0 == segmentId)
+    {
+        map_file_size = file.GetSize();  // recheck in case it was truncated
+    }
+    if (segmentEnd > map_file_size) return NULL;
+    return (map_ptr + (size_t)(offset - map_offset));
+}  // end NormFileObject::MapSegment()
+
+void NormFileObject::UnmapFile()
+{
+    if (NULL != map_ptr)
+    {
+        NormFile::Unmap(map_ptr, map_length);
+        map_ptr = NULL;
+        map_offset = 0;
+        map_length = 0;
+    }
+    file_mapped = false;
+}  // end NormFileObject::UnmapFile()
+
+/////////////////////////////////////////////////////////////////
+//
+// NormDataObject Implementation
+//
+NormDataObject::NormDataObject(class NormSession&       theSession, 
+                               class NormSenderNode*    theSender,
+                               const NormObjectId&      objectId,
+                               DataFreeFunctionHandle   dataFreeFunc)
+ : NormObject(DATA, theSession, theSender, objectId), 
+   large_block_length(0), small_block_length(0),
+   data_ptr(NULL), data_max(0), data_released(false),
+   data_free_func(dataFreeFunc), comp_ptr(NULL), comp_len(0),
+   extent_list(NULL), extent_count(0), 
+   extent_release_func(NULL), extent_release_data(NULL)
+{
+    
+}
+
+NormDataObject::~NormDataObject()
+{
+    Close();
+    FreeContent();
+}
+
+// Frees (or releases) any content the object is responsible for
+void NormDataObject::FreeContent()
+{
+    if (data_released)
+    {
+        if (NULL != data_ptr)
+        {
+            if (NULL != data_free_func)
+                data_free_func(data_ptr);
+            else
+                delete[] data_ptr;
+            data_ptr = NULL;
+        }
+        data_released = false;
+    }
+    if (NULL != comp_ptr)
+    {
+        delete[] comp_ptr;
+        comp_ptr = NULL;
+    }
+    ReleaseExtents();
+}  // end NormDataObject::FreeContent()
+
+// Assign data object to data ptr
+bool NormDataObject::Open(char*       dataPtr,
+                          UINT32      dataLen,
+                          bool        dataRelease,
+                          const char* infoPtr,
+                          UINT16      infoLen)
+{
+    FreeContent();
+    if (NULL == sender)
+    {
+        // We're sending this data object
+        if (session.GetTxCompression()) CompressContent(dataPtr, dataLen);
+        if (!OpenSender(dataLen, infoPtr, infoLen)) return false;
+    }
+    else
+    {
+        // We're receiving this data object
+        //ASSERT(NULL == infoPtr);
+    }
+    data_ptr = dataPtr;
+    data_max = dataLen;
     data_released = dataRelease;
     large_block_length = NormObjectSize(large_block_size) * segment_size;
     small_block_length = NormObjectSize(small_block_size) * segment_size;
     return true;
 }  // end NormDataObject::Open()
+
+bool NormDataObject::OpenV(const struct iovec*          iov,
+                           unsigned int                 iovCount,
+                           ExtentReleaseFunctionHandle  releaseFunc,
+                           const void*                  releaseData,
+                           const char*                  infoPtr,
+                           UINT16                       infoLen)
+{
+    if (NULL != sender)
+    {
+        PLOG(PL_FATAL, "NormDataObject::OpenV() error: not a sender object\n");
+        return false;
+    }
+    FreeContent();
+    data_ptr = NULL;
+    UINT32 dataLen = 0;
+    for (unsigned int i = 0; i < iovCount; i++)
+    {
+        if ((size_t)(0xffffffff - dataLen) < iov[i].iov_len)
+        {
+            PLOG(PL_FATAL, "NormDataObject::OpenV() error: content too large\n");
+            return false;
+        }
+        dataLen += (UINT32)iov[i].iov_len;
+    }
+    if (0 != iovCount)
+    {
+        if (NULL == (extent_list = new Extent[iovCount]))
+        {
+            PLOG(PL_FATAL, "NormDataObject::OpenV() new extent list error: %s\n", GetErrorString());
+            return false;
+        }
+        UINT32 offset = 0;
+        for (unsigned int i = 0; i < iovCount; i++)
+        {
+            // (empty extents are kept so they are released, too)
+            extent_list[i].ptr = (char*)iov[i].iov_base;
+            extent_list[i].len = (UINT32)iov[i].iov_len;
+            extent_list[i].offset = offset;
+            offset += extent_list[i].len;
+        }
+        extent_count = iovCount;
+    }
+    if (session.GetTxCompression() && (0 != dataLen))
+    {
+        // The compressor needs contiguous input, so the extents are 
+        // gathered into a temporary buffer for this case only
+        char* dataPtr = new char[dataLen];
+        if (NULL != dataPtr)
+        {
+            ReadExtents(0, dataPtr, dataLen);
+            CompressContent(dataPtr, dataLen);
+            delete[] dataPtr;
+        }
+    }
+    if (!OpenSender(dataLen, infoPtr, infoLen))
+    {
+        // The caller retains ownership of the extents upon failure
+        DetachExtents();
+        return false;
+    }
+    extent_release_func = releaseFunc;
+    extent_release_data = releaseData;
+    data_max = dataLen;
+    large_block_length = NormObjectSize(large_block_size) * segment_size;
+    small_block_length = NormObjectSize(small_block_size) * segment_size;
+    return true;
+}  // end NormDataObject::OpenV()
+
+bool NormDataObject::OpenSender(UINT32 dataLen, const char* infoPtr, UINT16 infoLen)
+{
+    if (!NormObject::Open(compressed ? comp_len : dataLen, 
+                          infoPtr, 
+                          infoLen,
+                          session.SenderSegmentSize(),
+                          session.GetSenderFecId(),
+                          session.GetSenderFecFieldSize(),
+                          session.SenderBlockSize(),
+                          session.SenderNumParity()))
+    {
+        PLOG(PL_FATAL, "NormDataObject::Open() send object open error\n");
+        Close();
+        return false;
+    }
+    return true;
+}  // end NormDataObject::OpenSender()
+
+// Sets up a compressed copy of the content to send instead if that's smaller
+void NormDataObject::CompressContent(const char* dataPtr, UINT32 dataLen)
+{
+    if (NULL == (comp_ptr = new char[dataLen])) return;
+    UINT32 chunkSize = (UINT32)session.SenderSegmentSize() * session.SenderBlockSize();
+    comp_len = NormCompressor::CompressData(dataPtr, dataLen, chunkSize, comp_ptr, dataLen);
+    if (0 == comp_len)
+    {
+        delete[] comp_ptr;
+        comp_ptr = NULL;
+    }
+    compressed = (NULL != comp_ptr);
+}  // end NormDataObject::CompressContent()
+
+void NormDataObject::ReleaseExtents()
+{
+    if (NULL == extent_list) return;
+    if (NULL != extent_release_func)
+    {
+        for (unsigned int i = 0; i < extent_count; i++)
+            extent_release_func(extent_list[i].ptr, extent_list[i].len, extent_release_data);
+    }
+    delete[] extent_list;
+    extent_list = NULL;
+    extent_count = 0;
+    extent_release_func = NULL;
+    extent_release_data = NULL;
+}  // end NormDataObject::ReleaseExtents()
+
+void NormDataObject::DetachExtents()
+{
+    if (NULL != extent_list)
+    {
+        delete[] extent_list;
+        extent_list = NULL;
+    }
+    extent_count = 0;
+    extent_release_func = NULL;
+    extent_release_data = NULL;
+}  // end NormDataObject::DetachExtents()
+
+void NormDataObject::ReadExtents(UINT32 offset, char* buffer, UINT32 len) const
+{
+    // Binary search for the last extent starting at/before "offset"
+    unsigned int lo = 0;
+    unsigned int hi = extent_count;
+    while ((hi - lo) > 1)
+    {
+        unsigned int mid = (lo + hi) >> 1;
+        if (extent_list[mid].offset <= offset)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    // Then copy from it (and any following extents) as needed
+    for (unsigned int i = lo; (0 != len) && (i < extent_count); i++)
+    {
+        const Extent& extent = extent_list[i];
+        UINT32 extentOffset = offset - extent.offset;
+        if (extentOffset >= extent.len) continue;  // (e.g., empty extent)
+        UINT32 count = extent.len - extentOffset;
+        if (count > len) count = len;
+        memcpy(buffer, extent.ptr + extentOffset, count);
+        buffer += count;
+        offset += count;
+        len -= count;
+    }
+}  // end NormDataObject::ReadExtents()
+
+// Replaces the received (compressed) data content with the original
+bool NormDataObject::Decompress()
+{
+    if (!compressed) return true;
+    NormFile::Offset size;
+    if ((NULL == data_ptr) || !NormCompressor::GetDataSize(data_ptr, data_max, size) ||
+        (size > (NormFile::Offset)0xffffffff))
+    {
+        PLOG(PL_ERROR, "NormDataObject::Decompress() error: invalid content\n");
+        return false;
+    }
+    UINT32 dataLen = (UINT32)size;
+    size_t allocLen = (0 != dataLen) ? dataLen : 1;
+    NormDataObject::DataAllocFunctionHandle allocFunc = session.GetSessionMgr().GetDataAllocFunction();
+    // (the size is from the sender's frame header, so allocation failure
+    //  is reported rather than thrown)
+    char* dataPtr = (NULL != allocFunc) ? allocFunc(allocLen) : new (std::nothrow) char[allocLen];
+    if (NULL == dataPtr)
+    {
+        PLOG(PL_ERROR, "NormDataObject::Decompress() new data buffer error: %s\n", GetErrorString());
+        return false;
+    }
+    bool result = NormCompressor::DecompressData(data_ptr, data_max, dataPtr, dataLen);
+    // Free whichever buffer is no longer needed
+    char* freePtr = result ? data_ptr : dataPtr;
+    if (!result || data_released)
+    {
+        if (NULL != data_free_func)
+            data_free_func(freePtr);
+        else
+            delete[] freePtr;
+    }
+    if (!result) return false;
+    // (the decompressed buffer is ours to free)
+    data_ptr = dataPtr;
+    data_max = dataLen;
+    data_released = true;
+    object_size = NormObjectSize((NormObjectSize::Offset)dataLen);
+    compressed = false;
+    return true;
+}  // end NormDataObject::Decompress()
                 
 bool NormDataObject::Accept(char* dataPtr, UINT32 dataMax, bool dataRelease)
 {
@@ -2674,7 +3672,9 @@ UINT16 NormDataObject::ReadSegment(NormBlockId      blockId,
                                    NormSegmentId    segmentId,
                                    char*            buffer)            
 {
-    if (NULL == data_ptr)
+    char* contentPtr = ContentPtr();
+    UINT32 contentMax = ContentMax();
+    if ((NULL == contentPtr) && (NULL == extent_list))
     {
         PLOG(PL_FATAL, "NormDataObject::ReadSegment() error: NULL data_ptr\n");
         return 0;    
@@ -2708,19 +3708,24 @@ UINT16 NormDataObject::ReadSegment(NormBlockId      blockId,
                                         segmentSize*segmentId;
     }
     ASSERT(0 == segmentOffset.MSB());    // we don't yet support super-sized "data" objects
-    if (data_max <= segmentOffset.LSB())
+    if (contentMax <= segmentOffset.LSB())
         return 0;
-    else if (data_max <= (segmentOffset.LSB() + len))
-        len -= (segmentOffset.LSB() + len - data_max);
+    else if (contentMax <= (segmentOffset.LSB() + len))
+        len -= (segmentOffset.LSB() + len - contentMax);
     
-    memcpy(buffer, data_ptr + segmentOffset.LSB(), len);
+    if (NULL != contentPtr)
+        memcpy(buffer, contentPtr + segmentOffset.LSB(), len);
+    else
+        ReadExtents(segmentOffset.LSB(), buffer, len);  // assembles across extents
     return len;
 }  // end NormDataObject::ReadSegment()
 
 char* NormDataObject::RetrieveSegment(NormBlockId   blockId, 
                                       NormSegmentId segmentId)
 {
-    if (NULL == data_ptr)
+    char* contentPtr = ContentPtr();
+    UINT32 contentMax = ContentMax();
+    if (NULL == contentPtr)
     {
         PLOG(PL_FATAL, "NormDataObject::RetrieveSegment() error: NULL data_ptr\n");
         return NULL;    
@@ -2753,7 +3758,7 @@ char* NormDataObject::RetrieveSegment(NormBlockId   blockId,
                                         segmentSize*segmentId;
     }
     ASSERT(0 == segmentOffset.MSB());  // we don't yet support super-sized "data" objects
-    if ((len < segment_size) || (data_max < (segmentOffset.LSB() + len)))
+    if ((len < segment_size) || (contentMax < (segmentOffset.LSB() + len)))
     {
         if (sender)
         {
@@ -2770,7 +3775,7 @@ char* NormDataObject::RetrieveSegment(NormBlockId   blockId,
     }
     else
     {
-        return (data_ptr + segmentOffset.LSB());
+        return (contentPtr + segmentOffset.LSB());
     }
 }  // end NormDataObject::RetrieveSegment()
 
@@ -2788,7 +3793,10 @@ NormStreamObject::NormStreamObject(class NormSession&       theSession,
    flush_pending(false), msg_start(true),
    flush_mode(FLUSH_NONE), push_mode(false),
    stream_broken(false), stream_closing(false),
-   block_pool_threshold(0)
+   block_pool_threshold(0), ring_buffer(NULL), ring_mask(0),
+   ring_head(0), ring_tail(0), ring_idle(1), ring_wanted(0),
+   ring_record(0), ring_flags(0), ring_record_open(false), ring_close_pending(false),
+   write_reserve(NULL), lent_bytes(0)
 {
 }
 
@@ -2806,6 +3814,7 @@ NormStreamObject::~NormStreamObject()
     stream_buffer.Destroy();
     segment_pool.Destroy();
     block_pool.Destroy();
+    CloseWriteRing();
 }  
 
 NormBlockId NormStreamObject::FlushBlockId() const
@@ -2881,14 +3890,15 @@ bool NormStreamObject::Open(UINT32      bufferSize,
         return false;
     }
     
-    if (!segment_pool.Init(numSegments, segmentSize+NormDataMsg::GetStreamPayloadHeaderLength()))
+    if (!segment_pool.Init(numSegments, segmentSize+NormDataMsg::GetStreamPayloadHeaderLength(), session.GetBufferLocking()))
     {
         PLOG(PL_FATAL, "NormStreamObject::Open() segment_pool init error\n");
         Close();
         return false;
     }
     
-    if (!stream_buffer.Init(numBlocks, 256, fec_block_mask))
+    // (stream_buffer ring is fully direct-mapped to its "numBlocks" range)
+    if (!stream_buffer.Init(numBlocks, numBlocks, fec_block_mask))
     {
         PLOG(PL_FATAL, "NormStreamObject::Open() stream_buffer init error\n");
         Close();
@@ -2928,12 +3938,25 @@ void NormStreamObject::Close(bool graceful)
 {
     if (graceful && (NULL == sender))
     {
+        // Any "write ring" content is sent before the stream is terminated
+        if (NULL != ring_buffer)
+        {
+            ring_close_pending = false;  // (in case this is a repeat call)
+            DrainWriteRing();
+            if (!RingIsEmpty())
+            {
+                ring_close_pending = true;
+                return;
+            }
+        }
+        ring_close_pending = false;
         Terminate();
         //SetFlushMode(FLUSH_ACTIVE);
         //Flush();
     }
     else
     {
+        ring_close_pending = false;
         NormObject::Close();
         write_vacancy = false;
     }
@@ -3125,6 +4148,22 @@ UINT16 NormStreamObject::ReadSegment(NormBlockId      blockId,
                                      NormSegmentId    segmentId,
                                      char*            buffer)
 {
+    if (NULL != ring_buffer)
+    {
+        // Move any application "write ring" content into the stream buffer.
+        // If the stream is starved, the ring is marked idle so the writer
+        // prompts the protocol thread upon its next write (the ring head is
+        // checked again so a write made in the meantime is not missed)
+        UINT32 head;
+        do
+        {
+            head = NormAtomicLoad(&ring_head);
+            if (DrainWriteRing())
+                session.Notify(NormController::TX_QUEUE_VACANCY, NULL, this);
+            if (!IsStarved(blockId, segmentId)) break;
+            NormAtomicExchange(&ring_idle, 1);
+        } while ((head != NormAtomicLoad(&ring_head)) && (0 != NormAtomicExchange(&ring_idle, 0)));
+    }
     // (TBD) compare blockId with stream_buffer.RangeLo() and stream_buffer.RangeHi()
     NormBlock* block = stream_buffer.Find(blockId);
     if (NULL == block)
@@ -3167,6 +4206,20 @@ UINT16 NormStreamObject::ReadSegment(NormBlockId      blockId,
         tx_index.segment = segmentId;
     }
     
+    // (The segment is copied before any TX_QUEUE_VACANCY is posted since the
+    //  notification may result in new stream writes that recycle its block)
+    UINT16 segmentLength = NormDataMsg::ReadStreamPayloadLength(segment);
+    ASSERT(segmentLength <= segment_size);
+    UINT16 payloadLength = segmentLength+NormDataMsg::GetStreamPayloadHeaderLength();
+#ifdef SIMULATE   
+    UINT16 payloadMax = segment_size + NormDataMsg::GetStreamPayloadHeaderLength();
+    payloadMax = MIN(payloadMax, SIM_PAYLOAD_MAX);
+    UINT16 copyMax = MIN(payloadMax, payloadLength);
+    memcpy(buffer, segment, copyMax); 
+#else
+    memcpy(buffer, segment, payloadLength);
+#endif // SIMULATE
+    
     // Only advertise vacancy if stream_buffer.RangeLo() is non-pending _and_
     // (write_index.block - tx_index.block) < block_pool.GetTotal() / 2
     if (!write_vacancy)
@@ -3209,24 +4262,27 @@ UINT16 NormStreamObject::ReadSegment(NormBlockId      blockId,
                 write_vacancy = true; 
             }
             if (write_vacancy) 
-                session.Notify(NormController::TX_QUEUE_VACANCY, NULL, this); 
+                NotifyVacancy(); 
         }       
     }
+    else if (event_held)
+    {
+        NotifyVacancy();  // reconsider held TX_QUEUE_VACANCY
+    }
     
-    UINT16 segmentLength = NormDataMsg::ReadStreamPayloadLength(segment);
-    ASSERT(segmentLength <= segment_size);
-    UINT16 payloadLength = segmentLength+NormDataMsg::GetStreamPayloadHeaderLength();
-#ifdef SIMULATE   
-    UINT16 payloadMax = segment_size + NormDataMsg::GetStreamPayloadHeaderLength();
-    payloadMax = MIN(payloadMax, SIM_PAYLOAD_MAX);
-    UINT16 copyMax = MIN(payloadMax, payloadLength);
-    memcpy(buffer, segment, copyMax); 
-#else
-    memcpy(buffer, segment, payloadLength);
-#endif // SIMULATE
     return payloadLength;
 }  // end NormStreamObject::ReadSegment()
 
+void NormStreamObject::NotifyVacancy()
+{
+    double holdDelay;
+    if (!session.EventCoalescing() ||
+        CoalesceCheck(GetVacancy(session.GetCoalesceBytes()), holdDelay))
+        session.Notify(NormController::TX_QUEUE_VACANCY, NULL, this);
+    else
+        session.ActivateCoalesceTimer(holdDelay);
+}  // end NormStreamObject::NotifyVacancy()
+
 bool NormStreamObject::WriteSegment(NormBlockId   blockId, 
                                     NormSegmentId segmentId, 
                                     const char*   segment)
@@ -3260,6 +4316,13 @@ bool NormStreamObject::WriteSegment(NormBlockId   blockId,
         bool dataLost = false;
         while (block_pool.IsEmpty() || !stream_buffer.CanInsert(blockId))
         {
+            if (IsLent())
+            {
+                // Buffered content is lent to the application (see PeekSegments())
+                // so this segment is dropped instead of forcing the read_index forward
+                PLOG(PL_DEBUG, "NormStreamObject::WriteSegment() stream buffer full (content lent)\n");
+                return false;
+            }
             block = stream_buffer.Find(stream_buffer.RangeLo());
             ASSERT(NULL != block);
             //if (blockId < block->GetId())
@@ -3510,6 +4573,12 @@ bool NormStreamObject::Read(char* buffer, unsigned int* buflen, bool seekMsgStar
     //         notification is reset upon a short read count.  The 
     //         "stream_broken" state variable is used for when this
     //         extra ReadPrivate() call reveals the broken stream condition.
+    if (IsLent())
+    {
+        PLOG(PL_ERROR, "NormStreamObject::Read() error: stream content is lent (Consume() needed)\n");
+        if (NULL != buflen) *buflen = 0;
+        return !seekMsgStart;
+    }
     if (stream_broken && !seekMsgStart)
     {
         if (NULL != buflen) *buflen = 0;
@@ -3542,36 +4611,141 @@ bool NormStreamObject::Read(char* buffer, unsigned int* buflen, bool seekMsgStar
             notify_on_update = true;
         }
     }
+    UpdateStatus();  // buffer usage may have changed
     return result;
 }  // end NormStreamObject::Read()
 
 
-// Sequential (in order) read/write routines (TBD) Add a "Seek()" method
-bool NormStreamObject::ReadPrivate(char* buffer, unsigned int* buflen, bool seekMsgStart)
+int NormStreamObject::PeekSegments(struct iovec* iov, unsigned int iovMax)
 {
-    if (stream_closing || read_init)
-    {
-        if (stream_closing)
-            PLOG(PL_DEBUG, "NormStreamObject::Read() attempted to read from closed stream\n");
-        *buflen = 0;
-        return seekMsgStart ? false : true;
-    }   
-    Retain();
-    unsigned int bytesRead = 0;
-    unsigned int bytesToRead = *buflen;
-    bool brokenStream = false;
-    do
+    if (!IsLent())
     {
-        NormBlock* block = stream_buffer.Find(read_index.block);
-        if (NULL == block)
+        if (stream_broken)
         {
-            PLOG(PL_DETAIL, "NormStreamObject::ReadPrivate() stream buffer empty (1) (sbEmpty:%d)\n", stream_buffer.IsEmpty());
-            read_ready = false;
-            *buflen = bytesRead;
-            if (bytesRead > 0)
-            {
-                Release();
-                return true;
+            stream_broken = false;
+            return -1;
+        }
+        // A zero-length ReadPrivate() positions the read_index at the next readable
+        // content (skipping invalid segments, forcing forward past lost data and
+        // handling stream end) just as "Read()" would
+        char dummyBuffer[8];
+        unsigned int dummyCount = 0;
+        if (!ReadPrivate(dummyBuffer, &dummyCount, false)) return -1;
+        if (stream_closing || read_init) return 0;
+    }
+    // Describe contiguous content from read_index up to the first gap
+    // (stream control segments are left for ReadPrivate() to handle)
+    unsigned int count = 0;
+    UINT32 numBytes = 0;
+    Index index = read_index;
+    NormBlock* block = stream_buffer.Find(index.block);
+    while ((count < iovMax) && (NULL != block))
+    {
+        char* segment = block->GetSegment(index.segment);
+        if (NULL == segment) break;
+        UINT16 length = NormDataMsg::ReadStreamPayloadLength(segment);
+        if ((0 == length) || (length > segment_size) || (index.offset >= length)) break;
+        iov[count].iov_base = segment + NormDataMsg::GetStreamPayloadHeaderLength() + index.offset;
+        iov[count].iov_len = length - index.offset;
+        numBytes += (length - index.offset);
+        count++;
+        index.offset = 0;
+        if (++index.segment >= ndata)
+        {
+            Increment(index.block);
+            index.segment = 0;
+            block = stream_buffer.Find(index.block);
+        }
+    }
+    if (0 != numBytes)
+    {
+        if (!IsLent()) Retain();  // until Consume()
+        lent_bytes = numBytes;
+    }
+    else if (!IsLent())
+    {
+        read_ready = false;
+        notify_on_update = true;
+    }
+    return (int)count;
+}  // end NormStreamObject::PeekSegments()
+
+bool NormStreamObject::Consume(UINT32 numBytes)
+{
+    if (!IsLent())
+    {
+        if (0 == numBytes) return true;
+        PLOG(PL_ERROR, "NormStreamObject::Consume() error: no stream content lent\n");
+        return false;
+    }
+    bool result = true;
+    if (numBytes > lent_bytes)
+    {
+        PLOG(PL_ERROR, "NormStreamObject::Consume() error: numBytes:%lu exceeds content lent:%lu\n",
+                       (unsigned long)numBytes, (unsigned long)lent_bytes);
+        numBytes = lent_bytes;
+        result = false;
+    }
+    while (0 != numBytes)
+    {
+        NormBlock* block = stream_buffer.Find(read_index.block);
+        ASSERT(NULL != block);
+        char* segment = block->GetSegment(read_index.segment);
+        ASSERT(NULL != segment);
+        UINT16 length = NormDataMsg::ReadStreamPayloadLength(segment);
+        UINT16 count = length - read_index.offset;
+        if (count > numBytes) count = (UINT16)numBytes;
+        read_index.offset += count;
+        read_offset += count;
+        numBytes -= count;
+        if (read_index.offset >= length)
+        {
+            block->UnsetPending(read_index.segment++);
+            read_index.offset = 0;
+            if (read_index.segment >= ndata) 
+            {
+                stream_buffer.Remove(block);
+                block->EmptyToPool(segment_pool);
+                block_pool.Put(block);
+                Increment(read_index.block);
+                read_index.segment = 0;
+                Prune(read_index.block, false);
+            }
+        }
+    }
+    lent_bytes = 0;
+    if (!DetermineReadReadiness())
+        notify_on_update = true;
+    Release();  // (from PeekSegments())
+    return result;
+}  // end NormStreamObject::Consume()
+
+// Sequential (in order) read/write routines (TBD) Add a "Seek()" method
+bool NormStreamObject::ReadPrivate(char* buffer, unsigned int* buflen, bool seekMsgStart)
+{
+    if (stream_closing || read_init)
+    {
+        if (stream_closing)
+            PLOG(PL_DEBUG, "NormStreamObject::Read() attempted to read from closed stream\n");
+        *buflen = 0;
+        return seekMsgStart ? false : true;
+    }   
+    Retain();
+    unsigned int bytesRead = 0;
+    unsigned int bytesToRead = *buflen;
+    bool brokenStream = false;
+    do
+    {
+        NormBlock* block = stream_buffer.Find(read_index.block);
+        if (NULL == block)
+        {
+            PLOG(PL_DETAIL, "NormStreamObject::ReadPrivate() stream buffer empty (1) (sbEmpty:%d)\n", stream_buffer.IsEmpty());
+            read_ready = false;
+            *buflen = bytesRead;
+            if (bytesRead > 0)
+            {
+                Release();
+                return true;
             }
             else
             {
@@ -4036,149 +5210,197 @@ unsigned int NormStreamObject::GetVacancy(unsigned int wanted)
     return nBytes;
 }  // end NormStreamObject::GetVacancy()
 
-UINT32 NormStreamObject::Write(const char* buffer, UINT32 len, bool eom)
-{               
-    UINT32 nBytes = 0;
-    do
+// Returns the segment (and its block) at the current "write_index", getting
+// a block and/or segment from the pools as needed (NULL if buffer is full)
+char* NormStreamObject::GetWriteSegment(NormBlock*& block)
+{
+    // This old code detected buffer "fullness" by offset instead of segment index
+    // but, the problem there was when apps wrote & flushed messages smaller than
+    // the segment_size, the buffer was used up before this detected it.
+    //INT32 deltaOffset = write_offset - tx_offset;  // (TBD) deprecate tx_offset
+    //ASSERT(deltaOffset >= 0);
+    //if (deltaOffset >= (INT32)object_size.LSB())
+    //ASSERT(write_index.block >= tx_index.block);
+    ASSERT(Compare(write_index.block, tx_index.block) >= 0);
+    UINT32 deltaBlock = (UINT32)Difference(write_index.block, tx_index.block);
+    if (deltaBlock > (block_pool.GetTotal() >> 1))  
     {
-        if (stream_closing)
-        {
-            if (0 != len)
-            {
-                PLOG(PL_ERROR, "NormStreamObject::Write() error: stream is closing (len:%lu eom:%d)\n", 
-                                (unsigned long)len, eom);
-                len = 0;
-            }
-            break;
-        }
-        // This old code detected buffer "fullness" by offset instead of segment index
-        // but, the problem there was when apps wrote & flushed messages smaller than
-        // the segment_size, the buffer was used up before this detected it.
-        //INT32 deltaOffset = write_offset - tx_offset;  // (TBD) deprecate tx_offset
-        //ASSERT(deltaOffset >= 0);
-        //if (deltaOffset >= (INT32)object_size.LSB())
-        //ASSERT(write_index.block >= tx_index.block);
-        ASSERT(Compare(write_index.block, tx_index.block) >= 0);
-        UINT32 deltaBlock = (UINT32)Difference(write_index.block, tx_index.block);
-        if (deltaBlock > (block_pool.GetTotal() >> 1))  
-        {
-            write_vacancy = false;
-            PLOG(PL_DEBUG, "NormStreamObject::Write() stream buffer full (1)\n");
-            if (!push_mode) break;  
-        }
-        NormBlock* block = stream_buffer.Find(write_index.block);
+        write_vacancy = false;
+        PLOG(PL_DEBUG, "NormStreamObject::GetWriteSegment() stream buffer full (1)\n");
+        if (!push_mode) return NULL;  
+    }
+    block = stream_buffer.Find(write_index.block);
+    if (NULL == block)
+    {   
+        block = block_pool.Get();
         if (NULL == block)
-        {   
-            block = block_pool.Get();
-            if (NULL == block)
+        {
+            block = stream_buffer.Find(stream_buffer.RangeLo());
+            ASSERT(NULL != block);
+            double delay = session.GetFlowControlDelay() - block->GetNackAge();
+            if (block->IsPending() || (delay >= 1.0e-06))
             {
-                block = stream_buffer.Find(stream_buffer.RangeLo());
-                ASSERT(NULL != block);
-                double delay = session.GetFlowControlDelay() - block->GetNackAge();
-                if (block->IsPending() || (delay >= 1.0e-06))
+                write_vacancy = false;
+                if (push_mode)
                 {
-                    write_vacancy = false;
-                    if (push_mode)
+                    NormBlockId blockId = block->GetId();
+                    pending_mask.Unset(blockId.GetValue());
+                    repair_mask.Unset(blockId.GetValue());
+                    NormBlock* b = FindBlock(blockId);
+                    if (b)
                     {
-                        NormBlockId blockId = block->GetId();
-                        pending_mask.Unset(blockId.GetValue());
-                        repair_mask.Unset(blockId.GetValue());
-                        NormBlock* b = FindBlock(blockId);
-                        if (b)
-                        {
-                            block_buffer.Remove(b);
-                            session.SenderPutFreeBlock(b); 
-                        }   
-                        if (!pending_mask.IsSet()) 
-                        {
-                            pending_mask.Set(write_index.block.GetValue());  
-                            //stream_next_id = write_index.block + 1;
-                            stream_next_id = write_index.block;
-                            Increment(stream_next_id);
-                        }
+                        block_buffer.Remove(b);
+                        session.SenderPutFreeBlock(b); 
+                    }   
+                    if (!pending_mask.IsSet()) 
+                    {
+                        pending_mask.Set(write_index.block.GetValue());  
+                        //stream_next_id = write_index.block + 1;
+                        stream_next_id = write_index.block;
+                        Increment(stream_next_id);
                     }
-                    else
+                }
+                else
+                {
+                    // The timer activated here makes sure a deferred TX_QUEUE_VACANCY is posted
+                    // when flow control has been asserted.
+                    if (!block->IsPending())
                     {
-                        // The timer activated here makes sure a deferred TX_QUEUE_VACANCY is posted
-                        // when flow control has been asserted.
-                        if (!block->IsPending())
-                        {
-                            PLOG(PL_DEBUG, "NormStreamObject::Write() asserting flow control for stream (postedEmpty:%d)\n", 
-                                           session.GetPostedTxQueueEmpty());
-                            if (session.GetPostedTxQueueEmpty())
-                                session.ActivateFlowControl(delay, GetId(), NormController::TX_QUEUE_EMPTY);
-                            else
-                                session.ActivateFlowControl(delay, GetId(), NormController::TX_QUEUE_VACANCY);
-                        }
-                        PLOG(PL_DEBUG, "NormStreamObject::Write() stream buffer full (2) len:%d eom:%d\n", len, eom);
-                        break;
+                        PLOG(PL_DEBUG, "NormStreamObject::GetWriteSegment() asserting flow control for stream (postedEmpty:%d)\n", 
+                                       session.GetPostedTxQueueEmpty());
+                        if (session.GetPostedTxQueueEmpty())
+                            session.ActivateFlowControl(delay, GetId(), NormController::TX_QUEUE_EMPTY);
+                        else
+                            session.ActivateFlowControl(delay, GetId(), NormController::TX_QUEUE_VACANCY);
                     }
-                }                             
-                stream_buffer.Remove(block);
-                block->EmptyToPool(segment_pool);
-            }
-            block->SetId(write_index.block);
-            block->ClearPending();
-            bool success = stream_buffer.Insert(block);
-            ASSERT(success);
-        }  // end if (NULL == block)
-        char* segment = block->GetSegment(write_index.segment);
-        if (NULL == segment)
+                    PLOG(PL_DEBUG, "NormStreamObject::GetWriteSegment() stream buffer full (2)\n");
+                    return NULL;
+                }
+            }                             
+            stream_buffer.Remove(block);
+            block->EmptyToPool(segment_pool);
+        }
+        block->SetId(write_index.block);
+        block->ClearPending();
+        bool success = stream_buffer.Insert(block);
+        ASSERT(success);
+    }  // end if (NULL == block)
+    char* segment = block->GetSegment(write_index.segment);
+    if (NULL == segment)
+    {
+        if (NULL == (segment = segment_pool.Get()))
         {
-            if (NULL == (segment = segment_pool.Get()))
+            NormBlock* b = stream_buffer.Find(stream_buffer.RangeLo());
+            ASSERT(b != block);
+            if (b->IsPending())
             {
-                NormBlock* b = stream_buffer.Find(stream_buffer.RangeLo());
-                ASSERT(b != block);
-                if (b->IsPending())
+                write_vacancy = false;
+                if (push_mode)
                 {
-                    write_vacancy = false;
-                    if (push_mode)
+                    NormBlockId blockId = b->GetId();
+                    pending_mask.Unset(blockId.GetValue());
+                    repair_mask.Unset(blockId.GetValue());
+                    NormBlock* c = FindBlock(blockId);
+                    if (c)
                     {
-                        NormBlockId blockId = b->GetId();
-                        pending_mask.Unset(blockId.GetValue());
-                        repair_mask.Unset(blockId.GetValue());
-                        NormBlock* c = FindBlock(blockId);
-                        if (c)
-                        {
-                            block_buffer.Remove(c);
-                            session.SenderPutFreeBlock(c);
-                        }  
-                        if (!pending_mask.IsSet()) 
-                        {
-                            pending_mask.Set(write_index.block.GetValue());  
-                            //stream_next_id = write_index.block + 1;
-                            stream_next_id = write_index.block;
-                            Increment(stream_next_id);
-                        }  
-                    }
-                    else
+                        block_buffer.Remove(c);
+                        session.SenderPutFreeBlock(c);
+                    }  
+                    if (!pending_mask.IsSet()) 
                     {
-                        PLOG(PL_DEBUG, "NormStreamObject::Write() stream buffer full (3)\n");
-                        break;
-                    }
+                        pending_mask.Set(write_index.block.GetValue());  
+                        //stream_next_id = write_index.block + 1;
+                        stream_next_id = write_index.block;
+                        Increment(stream_next_id);
+                    }  
+                }
+                else
+                {
+                    PLOG(PL_DEBUG, "NormStreamObject::GetWriteSegment() stream buffer full (3)\n");
+                    return NULL;
                 }
-                stream_buffer.Remove(b);
-                b->EmptyToPool(segment_pool);
-                block_pool.Put(b);
-                segment = segment_pool.Get();
-                ASSERT(NULL != segment);
             }
-            NormDataMsg::WriteStreamPayloadMsgStart(segment, 0);
-            NormDataMsg::WriteStreamPayloadLength(segment, 0);
-            NormDataMsg::WriteStreamPayloadOffset(segment, write_offset);
-            block->AttachSegment(write_index.segment, segment);
-        }  // end if (!segment)
-        
-        UINT16 index = NormDataMsg::ReadStreamPayloadLength(segment);
-        // If it is an application start-of-message, mark the stream header accordingly
-        // (but only if it is the _first_ message start for this segment!)
-        if (msg_start && (0 != len))
+            stream_buffer.Remove(b);
+            b->EmptyToPool(segment_pool);
+            block_pool.Put(b);
+            segment = segment_pool.Get();
+            ASSERT(NULL != segment);
+        }
+        NormDataMsg::WriteStreamPayloadMsgStart(segment, 0);
+        NormDataMsg::WriteStreamPayloadLength(segment, 0);
+        NormDataMsg::WriteStreamPayloadOffset(segment, write_offset);
+        block->AttachSegment(write_index.segment, segment);
+    }  // end if (!segment)
+    return segment;
+}  // end NormStreamObject::GetWriteSegment()
+
+// Accounts for "count" bytes added to the "write_index" segment, marking
+// it pending when full (or when flushing the "final" part of a write)
+void NormStreamObject::CommitSegment(NormBlock* block, char* segment, UINT32 count, bool final)
+{
+    UINT16 index = NormDataMsg::ReadStreamPayloadLength(segment);
+    // If it is an application start-of-message, mark the stream header accordingly
+    // (but only if it is the _first_ message start for this segment!)
+    if (msg_start && (0 != count))
+    {
+        if (0 == NormDataMsg::ReadStreamPayloadMsgStart(segment))
+            NormDataMsg::WriteStreamPayloadMsgStart(segment, index+1);
+        msg_start = false;
+    }
+    UINT32 space = (UINT32)(segment_size - index);
+    NormDataMsg::WriteStreamPayloadLength(segment, index+count);
+    write_offset += count;
+    // Is the segment full? or flushing
+    //if ((count == space) || ((FLUSH_NONE != flush_mode) && (0 != index) && (nBytes == len)))
+    if ((count == space) || 
+        ((FLUSH_NONE != flush_mode) && final && ((0 != index) || (0 != count))))
+    {   
+        block->SetPending(write_index.segment);
+        if (++write_index.segment >= ndata) 
         {
-            if (0 == NormDataMsg::ReadStreamPayloadMsgStart(segment))
-                NormDataMsg::WriteStreamPayloadMsgStart(segment, index+1);
-            msg_start = false;
+            ProtoTime currentTime;
+            currentTime.GetCurrentTime();
+            block->SetLastNackTime(currentTime);
+            Increment(write_index.block);
+            write_index.segment = 0;
         }
-        
+    }
+}  // end NormStreamObject::CommitSegment()
+
+// Updates message and flush state after a completed write of "nBytes"
+void NormStreamObject::CompleteWrite(UINT32 nBytes, bool eom)
+{
+    // if this was end-of-message next Write() will be considered a new message     
+    if (eom) 
+        msg_start = true;
+    if (FLUSH_ACTIVE == flush_mode) 
+        flush_pending = true;
+    else if (!stream_closing)
+        flush_pending = false;
+    if ((0 != nBytes) || (FLUSH_NONE != flush_mode))
+        session.TouchSender();
+}  // end NormStreamObject::CompleteWrite()
+
+UINT32 NormStreamObject::Write(const char* buffer, UINT32 len, bool eom)
+{               
+    UINT32 nBytes = 0;
+    write_reserve = NULL;  // invalidates any GetWriteBuffer() space
+    do
+    {
+        if (stream_closing)
+        {
+            if (0 != len)
+            {
+                PLOG(PL_ERROR, "NormStreamObject::Write() error: stream is closing (len:%lu eom:%d)\n", 
+                                (unsigned long)len, eom);
+                len = 0;
+            }
+            break;
+        }
+        NormBlock* block;
+        char* segment = GetWriteSegment(block);
+        if (NULL == segment) break;
+        UINT16 index = NormDataMsg::ReadStreamPayloadLength(segment);
         UINT32 count = len - nBytes;
         UINT32 space = (UINT32)(segment_size - index);
         count = MIN(count, space);
@@ -4190,46 +5412,312 @@ UINT32 NormStreamObject::Write(const char* buffer, UINT32 len, bool eom)
 #else
         memcpy(segment+index+NormDataMsg::GetStreamPayloadHeaderLength(), buffer+nBytes, count);
 #endif // if/else SIMULATE
-        NormDataMsg::WriteStreamPayloadLength(segment, index+count);
         nBytes += count;
-        write_offset += count;
-        // Is the segment full? or flushing
-        //if ((count == space) || ((FLUSH_NONE != flush_mode) && (0 != index) && (nBytes == len)))
-        if ((count == space) || 
-            ((FLUSH_NONE != flush_mode) && (nBytes == len) && ((0 != index) || (0 != len))))
-        {   
-            block->SetPending(write_index.segment);
-            if (++write_index.segment >= ndata) 
-            {
-                ProtoTime currentTime;
-                currentTime.GetCurrentTime();
-                block->SetLastNackTime(currentTime);
-                Increment(write_index.block);
-                write_index.segment = 0;
-            }
-        }
+        CommitSegment(block, segment, count, (nBytes == len));
     } while (nBytes < len);
     
-    // if this was end-of-message next Write() will be considered a new message     
     if (nBytes == len)
+        CompleteWrite(nBytes, eom);
+    else
+        session.TouchSender();  
+    UpdateStatus();  // buffer usage may have changed
+    return nBytes;
+}  // end NormStreamObject::Write()
+
+UINT32 NormStreamObject::Writev(const struct iovec* iov, unsigned int iovCount, bool eomEach, bool eom)
+{
+    // Messages are written with flushing deferred so that any
+    // auto flush is applied only once, after the last buffer
+    UINT32 nBytes = 0;
+    FlushMode saveFlushMode = flush_mode;
+    flush_mode = FLUSH_NONE;
+    for (unsigned int i = 0; i < iovCount; i++)
+    {
+        bool last = ((i + 1) == iovCount);
+        bool msgEnd = eomEach || (last && eom);
+        UINT32 len = (UINT32)iov[i].iov_len;
+        UINT32 count = Write((const char*)iov[i].iov_base, len, msgEnd);
+        nBytes += count;
+        if (count < len) break;  // stream buffer is full
+    }
+    flush_mode = saveFlushMode;
+    if ((0 != iovCount) && (FLUSH_NONE != flush_mode))
+        Write(NULL, 0, false);  // flushes what was written
+    return nBytes;
+}  // end NormStreamObject::Writev()
+
+char* NormStreamObject::GetWriteBuffer(UINT32& len)
+{
+    len = 0;
+    write_reserve = NULL;
+    if (stream_closing)
     {
-        if (eom) 
-            msg_start = true;
-        if (FLUSH_ACTIVE == flush_mode) 
-            flush_pending = true;
-        else if (!stream_closing)
-            flush_pending = false;
-		if ((0 != nBytes) || (FLUSH_NONE != flush_mode))
-		{
-			session.TouchSender();
-		}
+        PLOG(PL_ERROR, "NormStreamObject::GetWriteBuffer() error: stream is closing\n");
+        return NULL;
     }
-    else
+    NormBlock* block;
+    char* segment = GetWriteSegment(block);
+    if (NULL == segment) return NULL;  // stream buffer is full
+    UINT16 index = NormDataMsg::ReadStreamPayloadLength(segment);
+    len = segment_size - index;
+#ifdef SIMULATE
+    UINT32 simMax = index + NormDataMsg::GetStreamPayloadHeaderLength();
+    simMax = (simMax < SIM_PAYLOAD_MAX) ? (SIM_PAYLOAD_MAX - simMax) : 0;
+    if (len > simMax) len = simMax;
+    if (0 == len) return NULL;
+#endif // SIMULATE
+    write_reserve = segment;
+    return (segment + NormDataMsg::GetStreamPayloadHeaderLength() + index);
+}  // end NormStreamObject::GetWriteBuffer()
+
+UINT32 NormStreamObject::CommitWrite(UINT32 len, bool eom)
+{
+    char* segment = write_reserve;
+    write_reserve = NULL;
+    if (0 == len)
+        return Write(NULL, 0, eom);
+    NormBlock* block = stream_buffer.Find(write_index.block);
+    if (stream_closing || (NULL == segment) || (NULL == block) ||
+        (segment != block->GetSegment(write_index.segment)))
     {
-        session.TouchSender();  
+        PLOG(PL_ERROR, "NormStreamObject::CommitWrite() error: no valid write buffer reserved\n");
+        return 0;
+    }
+    UINT32 space = (UINT32)(segment_size - NormDataMsg::ReadStreamPayloadLength(segment));
+    if (len > space)
+    {
+        PLOG(PL_WARN, "NormStreamObject::CommitWrite() warning: len:%lu exceeds reserved space:%lu\n",
+                      (unsigned long)len, (unsigned long)space);
+        len = space;
+    }
+    CommitSegment(block, segment, len, true);
+    CompleteWrite(len, eom);
+    UpdateStatus();
+    return len;
+}  // end NormStreamObject::CommitWrite()
+
+bool NormStreamObject::OpenWriteRing(UINT32 ringSize)
+{
+    if (NULL != sender)
+    {
+        PLOG(PL_ERROR, "NormStreamObject::OpenWriteRing() error: not a tx stream\n");
+        return false;
+    }
+    CloseWriteRing();
+    // Ring size is a power of two (at least big enough for a full segment)
+    UINT32 size = 2*RING_HEADER_SIZE;
+    while ((size < ringSize) || (size < (UINT32)(segment_size + RING_HEADER_SIZE)))
+    {
+        if (size > (RING_LENGTH_MASK >> 1))
+        {
+            PLOG(PL_ERROR, "NormStreamObject::OpenWriteRing() error: ringSize too large\n");
+            return false;
+        }
+        size <<= 1;
+    }
+    if (NULL == (ring_buffer = new char[size]))
+    {
+        PLOG(PL_ERROR, "NormStreamObject::OpenWriteRing() new ring_buffer error: %s\n", GetErrorString());
+        return false;
+    }
+    ring_mask = size - 1;
+    ring_head = ring_tail = 0;
+    ring_idle = 1;
+    ring_wanted = 0;
+    ring_record = ring_flags = 0;
+    ring_record_open = false;
+    return true;
+}  // end NormStreamObject::OpenWriteRing()
+
+void NormStreamObject::CloseWriteRing()
+{
+    if (NULL != ring_buffer)
+    {
+        if (ring_record_open || (NormAtomicLoad(&ring_head) != ring_tail))
+            PLOG(PL_WARN, "NormStreamObject::CloseWriteRing() warning: discarding unwritten ring content\n");
+        delete[] ring_buffer;
+        ring_buffer = NULL;
+    }
+    ring_mask = 0;
+    ring_head = ring_tail = 0;
+    ring_record_open = false;
+    ring_close_pending = false;
+}  // end NormStreamObject::CloseWriteRing()
+
+// Copies a record (header + content) into the ring at "ring_head"
+// and publishes it (caller has verified there is enough space)
+bool NormStreamObject::RingPut(UINT32 header, const char* buffer)
+{
+    UINT32 len = header & RING_LENGTH_MASK;
+    char headerBuffer[RING_HEADER_SIZE];
+    memcpy(headerBuffer, &header, RING_HEADER_SIZE);
+    UINT32 ringSize = ring_mask + 1;
+    UINT32 index = ring_head;
+    for (int i = 0; i < 2; i++)
+    {
+        const char* ptr = (0 == i) ? headerBuffer : buffer;
+        UINT32 count = (0 == i) ? (UINT32)RING_HEADER_SIZE : len;
+        while (0 != count)
+        {
+            UINT32 offset = index & ring_mask;
+            UINT32 chunk = ringSize - offset;
+            if (chunk > count) chunk = count;
+            memcpy(ring_buffer + offset, ptr, chunk);
+            ptr += chunk;
+            index += chunk;
+            count -= chunk;
+        }
+    }
+    NormAtomicStore(&ring_head, index);
+    return true;
+}  // end NormStreamObject::RingPut()
+
+void NormStreamObject::RingCopyOut(UINT32 index, char* buffer, UINT32 len) const
+{
+    UINT32 offset = index & ring_mask;
+    UINT32 chunk = ring_mask + 1 - offset;
+    if (chunk > len) chunk = len;
+    memcpy(buffer, ring_buffer + offset, chunk);
+    if (chunk < len) memcpy(buffer + chunk, ring_buffer, len - chunk);
+}  // end NormStreamObject::RingCopyOut()
+
+UINT32 NormStreamObject::RingWrite(const char* buffer, UINT32 len, bool eom)
+{
+    UINT32 nBytes = 0;
+    UINT32 space = RingSpace();
+    while (true)
+    {
+        if (space > RING_HEADER_SIZE)
+        {
+            UINT32 count = len - nBytes;
+            if (count > (space - RING_HEADER_SIZE)) 
+                count = space - RING_HEADER_SIZE;
+            bool done = ((nBytes + count) == len);
+            UINT32 header = count;
+            if (done && eom) header |= RING_FLAG_EOM;
+            if (0 != header)
+            {
+                RingPut(header, buffer + nBytes);
+                nBytes += count;
+            }
+            if (done) break;
+            space = RingSpace();
+            if (space > RING_HEADER_SIZE) continue;
+        }
+        // The ring is full, so ask for a TX_QUEUE_VACANCY notification, but
+        // check again in case the protocol thread drained it in the meantime
+        NormAtomicExchange(&ring_wanted, 1);
+        UINT32 newSpace = RingSpace();
+        if (newSpace <= space) break;
+        space = newSpace;
     }
     return nBytes;
-}  // end NormStreamObject::Write()
+}  // end NormStreamObject::RingWrite()
+
+bool NormStreamObject::RingMark(UINT32 header)
+{
+    if (RingSpace() < RING_HEADER_SIZE)
+    {
+        NormAtomicExchange(&ring_wanted, 1);
+        if (RingSpace() < RING_HEADER_SIZE) return false;
+    }
+    return RingPut(header, NULL);
+}  // end NormStreamObject::RingMark()
+
+bool NormStreamObject::RingFlush(bool eom, FlushMode flushMode)
+{
+    UINT32 header = RING_FLAG_FLUSH;
+    if (eom) header |= RING_FLAG_EOM;
+    if (FLUSH_ACTIVE == flushMode) header |= RING_FLAG_ACTIVE;
+    return RingMark(header);
+}  // end NormStreamObject::RingFlush()
+
+UINT32 NormStreamObject::RingGetVacancy(unsigned int wanted)
+{
+    UINT32 space = RingSpace();
+    UINT32 vacancy = (space > RING_HEADER_SIZE) ? (space - RING_HEADER_SIZE) : 0;
+    if ((0 == vacancy) || (vacancy < wanted))
+    {
+        // Ask for a TX_QUEUE_VACANCY notification and check again
+        NormAtomicExchange(&ring_wanted, 1);
+        space = RingSpace();
+        vacancy = (space > RING_HEADER_SIZE) ? (space - RING_HEADER_SIZE) : 0;
+    }
+    return vacancy;
+}  // end NormStreamObject::RingGetVacancy()
+
+bool NormStreamObject::DrainWriteRing()
+{
+    UINT32 head = NormAtomicLoad(&ring_head);
+    UINT32 tail = ring_tail;
+    if (stream_closing && (ring_record_open || (head != tail)))
+    {
+        PLOG(PL_ERROR, "NormStreamObject::DrainWriteRing() error: stream is closing (discarding %lu bytes)\n",
+                        (unsigned long)(head - tail));
+        ring_record_open = false;
+        NormAtomicStore(&ring_tail, head);
+        return false;
+    }
+    UINT32 oldTail = tail;
+    while (true)
+    {
+        if (!ring_record_open)
+        {
+            if ((head - tail) < RING_HEADER_SIZE) break;
+            UINT32 header;
+            RingCopyOut(tail, (char*)&header, RING_HEADER_SIZE);
+            tail += RING_HEADER_SIZE;
+            ring_record = header & RING_LENGTH_MASK;
+            ring_flags = header & ~((UINT32)RING_LENGTH_MASK);
+            ring_record_open = true;
+        }
+        bool eom = (0 != (RING_FLAG_EOM & ring_flags));
+        if (0 != (RING_FLAG_FLUSH & ring_flags))
+        {
+            FlushMode saveFlushMode = flush_mode;
+            flush_mode = (0 != (RING_FLAG_ACTIVE & ring_flags)) ? FLUSH_ACTIVE : FLUSH_NONE;
+            Flush(eom);
+            flush_mode = saveFlushMode;
+        }
+        else if (0 == ring_record)
+        {
+            Write(NULL, 0, eom);  // end-of-message only
+        }
+        else
+        {
+            // Record content is written in contiguous chunks with any
+            // auto flush deferred until the end of the record
+            FlushMode saveFlushMode = flush_mode;
+            while (0 != ring_record)
+            {
+                UINT32 offset = tail & ring_mask;
+                UINT32 count = ring_mask + 1 - offset;
+                bool last = (count >= ring_record);
+                if (last) 
+                    count = ring_record;
+                else
+                    flush_mode = FLUSH_NONE;
+                UINT32 written = Write(ring_buffer + offset, count, last && eom);
+                flush_mode = saveFlushMode;
+                tail += written;
+                ring_record -= written;
+                if (written < count) break;  // stream buffer is full
+            }
+            if (0 != ring_record) break;
+        }
+        ring_record_open = false;
+    }
+    if (tail == oldTail) return false;
+    NormAtomicStore(&ring_tail, tail);
+    bool vacancy = (0 != NormAtomicExchange(&ring_wanted, 0));
+    if (ring_close_pending && RingIsEmpty())
+    {
+        // Complete the graceful "Close()" deferred until the ring drained
+        ring_close_pending = false;
+        Terminate();
+    }
+    return vacancy;
+}  // end NormStreamObject::DrainWriteRing()
 
 #ifdef SIMULATE
 /////////////////////////////////////////////////////////////////
@@ -4299,11 +5787,7 @@ char* NormSimObject::RetrieveSegment(NormBlockId   blockId,
 //
 
 NormObjectTable::NormObjectTable()
-#ifndef USE_PROTO_TREE
- : table((NormObject**)NULL), 
-#else
- :
-#endif // if/else USE_PROTO_TREE
+ : table((NormObject**)NULL), ring_mask(0),
    range_max(0), range(0),
    count(0), size(0)
 {
@@ -4314,28 +5798,49 @@ NormObjectTable::~NormObjectTable()
     Destroy();
 }
 
-bool NormObjectTable::Init(UINT16 rangeMax, UINT16 tableSize)
+bool NormObjectTable::Init(UINT16 rangeMax)
 {
     Destroy();
-    if (!rangeMax || !tableSize) return false;
-#ifndef USE_PROTO_TREE
-    // Make sure (rangeMax > 0) and tableSize is greater than 0 and 2^n
-    if (!rangeMax || !tableSize) return false;
-    if (0 != (tableSize & 0x07)) tableSize = (tableSize >> 3) + 1;
-    if (!(table = new NormObject*[tableSize]))
-    {
-        PLOG(PL_FATAL, "NormObjectTable::Init() table allocation error: %s\n", GetErrorString());
-        return false;         
-    }
-    memset(table, 0, tableSize*sizeof(char*));
-    hash_mask = tableSize - 1;
-#endif  //  !USE_PROTO_TREE
+    if (0 == rangeMax) return false;
+    if (!ResizeRing(rangeMax)) return false;
     range_max = rangeMax;
     count = range = 0;
     size = NormObjectSize(0);
     return true;
 }  // end NormObjectTable::Init()
 
+// Makes sure the ring is large enough (2^n) to direct-map "rangeMax" objects, 
+// moving any currently-held objects to their slots in a new ring as needed.
+bool NormObjectTable::ResizeRing(UINT16 rangeMax)
+{
+    unsigned int ringSize = 1;
+    while (ringSize < rangeMax) ringSize <<= 1;
+    if ((NULL != table) && (ringSize <= ((unsigned int)ring_mask + 1))) 
+        return true;  // current ring is big enough
+    NormObject** newTable;
+    if (!(newTable = new NormObject*[ringSize]))
+    {
+        PLOG(PL_FATAL, "NormObjectTable::ResizeRing() table allocation error: %s\n", GetErrorString());
+        return false;         
+    }
+    memset(newTable, 0, ringSize*sizeof(NormObject*));
+    UINT16 newMask = (UINT16)(ringSize - 1);
+    if (0 != range)
+    {
+        NormObjectId objectId = range_lo;
+        for (UINT16 i = 0; i < range; i++)
+        {
+            NormObject* obj = Slot(objectId);
+            if (NULL != obj) newTable[((UINT16)objectId) & newMask] = obj;
+            objectId++;
+        }
+    }
+    if (NULL != table) delete[] table;
+    table = newTable;
+    ring_mask = newMask;
+    return true;
+}  // end NormObjectTable::ResizeRing()
+
 void NormObjectTable::SetRangeMax(UINT16 rangeMax)
 {
     if (rangeMax < range_max)
@@ -4359,57 +5864,54 @@ void NormObjectTable::SetRangeMax(UINT16 rangeMax)
             }
         }
     }
+    else if (!ResizeRing(rangeMax))
+    {
+        PLOG(PL_ERROR, "NormObjectTable::SetRangeMax() error: unable to resize table\n");
+        return;  // keep prior range_max
+    }
     range_max = rangeMax;
 }  // end NormObjectTable::SetRangeMax()
 
-#ifdef USE_PROTO_TREE
-
 NormObject* NormObjectTable::Find(const NormObjectId& objectId) const
 {
     if ((0 == range) || (objectId < range_lo) || (objectId > range_hi))
-        return NULL;    
-    else        
-        return tree.Find(objectId.GetValuePtr(), 8*sizeof(UINT16));
+        return (NormObject*)NULL;
+    else
+        return Slot(objectId);
 }  // end NormObjectTable::Find()
 
-void NormObjectTable::Destroy()
+NormObject* NormObjectTable::FindNext(const NormObjectId& objectId) const
 {
-    NormObject* obj;
-    while(NULL != (obj = Find(range_lo)))
+    UINT16 span = range_hi - objectId;
+    NormObjectId id = objectId;
+    for (UINT16 i = 0; i < span; i++)
     {
-        // TBD - should we issue PURGED/ABORTED notifications here???
-        // (We haven't since this is destroyed only when session is terminated)
-        // or when a NormSenderNode is deleted
-        Remove(obj);
-        obj->Release();
+        id++;
+        NormObject* obj = Slot(id);
+        if (NULL != obj) return obj;
     }
-    count = range = range_max = 0;
-}  // end NormObjectTable::Destroy()
-
-#else  // !USE_PROTO_TREE
+    return (NormObject*)NULL;
+}  // end NormObjectTable::FindNext()
 
-NormObject* NormObjectTable::Find(const NormObjectId& objectId) const
+NormObject* NormObjectTable::FindPrev(const NormObjectId& objectId) const
 {
-    if (0 != range)
+    UINT16 span = objectId - range_lo;
+    NormObjectId id = objectId;
+    for (UINT16 i = 0; i < span; i++)
     {
-        if ((objectId < range_lo)  || (objectId > range_hi)) return (NormObject*)NULL;
-        NormObject* theObject = table[((UINT16)objectId) & hash_mask];
-        while (theObject && (objectId != theObject->GetId())) 
-            theObject = theObject->next;
-        return theObject;
+        id--;
+        NormObject* obj = Slot(id);
+        if (NULL != obj) return obj;
     }
-    else
-    {
-        return (NormObject*)NULL;
-    }   
-}  // end NormObjectTable::Find()
+    return (NormObject*)NULL;
+}  // end NormObjectTable::FindPrev()
 
 void NormObjectTable::Destroy()
 {
     if (NULL != table)
     {
         NormObject* obj;
-        while((obj = Find(range_lo)))
+        while (NULL != (obj = Find(range_lo)))
         {
             // TBD - should we issue PURGED/ABORTED notifications here???
             // (We haven't since this is destroyed only when session is terminated)
@@ -4419,26 +5921,24 @@ void NormObjectTable::Destroy()
         }
         delete[] table;
         table = (NormObject**)NULL;
-        count = range = range_max = 0;
     }  
+    count = range = range_max = 0;
 }  // end NormObjectTable::Destroy()
 
-#endif // if/else USE_PROTO_TREE
-
 bool NormObjectTable::CanInsert(NormObjectId objectId) const
 {
     if (0 != range)
     {
         if (objectId < range_lo)
         {
-            if ((range_lo - objectId + range) > range_max)
+            if (((UINT32)((UINT16)(range_lo - objectId)) + range) > range_max)
                 return false;
             else
                 return true;
         }
         else if (objectId > range_hi)
         {
-            if ((objectId - range_hi + range) > range_max)
+            if (((UINT32)((UINT16)(objectId - range_hi)) + range) > range_max)
                 return false;
             else
                 return true;
@@ -4465,265 +5965,65 @@ bool NormObjectTable::Insert(NormObject* theObject)
     }
     else if (objectId < range_lo)
     {
-        UINT16 newRange = range_lo - objectId + range;
+        UINT32 newRange = (UINT32)((UINT16)(range_lo - objectId)) + range;
         if (newRange > range_max) return false;
         range_lo = objectId;
         ASSERT(range_lo <= range_hi);
-        range = newRange;
+        range = (UINT16)newRange;
     }
     else if (objectId > range_hi)
     {            
-        UINT16 newRange = objectId - range_hi + range;
+        UINT32 newRange = (UINT32)((UINT16)(objectId - range_hi)) + range;
         if (newRange > range_max) return false;
         range_hi = objectId;
         ASSERT(range_lo <= range_hi);
-        range = newRange;
+        range = (UINT16)newRange;
     }
-    
-#ifdef USE_PROTO_TREE
-    ASSERT(NULL == Find(theObject->GetId()));
-    tree.Insert(*theObject);
-#else
-    UINT16 index = ((UINT16)objectId) & hash_mask;
-    NormObject* prev = NULL;
-    NormObject* entry = table[index];
-    while (entry && (entry->GetId() < objectId)) 
-    {
-        prev = entry;
-        entry = entry->next;
-    }  
-    if (prev)
-        prev->next = theObject;
-    else
-        table[index] = theObject;
-    ASSERT(((NULL != entry) ? (objectId != entry->GetId()) : true));
-    theObject->next = entry;
-#endif  // if/else USE_PROTO_TREE
+    ASSERT(NULL == Slot(objectId));
+    table[((UINT16)objectId) & ring_mask] = theObject;
     count++;
     size = size + theObject->GetSize();
     theObject->Retain();
     return true;
 }  // end NormObjectTable::Insert()
 
-#ifdef USE_PROTO_TREE
-bool NormObjectTable::Remove(NormObject* theObject)
-{
-    ASSERT(NULL != theObject);
-    const NormObjectId& objectId = theObject->GetId();
-    if (range)
-    {
-        if ((objectId < range_lo) || (objectId > range_hi)) return false;
-        if (range > 1)
-        {
-            if (objectId == range_lo)
-            {
-                const NormObject* next = static_cast<const NormObject*>(theObject->GetNext());
-                if (NULL == next) next = static_cast<const NormObject*>(tree.GetHead());
-                ASSERT(NULL != next);
-                range_lo = next->GetId();
-                ASSERT(range_lo <= range_hi);
-                range = range_hi - range_lo + 1;
-            }
-            else if (objectId == range_hi)
-            {
-                const NormObject* prev = static_cast<const NormObject*>(theObject->GetPrev());
-                if (NULL == prev) prev = static_cast<const NormObject*>(tree.GetTail());
-                ASSERT(NULL != prev);
-                range_hi = prev->GetId();
-                ASSERT(range_lo <= range_hi);
-                range = range_hi - range_lo + 1;
-            }
-        }
-        else
-        {
-            range = 0;
-        }
-        ASSERT(NULL != tree.Find(theObject->GetId().GetValuePtr(), 8*sizeof(UINT16)));
-        tree.Remove(*theObject);
-        count--;
-        size = size - theObject->GetSize();
-        theObject->Release();
-        return true;
-    }
-    else
-    {
-        return false;
-    }
-}  // end NormObjectTable::Remove()
-#else
 bool NormObjectTable::Remove(NormObject* theObject)
 {
     ASSERT(NULL != theObject);
     const NormObjectId& objectId = theObject->GetId();
-    if (range)
+    if (0 == range) return false;
+    if ((objectId < range_lo) || (objectId > range_hi)) return false;
+    if (theObject != Slot(objectId)) return false;
+    table[((UINT16)objectId) & ring_mask] = (NormObject*)NULL;
+    if (range > 1)
     {
-        if ((objectId < range_lo) || (objectId > range_hi)) return false;
-        UINT16 index = ((UINT16)objectId) & hash_mask;
-        NormObject* prev = NULL;
-        NormObject* entry = table[index];
-        while (entry && (entry->GetId() != objectId))
+        if (objectId == range_lo)
         {
-            prev = entry;
-            entry = entry->next;
+            const NormObject* next = FindNext(objectId);
+            ASSERT(NULL != next);
+            range_lo = next->GetId();
+            ASSERT(range_lo <= range_hi);
+            range = range_hi - range_lo + 1;
         }
-        if (entry != theObject) return false;
-        if (prev)
-            prev->next = entry->next;
-        else
-            table[index] = entry->next;
-        if (range > 1)
+        else if (objectId == range_hi)
         {
-            if (objectId == range_lo)
-            {
-                // Find next entry for range_lo
-                UINT16 i = index;
-                UINT16 endex;
-                if (range <= hash_mask)
-                    endex = (index + range - 1) & hash_mask;
-                else
-                    endex = index;
-                entry = NULL;
-                UINT16 offset = 0;
-                NormObjectId nextId = range_hi;
-                do
-                {
-                    ++i &= hash_mask;
-                    offset++;
-                    if ((entry = table[i]))
-                    {
-                        NormObjectId id = (UINT16)objectId + offset;
-                        while(entry && (entry->GetId() != id)) 
-                        {
-                            if ((entry->GetId() > objectId) && 
-                                (entry->GetId() < nextId)) nextId = entry->GetId();
-                            entry = entry->next;
-                               
-                        }
-                        if (entry) break;    
-                    }
-                } while (i != endex);
-                if (entry)
-                    range_lo = entry->GetId();
-                else
-                    range_lo = nextId;
-                range = range_hi - range_lo + 1;
-            }
-            else if (objectId == range_hi)
-            {
-                // Find prev entry for range_hi
-                UINT16 i = index;
-                UINT16 endex;
-                if (range <= hash_mask)
-                    endex = (index - range + 1) & hash_mask;
-                else
-                    endex = index;
-                entry = NULL;
-                UINT16 offset = 0;
-                NormObjectId prevId = range_lo;
-                do
-                {
-                    --i &= hash_mask;
-                    offset++;
-                    if ((entry = table[i]))
-                    {
-                        NormObjectId id = (UINT16)objectId - offset;
-                        while(entry && (entry->GetId() != id)) 
-                        {
-                            if ((entry->GetId() < objectId) && 
-                                (entry->GetId() > prevId)) prevId = entry->GetId();
-                            entry = entry->next;
-                        }
-                        if (entry) break;    
-                    }
-                } while (i != endex);
-                if (entry)
-                    range_hi = entry->GetId();
-                else
-                    range_hi = prevId;
-                range = range_hi - range_lo + 1;
-            } 
+            const NormObject* prev = FindPrev(objectId);
+            ASSERT(NULL != prev);
+            range_hi = prev->GetId();
+            ASSERT(range_lo <= range_hi);
+            range = range_hi - range_lo + 1;
         }
-        else
-        {
-            range = 0;
-        }  
-        count--;
-        size = size - theObject->GetSize();
-        theObject->Release();
-        return true;
     }
     else
     {
-        return false;
+        range = 0;
     }
+    count--;
+    size = size - theObject->GetSize();
+    theObject->Release();
+    return true;
 }  // end NormObjectTable::Remove()
-#endif // if/else USE_PROTO_TREE
-
-#ifdef USE_PROTO_TREE
-NormObjectTable::Iterator::Iterator(NormObjectTable& objectTable)
- : table(objectTable), iterator(objectTable.tree, false, objectTable.range_lo.GetValuePtr(), 8*sizeof(UINT16))
-{
-    next_object = iterator.GetNextItem();
-    ASSERT((NULL == next_object) || (objectTable.range_lo == next_object->GetId()))
-}
-
-void NormObjectTable::Iterator::Reset()
-{
-    iterator.Reset(false, table.range_lo.GetValuePtr(), 8*sizeof(UINT16));
-    next_object = iterator.GetNextItem();
-    ASSERT(table.IsEmpty() || (NULL != next_object));
-    ASSERT((NULL == next_object) || (table.range_lo == next_object->GetId()))
-}
-
-NormObject* NormObjectTable::Iterator::GetNextObject()
-{
-    NormObject* nextObj = next_object;
-    if (NULL != nextObj)
-    {
-        next_object = iterator.GetNextItem();
-        if (NULL == next_object)
-        {
-            iterator.Reset();
-            next_object = iterator.GetNextItem();
-            if (next_object->GetId() <= nextObj->GetId())
-                next_object = NULL;
-        }
-        else if (next_object->GetId() <= nextObj->GetId())
-        {
-            next_object = NULL;
-        }
-    }
-    return nextObj;
-}  // end NormObjectTable::Iterator::GetNextObject()
 
-NormObject* NormObjectTable::Iterator::GetPrevObject()
-{
-    if (!iterator.IsReversed())
-    {
-        iterator.Reset(true, table.range_hi.GetValuePtr(), 8*sizeof(UINT16));
-        next_object = iterator.GetPrevItem();
-    }
-    NormObject* prevObj = next_object;
-    if (NULL != prevObj)
-    {
-        next_object = iterator.GetPrevItem();
-        if (NULL == next_object)
-        {
-            iterator.Reset(true);
-            next_object = iterator.GetPrevItem();
-            if (next_object->GetId() >= prevObj->GetId())
-                next_object = NULL;
-        }
-        else if (next_object->GetId() >= prevObj->GetId())
-        {
-            next_object = NULL;
-        }
-    }
-    return prevObj;
-}  // end NormObjectTable::Iterator::GetPrevObject()
-        
-        
-#else
 NormObjectTable::Iterator::Iterator(const NormObjectTable& objectTable)
  : table(objectTable), reset(true)
 {
@@ -4731,120 +6031,44 @@ NormObjectTable::Iterator::Iterator(const NormObjectTable& objectTable)
 
 NormObject* NormObjectTable::Iterator::GetNextObject()
 {
-    if (reset)
+    if (0 == table.range) return (NormObject*)NULL;
+    // (If the prior object was removed from the low end of the
+    //  range, we pick up again at the new "range_lo")
+    if (reset || (index < table.range_lo))
     {
-        if (table.range)
-        {
-            reset = false;
-            index = table.range_lo;
-            return table.Find(index);
-        }
-        else
-        {
-            return (NormObject*)NULL;
-        }
+        reset = false;
+        index = table.range_lo;
+        return table.Find(index);
+    }
+    else if (index < table.range_hi)
+    {
+        NormObject* nextObj = table.FindNext(index);
+        if (NULL != nextObj) index = nextObj->GetId();
+        return nextObj;
     }
     else
     {
-        if (table.range && 
-            (index < table.range_hi) && 
-            (index >= table.range_lo))
-        {
-            // Find next entry _after_ current "index"
-            UINT16 i = index;
-            UINT16 endex;
-            if ((UINT16)(table.range_hi - index) <= table.hash_mask)
-                endex = table.range_hi & table.hash_mask;
-            else
-                endex = index;
-            UINT16 offset = 0;
-            NormObjectId nextId = table.range_hi;
-            do
-            {
-                ++i &= table.hash_mask;
-                offset++;
-                NormObjectId id = (UINT16)index + offset;
-                NormObject* entry = table.table[i];
-                while ((NULL != entry) && (entry->GetId() != id)) 
-                {
-                    if ((entry->GetId() > index) && (entry->GetId() < nextId))
-                        nextId = entry->GetId();
-                    entry = table.Next(entry);
-                }
-                if (entry)
-                {
-                    index = entry->GetId();
-                    return entry;   
-                } 
-            } while (i != endex);
-            // If we get here, use nextId value
-            index = nextId;
-            return table.Find(nextId);
-        }
-        else
-        {
-            return (NormObject*)NULL;
-        }
-    }   
+        return (NormObject*)NULL;
+    }
 }  // end NormObjectTable::Iterator::GetNextObject()
 
 NormObject* NormObjectTable::Iterator::GetPrevObject()
 {
-    if (reset)
+    if (0 == table.range) return (NormObject*)NULL;
+    if (reset || (index > table.range_hi))
     {
-        if (table.range)
-        {
-            reset = false;
-            index = table.range_hi;
-            return table.Find(index);
-        }
-        else
-        {
-            return (NormObject*)NULL;
-        }
+        reset = false;
+        index = table.range_hi;
+        return table.Find(index);
+    }
+    else if (index > table.range_lo)
+    {
+        NormObject* prevObj = table.FindPrev(index);
+        if (NULL != prevObj) index = prevObj->GetId();
+        return prevObj;
     }
     else
     {
-        if (table.range && 
-            (index <= table.range_hi) && 
-            (index > table.range_lo))
-        {
-            // Find prev entry _before_ current "index"
-            UINT16 i = index;
-            UINT16 endex;
-            if ((UINT16)(index - table.range_lo) <= table.hash_mask)
-                endex = table.range_lo & table.hash_mask;
-            else
-                endex = index;
-            UINT16 offset = 0;
-            NormObjectId nextId = table.range_hi;
-            do
-            {
-                --i &= table.hash_mask;
-                offset--;
-                NormObjectId id = (UINT16)index + offset;
-                NormObject* entry = table.table[i];
-                while ((NULL != entry ) && (entry->GetId() != id)) 
-                {
-                    if ((entry->GetId() > index) && (entry->GetId() < nextId))
-                        nextId = entry->GetId();
-                    entry = table.Next(entry);
-                }
-                if (entry)
-                {
-                    index = entry->GetId();
-                    return entry;   
-                } 
-            } while (i != endex);
-            // If we get here, use nextId value
-            index = nextId;
-            return table.Find(nextId);
-        }
-        else
-        {
-            return (NormObject*)NULL;
-        }
+        return (NormObject*)NULL;
     }
 }  // end NormObjectTable::Iterator::GetPrevObject()
-
-#endif  // if/else USE_PROTO_TREE
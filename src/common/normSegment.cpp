@@ -1,7 +1,19 @@
 #include "normSegment.h"
 
+#if !defined(WIN32) && !defined(SIMULATE)
+#include <sys/mman.h>  // for mmap(), mlock(), etc
+static const size_t NORM_HUGE_PAGE_SIZE = 2*1024*1024;
+// Only segment pool slabs at least this large (or to be locked in memory)
+// get their own mmap(), backed by huge pages when possible.  Smaller slabs
+// (e.g., those of the many per-sender pools) come from the heap so they 
+// don't each round up to a huge page or cost a separate mapping (and the
+// rounding wastes at most 1/8th of a slab this large).
+static const size_t NORM_SLAB_MAP_MIN = 8*NORM_HUGE_PAGE_SIZE;
+#endif // !WIN32 && !SIMULATE
+
 NormSegmentPool::NormSegmentPool()
  : seg_size(0), seg_count(0), seg_total(0), seg_list(NULL), seg_pool(NULL),
+   slab_ptr(NULL), slab_size(0), slab_mapped(false), slab_locked(false),
    peak_usage(0), overruns(0), overrun_flag(false)
 {
 }
@@ -11,9 +23,9 @@ NormSegmentPool::~NormSegmentPool()
     Destroy();
 }
 
-bool NormSegmentPool::Init(unsigned int count, unsigned int size)
+bool NormSegmentPool::Init(unsigned int count, unsigned int size, bool lockMemory)
 {
-    if (seg_pool) Destroy();
+    if (NULL != seg_list) Destroy();
     peak_usage = 0;
     overruns = 0;        
 #ifdef SIMULATE
@@ -21,52 +33,145 @@ bool NormSegmentPool::Init(unsigned int count, unsigned int size)
     // since we don't actually read/write real data (for the most part)
     size = MIN(size, SIM_PAYLOAD_MAX);
 #endif  // SIMULATE
-    // This makes sure we get appropriate alignment
-    unsigned int allocSize = size / sizeof(char*);
-    if ((allocSize*sizeof(char*)) < size) allocSize++;
-    seg_size = allocSize * sizeof(char*);
-	seg_pool = new char*[allocSize * count];
-	if (seg_pool)
-	{
-		char** ptr = seg_pool;
-		for (unsigned int i = 0; i < count; i++)
-		{
-			*ptr = seg_list;
-			seg_list = (char*)ptr;
-			ptr += allocSize;
-		}
-	}
-	else
-	{
-		PLOG(PL_FATAL, "NormSegmentPool::Init() memory allocation error: %s\n",
-				GetErrorString());
-		Destroy();
-		return false;
-	}
-	seg_total = seg_count = count;
-	return true;
+    // Pad segments to a multiple of the cache line size so every segment
+    // is aligned for the FEC encoders/decoders
+    seg_size = ((size + SEGMENT_ALIGNMENT - 1) / SEGMENT_ALIGNMENT) * SEGMENT_ALIGNMENT;
+    if (!(seg_list = new char*[count]))
+    {
+        PLOG(PL_FATAL, "NormSegmentPool::Init() seg_list allocation error: %s\n",
+                GetErrorString());
+        return false;
+    }
+    if (!AllocateSlab((size_t)seg_size * count, lockMemory))
+    {
+        Destroy();
+        return false;
+    }
+    // Stack the segments so the lowest addressed ones are handed out first
+    char* ptr = seg_pool + ((size_t)seg_size * count);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        ptr -= seg_size;
+        seg_list[i] = ptr;
+    }
+    seg_total = seg_count = count;
+    return true;
 }  // end NormSegmentPool::Init()
 
+bool NormSegmentPool::AllocateSlab(size_t numBytes, bool lockMemory)
+{
+#if !defined(WIN32) && !defined(SIMULATE)
+    void* ptr = MAP_FAILED;
+    size_t mapSize = numBytes;
+#ifdef MAP_HUGETLB
+    // Use explicit huge pages if the system has some reserved ...
+    if (numBytes >= NORM_SLAB_MAP_MIN)
+    {
+        mapSize = ((numBytes + NORM_HUGE_PAGE_SIZE - 1) / NORM_HUGE_PAGE_SIZE) * NORM_HUGE_PAGE_SIZE;
+        ptr = mmap(NULL, mapSize, PROT_READ | PROT_WRITE, 
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    }
+#endif // MAP_HUGETLB
+    // (a slab to be locked is always mapped so that mlock()/munlock() 
+    //  don't affect pages shared with other heap allocations)
+    if ((MAP_FAILED == ptr) && (lockMemory || (numBytes >= NORM_SLAB_MAP_MIN)))
+    {
+        mapSize = numBytes;
+        ptr = mmap(NULL, mapSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (MAP_FAILED == ptr)
+        {
+            PLOG(PL_WARN, "NormSegmentPool::AllocateSlab() mmap() error: %s (using heap)\n",
+                    GetErrorString());
+        }
+#ifdef MADV_HUGEPAGE
+        else if (numBytes >= NORM_SLAB_MAP_MIN)
+        {
+            // ... otherwise ask for transparent huge pages
+            madvise(ptr, mapSize, MADV_HUGEPAGE);
+        }
+#endif // MADV_HUGEPAGE
+    }
+    if (MAP_FAILED != ptr)
+    {
+        slab_ptr = seg_pool = (char*)ptr;  // (page aligned)
+        slab_size = mapSize;
+        slab_mapped = true;
+    }
+#endif // !WIN32 && !SIMULATE
+    if (NULL == slab_ptr)
+    {
+        slab_size = numBytes + SEGMENT_ALIGNMENT;
+        if (!(slab_ptr = new char[slab_size]))
+        {
+            PLOG(PL_FATAL, "NormSegmentPool::AllocateSlab() memory allocation error: %s\n",
+                    GetErrorString());
+            slab_size = 0;
+            return false;
+        }
+        slab_mapped = false;
+        size_t misalign = ((size_t)slab_ptr) % SEGMENT_ALIGNMENT;
+        seg_pool = slab_ptr + ((0 != misalign) ? (SEGMENT_ALIGNMENT - misalign) : 0);
+    }
+#ifndef SIMULATE
+    if (lockMemory)
+    {
+#ifdef WIN32
+        slab_locked = (0 != VirtualLock(slab_ptr, slab_size));
+#else
+        slab_locked = (0 == mlock(slab_ptr, slab_size));
+#endif // if/else WIN32
+        if (!slab_locked)
+            PLOG(PL_WARN, "NormSegmentPool::AllocateSlab() warning: unable to lock buffer memory: %s\n",
+                    GetErrorString());
+    }
+#endif // !SIMULATE
+    return true;
+}  // end NormSegmentPool::AllocateSlab()
+
+void NormSegmentPool::FreeSlab()
+{
+    if (NULL == slab_ptr) return;
+#ifndef SIMULATE
+    if (slab_locked)
+    {
+#ifdef WIN32
+        VirtualUnlock(slab_ptr, slab_size);
+#else
+        munlock(slab_ptr, slab_size);
+#endif // if/else WIN32
+    }
+#endif // !SIMULATE
+#if !defined(WIN32) && !defined(SIMULATE)
+    if (slab_mapped)
+        munmap(slab_ptr, slab_size);
+    else
+#endif // !WIN32 && !SIMULATE
+        delete[] slab_ptr;
+    slab_ptr = seg_pool = NULL;
+    slab_size = 0;
+    slab_mapped = slab_locked = false;
+}  // end NormSegmentPool::FreeSlab()
+
 void NormSegmentPool::Destroy()
 {
     ASSERT(seg_count == seg_total);
-	if (NULL != seg_pool)
-        delete[] seg_pool;
-	seg_pool = NULL;
-	seg_list = NULL;
-	seg_count = 0;
-	seg_total = 0;
-	seg_size = 0;
+    FreeSlab();
+    if (NULL != seg_list)
+    {
+        delete[] seg_list;
+        seg_list = NULL;
+    }
+    seg_count = 0;
+    seg_total = 0;
+    seg_size = 0;
 }  // end NormSegmentPool::Destroy()
 
 char* NormSegmentPool::Get()
 {
-    char* ptr = seg_list;
-    if (ptr)
+    char* ptr = NULL;
+    if (0 != seg_count)
     {
-        //memcpy(&seg_list, ptr, sizeof(char*));
-        seg_list = *((char**)((void*)ptr));
-        seg_count--;
+        ptr = seg_list[--seg_count];
 //#ifdef NORM_DEBUG
         overrun_flag = false;
         unsigned int usage = seg_total - seg_count;
@@ -683,11 +788,7 @@ void NormBlockPool::Destroy()
 }  // end NormBlockPool::Destroy()
 
 NormBlockBuffer::NormBlockBuffer()
-#ifdef USE_PROTO_TREE
- :
-#else
- : table((NormBlock**)NULL), 
-#endif  // if/else USE_PROTO_TREE
+ : table((NormBlock**)NULL), ring_mask(0),
    range_max(0), range(0), fec_block_mask(0)
 {
 }
@@ -700,65 +801,44 @@ NormBlockBuffer::~NormBlockBuffer()
 bool NormBlockBuffer::Init(unsigned long rangeMax, unsigned long tableSize, UINT32 fecBlockMask)
 {
     Destroy();
-    // Make sure tableSize is greater than 0 and 2^n
-    //if (!rangeMax || !tableSize) 
     if (0 == tableSize)
     {
         PLOG(PL_FATAL, "NormBlockBuffer::Init() bad range(%lu) or tableSize(%lu)\n",
                         rangeMax, tableSize);
         return false;
     }
-#ifndef USE_PROTO_TREE
-    if (0 != (tableSize & 0x07)) tableSize = (tableSize >> 3) + 1;
-    if (!(table = new NormBlock*[tableSize]))
+    // The ring is sized (2^n) to direct-map the full "rangeMax" if it 
+    // can, but is limited by "tableSize" and the FEC block id space
+    unsigned long ringMax = (rangeMax < tableSize) ? rangeMax : tableSize;
+    if ((0 != fecBlockMask) && (ringMax > (unsigned long)fecBlockMask))
+        ringMax = (unsigned long)fecBlockMask + 1;
+    unsigned long ringSize = 1;
+    while (ringSize < ringMax) ringSize <<= 1;
+    if (!(table = new NormBlock*[ringSize]))
     {
         PLOG(PL_FATAL, "NormBlockBuffer::Init() buffer allocation error: %s\n", GetErrorString());
         return false;         
     }
-    memset(table, 0, tableSize*sizeof(char*));
-    hash_mask = tableSize - 1;
-#endif // !USE_PROTO_TREE
+    memset(table, 0, ringSize*sizeof(NormBlock*));
+    ring_mask = (UINT32)(ringSize - 1);
     range_max = rangeMax;
     range = 0;
     fec_block_mask = fecBlockMask;
     return true;
 }  // end NormBlockBuffer::Init()
 
-#ifdef USE_PROTO_TREE
 void NormBlockBuffer::Destroy()
 {
-    NormBlock* block;
-    while((block = Find(range_lo)))
-    {
-        PLOG(PL_ERROR, "NormBlockBuffer::Destroy() buffer not empty!?\n");
-        Remove(block);
-        delete block;   
-    }
-    range_max = range = 0;
-}  // end NormBlockBuffer::Destroy()
-
-NormBlock* NormBlockBuffer::Find(const NormBlockId& blockId) const
-{
-    if ((0 == range) || (Compare(blockId, range_lo) < 0) || (Compare(blockId, range_hi) > 0))
-        return NULL;
-    else
-        return tree.Find(blockId.GetValuePtr(), 8*sizeof(UINT32));
-}  // end NormBlockBuffer::Find()
-
-#else
-
-void NormBlockBuffer::Destroy()
-{
-    if (table)
+    if (NULL != table)
     {
         NormBlock* block;
-        while((block = Find(range_lo)))
+        while (NULL != (block = Find(range_lo)))
         {
             PLOG(PL_ERROR, "NormBlockBuffer::Destroy() buffer not empty!?\n");
             Remove(block);
             delete block;   
         }
-        delete []table;
+        delete[] table;
         table = (NormBlock**)NULL;
     }  
     range_max = range = 0;  
@@ -766,23 +846,64 @@ void NormBlockBuffer::Destroy()
 
 NormBlock* NormBlockBuffer::Find(const NormBlockId& blockId) const
 {
-    if (range)
-    {
-        //if ((blockId < range_lo)  || (blockId > range_hi)) 
-        if ((Compare(blockId, range_lo) < 0) || (Compare(blockId, range_hi) > 0))
-            return (NormBlock*)NULL;
-        NormBlock* theBlock = table[(blockId.GetValue()) & hash_mask];
-        while ((NULL != theBlock) && (blockId != theBlock->GetId())) 
-            theBlock = theBlock->next;
-        return theBlock;
-    }
-    else
-    {
+    if ((0 == range) || (Compare(blockId, range_lo) < 0) || (Compare(blockId, range_hi) > 0))
         return (NormBlock*)NULL;
-    }   
+    NormBlock* theBlock = table[blockId.GetValue() & ring_mask];
+    while ((NULL != theBlock) && (blockId != theBlock->GetId())) 
+        theBlock = theBlock->next;
+    return theBlock;
 }  // end NormBlockBuffer::Find()
 
-#endif // if/else USE_PROTO_TREE
+NormBlock* NormBlockBuffer::FindNext(const NormBlockId& blockId) const
+{
+    // Step through ring slots after "blockId" looking for an exact
+    // id match.  If the remaining range exceeds the ring size, one full
+    // pass visits every chained block and the lowest id found is it.
+    UINT32 span = (UINT32)Difference(range_hi, blockId);
+    UINT32 count = (span <= ring_mask) ? span : (ring_mask + 1);
+    NormBlock* nextBlock = NULL;
+    NormBlockId id = blockId;
+    for (UINT32 i = 0; i < count; i++)
+    {
+        Increment(id);
+        NormBlock* entry = table[id.GetValue() & ring_mask];
+        while (NULL != entry)
+        {
+            if (id == entry->GetId()) return entry;
+            if ((Compare(entry->GetId(), blockId) > 0) &&
+                ((NULL == nextBlock) || (Compare(entry->GetId(), nextBlock->GetId()) < 0)))
+            {
+                nextBlock = entry;
+            }
+            entry = entry->next;
+        }
+    }
+    return nextBlock;
+}  // end NormBlockBuffer::FindNext()
+
+NormBlock* NormBlockBuffer::FindPrev(const NormBlockId& blockId) const
+{
+    UINT32 span = (UINT32)Difference(blockId, range_lo);
+    UINT32 count = (span <= ring_mask) ? span : (ring_mask + 1);
+    NormBlock* prevBlock = NULL;
+    NormBlockId id = blockId;
+    for (UINT32 i = 0; i < count; i++)
+    {
+        Decrement(id);
+        NormBlock* entry = table[id.GetValue() & ring_mask];
+        while (NULL != entry)
+        {
+            if (id == entry->GetId()) return entry;
+            if ((Compare(entry->GetId(), blockId) < 0) &&
+                ((NULL == prevBlock) || (Compare(entry->GetId(), prevBlock->GetId()) > 0)))
+            {
+                prevBlock = entry;
+            }
+            entry = entry->next;
+        }
+    }
+    return prevBlock;
+}  // end NormBlockBuffer::FindPrev()
 
 NormBlockId NormBlockBuffer::RangeMin() const
 {
@@ -854,235 +975,60 @@ bool NormBlockBuffer::Insert(NormBlock* theBlock)
         range_hi = blockId;
         range = newRange;
     }
-    ASSERT(Compare(range_hi, range_lo) >= 0);
     // else unchanged range
-#ifdef USE_PROTO_TREE
-    ASSERT(NULL == Find(theBlock->GetId()));
-    tree.Insert(*theBlock);
-#else
-    UINT32 index = blockId.GetValue() & hash_mask;
-    NormBlock* prev = NULL;
-    NormBlock* entry = table[index];
-    // while (entry && (entry->GetId() < blockId)) 
-    while ((NULL != entry) && (Compare(entry->GetId(), blockId) < 0))
-    {
-        prev = entry;
-        entry = entry->next;
-    }  
-    if (prev)
-        prev->next = theBlock;
-    else
-        table[index] = theBlock;
-    ASSERT((entry ? (blockId != entry->GetId()) : true));
-    theBlock->next = entry;
-#endif // if/else USE_PROTO_TREE
+    ASSERT(Compare(range_hi, range_lo) >= 0);
+    ASSERT(NULL == Find(blockId));
+    UINT32 index = blockId.GetValue() & ring_mask;
+    theBlock->next = table[index];
+    table[index] = theBlock;
     return true;
 }  // end NormBlockBuffer::Insert()
 
-#ifdef USE_PROTO_TREE
-
 bool NormBlockBuffer::Remove(NormBlock* theBlock)
 {
     ASSERT(NULL != theBlock);
+    if (0 == range) return false;  // empty NormBlockBuffer
     const NormBlockId& blockId = theBlock->GetId();
-    switch (range)
+    if ((Compare(blockId, range_lo) < 0) || (Compare(blockId, range_hi) > 0)) 
+        return false;  // out-of-range
+    UINT32 index = blockId.GetValue() & ring_mask;
+    NormBlock* prev = NULL;
+    NormBlock* entry = table[index];
+    while ((NULL != entry) && (entry != theBlock))
     {
-        case 0:
-            return false;  // empty NormBlockBuffer
-        case 1:
-            if (blockId != range_lo)
-                return false;  // out-of-range
-            range = 0;
-            break;
-        default:
-            if ((Compare(blockId, range_lo) < 0) || (Compare(blockId, range_hi) > 0)) 
-                return false;  // out-of-range
-            if (blockId == range_lo)
-            {
-                const NormBlock* next = static_cast<const NormBlock*>(theBlock->GetNext());
-                if (NULL == next) next = static_cast<const NormBlock*>(tree.GetHead());
-                ASSERT(NULL != next);
-                range_lo = next->GetId();
-                range = Difference(range_hi, range_lo) + 1;
-            }
-            else if (blockId == range_hi)
-            {
-                const NormBlock* prev = static_cast<const NormBlock*>(theBlock->GetPrev());
-                if (NULL == prev) prev = static_cast<const NormBlock*>(tree.GetTail());
-                ASSERT(NULL != prev);
-                range_hi = prev->GetId();
-                range = Difference(range_hi, range_lo) + 1;
-            }
-            // else range unchanged
-            break;
+        prev = entry;
+        entry = entry->next;
     }
-    ASSERT(NULL != tree.Find(theBlock->GetId().GetValuePtr(), 8*sizeof(UINT32)));
-    tree.Remove(*theBlock);
-    return true;
-}  // end NormBlockBuffer::Remove()
-
-#else
-
-bool NormBlockBuffer::Remove(NormBlock* theBlock)
-{
-    ASSERT(NULL != theBlock);
-    if (range)
+    if (NULL == entry) return false;
+    if (NULL != prev)
+        prev->next = entry->next;
+    else
+        table[index] = entry->next;
+    if (range > 1)
     {
-        const NormBlockId& blockId = theBlock->GetId();
-        // if ((blockId < range_lo) || (blockId > range_hi)) 
-        if ((Compare(blockId, range_lo) < 0) || (Compare(blockId, range_hi) > 0))
-            return false;
-        UINT32 index = blockId.GetValue() & hash_mask;
-        NormBlock* prev = NULL;
-        NormBlock* entry = table[index];
-        while (entry && (entry->GetId() != blockId))
+        if (blockId == range_lo)
         {
-            prev = entry;
-            entry = entry->next;
+            NormBlock* nextBlock = FindNext(blockId);
+            ASSERT(NULL != nextBlock);
+            range_lo = nextBlock->GetId();
+            range = (UINT32)Difference(range_hi, range_lo) + 1;
         }
-        if (NULL == entry) return false;
-        if (NULL != prev)
-            prev->next = entry->next;
-        else
-            table[index] = entry->next;
-        
-        if (range > 1)
+        else if (blockId == range_hi)
         {
-            if (blockId == range_lo)
-            {
-                // Find next entry for new range_lo
-                UINT32 i = index;
-                UINT32 endex;
-                if (range <= hash_mask)
-                    endex = (index + range - 1) & hash_mask;
-                else
-                    endex = index;
-                entry = NULL;
-                UINT32 offset = 0;
-                NormBlockId nextId = range_hi;
-                do
-                {
-                    ++i &= hash_mask;
-                    offset++;
-                    if (NULL != (entry = table[i]))
-                    {
-                        // NormBlockId id = blockId + offset;
-                        NormBlockId id = blockId;
-                        Increment(id, offset);
-                        while(entry && (entry->GetId() != id)) 
-                        {
-                            // if ((entry->GetId() > blockId) && (entry->GetId() < nextId)
-                            if ((Compare(entry->GetId(), blockId) > 0) &&
-                                (Compare(entry->GetId(), nextId) < 0))
-                            { 
-                                nextId = entry->GetId();
-                            }
-                            entry = entry->next;
-                        }
-                        if (NULL != entry) break;    
-                    }
-                } while (i != endex);
-                if (NULL != entry)
-                    range_lo = entry->GetId();
-                else
-                    range_lo = nextId;
-                range = (UINT32)Difference(range_hi, range_lo) + 1; 
-            }
-            else if (blockId == range_hi)
-            {
-                // Find prev entry for new range_hi
-                UINT32 i = index;
-                UINT32 endex;
-                if (range <= hash_mask)
-                    endex = (index - range + 1) & hash_mask;
-                else
-                    endex = index;
-                entry = NULL;
-                UINT32 offset = 0;
-                NormBlockId prevId = range_lo;
-                do
-                {
-                    --i &= hash_mask;
-                    offset++;
-                    if ((entry = table[i]))
-                    {
-                        // NormBlockId id = blockId - offset;
-                        NormBlockId id = blockId;
-                        Decrement(id, offset);
-                        while(entry && (entry->GetId() != id)) 
-                        {
-                            // if ((entry->GetId() < blockId) && (entry->GetId() > prevId)) 
-                            if ((Compare(entry->GetId(), blockId) < 0) && 
-                                (Compare(entry->GetId(), prevId) > 0))
-                            {  
-                                prevId = entry->GetId();
-                            }
-                            entry = entry->next;
-                        }
-                        if (NULL != entry) break;    
-                    }
-                } while (i != endex);
-                if (NULL != entry)
-                    range_hi = entry->GetId();
-                else 
-                    range_hi = prevId;
-                range = (UINT32)Difference(range_hi, range_lo) + 1;
-            } 
+            NormBlock* prevBlock = FindPrev(blockId);
+            ASSERT(NULL != prevBlock);
+            range_hi = prevBlock->GetId();
+            range = (UINT32)Difference(range_hi, range_lo) + 1;
         }
-        else
-        {
-            range = 0;
-        }  
-        return true;
+        // else range unchanged
     }
     else
     {
-        return false;
+        range = 0;
     }
+    return true;
 }  // end NormBlockBuffer::Remove()
 
-#endif // if/else USE_PROTO_TREE
-
-
-#ifdef USE_PROTO_TREE
-NormBlockBuffer::Iterator::Iterator(NormBlockBuffer& blockBuffer)
- : buffer(blockBuffer), iterator(blockBuffer.tree, false, blockBuffer.range_lo.GetValuePtr(), 8*sizeof(UINT32))
-{
-    next_block = iterator.GetNextItem();
-    ASSERT((NULL == next_block) || (blockBuffer.range_lo == next_block->GetId()))
-}
-
-void NormBlockBuffer::Iterator::Reset()
-{
-    iterator.Reset(false, buffer.range_lo.GetValuePtr(), 8*sizeof(UINT32));
-    next_block = iterator.GetNextItem();
-    ASSERT(buffer.IsEmpty() || (NULL != next_block));
-    ASSERT((NULL == next_block) || (buffer.range_lo == next_block->GetId()))
-}  // end NormBlockBuffer::Iterator::Reset()
-
-NormBlock* NormBlockBuffer::Iterator::GetNextBlock()
-{
-    NormBlock* nextBlock = next_block;
-    if (NULL != nextBlock)
-    {
-        next_block = iterator.GetNextItem();
-        if (NULL == next_block)
-        {
-            iterator.Reset();
-            next_block = iterator.GetNextItem();
-            if (buffer.Compare(next_block->GetId(), nextBlock->GetId()) <= 0)
-                next_block = NULL;
-        }
-        else if (buffer.Compare(next_block->GetId(), nextBlock->GetId()) <= 0)
-        {
-            next_block = NULL;
-        }
-    }
-    return nextBlock;
-}  // end NormBlockBuffer::Iterator::GetNextBlock()
-    
-#else
-    
 NormBlockBuffer::Iterator::Iterator(const NormBlockBuffer& blockBuffer)
  : buffer(blockBuffer), reset(true)
 {
@@ -1090,70 +1036,23 @@ NormBlockBuffer::Iterator::Iterator(const NormBlockBuffer& blockBuffer)
 
 NormBlock* NormBlockBuffer::Iterator::GetNextBlock()
 {
-    if (reset)
+    if (0 == buffer.range) return (NormBlock*)NULL;
+    // (If the prior block was removed from the low end of the
+    //  range, we pick up again at the new "range_lo")
+    if (reset || (buffer.Compare(index, buffer.range_lo) < 0))
     {
-        if (buffer.range)
-        {
-            reset = false;
-            index = buffer.range_lo;
-            return buffer.Find(index);
-        }
-        else
-        {
-            return (NormBlock*)NULL;
-        }
+        reset = false;
+        index = buffer.range_lo;
+        return buffer.Find(index);
+    }
+    else if (buffer.Compare(index, buffer.range_hi) < 0)
+    {
+        NormBlock* nextBlock = buffer.FindNext(index);
+        if (NULL != nextBlock) index = nextBlock->GetId();
+        return nextBlock;
     }
     else
     {
-        // if (buffer.range && (index < buffer.range_hi) &&  (index >= buffer.range_lo))
-        if ((0 != buffer.range) &&
-            (buffer.Compare(index, buffer.range_hi) < 0) &&
-            (buffer.Compare(index, buffer.range_lo) >= 0))
-        {
-            // Find next entry _after_ current "index"
-            UINT32 i = index.GetValue();;
-            UINT32 endex;
-            // if ((UINT32)(buffer.range_hi - index) <= buffer.hash_mask)
-            if ((UINT32)buffer.Difference(buffer.range_hi, index) <= buffer.hash_mask)
-                endex = buffer.range_hi.GetValue() & buffer.hash_mask;
-            else
-                endex = index.GetValue();
-            UINT32 offset = 0;
-            NormBlockId nextId = buffer.range_hi;
-            do
-            {
-                ++i &= buffer.hash_mask;
-                offset++;
-                // NormBlockId id = (UINT32)index + offset;
-                NormBlockId id = index;
-                buffer.Increment(id, offset);
-                ASSERT(i < 256);
-                NormBlock* entry = buffer.table[i];
-                while ((NULL != entry ) && (entry->GetId() != id)) 
-                {
-                    // if ((entry->GetId() > index) && (entry->GetId() < nextId))
-                    if ((buffer.Compare(entry->GetId(), index) > 0) && 
-                        (buffer.Compare(entry->GetId(), nextId) < 0))
-                    {
-                        nextId = entry->GetId();
-                    }
-                    entry = NormBlockBuffer::Next(entry);
-                }
-                if (entry)
-                {
-                    index = entry->GetId();
-                    return entry;   
-                } 
-            } while (i != endex);
-            // If we get here, use nextId value
-            index = nextId;
-            return buffer.Find(nextId);
-        }
-        else
-        {
-            return (NormBlock*)NULL;
-        }
-    }   
+        return (NormBlock*)NULL;
+    }
 }  // end NormBlockBuffer::Iterator::GetNextBlock()
-
-#endif  // if/else USE_PROTO_TREE
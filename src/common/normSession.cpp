@@ -5,6 +5,9 @@
 #include "normEncoderRS16.h" // 16-bit Reed-Solomon encoder of RFC 5510
 
 #include <time.h> // for gmtime() in NormTrace()
+#if !defined(WIN32) && !defined(SIMULATE)
+#include <poll.h> // for poll() in NormSession::ServiceSockets()
+#endif // !WIN32 && !SIMULATE
 
 #include "protoPktETH.h"
 #include "protoPktIP.h"
@@ -26,6 +29,7 @@ const UINT16 NormSession::DEFAULT_TX_CACHE_MAX = 256;
 const UINT32 NormSession::DEFAULT_TX_CACHE_SIZE = (UINT32)20 * 1024 * 1024;
 const double NormSession::DEFAULT_FLOW_CONTROL_FACTOR = 2.0;
 const UINT16 NormSession::DEFAULT_RX_CACHE_MAX = 256;
+const double NormSession::TX_READ_RETRY_INTERVAL = 0.001;   // sec
 
 const int NormSession::DEFAULT_ROBUST_FACTOR = 20; // default robust factor
 
@@ -45,7 +49,7 @@ enum NormSocketCommand
 NormSession::NormSession(NormSessionMgr &sessionMgr, NormNodeId localNodeId)
     : session_mgr(sessionMgr), notify_pending(false), tx_port(0), tx_port_reuse(false),
       tx_socket_actual(ProtoSocket::UDP), tx_socket(&tx_socket_actual),
-      rx_socket(ProtoSocket::UDP),
+      rx_socket(ProtoSocket::UDP), tx_blocked(false), tx_read_wait(false),
 #ifdef ECN_SUPPORT 
       proto_cap(NULL), 
 #endif // ECN_SUPPORT
@@ -59,8 +63,8 @@ NormSession::NormSession(NormSessionMgr &sessionMgr, NormNodeId localNodeId)
       next_tx_object_id(0),
       tx_cache_count_min(DEFAULT_TX_CACHE_MIN),
       tx_cache_count_max(DEFAULT_TX_CACHE_MAX),
-      tx_cache_size_max(DEFAULT_TX_CACHE_SIZE),
-      posted_tx_queue_empty(false), posted_tx_rate_changed(false), posted_send_error(false),
+      tx_cache_size_max(DEFAULT_TX_CACHE_SIZE), tx_read_ahead(0), tx_compression(false),
+      posted_tx_queue_empty(false), posted_tx_rate_changed(0), posted_send_error(false),
       acking_node_count(0), acking_auto_populate(TRACK_NONE), watermark_pending(false), watermark_flushes(false),
       tx_repair_pending(false), advertise_repairs(false),
       suppress_nonconfirmed(false), suppress_rate(-1.0), suppress_rtt(-1.0),
@@ -78,7 +82,9 @@ NormSession::NormSession(NormSessionMgr &sessionMgr, NormNodeId localNodeId)
       receiver_silent(false), rcvr_ignore_info(false), rcvr_max_delay(-1), rcvr_realtime(false),
       default_repair_boundary(NormSenderNode::BLOCK_BOUNDARY),
       default_nacking_mode(NormObject::NACK_NORMAL), default_sync_policy(NormSenderNode::SYNC_CURRENT),
-      rx_cache_count_max(DEFAULT_RX_CACHE_MAX), is_server_listener(false), notify_on_grtt_update(true),
+      rx_cache_count_max(DEFAULT_RX_CACHE_MAX), rx_write_behind(0), rx_file_resume(false), buffer_locking(false), file_mapping(false), 
+      coalesce_enable(false), coalesce_interval(0.0), coalesce_bytes(0), coalesce_latency(0.0),
+      is_server_listener(false), notify_on_grtt_update(1),
       ecn_ignore_loss(false),
       trace(false), tx_loss_rate(0.0), rx_loss_rate(0.0),
       user_data(NULL), next(NULL)
@@ -106,6 +112,10 @@ NormSession::NormSession(NormSessionMgr &sessionMgr, NormNodeId localNodeId)
     flow_control_timer.SetListener(this, &NormSession::OnFlowControlTimeout);
     flow_control_timer.SetInterval(0.0);
     flow_control_timer.SetRepeat(0);
+    
+    coalesce_timer.SetListener(this, &NormSession::OnCoalesceTimeout);
+    coalesce_timer.SetInterval(0.0);
+    coalesce_timer.SetRepeat(0);
 
     cmd_timer.SetListener(this, &NormSession::OnCmdTimeout);
     cmd_timer.SetInterval(0.0);
@@ -118,6 +128,7 @@ NormSession::NormSession(NormSessionMgr &sessionMgr, NormNodeId localNodeId)
 
     grtt_quantized = NormQuantizeRtt(DEFAULT_GRTT_ESTIMATE);
     grtt_measured = grtt_advertised = NormUnquantizeRtt(grtt_quantized);
+    PublishStatus();
 
     gsize_measured = DEFAULT_GSIZE_ESTIMATE;
     gsize_quantized = NormQuantizeGroupSize(DEFAULT_GSIZE_ESTIMATE);
@@ -350,6 +361,8 @@ void NormSession::Close()
 {
     if (report_timer.IsActive())
         report_timer.Deactivate();
+    if (coalesce_timer.IsActive())
+        coalesce_timer.Deactivate();
     if (is_sender)
         StopSender();
     if (is_receiver)
@@ -360,6 +373,7 @@ void NormSession::Close()
     message_pool.Destroy();
     if (tx_socket->IsOpen())
         tx_socket->Close();
+    tx_blocked = false;
     if (rx_socket.IsOpen())
     {
         if (address.IsMulticast())
@@ -599,20 +613,25 @@ void NormSession::SetTxOnly(bool txOnly, bool connectToSessionAddress)
     }
 } // end NormSession::SetTxOnly()
 
-double NormSession::GetTxRate()
+// Publishes the current rate and grtt for lock-free reading by API
+// getters.  This should be called before any TX_RATE_CHANGED or 
+// GRTT_UPDATED notification is posted.
+void NormSession::PublishStatus()
 {
-    posted_tx_rate_changed = false;
+    Status status;
     if (cc_enable && !cc_adjust)
     {
-        // Return rate of CLR
+        // Report rate of CLR
         const NormCCNode *clr = static_cast<const NormCCNode *>(cc_node_list.Head());
-        return ((NULL != clr) ? 8.0 * clr->GetRate() : 0.0);
+        status.tx_rate = ((NULL != clr) ? 8.0 * clr->GetRate() : 0.0);
     }
     else
     {
-        return (8.0 * tx_rate);
+        status.tx_rate = 8.0 * tx_rate;
     }
-} // end NormSession::GetTxRate()
+    status.grtt = grtt_advertised;
+    status_snapshot.Publish(status);
+} // end NormSession::PublishStatus()
 
 /*
 // This hack can be uncommented give us a tx rate interval that is POISSON instead of PERIODIC
@@ -637,6 +656,7 @@ void NormSession::SetTxRateInternal(double txRate)
     if (!is_sender)
     {
         tx_rate = txRate;
+        PublishStatus();
         return;
     }
     if (txRate < 0.0)
@@ -691,11 +711,9 @@ void NormSession::SetTxRateInternal(double txRate)
                  (unsigned long)LocalNodeId(),
                  (grttQuantizedOld < grtt_quantized) ? "increased" : "decreased",
                  grtt_advertised);
-            if (notify_on_grtt_update)
-            {
-                notify_on_grtt_update = false;
+            PublishStatus();
+            if (0 != NormAtomicExchange(&notify_on_grtt_update, 0))
                 Notify(NormController::GRTT_UPDATED, (NormSenderNode *)NULL, (NormObject *)NULL);
-            }
         }
         // wakeup grtt/cc probing if necessary
         if (probe_reset)
@@ -706,11 +724,12 @@ void NormSession::SetTxRateInternal(double txRate)
                 ActivateTimer(probe_timer);
         }
     }
+    PublishStatus();
 } // end NormSession::SetTxRateInternal()
 
 void NormSession::SetTxRateBounds(double rateMin, double rateMax)
 {
-    posted_tx_rate_changed = false;
+    NormAtomicStore(&posted_tx_rate_changed, 0);
     // Make sure min <= max
     if ((rateMin >= 0.0) && (rateMax >= 0.0))
     {
@@ -824,7 +843,7 @@ bool NormSession::StartSender(UINT16 instanceId,
         return false;
     }
 
-    if (!segment_pool.Init((unsigned int)numSegments, segmentSize + NormDataMsg::GetStreamPayloadHeaderLength()))
+    if (!segment_pool.Init((unsigned int)numSegments, segmentSize + NormDataMsg::GetStreamPayloadHeaderLength(), buffer_locking))
     {
         PLOG(PL_FATAL, "NormSession::StartSender() segment_pool init error\n");
         StopSender();
@@ -998,6 +1017,7 @@ void NormSession::StopSender()
     }
     acking_node_tree.Destroy();
     cc_node_list.Destroy();
+    PublishStatus();
     // Iterate tx_table and release objects
     while (!tx_table.IsEmpty())
     {
@@ -1154,6 +1174,7 @@ void NormSession::Serve()
         ASSERT(tx_timer.IsActive());
         return;
     }
+    tx_read_wait = false;
 
     // Queue next sender message
     NormObjectId objectId;
@@ -1311,6 +1332,7 @@ void NormSession::Serve()
         {
             if (obj->NextSenderMsg(msg))
             {
+                obj->UpdateStatus();
                 if (cc_enable && !data_active)
                 {
                     data_active = true;
@@ -1401,6 +1423,12 @@ void NormSession::Serve()
                         return;
                     }
                 }
+                else if ((NormObject::FILE == obj->GetType()) &&
+                         static_cast<NormFileObject *>(obj)->IsReadPending())
+                {
+                    // File content is still being loaded (see OnTxTimeout())
+                    tx_read_wait = true;
+                }
                 else
                 {
                     PLOG(PL_ERROR, "NormSession::Serve() pending non-stream obj, no message?.\n");
@@ -1952,6 +1980,46 @@ NormDataObject *NormSession::QueueTxData(const char* dataPtr,
     }
 } // end NormSession::QueueTxData()
 
+NormDataObject *NormSession::QueueTxDataV(const struct iovec*                         iov,
+                                          unsigned int                                iovCount,
+                                          NormDataObject::ExtentReleaseFunctionHandle releaseFunc,
+                                          const void*                                 releaseData,
+                                          const char*                                 infoPtr,
+                                          UINT16                                      infoLen)
+{
+    if (!IsSender())
+    {
+        PLOG(PL_FATAL, "NormSession::QueueTxDataV() Error: sender is closed\n");
+        return NULL;
+    }
+    NormDataObject *obj = new NormDataObject(*this, (NormSenderNode *)NULL, next_tx_object_id, session_mgr.GetDataFreeFunction());
+    if (!obj)
+    {
+        PLOG(PL_FATAL, "NormSession::QueueTxDataV() new data object error: %s\n",
+             GetErrorString());
+        return NULL;
+    }
+    if (!obj->OpenV(iov, iovCount, releaseFunc, releaseData, infoPtr, infoLen))
+    {
+        PLOG(PL_FATAL, "NormSession::QueueTxDataV() object open error\n");
+        obj->Release();
+        return NULL;
+    }
+    if (QueueTxObject(obj))
+    {
+        return obj;
+    }
+    else
+    {
+        // The caller keeps the extents when enqueue fails, so
+        // the release function must not be invoked for them
+        obj->DetachExtents();
+        obj->Close();
+        obj->Release();
+        return NULL;
+    }
+} // end NormSession::QueueTxDataV()
+
 NormStreamObject *NormSession::QueueTxStream(UINT32      bufferSize,
                                              bool        doubleBuffer,
                                              const char* infoPtr,
@@ -2308,6 +2376,7 @@ void NormSession::TxSocketRecvHandler(ProtoSocket &theSocket,
     {
         // This is a little cheesy, but ...
         theSocket.StopOutputNotification();
+        tx_blocked = false;
         if (tx_timer.IsActive())
             tx_timer.Deactivate();
         if (OnTxTimeout(tx_timer))
@@ -2433,6 +2502,7 @@ void NormSession::RxSocketRecvHandler(ProtoSocket &theSocket,
     {
         // This is a little cheesy, but ...
         theSocket.StopOutputNotification();
+        tx_blocked = false;
         if (tx_timer.IsActive())
             tx_timer.Deactivate();
         if (OnTxTimeout(tx_timer))
@@ -2443,6 +2513,74 @@ void NormSession::RxSocketRecvHandler(ProtoSocket &theSocket,
     } // end if/else (theEvent == RECV/SEND)
 } // end NormSession::RxSocketRecvHandler()
 
+#if !defined(WIN32) && !defined(SIMULATE)
+unsigned int NormSession::GetDescriptors(int* fdArray, unsigned int arraySize) const
+{
+    unsigned int count = 0;
+    if (rx_socket.IsOpen() && (count < arraySize))
+        fdArray[count++] = rx_socket.GetHandle();
+    if ((tx_socket != &rx_socket) && tx_socket->IsOpen() && (count < arraySize))
+        fdArray[count++] = tx_socket->GetHandle();
+    return count;
+}  // end NormSession::GetDescriptors()
+
+// Polls (without waiting) the session sockets and invokes the same
+// handlers the dispatcher would for any that are ready.  Returns
+// the number of socket handlers invoked.
+unsigned int NormSession::ServiceSockets()
+{
+    struct pollfd fds[2];
+    ProtoSocket* sockets[2];
+    nfds_t nfds = 0;
+    if (rx_socket.IsOpen())
+    {
+        fds[nfds].fd = rx_socket.GetHandle();
+        fds[nfds].events = POLLIN;
+        if (tx_blocked && (tx_socket == &rx_socket)) 
+            fds[nfds].events |= POLLOUT;
+        sockets[nfds++] = &rx_socket;
+    }
+    if ((tx_socket != &rx_socket) && tx_socket->IsOpen())
+    {
+        fds[nfds].fd = tx_socket->GetHandle();
+        fds[nfds].events = tx_blocked ? (POLLIN | POLLOUT) : POLLIN;
+        sockets[nfds++] = tx_socket;
+    }
+    if (0 == nfds) return 0;
+    int result = poll(fds, nfds, 0);
+    if (result <= 0)
+    {
+        if ((result < 0) && (EINTR != errno))
+            PLOG(PL_ERROR, "NormSession::ServiceSockets() poll() error: %s\n", GetErrorString());
+        return 0;
+    }
+    unsigned int count = 0;
+    for (nfds_t i = 0; i < nfds; i++)
+    {
+        ProtoSocket& theSocket = *sockets[i];
+        // (the rx_socket handler also serves as the tx_socket handler when shared)
+        bool isRx = (&theSocket == &rx_socket);
+        if (0 != (fds[i].revents & (POLLIN | POLLERR)))
+        {
+            if (isRx)
+                RxSocketRecvHandler(theSocket, ProtoSocket::RECV);
+            else
+                TxSocketRecvHandler(theSocket, ProtoSocket::RECV);
+            count++;
+        }
+        if (0 != (fds[i].revents & POLLOUT))
+        {
+            if (isRx)
+                RxSocketRecvHandler(theSocket, ProtoSocket::SEND);
+            else
+                TxSocketRecvHandler(theSocket, ProtoSocket::SEND);
+            count++;
+        }
+    }
+    return count;
+}  // end NormSession::ServiceSockets()
+#endif // !WIN32 && !SIMULATE
+
 #ifdef ECN_SUPPORT
 #ifndef SIMULATE
 void NormSession::OnPktCapture(ProtoChannel &theChannel,
@@ -3274,11 +3412,9 @@ void NormSession::SenderUpdateGrttEstimate(double receiverRtt)
         grtt_current_peak = grtt_measured;
         if (grttQuantizedOld != grtt_quantized)
         {
-            if (notify_on_grtt_update)
-            {
-                notify_on_grtt_update = false;
+            PublishStatus();
+            if (0 != NormAtomicExchange(&notify_on_grtt_update, 0))
                 Notify(NormController::GRTT_UPDATED, (NormSenderNode *)NULL, (NormObject *)NULL);
-            }
             Notify(NormController::GRTT_UPDATED, (NormSenderNode *)NULL, (NormObject *)NULL);
             PLOG(PL_DEBUG, "NormSession::SenderUpdateGrttEstimate() node>%lu increased to new grtt>%lf sec\n",
                  (unsigned long)LocalNodeId(), grtt_advertised);
@@ -4595,6 +4731,74 @@ bool NormSession::OnFlowControlTimeout(ProtoTimer &theTimer)
     return false;
 } // end NormSession::OnFlowControlTimeout()
 
+// When enabled, an RX_OBJECT_UPDATED or TX_QUEUE_VACANCY is held until
+// at least "minBytes" of new data (or stream buffer space) is available
+// and no more than "maxRate" such events per second are posted per object.
+// No event is held longer than "maxLatency" seconds.
+void NormSession::SetEventCoalescing(double maxRate, UINT32 minBytes, double maxLatency)
+{
+    bool enable = (maxRate > 0.0) || (0 != minBytes);
+    coalesce_interval = (maxRate > 0.0) ? (1.0 / maxRate) : 0.0;
+    coalesce_bytes = minBytes;
+    coalesce_latency = maxLatency;
+    if (coalesce_enable && !enable)
+    {
+        // Post any events still being held
+        if (coalesce_timer.IsActive())
+            coalesce_timer.Deactivate();
+        coalesce_enable = false;
+        ServiceHeldEvents(true);
+    }
+    coalesce_enable = enable;
+} // end NormSession::SetEventCoalescing()
+
+// Makes sure the "coalesce_timer" fires within "delay" seconds
+void NormSession::ActivateCoalesceTimer(double delay)
+{
+    if (delay < 1.0e-06) delay = 1.0e-06;  // see OnFlowControlTimeout() note
+    if (coalesce_timer.IsActive())
+    {
+        if (coalesce_timer.GetTimeRemaining() > delay)
+        {
+            coalesce_timer.SetInterval(delay);
+            coalesce_timer.Reschedule();
+        }
+    }
+    else
+    {
+        coalesce_timer.SetInterval(delay);
+        ActivateTimer(coalesce_timer);
+    }
+} // end NormSession::ActivateCoalesceTimer()
+
+bool NormSession::OnCoalesceTimeout(ProtoTimer &theTimer)
+{
+    double nextDelay = ServiceHeldEvents(false);
+    if (nextDelay < 0.0) return true;  // no more held events
+    if (nextDelay < 1.0e-06) nextDelay = 1.0e-06;
+    theTimer.SetInterval(nextDelay);
+    theTimer.Reschedule();
+    return false;
+} // end NormSession::OnCoalesceTimeout()
+
+// Posts held events that are now due (or all if "flush" is true) and returns
+// the delay until the next remaining held event is due (-1.0 if none).
+// (Objects are found via the tx_table and sender rx_tables so that objects
+//  deleted while an event was held need no further cleanup)
+double NormSession::ServiceHeldEvents(bool flush)
+{
+    double nextDelay = -1.0;
+    NormObjectTable::Iterator txIterator(tx_table);
+    NormObject *obj;
+    while (NULL != (obj = txIterator.GetNextObject()))
+        obj->ServiceHeldEvent(flush, nextDelay);
+    NormNodeTreeIterator nodeIterator(sender_tree);
+    NormNode *node;
+    while (NULL != (node = nodeIterator.GetNextNode()))
+        static_cast<NormSenderNode *>(node)->ServiceHeldEvents(flush, nextDelay);
+    return nextDelay;
+} // end NormSession::ServiceHeldEvents()
+
 bool NormSession::SenderBuildRepairAdv(NormCmdRepairAdvMsg &cmd)
 {
     // Build a NORM_CMD(REPAIR_ADV) message with current pending repair state.
@@ -4864,6 +5068,7 @@ bool NormSession::OnTxTimeout(ProtoTimer & /*theTimer*/)
                 if (tx_timer.IsActive())
                     tx_timer.Deactivate();
                 tx_socket->StartOutputNotification();
+                tx_blocked = true;
                 return false; // since timer was deactivated
 
             case MSG_SEND_FAILED:
@@ -4886,6 +5091,12 @@ bool NormSession::OnTxTimeout(ProtoTimer & /*theTimer*/)
 
         if (message_queue.IsEmpty())
         {
+            if (tx_read_wait && tx_timer.IsActive())
+            {
+                // Check back shortly for file read-ahead completion
+                tx_timer.SetInterval(TX_READ_RETRY_INTERVAL);
+                return true;
+            }
             if (tx_timer.IsActive())
                 tx_timer.Deactivate();
             // Check that any possible notifications posted in
@@ -5362,6 +5573,7 @@ bool NormSession::OnProbeTimeout(ProtoTimer & /*theTimer*/)
             }
             if (grttQuantizedOld != grtt_quantized)
             {
+                PublishStatus();
                 Notify(NormController::GRTT_UPDATED, (NormSenderNode *)NULL, (NormObject *)NULL);
                 PLOG(PL_DEBUG, "NormSession::OnProbeTimeout() node>%lu decreased to new grtt to: %lf sec\n",
                      (unsigned long)LocalNodeId(), grtt_advertised);
@@ -5661,6 +5873,7 @@ void NormSession::AdjustRate(bool onResponse)
     // Limit rate to tx_rate_max if that has been set
     if ((tx_rate_max >= 0.0) && (txRate > tx_rate_max))
         txRate = tx_rate_max;
+    if (!cc_adjust) PublishStatus();  // CLR rate is reported
     if (txRate != tx_rate)
     {
         // TBD - don't adjust rate more than double per RTT all the time???
@@ -5668,13 +5881,12 @@ void NormSession::AdjustRate(bool onResponse)
         //if (txRate > rateDouble) txRate = rateDouble;
         if (cc_adjust)
             SetTxRateInternal(txRate);
-        if (!posted_tx_rate_changed)
+        if (0 == NormAtomicExchange(&posted_tx_rate_changed, 1))
         {
             // TBD - make API notification filtering more consistent
             // (e.g., "notify_on_rate_update" like for grtt, etc
             //  putting API code in charge of resetting these API
             //  state variables).
-            posted_tx_rate_changed = true;
             Notify(NormController::TX_RATE_CHANGED, (NormSenderNode *)NULL, (NormObject *)NULL);
         }
     }
@@ -5788,7 +6000,8 @@ NormSessionMgr::NormSessionMgr(ProtoTimerMgr &timerMgr,
                                ProtoSocket::Notifier &socketNotifier,
                                ProtoChannel::Notifier *channelNotifier)
     : timer_mgr(timerMgr), socket_notifier(socketNotifier), channel_notifier(channelNotifier),
-      controller(NULL), data_free_func(NULL), top_session(NULL)
+      controller(NULL), data_free_func(NULL), data_alloc_func(NULL), top_session(NULL),
+      service_next(NULL)
 {
 }
 
@@ -5805,6 +6018,7 @@ void NormSessionMgr::Destroy()
         top_session = next->next;
         delete next;
     }
+    service_next = NULL;
 } // end NormSessionMgr::Destroy()
 
 NormSession *NormSessionMgr::NewSession(const char *sessionAddress,
@@ -5862,6 +6076,58 @@ void NormSessionMgr::DeleteSession(class NormSession *theSession)
             prev->next = theSession->next;
         else
             top_session = theSession->next;
+        if (theSession == service_next)
+            service_next = theSession->next;
         delete theSession;
     }
 } // end NormSessionMgr::DeleteSession()
+
+#if !defined(WIN32) && !defined(SIMULATE)
+unsigned int NormSessionMgr::GetDescriptors(int* fdArray, unsigned int arraySize) const
+{
+    unsigned int count = 0;
+    NormSession* next = top_session;
+    while ((NULL != next) && (count < arraySize))
+    {
+        count += next->GetDescriptors(fdArray + count, arraySize - count);
+        next = next->next;
+    }
+    return count;
+}  // end NormSessionMgr::GetDescriptors()
+
+// Services ready session sockets, stopping once "maxCount" socket
+// handlers have been invoked (zero means no limit).  Sessions are
+// visited round-robin, each pass resuming after the last session the
+// previous pass serviced so a busy session can't starve the others.
+unsigned int NormSessionMgr::ServiceSockets(unsigned int maxCount)
+{
+    unsigned int sessionCount = 0;
+    NormSession* next = top_session;
+    while (NULL != next)
+    {
+        sessionCount++;
+        next = next->next;
+    }
+    unsigned int count = 0;
+    next = (NULL != service_next) ? service_next : top_session;
+    for (unsigned int i = 0; (i < sessionCount) && (NULL != next); i++)
+    {
+        count += next->ServiceSockets();
+        next = (NULL != next->next) ? next->next : top_session;
+        if ((0 != maxCount) && (count >= maxCount)) break;
+    }
+    service_next = next;
+    return count;
+}  // end NormSessionMgr::ServiceSockets()
+
+bool NormSessionMgr::IsTxBlocked() const
+{
+    NormSession* next = top_session;
+    while (NULL != next)
+    {
+        if (next->IsTxBlocked()) return true;
+        next = next->next;
+    }
+    return false;
+}  // end NormSessionMgr::IsTxBlocked()
+#endif // !WIN32 && !SIMULATE